@@ -7,10 +7,21 @@
  * @date 29/04/2024
 """
 
+import machine
 from machine import Pin
 import utime
 import math
 
+# Ruta de muestras nativa (py_native/): si siggen_native.mpy y siggen.py estan en la placa, las muestras
+# salen del modulo nativo temporizado y el teclado sigue en Python; si no, se usa generator()
+try:
+    import siggen
+except ImportError:
+    siggen = None
+
+# Tiempo que el modulo nativo genera la señal entre dos lecturas del teclado
+SLICE_US = 20000
+
 # Definir los pines GPIO utilizados para controlar el DAC0808
 D0 = machine.Pin(16, machine.Pin.OUT)
 D1 = machine.Pin(17, machine.Pin.OUT)
@@ -261,6 +272,9 @@ def main():
     samp_t = utime.ticks_us()
     samp_freq = int(1000000.0 / points / frequency)
 
+    gen = siggen.Generator() if siggen else None
+    applied = None  # Parámetros que tiene el modulo nativo
+
     next_execution_time = utime.ticks_ms()  # Tiempo para la próxima ejecución del ciclo
     while True:
         amplitude, offsete, frequency, text_input, last_keypress_time, samp_freq = check_keypress(row_pins, col_pins, matrix_keys, last_keypress_time, text_input, amplitude, offsete, frequency, points, samp_freq)
@@ -269,7 +283,12 @@ def main():
             if current_time - last_button_press > 300:
                 count = (count + 1) % 4  # Incrementar el contador al presionar el botón
                 last_button_press= current_time
-        if utime.ticks_us() - samp_t > samp_freq:
+        if gen:
+            if applied != (count, amplitude, offsete, frequency):
+                applied = (count, amplitude, offsete, frequency)
+                gen.setup(count, amplitude, offsete, frequency)
+            gen.play(SLICE_US)
+        elif utime.ticks_us() - samp_t > samp_freq:
             generator(count, amplitude, offsete)
             samp_t = utime.ticks_us()
             
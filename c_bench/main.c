@@ -0,0 +1,56 @@
+/**
+ * @file main.c
+ * @brief Microbenchmarks del camino de muestras sobre el RP2040.
+ *
+ * Mide con SysTick (ciclos del procesador) cada variante de la suite de
+ * microbench.h: escalado del generador, lectura de tabla por forma de onda
+ * y estrategias de escritura del bus del DAC0808. Los resultados salen por
+ * USB serial con el mismo CSV que host/bench_micro, para poder comparar
+ * entre versiones. Cualquier tecla recibida repite la suite.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+
+#include "microbench.h"
+
+#ifndef MICROBENCH_OPS
+#define MICROBENCH_OPS 16384 ///< Operaciones medidas por variante
+#endif
+
+/**
+ * @brief Run every kernel variant and print its CSV line.
+ *
+ * Interrupts are off while a variant runs, so the USB stack does not show
+ * up in the cycle counts; they are back on to print.
+ */
+void run_suite(void) {
+    char line[160];
+    microbench_csv_header(line, sizeof(line));
+    fputs(line, stdout);
+    for (uint32_t i = 0; i < microbench_count; i++) {
+        microbench_result_t r;
+        uint32_t status = save_and_disable_interrupts();
+        microbench_run(&microbench_suite[i], MICROBENCH_OPS, &r);
+        restore_interrupts(status);
+        microbench_csv_line(&microbench_suite[i], &r, line, sizeof(line));
+        fputs(line, stdout);
+    }
+}
+
+/**
+ * @brief Main function.
+ */
+int main() {
+    stdio_init_all();
+    microbench_hw_init();
+    while (!stdio_usb_connected()) {
+        sleep_ms(100); ///< esperar al monitor serial
+    }
+    while (true) {
+        run_suite();
+        getchar(); ///< repetir con cualquier tecla
+    }
+}
@@ -19,10 +19,44 @@
 #include "hardware/gpio.h"
 #include "hardware/sync.h"
 #include "hardware/timer.h"
+#include "pico/stdio_usb.h"
 #include <math.h>
 #include "pico/time.h"
 
 // Include your own header files here
+#include "alarm_sched.h"
+#include "dds.h"
+#include "gen_block.h"
+#include "keypad.h"
+#include "log_ring.h"
+#include "mailbox.h"
+#include "modulation.h"
+#include "param_txn.h"
+#include "preset_store.h"
+#include "wave_cache.h"
+#include "wave_upload.h"
+#include "waveform.h"
+#if !SIGGEN_PIO_OUTPUT && !SIGGEN_IQ_OUTPUT
+#include "stream_rx.h"
+#define SIGGEN_STREAM_INPUT 1 ///< Codigos enviados por el host (solo con el reloj de 20 kHz)
+#else
+#define SIGGEN_STREAM_INPUT 0
+#endif
+#if SIGGEN_PIO_OUTPUT
+#include "hardware/clocks.h"
+#include "clock_plan.h"
+#include "dac_stream.h"
+#endif
+#if SIGGEN_DUAL_CORE
+#include "pico/flash.h"
+#include "pico/multicore.h"
+#endif
+#if SIGGEN_LATENCY_PROBES
+#include "latency_hist.h"
+#endif
+#if SIGGEN_IQ_OUTPUT
+#include "multichan.h"
+#endif
 
 /**
  * @brief Main program.
@@ -39,7 +73,23 @@
 #define D6_PIN 22
 #define D7_PIN 26
 #define Button_pin 1
+#define IQ_CHANNELS 2 ///< Canal 0 en el bus del DAC, canal 1 desfasado (SIGGEN_IQ_OUTPUT)
 #define MAX_LETTERS_PRESSED 10
+#define SAMPLE_RATE_HZ 20000 ///< Reloj de muestreo fijo del DDS (TIMER_IRQ_2)
+#define SAMPLE_PERIOD_US (1000000 / SAMPLE_RATE_HZ)
+#define PIO_SAMPLE_RATE_HZ 1000000 ///< Reloj de muestreo del DDS con salida por PIO
+#if SIGGEN_PIO_OUTPUT
+#define MAX_FREQUENCY_MHZ 1000000000u ///< Frecuencia maxima aceptada: 1 MHz, lo que cubre clock_plan()
+#else
+#define MAX_FREQUENCY_MHZ (SAMPLE_RATE_HZ * 500u) ///< Frecuencia maxima aceptada: Nyquist
+#endif
+#define SEQUENCE_PERIOD_US 2000 ///< Barrido de las filas del teclado
+#define PRINT_PERIOD_US 1000000 ///< Impresion del estado
+#define UI_ALARM 0 ///< Alarma compartida por el barrido y la impresion
+#define SIGNAL_ALARM 2 ///< Alarma exclusiva del reloj de muestreo
+#define LOG_DRAIN_BATCH 4 ///< Registros enviados por vuelta del bucle principal
+#define SERIAL_BATCH 64 ///< Bytes leidos del puerto serie por vuelta del bucle principal
+#define AUTOSAVE_DELAY_US 5000000 ///< Quietud antes de guardar la configuracion en la flash (cada guardado detiene la salida)
 
 // Define signal types and their corresponding waveforms
 const char matrix_keys[4][4] = {
@@ -49,88 +99,327 @@ const char matrix_keys[4][4] = {
     {'*', '0', '#', 'D'}
 };
 
-// Define waveforms for signal generation
-
-const uint8_t seno [] = { ///< forma de onda senoidal
-    128, 136, 144, 152, 160, 167, 175, 182, 189, 196, 203, 209, 215, 221, 226, 231, 236, 240,
-    243, 247, 249, 251, 253, 254, 255, 255, 255, 254, 252, 250, 248, 245, 242, 238, 234, 229,
-    224, 218, 213, 206, 200, 193, 186, 179, 171, 163, 156, 148, 140, 132, 123, 115, 107,  99,
-    92,  84,  76,  69,  62,  55,  49,  42,  37,  31,  26,  21,  17,  13,  10,   7,   5,   3,
-    1,   0,   0,   0,   1,   2,   4,   6,   8,  12,  15,  19,  24,  29,  34,  40,  46,  52,
-    59,  66,  73,  80,  88,  95, 103, 111, 119, 127
-};
-
-const uint8_t triangular [] = { ///< forma de onda triangular
-      0,   5,  10,  15,  20,  26,  31,  36,  41,  46,  51,  56,  61,  66,  71,  76,  82,
-        87,  92,  97, 102, 107, 112, 117, 122, 127, 133, 138, 143, 148, 153, 158, 163, 168,
-       173, 178, 184, 189, 194, 199, 204, 209, 214, 219, 224, 229, 235, 240, 245, 250, 255,
-       250, 245, 240, 235, 229, 224, 219, 214, 209, 204, 199, 194, 189, 184, 178, 173, 168,
-       163, 158, 153, 148, 143, 138, 133, 127, 122, 117, 112, 107, 102,  97,  92,  87,  82,
-        77,  71,  66,  61,  56,  51,  46,  41,  36,  31,  25,  20,  15,  10,   5
-};
-
-const uint8_t sierra [] = { ///< forma de onda diente de sierra
-    129, 131, 134, 137, 139, 142, 144, 147, 149, 152, 155, 157, 160, 162, 165, 167,
-        170, 173, 175, 178, 180, 183, 185, 188, 191, 193, 196, 198, 201, 203, 206, 209,
-        211, 214, 216, 219, 222, 224, 227, 229, 232, 234, 237, 240, 242, 245, 247, 250,
-        252, 255,   0,   3,   5,   8,  10,  13,  15,  18,  21,  23,  26,  28,  31,  33,
-         36,  39,  41,  44,  46,  49,  52,  54,  57,  59,  62,  64,  67,  70,  72,  75,
-         77,  80,  82,  85,  88,  90,  93,  95,  98, 100, 103, 106, 108, 111, 113, 116,
-        118, 121, 124, 126
-};
-
-const uint8_t cuadrada [] = { ///< forma de onda cuadrada
-    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   0,   0,   0,
-      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
-};
+// Waveforms for signal generation are generated at build time (waveform_tables.h)
 
 // Define GPIO pins for keyboard rows and columns
 const uint gpio_rows[] = {2, 3, 4, 5};
 const uint gpio_columns[] = {6, 7, 8, 9};
 
 // Global variables for signal generation parameters
-uint8_t signal_index = 0; ///< Índice de la señal actual en la forma de onda
-uint8_t sequence = 0; ///< Índice de la secuencia actual de generación de señales
+keypad_t keypad; ///< Barrido, antirrebote y cola de eventos del teclado matricial
 uint8_t signal_count=0; ///< Contador para el tipo de señal actual
 uint32_t amplitude = 1000; ///< Amplitud de la señal predeterminado
 uint32_t offsete = 100;  ///< Desplazamiento de la señal (offset) predeterminado
-uint32_t frequency = 10; ///< Frecuencia de la señal
-uint32_t points = 100; ///< Número de puntos de muestreo de la señal
-uint32_t samp_freq; ///< Frecuencia de muestreo de la señal
+uint32_t frequency = 10000; ///< Frecuencia de la señal en mHz
+uint32_t phase_deg = 90; ///< Desfase del segundo canal en grados
+uint8_t modulation = MOD_NONE; ///< Barrido o modulacion de la portadora
+uint32_t mod_arg = 0; ///< Fin del barrido o desviacion (mHz), profundidad de AM (%)
+uint32_t mod_time = 0; ///< Duracion del barrido (ms) o frecuencia moduladora (mHz)
+uint32_t user_gen = 0; ///< Tablas cargadas por el puerto serie
+uint32_t sample_rate = SAMPLE_RATE_HZ; ///< Frecuencia de muestreo efectiva del DDS
+alarm_sched_t ui_sched; ///< Barrido del teclado e impresion, multiplexados en la alarma0
+alarm_sched_t signal_sched; ///< Reloj de muestreo en la alarma2
+alarm_task_t sequence_task; ///< Barrido de las filas del teclado
+alarm_task_t print_task; ///< Impresion del estado
+alarm_task_t signal_task; ///< Muestra del generador
+uint32_t missed_reported = 0; ///< Plazos perdidos ya informados
+wave_cache_t wave_cache; ///< Periodo ya escalado que lee el generador
+gen_state_t gen = { .cache = &wave_cache }; ///< Acumulador de fase y periodo del generador
+siggen_params_t engine; ///< Parametros que esta usando el generador
+mod_t mods[2]; ///< Modulacion activa y la que se prepara
+mod_t *volatile mod_active = &mods[0]; ///< Modulacion que lee el generador
+wave_upload_t upload; ///< Recepcion de formas de onda por el puerto serie
+waveform_sample_t user_waves[2][WAVEFORM_LENGTH]; ///< Tabla cargada y la que se recibe (user_gen par o impar)
+#if SIGGEN_STREAM_INPUT
+stream_rx_t stream; ///< Codigos enviados por el host para el DAC
+#endif
+#if SIGGEN_IQ_OUTPUT
+multichan_t channels; ///< Los dos canales, con la fase y el reloj de muestreo compartidos
+// D0-D7 del DAC de cada canal
+const uint8_t iq_pins[IQ_CHANNELS][MULTICHAN_BITS] = {
+    {D0_PIN, D1_PIN, D2_PIN, D3_PIN, D4_PIN, D5_PIN, D6_PIN, D7_PIN},
+    {10, 11, 12, 13, 14, 15, 27, 28}
+};
+#endif
+volatile bool params_dirty = false; ///< Hay parametros nuevos para el generador
+uint32_t txn_prepare_us = 0; ///< Tiempo de preparacion del ultimo cambio del periodo o la frecuencia
+uint32_t txn_reported = 0; ///< Ultimo cambio aplicado ya informado
+preset_store_t presets; ///< Ultima configuracion y presets guardados en la flash
+bool autosave_pending = false; ///< Hay una configuracion confirmada sin guardar
+uint32_t autosave_at = 0; ///< Instante del guardado diferido
+volatile uint32_t first_sample_us = 0; ///< Instante de la primera muestra (0: aun no)
+uint32_t boot_read_us = 0; ///< Lectura de la flash al arrancar
+bool first_sample_reported = false; ///< Tiempo de arranque ya informado
+#if SIGGEN_DUAL_CORE
+mailbox_t param_mailbox; ///< Parametros del nucleo 0 al nucleo 1
+#endif
+log_ring_t log_main; ///< Registros del bucle principal (comandos)
+log_ring_t log_ui; ///< Registros de la alarma 0 (estado periodico)
+log_drain_t log_out; ///< Envio por USB de los registros, como texto o telemetria binaria
 uint8_t letter_index = 0; ///< Índice para el texto ingresado por el usuario
-volatile char current_key = '\0'; ///< Tecla actual presionada en el teclado matricial
-char text_input[MAX_LETTERS_PRESSED] = ""; ///< Almacena el texto ingresado por el usuario
+char text_input[MAX_LETTERS_PRESSED + 1] = ""; ///< Almacena el texto ingresado por el usuario
+#if SIGGEN_PIO_OUTPUT
+dac_stream_t dac_stream; ///< Salida por PIO + DMA
+clock_planner_t planner; ///< Relojes del PLL posibles y limites de los planes
+clock_plan_t clock_now; ///< Reloj, divisor del PIO y sintonia en uso
+uint32_t boot_sys_khz = 0; ///< Reloj del sistema al arrancar (el de las modulaciones)
+uint32_t clock_plans = 0; ///< Planes de reloj aplicados
+uint32_t clock_reported = 0; ///< Ultimo plan ya informado
+#endif
+
+#if SIGGEN_LATENCY_PROBES
+// Retraso y duracion de cada manejador (comandos 'L', 'H' y 'R' por el puerto serie)
+enum { PROBE_SIGNAL, PROBE_SEQUENCE, PROBE_PRINT, PROBE_GPIO, PROBE_COUNT };
+latency_probe_t probes[PROBE_COUNT] = {
+    { .name = "signal" }, { .name = "sequence" }, { .name = "print" }, { .name = "gpio" }
+};
+#define PROBE_ENTER(id, scheduled) \
+    uint32_t probe_start = time_us_32(); \
+    if (scheduled) latency_probe_enter(&probes[id], (scheduled), probe_start)
+#define PROBE_EXIT(id) latency_probe_exit(&probes[id], probe_start, time_us_32())
+#else
+#define PROBE_ENTER(id, scheduled)
+#define PROBE_EXIT(id)
+#endif
 
 // Define debounce time for button pres
 const uint32_t DEBOUNCE_TIME_US = 500000; // 500 ms
-uint64_t last_press_time = 0; ///< Tiempo de la última pulsación del teclado
 uint64_t last_press_button_time = 0;///< Tiempo de la última pulsación del botón físico
 
 
 // Function prototypes
-void initialize_samp_freq(void);
+void update_tuning_word(void);
+void engine_apply(const siggen_params_t *p);
+void modulation_apply(void);
+siggen_params_t ui_params(void);
+const char *stage_command(param_txn_t *txn, const char *cmd);
+void ui_commit(const siggen_params_t *p, uint32_t staged);
+void ui_load(const siggen_params_t *p);
+void preset_command(bool save, uint32_t slot);
+void autosave(void);
+void report_boot(void);
+void publish_params(void);
+void flush_params(void);
 void set_dac_value(uint8_t value);
 void analyze_text_input(void);
-void generator(uint8_t type, uint32_t Amp, uint32_t DC);
+void generator(void);
 void gpio_callback(uint gpio, uint32_t events);
-void callback_keypress(uint gpio, uint32_t events);
+void handle_key(char key);
 void callback_pressed(uint gpio, uint32_t events);
 void setup_keyboard(void);
-void timer_sequence_handler(void);
-void timerPrintHandler(void);
-void timerSignalHandler(void);
+void setup_ui_timers(void);
+void timer_sequence_handler(alarm_task_t *t, void *ctx);
+void timerPrintHandler(alarm_task_t *t, void *ctx);
+void timerSignalHandler(alarm_task_t *t, void *ctx);
 void timerPrintCallback(void);
+void serial_command(int ch);
+void load_user_wave(void);
+void read_serial(void);
+#if SIGGEN_STREAM_INPUT
+uint32_t read_stream(uint32_t budget);
+void report_stream(void);
+#endif
+void write_log(const uint8_t *buf, uint32_t len, void *ctx);
+#if SIGGEN_LATENCY_PROBES
+void write_serial(const char *line, void *ctx);
+#endif
 void setup_button(void);
+#if !SIGGEN_PIO_OUTPUT
+void setup_dac_pins(void);
+#endif
+#if SIGGEN_IQ_OUTPUT
+void setup_channels(void);
+#endif
+#if SIGGEN_PIO_OUTPUT
+void fill_dac_codes(uint8_t *codes, uint32_t count, void *ctx);
+bool plan_clocks(void);
+void setup_dac_stream(void);
+#endif
+void start_sample_engine(void);
+#if SIGGEN_DUAL_CORE
+void core1_main(void);
+#endif
 
 /**
- * @brief Initialize the sampling frequency.
+ * @brief Update the DDS tuning word for the engine frequency.
+ *
+ * The PIO build takes the step of the clock plan, exact for an unmodulated
+ * carrier.
  */
-void initialize_samp_freq(void) {
-    samp_freq = (uint32_t)((1000000.0) * (1.0 / points) * (1.0 / frequency)); 
+void update_tuning_word(void) {
+#if SIGGEN_IQ_OUTPUT
+    dds_set_frequency(&channels.dds, engine.freq_mhz, sample_rate);
+#elif SIGGEN_PIO_OUTPUT
+    gen.dds.tuning = clock_now.tuning;
+#else
+    dds_set_frequency(&gen.dds, engine.freq_mhz, sample_rate);
+#endif
+}
+
+/**
+ * @brief Make the sample engine use a new parameter set.
+ *
+ * Runs on the core that owns the engine. Only the parts that changed are
+ * recomputed. A new shape, amplitude, offset and frequency go out as one
+ * change that the sample interrupt applies at the next period boundary;
+ * in the IQ build the frequency still changes on the next tick. In the PIO
+ * build a new frequency or modulation also gets a new clock plan, whose
+ * clocks change at once: the rest of the current period plays at the new
+ * rate with the old step.
+ *
+ * @param p Parameter set.
+ */
+void engine_apply(const siggen_params_t *p) {
+    uint32_t changed = param_txn_diff(&engine, p);
+    bool remod = (changed & PARAM_MOD) || ((changed & (PARAM_WAVE | PARAM_FREQ)) && p->mod != MOD_NONE);
+    engine = *p;
+    waveform_set_user(engine.user_gen ? user_waves[engine.user_gen & 1] : NULL);
+#if SIGGEN_IQ_OUTPUT
+    uint32_t band = param_txn_band(&engine, sample_rate);
+    if ((changed & PARAM_WAVE) || band != channels.cache[0].band) {
+        for (uint32_t c = 0; c < IQ_CHANNELS; c++) {
+            multichan_set_wave(&channels, c, engine.shape, band, engine.amplitude, engine.offset);
+        }
+    }
+    multichan_set_phase(&channels, 1, multichan_phase_deg(engine.phase_deg));
+    if (changed & PARAM_FREQ) {
+        update_tuning_word();
+    }
+#elif SIGGEN_PIO_OUTPUT
+    uint32_t start = time_us_32();
+    if ((changed & (PARAM_FREQ | PARAM_MOD)) && plan_clocks()) {
+        changed |= PARAM_FREQ; ///< otro muestreo: otra sintonia
+    }
+    if (param_txn_stage_tuning(&wave_cache, &engine, changed, sample_rate, clock_now.tuning)) {
+        txn_prepare_us = time_us_32() - start;
+    }
+#else
+    uint32_t start = time_us_32();
+    if (param_txn_stage(&wave_cache, &engine, changed, sample_rate)) {
+        txn_prepare_us = time_us_32() - start;
+    }
+#endif
+    if (remod) {
+        modulation_apply();
+    }
+}
+
+/**
+ * @brief Start the modulation of the engine parameters.
+ *
+ * The sweep or modulator is set up in the state the generator is not
+ * reading and then published with one pointer store, so the sample
+ * interrupt never sees a half-built one. A sweep starts from the carrier
+ * frequency and repeats; AM and FM use a sine modulator. Settings the
+ * engine cannot produce leave the carrier unmodulated.
+ */
+void modulation_apply(void) {
+    mod_t *next = mod_active == &mods[0] ? &mods[1] : &mods[0];
+    bool ok = false;
+    switch (engine.mod) {
+    case MOD_SWEEP_LIN:
+    case MOD_SWEEP_LOG:
+        ok = mod_sweep(next, engine.mod, engine.freq_mhz, engine.mod_arg, engine.mod_time, true, sample_rate);
+        break;
+    case MOD_AM:
+        ok = mod_am(next, engine.mod_arg, engine.mod_time, WAVEFORM_SINE, engine.amplitude, engine.offset, sample_rate);
+        break;
+    case MOD_FM:
+        ok = mod_fm(next, engine.freq_mhz, engine.mod_arg, engine.mod_time, WAVEFORM_SINE, sample_rate);
+        break;
+    }
+    if (!ok) {
+        mod_init(next);
+    }
+    mod_active = next;
+    if (next->kind == MOD_NONE) {
+        update_tuning_word(); ///< devolver la portadora que dejo el barrido o la FM
+    }
+}
+
+/**
+ * @brief Snapshot of the UI parameters.
+ */
+siggen_params_t ui_params(void) {
+    return (siggen_params_t){ signal_count, amplitude, offsete, frequency, phase_deg, modulation, mod_arg, mod_time,
+                              user_gen, 0 }; ///< el cambio entra al final del periodo
+}
+
+/**
+ * @brief Copy the committed fields of a transaction into the UI parameters.
+ *
+ * Only the staged fields are written, so a button press that changed the
+ * shape meanwhile is kept.
+ */
+void ui_commit(const siggen_params_t *p, uint32_t staged) {
+    if (staged & PARAM_SHAPE) {
+        signal_count = p->shape;
+    }
+    if (staged & PARAM_AMPLITUDE) {
+        amplitude = p->amplitude;
+    }
+    if (staged & PARAM_OFFSET) {
+        offsete = p->offset;
+    }
+    if (staged & PARAM_FREQ) {
+        frequency = p->freq_mhz;
+    }
+    if (staged & PARAM_PHASE) {
+        phase_deg = p->phase_deg;
+    }
+    if (staged & PARAM_MOD) {
+        modulation = p->mod;
+        mod_arg = p->mod_arg;
+        mod_time = p->mod_time;
+    }
+}
+
+/**
+ * @brief Take a saved parameter set as the UI parameters.
+ *
+ * The uploaded table is not saved, so a preset of it plays the sine until
+ * a table is uploaded again.
+ */
+void ui_load(const siggen_params_t *p) {
+    siggen_params_t q = *p;
+    if (q.shape > WAVEFORM_USER || (q.shape == WAVEFORM_USER && !user_gen)) {
+        q.shape = WAVEFORM_SINE;
+    }
+    ui_commit(&q, PARAM_SHAPE | PARAM_AMPLITUDE | PARAM_OFFSET | PARAM_FREQ | PARAM_PHASE | PARAM_MOD);
+}
+
+/**
+ * @brief Flag a change of the UI parameters.
+ *
+ * Safe from the button interrupt: the change is handed to the sample
+ * engine by flush_params() in the main loop, the only place that does so.
+ */
+void publish_params(void) {
+    params_dirty = true;
+}
+
+/**
+ * @brief Hand a snapshot of the UI parameters to the sample engine.
+ *
+ * The flag is cleared before the snapshot is taken, so a change made
+ * meanwhile is handed over on the next pass. In the dual-core build the
+ * snapshot goes through the mailbox (this is its single producer) and a
+ * full mailbox is retried later. The snapshot is saved to flash once the
+ * parameters have been left alone for AUTOSAVE_DELAY_US.
+ */
+void flush_params(void) {
+    params_dirty = false;
+    autosave_pending = true;
+    autosave_at = time_us_32() + AUTOSAVE_DELAY_US;
+    siggen_params_t p = ui_params();
+#if SIGGEN_DUAL_CORE
+    if (!mailbox_post(&param_mailbox, &p)) {
+        params_dirty = true;
+    }
+    __sev(); ///< despertar al nucleo 1
+#else
+    engine_apply(&p);
+#endif
 }
 
 /**
@@ -150,31 +439,134 @@ void set_dac_value(uint8_t value) {
 }
 
 /**
- * @brief Analyze text input for configuring parameters.
+ * @brief Stage one keypad command into a transaction.
+ *
+ * @param txn Transaction.
+ * @param cmd Command text.
+ * @return Start of the next command, NULL if this one is invalid (logged).
  */
-void analyze_text_input() {
-    printf("Texto ingresado: %s\n", text_input);
-    if (text_input[0] == 'A') {
-            uint16_t amplitud = atoi(&text_input[1]);
+const char *stage_command(param_txn_t *txn, const char *cmd) {
+    const char *next = cmd + 1;
+    while ((*next >= '0' && *next <= '9') || (*cmd == 'C' && *next == '*')) {
+        next++;
+    }
+    if (cmd[0] == 'A') {
+        uint16_t amplitud = atoi(&cmd[1]);
         if (amplitud >= 100 && amplitud <= 2500) {
-            printf("Configuracion ingresada: Amplitud -> %d\n", amplitud);
-            amplitude = amplitud;
+            log_put(&log_main, LOG_SET_AMPLITUDE, amplitud, 0, 0, 0);
+            param_txn_amplitude(txn, amplitud);
         } else {
-            printf("Configuracion de amplitud invalida\n");
+            log_put(&log_main, LOG_BAD_AMPLITUDE, 0, 0, 0, 0);
+            return NULL;
         }
-    } else if (text_input[0] == 'B') {
-            uint16_t offset = atoi(&text_input[1]);
+    } else if (cmd[0] == 'B') {
+        uint16_t offset = atoi(&cmd[1]);
         if (offset >= 50 && offset <= 1250) {
-            printf("Configuracion ingresada: Offset -> %d\n", offset);
-            offsete = offset;
+            log_put(&log_main, LOG_SET_OFFSET, offset, 0, 0, 0);
+            param_txn_offset(txn, offset);
+        } else {
+            log_put(&log_main, LOG_BAD_OFFSET, 0, 0, 0, 0);
+            return NULL;
+        }
+    } else if (cmd[0] == 'C') {
+        uint32_t freq = dds_parse_mhz(&cmd[1]);
+        if (1 <= freq && freq <= MAX_FREQUENCY_MHZ) {
+            log_put(&log_main, LOG_SET_FREQUENCY, freq / 1000, freq % 1000, 0, 0);
+            param_txn_frequency(txn, freq);
         } else {
-            printf("Configuracion de offset invalida\n");
+            log_put(&log_main, LOG_BAD_FREQUENCY, 0, 0, 0, 0);
+            return NULL;
         }
-    } else if (text_input[0] == 'C') {
-        frequency = atoi(&text_input[1]);
-        printf("Configuracion ingresada: Frecuencia -> %d\n", frequency);
-        initialize_samp_freq();
-    } 
+#if !SIGGEN_IQ_OUTPUT
+    } else if (cmd[0] == '*' && cmd == text_input) {
+        // *<tipo><valor>#<tiempo>D: tipo 0 nada, 1 barrido lineal, 2 logaritmico, 3 AM, 4 FM
+        const char *sep = strchr(cmd, '#');
+        uint8_t kind = (uint8_t)(cmd[1] - '0');
+        if (kind <= MOD_FM) {
+            uint32_t arg = dds_parse_mhz(&cmd[2]);
+            uint32_t time = sep ? dds_parse_mhz(sep + 1) : 0;
+            if (kind == MOD_AM) {
+                arg /= 1000; ///< profundidad en %
+            }
+            log_put(&log_main, LOG_SET_MODULATION, kind, arg, time, 0);
+            param_txn_modulation(txn, kind, arg, time);
+        } else {
+            log_put(&log_main, LOG_BAD_MODULATION, 0, 0, 0, 0);
+            return NULL;
+        }
+        next = cmd + strlen(cmd);
+#else
+    } else if (cmd[0] == '#' && cmd == text_input) {
+        uint32_t deg = atoi(&cmd[1]) % 360;
+        log_put(&log_main, LOG_SET_PHASE, deg, 0, 0, 0);
+        param_txn_phase(txn, deg);
+        next = cmd + strlen(cmd);
+#endif
+    } else {
+        next = cmd + strlen(cmd); ///< el resto no es un comando
+    }
+    return next;
+}
+
+/**
+ * @brief Save the UI parameters into a preset, or recall one.
+ *
+ * Saving stalls the sample output for a page program (about 1 ms), or
+ * for a sector erase (about 50 ms) once every few dozen saves.
+ *
+ * @param save Save (true) or recall (false).
+ * @param slot Preset, 1 to PRESET_SLOTS - 1.
+ */
+void preset_command(bool save, uint32_t slot) {
+    const preset_t *preset = preset_store_get(&presets, slot);
+    if (slot == PRESET_LAST || slot >= PRESET_SLOTS || (!save && !preset)) {
+        log_put(&log_main, LOG_BAD_PRESET, slot, 0, 0, 0);
+        return;
+    }
+    if (save) {
+        char name[PRESET_NAME_LEN + 1];
+        snprintf(name, sizeof(name), "Preset %u", (unsigned)slot);
+        siggen_params_t p = ui_params();
+        if (preset_store_save(&presets, slot, &p, preset ? preset->name : name)) {
+            log_put_text(&log_main, LOG_PRESET_SAVED, presets.slot[slot].name);
+        } else {
+            log_put(&log_main, LOG_PRESET_FAILED, slot, 0, 0, 0);
+        }
+        return;
+    }
+    ui_load(&preset->params);
+    log_put_text(&log_main, LOG_PRESET_LOADED, preset->name);
+    publish_params();
+}
+
+/**
+ * @brief Analyze text input for configuring parameters.
+ *
+ * Amplitude, offset and frequency commands can be chained in one entry
+ * ("A1500B300C250D"); they are committed together as one transaction, or
+ * not at all if one of them is invalid. "*7<n>D" saves the parameters into
+ * preset n and "*8<n>D" recalls it.
+ */
+void analyze_text_input() {
+    log_put_text(&log_main, LOG_TEXT_INPUT, text_input);
+    if (text_input[0] == '*' && (text_input[1] == '7' || text_input[1] == '8')) {
+        preset_command(text_input[1] == '7', atoi(&text_input[2]));
+        letter_index = 0;
+        memset(text_input, 0, sizeof(text_input));
+        return;
+    }
+    siggen_params_t p = ui_params();
+    param_txn_t txn;
+    param_txn_begin(&txn, &p);
+    const char *cmd = text_input;
+    while (cmd && *cmd && *cmd != 'D') {
+        cmd = stage_command(&txn, cmd);
+    }
+    uint32_t staged = param_txn_commit(&txn, &p);
+    if (cmd && staged) {
+        ui_commit(&p, staged);
+        publish_params();
+    }
 
     letter_index = 0;
     memset(text_input, 0, sizeof(text_input));   ///< Limpiar el arreglo de letras presionadas
@@ -183,40 +575,22 @@ void analyze_text_input() {
 /**
  * @brief Generate signal.
  *
- * @param type Type of signal.
- * @param Amp Amplitude of the signal.
- * @param DC DC offset of the signal.
+ * Outputs the cached, already scaled point at the current phase, or the
+ * next host code while a stream owns the DAC.
  */
-void generator(uint8_t type, uint32_t Amp, uint32_t DC){
-    Amp /=2;
-    uint16_t signal;
-
-    switch (type)
-    {
-    case 0:
-        signal = seno[signal_index];
-        break;
-    case 1: 
-        signal = triangular[signal_index];
-        break;
-    case 2:
-        signal = sierra[signal_index];
-        break;
-    case 3:
-        signal = cuadrada[signal_index];
-        break;
-    
-    default:
-        break;
+void generator(void){
+#if SIGGEN_IQ_OUTPUT
+    multichan_hw_put(&channels, multichan_tick(&channels)); ///< los dos buses en una escritura
+#else
+#if SIGGEN_STREAM_INPUT
+    uint8_t code;
+    if (stream_rx_pop(&stream, &code)) {
+        set_dac_value(code);
+        return;
     }
-
-    uint16_t norm_DC = 255 - ((DC*255)/1250);
-    uint16_t norm_Amp = 2500/Amp;
-    signal = (signal/norm_Amp) - norm_DC;
-    set_dac_value(signal);
-    signal_index += 1;
-    signal_index %= 100;
-
+#endif
+    set_dac_value(mod_next(mod_active, &wave_cache, &gen.dds));
+#endif
 }
 
 /**
@@ -226,40 +600,27 @@ void generator(uint8_t type, uint32_t Amp, uint32_t DC){
  * @param events GPIO events.
  */
 void gpio_callback(uint gpio, uint32_t events) {
+    PROBE_ENTER(PROBE_GPIO, 0);
     if(gpio == Button_pin) {
         callback_pressed(gpio, events);   
     }
-    else {
-        callback_keypress(gpio, events);
-    }
+    PROBE_EXIT(PROBE_GPIO);
 }
 
 /**
- * @brief Keyboard button press callback.
+ * @brief Handle a debounced key press.
  *
- * @param gpio GPIO pin number.
- * @param events GPIO events.
+ * Runs in the main loop, which drains the keypad event queue, so the
+ * command parser never runs in interrupt context.
+ *
+ * @param key Key character.
  */
-void callback_keypress(uint gpio, uint32_t events) {
-    // Verificar el debounce
-    if (time_us_64() - last_press_time < DEBOUNCE_TIME_US) {
-        return;
-    }
-    
-    for (int col = 0; col < 4; col++) { 
-        if (gpio_columns[col] == gpio) {
-            current_key = matrix_keys[sequence][col];
-            text_input[letter_index] = current_key;
-            letter_index = (letter_index + 1) % MAX_LETTERS_PRESSED; 
-            if (current_key == 'D') { 
-                analyze_text_input();
-            }
-            last_press_time = time_us_64();  
-        }
-        
+void handle_key(char key) {
+    text_input[letter_index] = key;
+    letter_index = (letter_index + 1) % MAX_LETTERS_PRESSED; 
+    if (key == 'D') { 
+        analyze_text_input();
     }
-         
-    gpio_acknowledge_irq(gpio, events);
 }
 
 /**
@@ -273,101 +634,131 @@ void callback_pressed(uint gpio,uint32_t events) {
         return;
     }
     last_press_button_time = time_us_64();
-    signal_count = (signal_count + 1) % 4;
+    signal_count = (signal_count + 1) % (user_gen ? WAVEFORM_COUNT + 1 : WAVEFORM_COUNT); ///< la cargada va tras las fijas
+    publish_params();
     gpio_acknowledge_irq(gpio, events);
 }
 
 /**
  * @brief Setup keyboard GPIO pins.
+ *
+ * The keypad is scanned by timer_sequence_handler(); no GPIO interrupt is
+ * used for the columns.
  */
 void setup_keyboard(void) {
-    for (int i = 0; i < 4; i++) {
-        gpio_init(gpio_rows[i]);
-        gpio_set_dir(gpio_rows[i], GPIO_OUT);
-        gpio_init(gpio_columns[i]);
-        gpio_set_dir(gpio_columns[i], GPIO_IN);
-        gpio_pull_down(gpio_columns[i]);
-        gpio_set_irq_enabled_with_callback(gpio_columns[i], GPIO_IRQ_EDGE_RISE, true, gpio_callback);
-    }
+    keypad_init(&keypad, &matrix_keys[0][0], KEYPAD_DEBOUNCE_SCANS);
+    keypad_hw_init(&keypad, gpio_rows[0], gpio_columns[0]);
+}
+
+/**
+ * @brief Start the keypad scan and the status print on the shared alarm.
+ *
+ * Both tasks run from the TIMER_IRQ_0 handler, registered once; the
+ * scheduler keeps the alarm armed for whichever is due first.
+ */
+void setup_ui_timers(void) {
+    uint64_t now = time_us_64();
+    alarm_sched_init(&ui_sched, UI_ALARM);
+    alarm_sched_add(&ui_sched, &sequence_task, timer_sequence_handler, NULL, SEQUENCE_PERIOD_US, now + SEQUENCE_PERIOD_US);
+    alarm_sched_add(&ui_sched, &print_task, timerPrintHandler, NULL, PRINT_PERIOD_US, now + PRINT_PERIOD_US);
+    alarm_sched_start(&ui_sched);
 }
 
 /**
  * @brief Timer sequence handler.
+ *
+ * @param t Scheduler task (its deadline is this run's scheduled time).
+ * @param ctx Unused.
  */
-void timer_sequence_handler(void){
-    // Interrupt acknowledge
-    hw_clear_bits(&timer_hw->intr, 1u << TIMER_IRQ_0);
-     // Setting the IRQ handler
-    irq_set_exclusive_handler(TIMER_IRQ_0, timer_sequence_handler);
-    irq_set_enabled(TIMER_IRQ_0, true);
-    hw_set_bits(&timer_hw->inte, 1u << TIMER_IRQ_0); ///< habilitar la alarma0 para la secuencia
-    timer_hw->alarm[0] = (uint32_t)(time_us_64() + 2000); ///< establecer la alarma0 para que se active en 2ms
-
-    //Generacion secuencia 
-    uint8_t sq; ///< Valor de secuencia
-    sequence = (sequence + 1) % 4; ///< Incrementar la secuencia
-    sq = 1 << sequence; ///< Valor de secuencia
-    gpio_put_masked(0xF<<gpio_rows[0], ((uint32_t) sq )<< gpio_rows[0]); ///< Establecer la secuencia en las filas  
-    
+void timer_sequence_handler(alarm_task_t *t, void *ctx) {
+    (void)t;
+    (void)ctx;
+    PROBE_ENTER(PROBE_SEQUENCE, (uint32_t)t->deadline);
+
+    keypad_hw_scan(&keypad); ///< leer la fila actual y excitar la siguiente
+    PROBE_EXIT(PROBE_SEQUENCE);
 }
 
 /**
  * @brief Timer print handler.
+ *
+ * @param t Scheduler task (its deadline is this run's scheduled time).
+ * @param ctx Unused.
  */
- void timerPrintHandler(void)
+ void timerPrintHandler(alarm_task_t *t, void *ctx)
  {
-    // Interrupt acknowledge
-    hw_clear_bits(&timer_hw->intr, 1u << TIMER_IRQ_1);
-
-    // Setting the IRQ handler
-    irq_set_exclusive_handler(TIMER_IRQ_1, timerPrintHandler);
-    irq_set_enabled(TIMER_IRQ_1, true);
-    hw_set_bits(&timer_hw->inte, 1u << TIMER_IRQ_1); ///< habilitar la alarma1 para la impresión de la señal
-    timer_hw->alarm[1] = (uint32_t)(time_us_64() + 1000000); ///< Establecer la alarma1 para que se active en 1s
-
+    (void)t;
+    (void)ctx;
+    PROBE_ENTER(PROBE_PRINT, (uint32_t)t->deadline);
     timerPrintCallback();
-
+    PROBE_EXIT(PROBE_PRINT);
  }
 
 /**
  * @brief Timer signal handler.
+ *
+ * Runs every SAMPLE_PERIOD_US on an absolute deadline, so the sample clock
+ * does not accumulate the interrupt latency. The first run latches the
+ * time of the first sample for report_boot().
+ *
+ * @param t Scheduler task (its deadline is this run's scheduled time).
+ * @param ctx Unused.
  */
- void timerSignalHandler(void) 
+ void timerSignalHandler(alarm_task_t *t, void *ctx) 
  {
-    // Interrupt acknowledge
-    hw_clear_bits(&timer_hw->intr, 1u << TIMER_IRQ_2);
-
-    // Setting the IRQ handler
-    irq_set_exclusive_handler(TIMER_IRQ_2, timerSignalHandler);
-    irq_set_enabled(TIMER_IRQ_2, true);
-    hw_set_bits(&timer_hw->inte, 1u << TIMER_IRQ_2); ///< habilitar la alarma2 para la generación de señales
-    timer_hw->alarm[2] = (uint32_t)(time_us_64() + samp_freq); ///< establecer la alarma2 para que se active en la frecuencia de muestreo
-
-    generator(signal_count, amplitude, offsete);
-
+    (void)t;
+    (void)ctx;
+    PROBE_ENTER(PROBE_SIGNAL, (uint32_t)t->deadline);
+    generator();
+    if (!first_sample_us) {
+        first_sample_us = time_us_32(); ///< medido en la primera muestra
+    }
+    PROBE_EXIT(PROBE_SIGNAL);
  }
 
 /**
  * @brief Timer print callback.
+ *
+ * Runs in TIMER_IRQ_0: the state is logged as records, formatted and sent
+ * by the main loop.
  */
  void timerPrintCallback(void)
  {
-    // Print the signal characteristics
-    switch (signal_count){
-        case 0:
-            printf("Sinusoidal: ");
-            break;
-        case 1:
-            printf("Triangular: ");
-            break;
-        case 2:
-            printf("Saw tooth: ");
-            break;
-        case 3:
-            printf("Square: ");
-            break;
+    // Log the signal characteristics
+    log_put(&log_ui, signal_count == WAVEFORM_USER ? LOG_STATUS_USER : LOG_STATUS_SINE + signal_count, amplitude,
+            offsete, frequency / 1000, frequency % 1000);
+#if SIGGEN_IQ_OUTPUT
+    log_put(&log_ui, LOG_STATUS_PHASE, phase_deg, 0, 0, 0);
+#else
+    if (modulation != MOD_NONE) {
+        log_put(&log_ui, LOG_STATUS_SWEEP_LIN + modulation - MOD_SWEEP_LIN, mod_arg, mod_time, 0, 0);
+    }
+
+    // Report how long the last change waited for its period boundary (not the start-up one)
+    uint32_t applied = wave_cache.applied;
+    if (applied != txn_reported && wave_cache.waited) {
+        log_put(&log_ui, LOG_TXN_APPLIED, (uint32_t)((uint64_t)wave_cache.waited * 1000000u / sample_rate),
+                txn_prepare_us, 0, 0);
+    }
+    txn_reported = applied;
+#endif
+#if SIGGEN_PIO_OUTPUT
+    // Report a new clock plan: clocks and the frequency they really give
+    if (clock_plans != clock_reported) {
+        clock_reported = clock_plans;
+        log_put(&log_ui, LOG_CLOCK_PLAN, clock_now.sys_khz, clock_now.points, clock_now.rate_hz, clock_now.load_pct);
+        log_put(&log_ui, clock_now.error_ppb < 0 ? LOG_CLOCK_ERROR_LOW : LOG_CLOCK_ERROR_HIGH,
+                clock_now.freq_mhz / 1000, clock_now.freq_mhz % 1000,
+                (uint32_t)(clock_now.error_ppb < 0 ? -(int64_t)clock_now.error_ppb : clock_now.error_ppb), 0);
+    }
+#endif
+
+    // Report the deadlines missed since the last print
+    uint32_t missed = alarm_sched_missed(&ui_sched) + alarm_sched_missed(&signal_sched);
+    if (missed != missed_reported) {
+        log_put(&log_ui, LOG_MISSED, missed - missed_reported, 0, 0, 0);
+        missed_reported = missed;
     }
-    printf("Amp: %d, Offset: %d, Freq: %d\n", amplitude, offsete, frequency);
  }
 
 /**
@@ -380,24 +771,428 @@ void setup_button(void) {
     gpio_set_irq_enabled_with_callback(Button_pin, GPIO_IRQ_EDGE_RISE, true, gpio_callback);
 }
 
+#if !SIGGEN_PIO_OUTPUT
+/**
+ * @brief Setup the DAC0808 bus pins as outputs of TIMER_IRQ_2.
+ *
+ * With the PIO output the state machine claims these pins instead.
+ */
+void setup_dac_pins(void) {
+    const uint dac_pins[] = {D0_PIN, D1_PIN, D2_PIN, D3_PIN, D4_PIN, D5_PIN, D6_PIN, D7_PIN};
+    for (int i = 0; i < 8; i++) {
+        gpio_init(dac_pins[i]);
+        gpio_set_dir(dac_pins[i], GPIO_OUT);
+    }
+}
+#endif
+
+#if SIGGEN_IQ_OUTPUT
+/**
+ * @brief Setup both channels and their buses as outputs of TIMER_IRQ_2.
+ *
+ * Channel 1 is a copy of channel 0 shifted by the engine phase; both
+ * are written with one masked store per sample.
+ */
+void setup_channels(void) {
+    multichan_init(&channels, IQ_CHANNELS, WAVEFORM_LENGTH);
+    for (uint32_t c = 0; c < IQ_CHANNELS; c++) {
+        multichan_set_pins(&channels, c, iq_pins[c]);
+        multichan_set_wave(&channels, c, engine.shape, param_txn_band(&engine, sample_rate), engine.amplitude,
+                           engine.offset);
+    }
+    multichan_set_phase(&channels, 1, multichan_phase_deg(engine.phase_deg));
+    multichan_swap(&channels);
+    multichan_hw_init(&channels);
+}
+#endif
+
+/**
+ * @brief Send drained log bytes, upload replies or stream reports to USB stdio.
+ *
+ * Only called from the main loop, so a slow USB write delays nothing but
+ * the log itself. Both come out between records, never inside one.
+ */
+void write_log(const uint8_t *buf, uint32_t len, void *ctx) {
+    (void)ctx;
+    for (uint32_t i = 0; i < len; i++) {
+        putchar_raw(buf[i]);
+    }
+}
+
+#if SIGGEN_LATENCY_PROBES
+/**
+ * @brief Write one line of the latency export to USB stdio.
+ */
+void write_serial(const char *line, void *ctx) {
+    (void)ctx;
+    fputs(line, stdout);
+}
+#endif
+
+/**
+ * @brief Serial commands.
+ *
+ * 'T' switches the log to binary telemetry frames (host/log_decode.c) and
+ * 'P' back to plain text. 'S' starts a sample stream (host/stream_play.c)
+ * in the 20 kHz build; its blocks, like waveform uploads
+ * (host/upload_wave.c), are taken out of the input before it gets here.
+ * With the latency probes, 'L' dumps the
+ * summaries (count, min, mean, p99, max in us), 'H' the summaries and the
+ * histogram bins, 'R' clears the probes.
+ *
+ * @param ch Character read from USB stdio.
+ */
+void serial_command(int ch) {
+    if (ch == 'T' || ch == 'P') {
+        log_drain_set_binary(&log_out, ch == 'T');
+#if SIGGEN_STREAM_INPUT
+    } else if (ch == 'S') {
+        stream_rx_start(&stream, time_us_32());
+#endif
+#if SIGGEN_LATENCY_PROBES
+    } else if (ch == 'L' || ch == 'H') {
+        latency_probe_dump_csv(probes, PROBE_COUNT, ch == 'H', write_serial, NULL);
+    } else if (ch == 'R') {
+        for (int i = 0; i < PROBE_COUNT; i++) {
+            latency_probe_reset(&probes[i]);
+        }
+#endif
+    }
+}
+
+/**
+ * @brief Select a waveform that has just been uploaded.
+ *
+ * The table is copied into the bank the engine is not using and handed
+ * over with the next parameter snapshot; the engine rebuilds its cache
+ * from it, and the new period starts at the next phase wrap.
+ */
+void load_user_wave(void) {
+    wave_upload_export(&upload, user_waves[(user_gen + 1) & 1]);
+    user_gen++;
+    signal_count = WAVEFORM_USER;
+    log_put(&log_main, LOG_WAVE_LOADED, WAVEFORM_LENGTH, user_gen, 0, 0);
+    publish_params();
+}
+
+#if SIGGEN_PIO_OUTPUT
+/**
+ * @brief Produce DAC codes for the PIO stream.
+ *
+ * @param codes Destination buffer.
+ * @param count Number of codes.
+ * @param ctx Unused.
+ */
+void fill_dac_codes(uint8_t *codes, uint32_t count, void *ctx) {
+    (void)ctx;
+    mod_t *m = mod_active;
+    if (m->kind == MOD_NONE) {
+        gen_block_fill(&gen, codes, count);
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        codes[i] = mod_next(m, &wave_cache, &gen.dds);
+    }
+}
+
+/**
+ * @brief Plan the system clock, the PIO pacing and the points per period for the engine.
+ *
+ * An unmodulated carrier gets the plan of clock_plan(), preferring the
+ * clock in use. A sweep, AM or FM computes its steps from the sample rate,
+ * so it gets the boot clock at PIO_SAMPLE_RATE_HZ, as does a carrier no
+ * plan reaches. The PLL is reprogrammed only if the system clock changes
+ * (clk_peri follows it; the 1 us timer and USB do not).
+ *
+ * @return true if the sample rate or the step changed.
+ */
+bool plan_clocks(void) {
+    clock_plan_t next;
+    bool ok = engine.mod == MOD_NONE && clock_plan(&planner, engine.freq_mhz, clock_now.sys_khz, &next);
+    if (!ok && !clock_plan_rate(&planner, boot_sys_khz, PIO_SAMPLE_RATE_HZ, engine.freq_mhz ? engine.freq_mhz : 1,
+                                &next)) {
+        return false;
+    }
+    bool moved = next.div256 != clock_now.div256 || next.hold != clock_now.hold || next.sys_khz != clock_now.sys_khz;
+    if (next.sys_khz != clock_now.sys_khz) {
+        set_sys_clock_pll(next.vco_khz * 1000u, next.postdiv1, next.postdiv2);
+    }
+    if (moved) {
+        sample_rate = dac_stream_set_divider(&dac_stream, next.sys_khz * 1000u, next.div256, next.hold);
+        dac_stream_hw_apply_rate(&dac_stream);
+    }
+    moved = moved || next.tuning != clock_now.tuning;
+    clock_now = next;
+    clock_plans++;
+    return moved;
+}
+
+/**
+ * @brief Start the PIO + DMA output with the clocks planned for the engine.
+ */
+void setup_dac_stream(void) {
+    clock_plan_limits_t limits;
+    clock_plan_defaults(&limits, WAVEFORM_LENGTH);
+    clock_planner_init(&planner, &limits);
+    boot_sys_khz = clock_get_hz(clk_sys) / 1000u;
+    dac_stream_init(&dac_stream, fill_dac_codes, NULL);
+    sample_rate = dac_stream_set_rate(&dac_stream, clock_get_hz(clk_sys), PIO_SAMPLE_RATE_HZ);
+    clock_now.sys_khz = boot_sys_khz;
+    plan_clocks();
+    update_tuning_word();
+    if (param_txn_stage_tuning(&wave_cache, &engine, PARAM_FREQ, sample_rate, clock_now.tuning)) {
+        wave_cache_swap(&wave_cache); ///< la banda depende de la frecuencia de muestreo real
+    }
+    dac_stream_prime(&dac_stream);
+    dac_stream_hw_start(&dac_stream);
+    first_sample_us = time_us_32();
+}
+#endif
+
+/**
+ * @brief Start producing samples with the engine parameters.
+ *
+ * Runs on the core that owns the engine: the sample interrupt (TIMER_IRQ_2
+ * or DMA_IRQ_0) is enabled on the calling core. The time of the first
+ * sample is kept for report_boot().
+ */
+void start_sample_engine(void) {
+    dds_init(&gen.dds, WAVEFORM_LENGTH, false);
+    update_tuning_word();
+    wave_cache_init(&wave_cache, WAVEFORM_LENGTH);
+    param_txn_stage(&wave_cache, &engine, PARAM_WAVE, sample_rate);
+    wave_cache_swap(&wave_cache);
+#if SIGGEN_PIO_OUTPUT
+    setup_dac_stream();
+#elif SIGGEN_IQ_OUTPUT
+    setup_channels();
+    update_tuning_word();
+#else
+    setup_dac_pins();
+#endif
+    if (engine.mod != MOD_NONE) {
+        modulation_apply();
+    }
+#if !SIGGEN_PIO_OUTPUT
+    uint64_t first = time_us_64() + SAMPLE_PERIOD_US;
+    alarm_sched_init(&signal_sched, SIGNAL_ALARM);
+    alarm_sched_add(&signal_sched, &signal_task, timerSignalHandler, NULL, SAMPLE_PERIOD_US, first);
+    irq_set_priority(TIMER_IRQ_0 + SIGNAL_ALARM, PICO_HIGHEST_IRQ_PRIORITY); ///< la muestra interrumpe al teclado y a printf
+    alarm_sched_start(&signal_sched);
+#endif
+}
+
+#if SIGGEN_DUAL_CORE
+/**
+ * @brief Core 1: the sample engine alone.
+ *
+ * Applies the parameter sets posted by core 0 and sleeps between
+ * interrupts; nothing here prints or touches the keypad. Core 0 parks it
+ * while it writes the flash.
+ */
+void core1_main(void) {
+    siggen_params_t p;
+    flash_safe_execute_core_init();
+    while (!mailbox_take_latest(&param_mailbox, &p)) {
+        __wfe();
+    }
+    engine = p;
+    start_sample_engine();
+    while (1) {
+        if (mailbox_take_latest(&param_mailbox, &p)) {
+            engine_apply(&p);
+        }
+#if SIGGEN_PIO_OUTPUT
+        dac_stream_service(&dac_stream); ///< rellenar los bloques que el DMA ya envió
+#endif
+        __wfe(); ///< esperar a una interrupción o a un mensaje del nucleo 0
+    }
+}
+#endif
+
+/**
+ * @brief Take what arrived on USB stdio: stream codes, uploads, commands.
+ *
+ * At most SERIAL_BATCH bytes per call, so a busy port does not starve
+ * the keypad or the log.
+ */
+void read_serial(void) {
+    for (uint32_t n = 0; n < SERIAL_BATCH; n++) {
+#if SIGGEN_STREAM_INPUT
+        if (stream_rx_receiving(&stream)) {
+            uint32_t took = read_stream(SERIAL_BATCH - n);
+            if (!took) {
+                break;
+            }
+            n += took - 1;
+            continue;
+        }
+#endif
+        int ch = getchar_timeout_us(0);
+        if (ch == PICO_ERROR_TIMEOUT) {
+            break;
+        }
+        int r = wave_upload_feed(&upload, (uint8_t)ch, time_us_32());
+        if (r == WAVE_UPLOAD_PASS) {
+            serial_command(ch);
+        } else if (r == WAVE_UPLOAD_DONE) {
+            load_user_wave();
+        }
+    }
+}
+
+#if SIGGEN_STREAM_INPUT
+/**
+ * @brief Read stream bytes straight into the ring.
+ *
+ * Codes are read into the free span of the ring, with no copy; block
+ * lengths (and codes with no room left) go through stream_rx_feed().
+ *
+ * @param budget Bytes that may be read.
+ * @return Bytes read.
+ */
+uint32_t read_stream(uint32_t budget) {
+    uint8_t *dst;
+    uint32_t span = stream_rx_span(&stream, &dst);
+    if (!span) {
+        int ch = getchar_timeout_us(0);
+        if (ch == PICO_ERROR_TIMEOUT) {
+            return 0;
+        }
+        stream_rx_feed(&stream, (uint8_t)ch);
+        return 1;
+    }
+    span = span < budget ? span : budget;
+    uint32_t n = 0;
+    while (n < span) {
+        int ch = getchar_timeout_us(0);
+        if (ch == PICO_ERROR_TIMEOUT) {
+            break;
+        }
+        dst[n++] = (uint8_t)ch;
+    }
+    stream_rx_commit(&stream, n);
+    return n;
+}
+
+/**
+ * @brief Advance the stream state and send the credit report, if any.
+ */
+void report_stream(void) {
+    uint8_t report[STREAM_RX_REPORT_LEN];
+    stream_rx_poll(&stream, time_us_32());
+    uint32_t len = stream_rx_report(&stream, report, false);
+    if (len) {
+        write_log(report, len, NULL);
+    }
+}
+#endif
+
+/**
+ * @brief Save the last committed parameters once they have settled.
+ *
+ * Nothing is written if they are the ones already saved, so a change that
+ * is undone costs no flash write.
+ */
+void autosave(void) {
+    if (!autosave_pending || (int32_t)(time_us_32() - autosave_at) < 0) {
+        return;
+    }
+    autosave_pending = false;
+    siggen_params_t p = ui_params();
+    const preset_t *last = preset_store_get(&presets, PRESET_LAST);
+    if (last && !(param_txn_diff(&last->params, &p) & ~PARAM_USER)) {
+        return;
+    }
+    if (!preset_store_save(&presets, PRESET_LAST, &p, "Ultima")) {
+        log_put(&log_main, LOG_PRESET_FAILED, PRESET_LAST, 0, 0, 0);
+    }
+}
+
+/**
+ * @brief Log the time to the first sample, once it is known.
+ *
+ * Counted from the start of the microsecond timer, early in the SDK
+ * start-up; the boot ROM and the clock set-up before it are not included.
+ */
+void report_boot(void) {
+    if (!first_sample_reported && first_sample_us) {
+        log_put(&log_main, LOG_FIRST_SAMPLE, first_sample_us, boot_read_us, 0, 0);
+        first_sample_reported = true;
+    }
+}
+
 /**
  * @brief Main function.
+ *
+ * Instant-on: the output starts from the last saved configuration before
+ * anything else is set up, and USB stdio enumerates in the background.
+ * The log is held in its rings until a terminal is connected.
  */
 int main() {
-    stdio_init_all();
-    sleep_ms(7000);
-    // Print initialization message
-    printf("Generador de señales\n");
+    log_ring_init(&log_main);
+    log_ring_init(&log_ui);
+    log_drain_init(&log_out, write_log, NULL);
+    log_drain_add(&log_out, &log_main);
+    log_drain_add(&log_out, &log_ui);
+    wave_upload_init(&upload, WAVEFORM_LENGTH, write_log, NULL);
+#if SIGGEN_STREAM_INPUT
+    stream_rx_init(&stream);
+#endif
 
-    // Setup keyboard, button, and timers
+    // Start from the last committed configuration, if there is one
+    uint32_t read_start = time_us_32();
+    preset_store_mount(&presets);
+    const preset_t *boot = preset_store_get(&presets, PRESET_LAST);
+    if (boot) {
+        ui_load(&boot->params);
+    }
+    boot_read_us = time_us_32() - read_start;
+
+    // Setup the sample engine before anything else
+#if SIGGEN_DUAL_CORE
+    mailbox_init(&param_mailbox);
+    flush_params();
+    multicore_launch_core1(core1_main);
+#else
+    engine = ui_params();
+    start_sample_engine();
+#endif
+    autosave_pending = false; ///< es la configuracion guardada
+
+    stdio_init_all(); ///< el USB enumera en segundo plano
+    // Log initialization message
+    log_put(&log_main, LOG_BOOT, 0, 0, 0, 0);
+    log_put_text(&log_main, LOG_BOOT_CONFIG, boot ? boot->name : "Por defecto");
+
+    // Setup the keyboard, button, and timers
     setup_keyboard();
     setup_button();
-    timer_sequence_handler();
-    timerPrintHandler();
-    timerSignalHandler();
+    setup_ui_timers();
     
     // Infinite loop
     while (1) {
         __wfi(); ///< esperar a la interrupción
+        read_serial();
+#if SIGGEN_STREAM_INPUT
+        report_stream(); ///< estado del flujo y credito para el host
+#endif
+        keypad_event_t ev;
+        while (keypad_pop(&keypad, &ev)) {
+            if (ev.pressed) {
+                handle_key(ev.key);
+            }
+        }
+        if (params_dirty) {
+            flush_params(); ///< aplicar o enviar los parametros nuevos
+        }
+#if SIGGEN_PIO_OUTPUT && !SIGGEN_DUAL_CORE
+        dac_stream_service(&dac_stream); ///< rellenar los bloques que el DMA ya envió
+#endif
+        autosave();
+        report_boot();
+        if (stdio_usb_connected()) {
+            log_drain_step(&log_out, LOG_DRAIN_BATCH); ///< formatear y enviar lo registrado
+        }
     }
 }
\ No newline at end of file
@@ -17,6 +17,14 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include "dds.h"
+#include "executive.h"
+#include "gen_block.h"
+#include "keypad.h"
+#include "log_ring.h"
+#include "param_txn.h"
+#include "wave_cache.h"
+#include "waveform.h"
 
 
 
@@ -30,6 +38,16 @@
 #define D6_PIN 22
 #define D7_PIN 26
 #define Button_pin 1
+#define SAMPLE_RATE_HZ 10000 ///< Reloj de muestreo fijo del DDS
+#define SAMPLE_PERIOD_US (1000000 / SAMPLE_RATE_HZ)
+#define KEYPAD_SCAN_US 2000 ///< Paso del barrido del teclado (una fila por paso)
+#define SAMPLE_DEADLINE_US (SAMPLE_PERIOD_US / 2) ///< Retraso maximo admitido para una muestra
+#define BUTTON_POLL_US 10000 ///< Lectura del pulsador
+#define SERIAL_POLL_US 10000 ///< Lectura de los comandos por serial
+#define STATUS_PERIOD_US 10000000 ///< Impresion del estado de la señal
+#define CONSOLE_LEN 1024 ///< Bytes de la cola de salida por serial
+#define CONSOLE_CHUNK 16 ///< Bytes escritos por paso de la tarea de consola
+#define UI_STEP_BUDGET_US 40 ///< Peor duracion supuesta de un paso de interfaz o de registro
 
 /**
  * @brief Configura el valor del DAC.
@@ -47,92 +65,60 @@ void set_dac_value(uint8_t value) {
     gpio_put(D7_PIN, (value & 0x80));
 }
 
-// Variable para almacenar el índice de la señal
-uint8_t signal_index = 0;
+// Acumulador de fase del generador y periodo ya escalado de la señal
+wave_cache_t wave_cache;
+gen_state_t gen = { .cache = &wave_cache };
 
 
-// Arreglos para almacenar las formas de onda de las señales
-const uint8_t seno [] = { 
-    128, 136, 144, 152, 160, 167, 175, 182, 189, 196, 203, 209, 215, 221, 226, 231, 236, 240,
-    243, 247, 249, 251, 253, 254, 255, 255, 255, 254, 252, 250, 248, 245, 242, 238, 234, 229,
-    224, 218, 213, 206, 200, 193, 186, 179, 171, 163, 156, 148, 140, 132, 123, 115, 107,  99,
-    92,  84,  76,  69,  62,  55,  49,  42,  37,  31,  26,  21,  17,  13,  10,   7,   5,   3,
-    1,   0,   0,   0,   1,   2,   4,   6,   8,  12,  15,  19,  24,  29,  34,  40,  46,  52,
-    59,  66,  73,  80,  88,  95, 103, 111, 119, 127
-};
-
-const uint8_t triangular [] = {
-      0,   5,  10,  15,  20,  26,  31,  36,  41,  46,  51,  56,  61,  66,  71,  76,  82,
-        87,  92,  97, 102, 107, 112, 117, 122, 127, 133, 138, 143, 148, 153, 158, 163, 168,
-       173, 178, 184, 189, 194, 199, 204, 209, 214, 219, 224, 229, 235, 240, 245, 250, 255,
-       250, 245, 240, 235, 229, 224, 219, 214, 209, 204, 199, 194, 189, 184, 178, 173, 168,
-       163, 158, 153, 148, 143, 138, 133, 127, 122, 117, 112, 107, 102,  97,  92,  87,  82,
-        77,  71,  66,  61,  56,  51,  46,  41,  36,  31,  25,  20,  15,  10,   5
-};
-
-const uint8_t sierra [] = {
-    129, 131, 134, 137, 139, 142, 144, 147, 149, 152, 155, 157, 160, 162, 165, 167,
-        170, 173, 175, 178, 180, 183, 185, 188, 191, 193, 196, 198, 201, 203, 206, 209,
-        211, 214, 216, 219, 222, 224, 227, 229, 232, 234, 237, 240, 242, 245, 247, 250,
-        252, 255,   0,   3,   5,   8,  10,  13,  15,  18,  21,  23,  26,  28,  31,  33,
-         36,  39,  41,  44,  46,  49,  52,  54,  57,  59,  62,  64,  67,  70,  72,  75,
-         77,  80,  82,  85,  88,  90,  93,  95,  98, 100, 103, 106, 108, 111, 113, 116,
-        118, 121, 124, 126
-};
-
-const uint8_t cuadrada [] = {
-    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   0,   0,   0,
-      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
-};
+// Las formas de onda se generan al compilar (waveform_tables.h)
 
 /**
- * @brief Genera la señal.
+ * @brief Reconstruye la forma de onda escalada tras un cambio de tipo, amplitud u offset.
+ *
+ * El nuevo periodo empieza a sonar en el siguiente cruce de periodo. Se usa la
+ * tabla de banda limitada de la frecuencia actual (waveform_band()).
  *
  * @param type Tipo de señal.
  * @param Amp Amplitud de la señal.
  * @param DC Offset de la señal.
+ * @param freq_mhz Frecuencia en mHz.
  */
+void rebuild_waveform(uint8_t type, uint32_t Amp, uint32_t DC, uint32_t freq_mhz) {
+    wave_cache_begin(&wave_cache);
+    wave_cache_fill_band(&wave_cache, type, waveform_band(type, freq_mhz, SAMPLE_RATE_HZ), Amp, DC);
+    wave_cache_commit(&wave_cache, 0, 0);
+}
 
-void generator(uint8_t type, uint32_t Amp, uint32_t DC){
-    Amp /=2;
-    uint16_t signal;
-
-    switch (type)
-    {
-    case 0:
-        signal = seno[signal_index];
-        break;
-    case 1: 
-        signal = triangular[signal_index];
-        break;
-    case 2:
-        signal = sierra[signal_index];
-        break;
-    case 3:
-        signal = cuadrada[signal_index];
-        break;
-    
-    default:
-        break;
+/**
+ * @brief Cambia la frecuencia en el siguiente cruce de periodo, sin saltos de fase.
+ *
+ * Si el periodo es mas largo que PARAM_TXN_MAX_WAIT_US, cambia al cumplirse esa espera.
+ * Si la nueva frecuencia cae en otra octava, el periodo de su tabla de banda
+ * limitada entra en la misma muestra que la nueva sintonia.
+ *
+ * @param type Tipo de señal.
+ * @param Amp Amplitud de la señal.
+ * @param DC Offset de la señal.
+ * @param freq_mhz Frecuencia en mHz.
+ */
+void retune(uint8_t type, uint32_t Amp, uint32_t DC, uint32_t freq_mhz) {
+    uint32_t band = waveform_band(type, freq_mhz, SAMPLE_RATE_HZ);
+    wave_cache_begin(&wave_cache);
+    if (band != wave_cache.band) {
+        wave_cache_fill_band(&wave_cache, type, band, Amp, DC);
     }
-
-    uint16_t norm_DC = 255 - ((DC*255)/1250); ///< Normaliza el offset de la señal.
-    uint16_t norm_Amp = 2500/Amp; ///< Normaliza la amplitud de la señal.
-    signal = (signal/norm_Amp) - norm_DC; ///< Genera la señal y la envía al DAC.
-    set_dac_value(signal);
-    signal_index += 1; ///< Incrementa el índice de la señal.
-    signal_index %= 100;
-
+    wave_cache_retune(&wave_cache, dds_tuning_word(freq_mhz, SAMPLE_RATE_HZ));
+    wave_cache_commit(&wave_cache, 0, param_txn_wait(SAMPLE_RATE_HZ));
 }
 
+/**
+ * @brief Genera la señal con el punto ya escalado de la fase actual.
+ */
+void generator(void){
+    set_dac_value(gen_next(&gen));
+}
 
 
-#define KEYPAD_ROWS 4
-#define KEYPAD_COLUMNS 4
 
 char matrix_keys[KEYPAD_ROWS][KEYPAD_COLUMNS] = {
     {'1', '2', '3', 'A'},
@@ -143,11 +129,27 @@ char matrix_keys[KEYPAD_ROWS][KEYPAD_COLUMNS] = {
 
 int keypad_rows[KEYPAD_ROWS] = {2, 3, 4, 5}; ///< Definición de los pines de fila del teclado.
 int keypad_columns[KEYPAD_COLUMNS] = {6, 7, 8, 9}; ///< Definición de los pines de columna del teclado.
-int col_pins[KEYPAD_COLUMNS];  ///< Arreglo para almacenar los pines de columna.
-int row_pins[KEYPAD_ROWS]; ///< Arreglo para almacenar los pines de fila.
+keypad_t keypad; ///< Barrido, antirrebote y cola de eventos del teclado.
 int count = 0; ///< Contador para el tipo de señal generada.
 int last_button_press = 0; ///< Tiempo de la última pulsación de botón
-int last_keypress_time = 0; ///< Tiempo de la última pulsación de tecla.
+char text_input[20] = "";  ///< Texto ingresado por el usuario.
+uint32_t amplitude = 1000; ///< Valor predeterminado para la amplitud de la señal.
+uint32_t offsete = 100; ///< Valor predeterminado para el offset de la señal.
+uint32_t frequency = 10000; ///< Valor predeterminado para la frecuencia de la señal (mHz).
+
+// Ejecutivo cooperativo: una tarea por actividad, en orden de prioridad
+exec_t executive;
+exec_task_t sample_task, scan_task, button_task, key_task, serial_task, status_task, report_task, console_task;
+uint32_t report_line = 0; ///< Siguiente linea del informe de tiempos
+
+// Registros de las tareas, formateados por la tarea de consola
+log_ring_t log_main; ///< Registros de todas las tareas (un solo contexto)
+log_drain_t log_out; ///< Texto o telemetria binaria hacia la cola de salida
+
+// Cola de salida por serial, vaciada por la tarea de consola en trozos acotados
+uint8_t console_buf[CONSOLE_LEN];
+uint32_t console_head = 0; ///< Bytes escritos en la cola
+uint32_t console_tail = 0; ///< Bytes enviados por serial
 
 
 
@@ -184,128 +186,222 @@ void setup() {
  * @brief Asigna los pines para filas y columnas del teclado matricial.
  */
 void assign_pins() {
-    for (int i = 0; i < KEYPAD_ROWS; i++) {
-        row_pins[i] = keypad_rows[i];
-        gpio_init(row_pins[i]);
-        gpio_set_dir(row_pins[i], GPIO_OUT);
+    keypad_init(&keypad, &matrix_keys[0][0], KEYPAD_DEBOUNCE_SCANS);
+    keypad_hw_init(&keypad, keypad_rows[0], keypad_columns[0]);
+}
+
+/**
+ * @brief Salida del registro: copia un mensaje ya formateado a la cola de salida.
+ *
+ * Solo se llama cuando cabe un mensaje entero (ver console_step()).
+ */
+void console_write(const uint8_t *buf, uint32_t len, void *ctx) {
+    (void)ctx;
+    for (uint32_t i = 0; i < len && console_head - console_tail < CONSOLE_LEN; i++) {
+        console_buf[console_head++ % CONSOLE_LEN] = buf[i];
+    }
+}
+
+/**
+ * @brief Tarea de consola: formatea un registro y envía hasta CONSOLE_CHUNK bytes pendientes.
+ *
+ * Las demás tareas solo guardan registros binarios; el formateo y la
+ * escritura por serial se hacen aquí, en pasos acotados.
+ *
+ * @return true si quedan registros o bytes por enviar.
+ */
+bool console_step(void *ctx) {
+    (void)ctx;
+    bool more = false;
+    if (CONSOLE_LEN - (console_head - console_tail) >= LOG_LINE_MAX) {
+        more = log_drain_step(&log_out, 1) != 0;
     }
-    for (int i = 0; i < KEYPAD_COLUMNS; i++) {
-        col_pins[i] = keypad_columns[i];
-        gpio_init(col_pins[i]);
-        gpio_set_dir(col_pins[i], GPIO_IN);
-        gpio_pull_down(col_pins[i]);
+    for (int i = 0; i < CONSOLE_CHUNK && console_tail != console_head; i++) {
+        putchar_raw(console_buf[console_tail++ % CONSOLE_LEN]);
     }
+    return more || console_tail != console_head;
 }
 
 /**
- * @brief Función principal.
+ * @brief Tarea de serial: 'T' pasa el registro a telemetria binaria, 'P' a texto.
  */
-void main() {
-    stdio_init_all();
-    setup();
-    assign_pins();
-    char text_input[20] = "";  ///< Inicializa la variable para almacenar el texto ingresado.
-    uint32_t amplitude = 1000; ///< Valor predeterminado para la amplitud de la señal.
-    uint32_t offsete = 100; ///< Valor predeterminado para el offset de la señal.
-    uint32_t frequency = 10; ///< Valor predeterminado para la frecuencia de la señal.
-    uint32_t next_execution_time = time_us_32() / 1000;  ///< Tiempo para la próxima ejecución del ciclo.
-    uint32_t points = 100;  ///< Número de puntos de la señal.
-    uint32_t samp_freq = (uint32_t)((1000000.0)*(1.0/points)*(1.0/frequency)); ///< Frecuencia de muestreo de la señal.
-    uint32_t samp_t = time_us_32(); ///< Tiempo de inicio del muestreo.
-    char tipo[11] = " ";  ///< Tipo de señal generada.
+bool serial_step(void *ctx) {
+    (void)ctx;
+    int ch = getchar_timeout_us(0);
+    if (ch == 'T' || ch == 'P') {
+        log_drain_set_binary(&log_out, ch == 'T');
+    }
+    return false;
+}
 
-    while (true) {
-        // Verificar si se han ingresado nuevas teclas
-        for (int row = 0; row < KEYPAD_ROWS; row++) {
-            for (int col = 0; col < KEYPAD_COLUMNS; col++) {
-                gpio_put(row_pins[row], 1);
-                if (gpio_get(col_pins[col]) == 1) {
-                    int current_time = time_us_32() / 1000;
-                    if (current_time - last_keypress_time > 500) {
-                        char key_pressed = matrix_keys[row][col];
-                        if (key_pressed == 'D') {  // Si se presiona 'D' se finaliza la entrada
-                            if (text_input[0] == 'A') {
-                                uint32_t amplitud = atoi(&text_input[1]);
-                                if (100 <= amplitud && amplitud <= 2500) {
-                                    printf("Configuracion ingresada : Amplitud-> %d\n", amplitud);
-                                    // Generar señal con nueva amplitud
-                                    amplitude = amplitud;
-                                } else {
-                                    printf("Configuracion de amplitud invalida\n");
-                                }
-                            } else if (text_input[0] == 'B') {
-                                uint32_t offset = atoi(&text_input[1]);
-                                if (50 <= offset && offset <= 1250) {
-                                    printf("Configuracion ingresada : Offset-> %d\n", offset);
-                                    // Generar señal con nuevo offset
-                                    offsete = offset;
-                                } else {
-                                    printf("Configuracion de offset invalida\n");
-                                }
-                            } else if (text_input[0] == 'C') {
-                                uint32_t frecuencia = atoi(&text_input[1]);
-                                if (1 <= frecuencia && frecuencia <= 12000000) {
-                                    printf("Configuracion ingresada : Frecuencia-> %d\n", frecuencia);
-                                    // Generar señal con nueva frecuencia
-                                    frequency = frecuencia;
-                                    samp_freq = (uint32_t)((1000000.0)*(1.0/points)*(1.0/frequency)); 
-                                } else {
-                                    printf("Configuracion de frecuencia invalida\n");
-                                }
-                            }
-                            printf("Texto ingresado: %s\n", text_input);
-                            text_input[0] = '\0';  // Reiniciar el texto ingresado
-                        } else {
-                            strncat(text_input, &key_pressed, 1);
-                            if (strlen(text_input) >= 10) { 
-                                printf("Texto demasiado largo. Presione 'D' para finalizar.\n");
-                                text_input[0] = '\0';  
-                            }
-                        }
-                        last_keypress_time = current_time;
-                    }
-                }
-                gpio_put(row_pins[row], 0);
-            }
-        }
+/**
+ * @brief Tarea de muestreo: una muestra por periodo, con plazo estricto.
+ */
+bool sample_step(void *ctx) {
+    (void)ctx;
+    generator();
+    return false;
+}
 
-        // Lógica para procesar el botón 
-        if (gpio_get(Button_pin) == 1) {
-            int current_time = time_us_32() / 1000;
-            if (current_time - last_button_press > 300) {
-                count = (count + 1) % 4; 
-                last_button_press = current_time;
-            }
-        }
+/**
+ * @brief Tarea de teclado: un paso del barrido (una fila).
+ */
+bool scan_step(void *ctx) {
+    (void)ctx;
+    keypad_hw_scan(&keypad);
+    return false;
+}
 
-        // Lógica para generar la señal
-        if ((time_us_32() - samp_t) > samp_freq) {
-            generator(count, amplitude, offsete);
-            samp_t = time_us_32();
+/**
+ * @brief Tarea del pulsador: cambia la forma de onda.
+ */
+bool button_step(void *ctx) {
+    (void)ctx;
+    if (gpio_get(Button_pin) == 1) {
+        int current_time = time_us_32() / 1000;
+        if (current_time - last_button_press > 300) {
+            count = (count + 1) % 4; 
+            rebuild_waveform(count, amplitude, offsete, frequency);
+            last_button_press = current_time;
         }
+    }
+    return false;
+}
 
-        //Logica para imprimir por serial el estado de la señal
-        uint32_t current_time = time_us_32()/1000;
-        if (current_time - next_execution_time >= 10000) {
-            if (count==0) {
-                strcpy(tipo, "Seno");
-            } else if (count==1){
-                strcpy(tipo, "Triangular");
-            } else if (count==2){
-               strcpy(tipo, "Sierra");
-            } else if (count==3){
-                strcpy(tipo, "Cuadrada");
+/**
+ * @brief Procesa la tecla pulsada.
+ *
+ * @param key_pressed Tecla.
+ */
+void handle_key(char key_pressed) {
+    if (key_pressed == 'D') {  // Si se presiona 'D' se finaliza la entrada
+        if (text_input[0] == 'A') {
+            uint32_t amplitud = atoi(&text_input[1]);
+            if (100 <= amplitud && amplitud <= 2500) {
+                log_put(&log_main, LOG_SET_AMPLITUDE, amplitud, 0, 0, 0);
+                // Generar señal con nueva amplitud
+                amplitude = amplitud;
+                rebuild_waveform(count, amplitude, offsete, frequency);
+            } else {
+                log_put(&log_main, LOG_BAD_AMPLITUDE, 0, 0, 0, 0);
+            }
+        } else if (text_input[0] == 'B') {
+            uint32_t offset = atoi(&text_input[1]);
+            if (50 <= offset && offset <= 1250) {
+                log_put(&log_main, LOG_SET_OFFSET, offset, 0, 0, 0);
+                // Generar señal con nuevo offset
+                offsete = offset;
+                rebuild_waveform(count, amplitude, offsete, frequency);
+            } else {
+                log_put(&log_main, LOG_BAD_OFFSET, 0, 0, 0, 0);
             }
-             printf("Señal: Tipo -> %s, Amplitud -> %d mV, Offset -> %d mV, Frecuencia -> %d Hz\n",
-                tipo, amplitude, offsete, frequency);
-            next_execution_time = current_time + 10000;
+        } else if (text_input[0] == 'C') {
+            uint32_t frecuencia = dds_parse_mhz(&text_input[1]);
+            if (1 <= frecuencia && frecuencia <= SAMPLE_RATE_HZ * 500u) {
+                log_put(&log_main, LOG_SET_FREQUENCY, frecuencia / 1000, frecuencia % 1000, 0, 0);
+                // Generar señal con nueva frecuencia
+                frequency = frecuencia;
+                retune(count, amplitude, offsete, frequency);
+            } else {
+                log_put(&log_main, LOG_BAD_FREQUENCY, 0, 0, 0, 0);
+            }
+        }
+        log_put_text(&log_main, LOG_TEXT_INPUT, text_input);
+        text_input[0] = '\0';  // Reiniciar el texto ingresado
+    } else {
+        strncat(text_input, &key_pressed, 1);
+        if (strlen(text_input) >= 10) { 
+            log_put(&log_main, LOG_TEXT_TOO_LONG, 0, 0, 0, 0);
+            text_input[0] = '\0';  
         }
-        
-        
     }
+}
 
+/**
+ * @brief Tarea de comandos: procesa un evento del teclado por paso.
+ *
+ * @return true si puede haber más eventos en cola.
+ */
+bool key_step(void *ctx) {
+    (void)ctx;
+    keypad_event_t ev;
+    if (!keypad_pop(&keypad, &ev)) {
+        return false;
+    }
+    if (ev.pressed) {
+        handle_key(ev.key);
+    }
+    return true;
+}
 
+/**
+ * @brief Tarea de estado: registra el estado de la señal.
+ */
+bool status_step(void *ctx) {
+    (void)ctx;
+    log_put(&log_main, LOG_STATUS_SINE + count, amplitude, offsete, frequency / 1000, frequency % 1000);
+    return false;
 }
 
+/**
+ * @brief Tarea de informe: una línea de tiempos por paso (peor retraso y duración de cada tarea).
+ *
+ * Cada línea son tres registros (nombre, periodo y plazo, tiempos), con el
+ * mismo CSV que exec_report_line().
+ *
+ * @return true mientras queden líneas.
+ */
+bool report_step(void *ctx) {
+    (void)ctx;
+    if (report_line == 0) {
+        log_put(&log_main, LOG_EXEC_HEADER, 0, 0, 0, 0);
+    } else if (report_line <= executive.count) {
+        const exec_task_t *t = executive.tasks[report_line - 1];
+        log_put_text(&log_main, LOG_EXEC_NAME, t->name);
+        log_put(&log_main, LOG_EXEC_PERIOD, t->period, t->deadline, 0, 0);
+        log_put(&log_main, LOG_EXEC_TIMES, t->runs, t->missed, t->worst_late, t->worst_run);
+    } else {
+        report_line = 0;
+        return false;
+    }
+    report_line++;
+    return true;
+}
 
+/**
+ * @brief Función principal.
+ */
+void main() {
+    stdio_init_all();
+    log_ring_init(&log_main);
+    log_drain_init(&log_out, console_write, NULL);
+    log_drain_add(&log_out, &log_main);
+    setup();
+    assign_pins();
+    dds_init(&gen.dds, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&gen.dds, frequency, SAMPLE_RATE_HZ);
+    wave_cache_init(&wave_cache, WAVEFORM_LENGTH);
+    rebuild_waveform(count, amplitude, offsete, frequency);
+    wave_cache_swap(&wave_cache);
+
+    // La muestra tiene la prioridad más alta y plazo estricto; el resto son pasos acotados
+    uint32_t now = time_us_32();
+    exec_init(&executive);
+    exec_add(&executive, &sample_task, "sample", sample_step, NULL, SAMPLE_PERIOD_US, SAMPLE_DEADLINE_US, now);
+    exec_add(&executive, &scan_task, "keypad", scan_step, NULL, KEYPAD_SCAN_US, 0, now);
+    exec_add(&executive, &button_task, "button", button_step, NULL, BUTTON_POLL_US, 0, now);
+    exec_add(&executive, &key_task, "keys", key_step, NULL, KEYPAD_SCAN_US, 0, now);
+    exec_add(&executive, &serial_task, "serial", serial_step, NULL, SERIAL_POLL_US, 0, now);
+    exec_add(&executive, &status_task, "status", status_step, NULL, STATUS_PERIOD_US, 0, now + STATUS_PERIOD_US);
+    exec_add(&executive, &report_task, "report", report_step, NULL, STATUS_PERIOD_US, 0, now + STATUS_PERIOD_US / 2);
+    exec_add(&executive, &console_task, "console", console_step, NULL, 0, 0, now);
+    exec_set_budget(&key_task, UI_STEP_BUDGET_US);
+    exec_set_budget(&serial_task, UI_STEP_BUDGET_US);
+    exec_set_budget(&status_task, UI_STEP_BUDGET_US);
+    exec_set_budget(&report_task, UI_STEP_BUDGET_US);
+    exec_set_budget(&console_task, UI_STEP_BUDGET_US);
 
+    while (true) {
+        exec_poll(&executive);
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file alarm_sched.c
+ * @brief Deadline queue and dispatch of the alarm scheduler.
+ *
+ * alarm_sched_run() is called by the backend from the alarm interrupt. It
+ * runs every task that is due, moves each one to its next deadline and
+ * re-arms the alarm for the head of the queue; if that deadline passed
+ * while arming, it dispatches again instead of waiting for a compare that
+ * would never match.
+ */
+
+#include "alarm_sched.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize an empty scheduler.
+ *
+ * @param s Scheduler.
+ * @param alarm Hardware alarm used by this scheduler.
+ */
+void alarm_sched_init(alarm_sched_t *s, uint32_t alarm) {
+    memset(s, 0, sizeof(*s));
+    s->alarm = alarm;
+}
+
+/**
+ * @brief Move the task at @p i to its place in the deadline order.
+ */
+static void alarm_sched_sift(alarm_sched_t *s, uint32_t i) {
+    alarm_task_t *t = s->queue[i];
+    while (i > 0 && s->queue[i - 1]->deadline > t->deadline) {
+        s->queue[i] = s->queue[i - 1];
+        i--;
+    }
+    while (i + 1 < s->count && s->queue[i + 1]->deadline < t->deadline) {
+        s->queue[i] = s->queue[i + 1];
+        i++;
+    }
+    s->queue[i] = t;
+}
+
+/**
+ * @brief Add a periodic task (before alarm_sched_start()).
+ *
+ * @param s Scheduler.
+ * @param t Task storage, owned by the caller.
+ * @param fn Task body.
+ * @param ctx Context for @p fn.
+ * @param period_us Period in microseconds.
+ * @param first_deadline Absolute time of the first run.
+ * @return false if the queue is full or the period is zero.
+ */
+bool alarm_sched_add(alarm_sched_t *s, alarm_task_t *t, alarm_task_fn_t fn, void *ctx,
+                     uint32_t period_us, uint64_t first_deadline) {
+    if (s->count >= ALARM_SCHED_MAX_TASKS || period_us == 0) {
+        return false;
+    }
+    memset(t, 0, sizeof(*t));
+    t->fn = fn;
+    t->ctx = ctx;
+    t->period = period_us;
+    t->deadline = first_deadline;
+    s->queue[s->count++] = t;
+    alarm_sched_sift(s, s->count - 1);
+    return true;
+}
+
+/**
+ * @brief Register the alarm handler and arm the first deadline.
+ *
+ * The interrupt is enabled on the calling core.
+ */
+bool alarm_sched_start(alarm_sched_t *s) {
+    if (s->count == 0 || !alarm_sched_hw_init(s)) {
+        return false;
+    }
+    if (!alarm_sched_hw_arm(s, s->queue[0]->deadline)) {
+        alarm_sched_run(s);
+    }
+    return true;
+}
+
+/**
+ * @brief Run the due tasks and re-arm the alarm.
+ */
+void alarm_sched_run(alarm_sched_t *s) {
+    if (s->count == 0) {
+        return;
+    }
+    do {
+        uint64_t now = alarm_sched_hw_now();
+        while (s->queue[0]->deadline <= now) {
+            alarm_task_t *t = s->queue[0];
+            t->fn(t, t->ctx);
+            t->runs++;
+            uint64_t next = t->deadline + t->period;
+            now = alarm_sched_hw_now();
+            if (now >= next + t->period) {
+                uint32_t skipped = (uint32_t)((now - next) / t->period); ///< periodos que ya terminaron
+                next += (uint64_t)skipped * t->period;
+                t->missed += skipped;
+            }
+            t->deadline = next;
+            alarm_sched_sift(s, 0);
+        }
+    } while (!alarm_sched_hw_arm(s, s->queue[0]->deadline));
+}
+
+/**
+ * @brief Periods skipped by all the tasks of a scheduler.
+ */
+uint32_t alarm_sched_missed(const alarm_sched_t *s) {
+    uint32_t missed = 0;
+    for (uint32_t i = 0; i < s->count; i++) {
+        missed += s->queue[i]->missed;
+    }
+    return missed;
+}
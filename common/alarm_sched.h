@@ -0,0 +1,69 @@
+/**
+ * @file alarm_sched.h
+ * @brief Periodic tasks on absolute deadlines, multiplexed on one timer alarm.
+ *
+ * Every task keeps its own deadline and advances it by exactly one period
+ * per run (deadline += period), so handler latency never turns into
+ * frequency drift. The tasks of a scheduler share one hardware alarm,
+ * which is always armed for the earliest deadline of a small sorted queue;
+ * its interrupt handler is registered once. Whole periods that have
+ * already elapsed when a task gets to run are skipped (keeping its phase)
+ * and counted as missed.
+ *
+ * The queue logic is portable; the alarm itself comes from a backend
+ * (alarm_sched_rp2040.c on the board, host/alarm_sched_host.c on Linux).
+ */
+
+// Avoid duplication in code
+#ifndef _ALARM_SCHED_H_
+#define _ALARM_SCHED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ALARM_SCHED_MAX_TASKS 8 ///< Tareas por alarma
+
+typedef struct alarm_task alarm_task_t;
+
+/**
+ * @brief Task body.
+ *
+ * @param t Task; @c t->deadline is the time this run was scheduled for.
+ * @param ctx User context given to alarm_sched_add().
+ */
+typedef void (*alarm_task_fn_t)(alarm_task_t *t, void *ctx);
+
+/**
+ * @brief Periodic task.
+ */
+struct alarm_task {
+    alarm_task_fn_t fn;       ///< Cuerpo de la tarea
+    void *ctx;                ///< Contexto del cuerpo
+    uint64_t deadline;        ///< Instante absoluto de la proxima ejecucion (us)
+    uint32_t period;          ///< Periodo (us)
+    uint32_t runs;            ///< Ejecuciones realizadas
+    volatile uint32_t missed; ///< Periodos saltados por llegar tarde
+};
+
+/**
+ * @brief Tasks sharing one hardware alarm.
+ */
+typedef struct {
+    alarm_task_t *queue[ALARM_SCHED_MAX_TASKS]; ///< Tareas ordenadas por plazo
+    uint32_t count;                             ///< Tareas en la cola
+    uint32_t alarm;                             ///< Alarma del timer (0-3)
+} alarm_sched_t;
+
+void alarm_sched_init(alarm_sched_t *s, uint32_t alarm);
+bool alarm_sched_add(alarm_sched_t *s, alarm_task_t *t, alarm_task_fn_t fn, void *ctx,
+                     uint32_t period_us, uint64_t first_deadline);
+bool alarm_sched_start(alarm_sched_t *s);
+void alarm_sched_run(alarm_sched_t *s);
+uint32_t alarm_sched_missed(const alarm_sched_t *s);
+
+// Backend
+bool alarm_sched_hw_init(alarm_sched_t *s);
+bool alarm_sched_hw_arm(alarm_sched_t *s, uint64_t deadline);
+uint64_t alarm_sched_hw_now(void);
+
+#endif
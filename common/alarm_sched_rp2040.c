@@ -0,0 +1,63 @@
+/**
+ * @file alarm_sched_rp2040.c
+ * @brief RP2040 timer alarms for the alarm scheduler.
+ *
+ * Each scheduler owns one of the four TIMER_IRQ_n alarms. The alarm
+ * compares against the low 32 bits of the microsecond timer, so deadlines
+ * must stay within about 71 minutes of the current time.
+ */
+
+#include "alarm_sched.h"
+
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+
+static alarm_sched_t *alarm_owner[4]; ///< Planificador de cada alarma
+
+/**
+ * @brief Common alarm interrupt: acknowledge and dispatch.
+ */
+static void alarm_irq(uint32_t alarm) {
+    hw_clear_bits(&timer_hw->intr, 1u << alarm);
+    alarm_sched_run(alarm_owner[alarm]);
+}
+
+static void alarm_irq_0(void) { alarm_irq(0); }
+static void alarm_irq_1(void) { alarm_irq(1); }
+static void alarm_irq_2(void) { alarm_irq(2); }
+static void alarm_irq_3(void) { alarm_irq(3); }
+
+static const irq_handler_t alarm_handlers[4] = { alarm_irq_0, alarm_irq_1, alarm_irq_2, alarm_irq_3 };
+
+/**
+ * @brief Register the handler of the scheduler's alarm (once).
+ */
+bool alarm_sched_hw_init(alarm_sched_t *s) {
+    if (s->alarm > 3) {
+        return false;
+    }
+    alarm_owner[s->alarm] = s;
+    hw_clear_bits(&timer_hw->intr, 1u << s->alarm);
+    irq_set_exclusive_handler(TIMER_IRQ_0 + s->alarm, alarm_handlers[s->alarm]);
+    hw_set_bits(&timer_hw->inte, 1u << s->alarm);
+    irq_set_enabled(TIMER_IRQ_0 + s->alarm, true);
+    return true;
+}
+
+/**
+ * @brief Arm the alarm for an absolute deadline.
+ *
+ * @return false if the deadline had already passed once armed.
+ */
+bool alarm_sched_hw_arm(alarm_sched_t *s, uint64_t deadline) {
+    timer_hw->alarm[s->alarm] = (uint32_t)deadline;
+    return (int64_t)(deadline - time_us_64()) > 0;
+}
+
+/**
+ * @brief Current time in microseconds.
+ */
+uint64_t alarm_sched_hw_now(void) {
+    return time_us_64();
+}
@@ -0,0 +1,253 @@
+/**
+ * @file clock_plan.c
+ * @brief PLL clock table and the search for the best clock plan.
+ *
+ * The table is built once (a few thousand PLL settings); a plan then tries
+ * each clock with each power of two of points per period, stopping at the
+ * first plan within the tolerance, so a typical search evaluates a few
+ * dozen combinations and a hard one a few thousand. Only when none is
+ * within the tolerance does it also try each clock with a rounded step.
+ */
+
+#include "clock_plan.h"
+
+#include <string.h>
+
+#include "dac_stream.h"
+#include "dds.h"
+
+/**
+ * @brief Default limits.
+ *
+ * @param l Limits to fill.
+ * @param max_points Points of the waveform table (more would only repeat points).
+ */
+void clock_plan_defaults(clock_plan_limits_t *l, uint32_t max_points) {
+    l->sys_min_khz = CLOCK_PLAN_SYS_MIN_KHZ;
+    l->sys_max_khz = CLOCK_PLAN_SYS_MAX_KHZ;
+    l->min_points = CLOCK_PLAN_MIN_POINTS;
+    l->max_points = max_points;
+    l->sample_cycles = CLOCK_PLAN_SAMPLE_CYCLES;
+    l->max_load_pct = CLOCK_PLAN_MAX_LOAD_PCT;
+    l->tolerance_ppb = CLOCK_PLAN_TOLERANCE_PPB;
+}
+
+/**
+ * @brief Add a clock to the table, keeping it sorted and without repeats.
+ *
+ * The first PLL setting found for a clock is kept: the search goes from
+ * the highest VCO down, as the SDK's check_sys_clock_khz() does.
+ */
+static void clock_planner_add(clock_planner_t *p, uint32_t sys_khz, uint32_t fbdiv, uint32_t pd1, uint32_t pd2) {
+    uint32_t at = 0;
+    while (at < p->count && p->clocks[at].sys_khz < sys_khz) {
+        at++;
+    }
+    if ((at < p->count && p->clocks[at].sys_khz == sys_khz) || p->count == CLOCK_PLAN_MAX_CLOCKS) {
+        return;
+    }
+    memmove(&p->clocks[at + 1], &p->clocks[at], (p->count - at) * sizeof(p->clocks[0]));
+    p->clocks[at] = (clock_plan_pll_t){ sys_khz, (uint16_t)fbdiv, (uint8_t)pd1, (uint8_t)pd2 };
+    p->count++;
+}
+
+/**
+ * @brief Build the table of the system clocks the PLL can make within the limits.
+ *
+ * Only clocks that are a whole number of kHz are kept, as
+ * set_sys_clock_khz() needs.
+ */
+void clock_planner_init(clock_planner_t *p, const clock_plan_limits_t *l) {
+    memset(p, 0, sizeof(*p));
+    p->limits = *l;
+    for (uint32_t fbdiv = CLOCK_PLAN_FBDIV_MAX; fbdiv >= CLOCK_PLAN_FBDIV_MIN; fbdiv--) {
+        uint32_t vco = CLOCK_PLAN_XOSC_KHZ * fbdiv;
+        if (vco < CLOCK_PLAN_VCO_MIN_KHZ || vco > CLOCK_PLAN_VCO_MAX_KHZ) {
+            continue;
+        }
+        for (uint32_t pd1 = CLOCK_PLAN_POSTDIV_MAX; pd1 >= 1; pd1--) {
+            for (uint32_t pd2 = pd1; pd2 >= 1; pd2--) {
+                uint32_t sys = vco / (pd1 * pd2);
+                if (vco % (pd1 * pd2) == 0 && sys >= l->sys_min_khz && sys <= l->sys_max_khz) {
+                    clock_planner_add(p, sys, fbdiv, pd1, pd2);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief PLL setting of a clock in the table, NULL if the limits leave it out.
+ */
+const clock_plan_pll_t *clock_planner_find(const clock_planner_t *p, uint32_t sys_khz) {
+    uint32_t lo = 0, hi = p->count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (p->clocks[mid].sys_khz < sys_khz) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < p->count && p->clocks[lo].sys_khz == sys_khz ? &p->clocks[lo] : NULL;
+}
+
+/**
+ * @brief Fill in a plan from its clock, divider and tuning word.
+ *
+ * @return false if the divider is out of range or the load over @p max_load.
+ */
+static bool clock_plan_fill(const clock_plan_limits_t *l, uint32_t max_load, const clock_plan_pll_t *c,
+                            uint64_t div256, uint32_t hold, uint32_t tuning, uint32_t freq_mhz, clock_plan_t *out) {
+    if (div256 < DAC_STREAM_DIV_MIN || div256 > DAC_STREAM_DIV_MAX) {
+        return false;
+    }
+    uint32_t load = (uint32_t)(((uint64_t)l->sample_cycles * 25600u + div256 - 1) / div256);
+    if (load > max_load) {
+        return false;
+    }
+    uint64_t sys256 = (uint64_t)c->sys_khz * 256000u;
+    uint64_t cycles = div256 * hold; ///< ciclos del sistema por muestra, en 1/256
+    double fs = (double)sys256 / (double)cycles;
+    double achieved = fs * tuning / 4294967296.0 * 1000.0;
+
+    out->sys_khz = c->sys_khz;
+    out->vco_khz = CLOCK_PLAN_XOSC_KHZ * c->fbdiv;
+    out->postdiv1 = c->postdiv1;
+    out->postdiv2 = c->postdiv2;
+    out->div256 = (uint32_t)div256;
+    out->hold = hold;
+    out->points = tuning && (tuning & (tuning - 1)) == 0 ? (uint32_t)(((uint64_t)1 << 32) / tuning) : 0;
+    out->tuning = tuning;
+    out->rate_hz = (uint32_t)((sys256 + cycles / 2) / cycles);
+    out->freq_mhz = (uint32_t)(achieved + 0.5);
+    out->error_ppb = (int32_t)((achieved - freq_mhz) / freq_mhz * 1e9 + (achieved >= freq_mhz ? 0.5 : -0.5));
+    out->load_pct = load;
+    return true;
+}
+
+/**
+ * @brief Plan with a clock and a power of two of points per period.
+ */
+static bool clock_plan_points(const clock_planner_t *p, const clock_plan_pll_t *c, uint32_t freq_mhz,
+                              uint32_t points, clock_plan_t *out) {
+    uint64_t sys256 = (uint64_t)c->sys_khz * 256000000u; ///< en mHz * 256
+    uint64_t step = (uint64_t)freq_mhz * points;         ///< muestras por segundo, en mHz
+    uint64_t per_hold = step * DAC_STREAM_DIV_MAX;
+    uint32_t hold = (uint32_t)((sys256 + per_hold - 1) / per_hold);
+    if (hold == 0) {
+        hold = 1;
+    }
+    uint64_t div256 = (sys256 + step * hold / 2) / (step * hold);
+    return clock_plan_fill(&p->limits, p->limits.max_load_pct, c, div256, hold, (uint32_t)(((uint64_t)1 << 32) / points),
+                           freq_mhz, out);
+}
+
+/**
+ * @brief Plan with a clock at the fastest rate the load allows and a rounded step.
+ *
+ * The step is worked out from the exact sample rate, so the only error
+ * left is the rounding of the 32-bit tuning word; the DDS then walks
+ * different table points on each period.
+ */
+static bool clock_plan_step(const clock_planner_t *p, const clock_plan_pll_t *c, uint32_t freq_mhz,
+                            clock_plan_t *out) {
+    const clock_plan_limits_t *l = &p->limits;
+    uint64_t div256 = ((uint64_t)l->sample_cycles * 25600u + l->max_load_pct - 1) / l->max_load_pct;
+    if (div256 < DAC_STREAM_DIV_MIN) {
+        div256 = DAC_STREAM_DIV_MIN;
+    }
+    uint64_t sys256 = (uint64_t)c->sys_khz * 256000000u; ///< en mHz * 256
+    if (sys256 < (uint64_t)freq_mhz * l->min_points * div256) {
+        return false; ///< menos puntos por periodo que el minimo
+    }
+    double tuning = (double)freq_mhz * (double)div256 * 4294967296.0 / (double)sys256 + 0.5;
+    return tuning >= 1.0 && tuning < 4294967296.0
+           && clock_plan_fill(l, l->max_load_pct, c, div256, 1, (uint32_t)tuning, freq_mhz, out);
+}
+
+static uint32_t clock_plan_abs(int32_t v) {
+    return v < 0 ? (uint32_t)-(int64_t)v : (uint32_t)v;
+}
+
+/**
+ * @brief Best plan for an output frequency.
+ *
+ * @param p Planner.
+ * @param freq_mhz Requested frequency in mHz.
+ * @param prefer_khz Clock in use, preferred among equal plans (0: none).
+ * @param out Plan; @c tried counts the combinations evaluated.
+ * @return false if no plan fits the limits (too high a frequency).
+ */
+bool clock_plan(const clock_planner_t *p, uint32_t freq_mhz, uint32_t prefer_khz, clock_plan_t *out) {
+    const clock_plan_limits_t *l = &p->limits;
+    const clock_plan_pll_t *prefer = clock_planner_find(p, prefer_khz);
+    uint32_t top = 1;
+    while (top * 2 <= l->max_points) {
+        top *= 2;
+    }
+    bool found = false;
+    uint32_t tried = 0;
+    clock_plan_t best, plan;
+    if (freq_mhz == 0) {
+        return false;
+    }
+    for (uint32_t points = top; points >= l->min_points && points >= 2; points /= 2) {
+        for (int32_t i = prefer ? -1 : 0; i < (int32_t)p->count; i++) {
+            const clock_plan_pll_t *c = i < 0 ? prefer : &p->clocks[i];
+            if (i >= 0 && c == prefer) {
+                continue;
+            }
+            tried++;
+            if (!clock_plan_points(p, c, freq_mhz, points, &plan)) {
+                continue;
+            }
+            if (clock_plan_abs(plan.error_ppb) <= l->tolerance_ppb) {
+                *out = plan; ///< el primero dentro de la tolerancia: mas puntos, reloj en uso o menor reloj
+                out->tried = tried;
+                return true;
+            }
+            if (!found || clock_plan_abs(plan.error_ppb) < clock_plan_abs(best.error_ppb)) {
+                best = plan;
+                found = true;
+            }
+        }
+    }
+    for (int32_t i = prefer ? -1 : 0; i < (int32_t)p->count; i++) {
+        const clock_plan_pll_t *c = i < 0 ? prefer : &p->clocks[i];
+        if (i >= 0 && c == prefer) {
+            continue;
+        }
+        tried++;
+        if (clock_plan_step(p, c, freq_mhz, &plan)
+            && (!found || clock_plan_abs(plan.error_ppb) < clock_plan_abs(best.error_ppb))) {
+            best = plan; ///< ningun paso exacto entra en la tolerancia: el paso redondeado mas fino
+            found = true;
+        }
+    }
+    if (found) {
+        *out = best;
+        out->tried = tried;
+    }
+    return found;
+}
+
+/**
+ * @brief Plan for a fixed clock and sample rate, as dac_stream_set_rate() paces it.
+ *
+ * The tuning word is the one dds_tuning_word() gives for the rounded rate
+ * the stream reports, which is what a modulated carrier is computed with.
+ * The load limit does not apply.
+ *
+ * @return false if the clock is not in the table.
+ */
+bool clock_plan_rate(const clock_planner_t *p, uint32_t sys_khz, uint32_t rate_hz, uint32_t freq_mhz,
+                     clock_plan_t *out) {
+    const clock_plan_pll_t *c = clock_planner_find(p, sys_khz);
+    if (!c || rate_hz == 0 || freq_mhz == 0) {
+        return false;
+    }
+    uint32_t div256, hold;
+    uint32_t rate = dac_stream_divider(sys_khz * 1000u, rate_hz, &div256, &hold);
+    return clock_plan_fill(&p->limits, UINT32_MAX, c, div256, hold, dds_tuning_word(freq_mhz, rate), freq_mhz, out);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file clock_plan.h
+ * @brief System clock, PIO pacing and samples per period planned for an output frequency.
+ *
+ * The PIO stream plays one code per divided system clock cycle, so with
+ * @c points samples per period the output frequency is
+ *
+ *     sys_hz * 256 / (div256 * hold * points)
+ *
+ * with div256 the 16.8 PIO divider and hold the repeats of each code
+ * (dac_stream.h). With @c points a power of two the DDS steps exactly
+ * 2^32 / points per sample and every period lands on the same table
+ * points, so the only error left is that of the divider.
+ *
+ * The planner tries every system clock the PLL can make within the
+ * limits (12 MHz crystal, VCO 750-1600 MHz, post dividers 1-7) with every
+ * power of two of points per period, and keeps, in this order:
+ *
+ * 1. the smallest frequency error (errors within the tolerance count as equal);
+ * 2. the most points per period, up to the table length;
+ * 3. the clock in use, if it qualifies, so a retune does not stop the PLL;
+ * 4. the lowest system clock, which cuts the power at low rates.
+ *
+ * If no power of two comes within the tolerance, the plan with the
+ * smallest error wins, counting also each clock at the fastest rate the
+ * load allows with a rounded step (@c points 0), as a fixed sample rate
+ * would play it.
+ *
+ * Plans whose CPU load (cycles to produce each PIO word times the word
+ * rate) would exceed the limit are left out. The code is portable and
+ * takes no time from the hardware: the firmware applies the plan with
+ * set_sys_clock_pll() and dac_stream_set_divider().
+ */
+
+// Avoid duplication in code
+#ifndef _CLOCK_PLAN_H_
+#define _CLOCK_PLAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CLOCK_PLAN_XOSC_KHZ 12000        ///< Cristal de referencia del PLL
+#define CLOCK_PLAN_VCO_MIN_KHZ 750000    ///< VCO minimo del PLL
+#define CLOCK_PLAN_VCO_MAX_KHZ 1600000   ///< VCO maximo del PLL
+#define CLOCK_PLAN_FBDIV_MIN 16          ///< Divisor de realimentacion minimo
+#define CLOCK_PLAN_FBDIV_MAX 320         ///< Divisor de realimentacion maximo
+#define CLOCK_PLAN_POSTDIV_MAX 7         ///< Divisor posterior maximo (cada uno de los dos)
+#define CLOCK_PLAN_MAX_CLOCKS 512        ///< Relojes distintos que puede guardar el planificador
+
+#define CLOCK_PLAN_SYS_MIN_KHZ 24000     ///< Reloj minimo por defecto (el nucleo 0 sigue atendiendo USB)
+#define CLOCK_PLAN_SYS_MAX_KHZ 133000    ///< Reloj maximo por defecto (el especificado)
+#define CLOCK_PLAN_MIN_POINTS 4          ///< Puntos por periodo minimos por defecto
+#define CLOCK_PLAN_SAMPLE_CYCLES 24      ///< Ciclos de CPU por palabra del PIO (relleno de los bloques DMA, estimado)
+#define CLOCK_PLAN_MAX_LOAD_PCT 75       ///< Carga de CPU maxima por defecto
+#define CLOCK_PLAN_TOLERANCE_PPB 1000    ///< Errores por debajo de este (en ppb) cuentan como iguales
+
+/**
+ * @brief What the planner may choose from.
+ */
+typedef struct {
+    uint32_t sys_min_khz;     ///< Reloj del sistema minimo
+    uint32_t sys_max_khz;     ///< Reloj del sistema maximo
+    uint32_t min_points;      ///< Puntos por periodo minimos
+    uint32_t max_points;      ///< Puntos por periodo maximos (se redondea a potencia de dos)
+    uint32_t sample_cycles;   ///< Ciclos de CPU por palabra del PIO
+    uint32_t max_load_pct;    ///< Carga de CPU maxima
+    uint32_t tolerance_ppb;   ///< Error que cuenta como exacto
+} clock_plan_limits_t;
+
+/**
+ * @brief One system clock and the PLL settings that make it.
+ */
+typedef struct {
+    uint32_t sys_khz;         ///< Reloj del sistema
+    uint16_t fbdiv;           ///< VCO = CLOCK_PLAN_XOSC_KHZ * fbdiv
+    uint8_t postdiv1;         ///< Primer divisor posterior
+    uint8_t postdiv2;         ///< Segundo divisor posterior
+} clock_plan_pll_t;
+
+/**
+ * @brief Planner: the limits and every clock they allow, in ascending order.
+ */
+typedef struct {
+    clock_plan_limits_t limits;                    ///< Limites de los planes
+    uint32_t count;                                ///< Relojes en la tabla
+    clock_plan_pll_t clocks[CLOCK_PLAN_MAX_CLOCKS]; ///< Relojes posibles, de menor a mayor
+} clock_planner_t;
+
+/**
+ * @brief Clocks, pacing and DDS step for one output frequency.
+ */
+typedef struct {
+    uint32_t sys_khz;         ///< Reloj del sistema
+    uint32_t vco_khz;         ///< VCO del PLL
+    uint8_t postdiv1;         ///< Primer divisor posterior
+    uint8_t postdiv2;         ///< Segundo divisor posterior
+    uint32_t div256;          ///< Divisor del PIO en formato 16.8
+    uint32_t hold;            ///< Repeticiones de cada codigo
+    uint32_t points;          ///< Muestras por periodo (0: no entero)
+    uint32_t tuning;          ///< Sintonia del DDS
+    uint32_t rate_hz;         ///< Frecuencia de muestreo redondeada
+    uint32_t freq_mhz;        ///< Frecuencia lograda (mHz, redondeada)
+    int32_t error_ppb;        ///< Error de la frecuencia lograda (ppb)
+    uint32_t load_pct;        ///< Carga de CPU del relleno
+    uint32_t tried;           ///< Combinaciones evaluadas
+} clock_plan_t;
+
+void clock_plan_defaults(clock_plan_limits_t *l, uint32_t max_points);
+void clock_planner_init(clock_planner_t *p, const clock_plan_limits_t *l);
+const clock_plan_pll_t *clock_planner_find(const clock_planner_t *p, uint32_t sys_khz);
+bool clock_plan(const clock_planner_t *p, uint32_t freq_mhz, uint32_t prefer_khz, clock_plan_t *out);
+bool clock_plan_rate(const clock_planner_t *p, uint32_t sys_khz, uint32_t rate_hz, uint32_t freq_mhz,
+                     clock_plan_t *out);
+
+#endif
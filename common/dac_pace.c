@@ -0,0 +1,119 @@
+/**
+ * @file dac_pace.c
+ * @brief Deadline loop of the timer-paced DAC writes.
+ */
+
+#include "dac_pace.h"
+
+/**
+ * @brief Set up paced output from a generator.
+ *
+ * The bus lines are taken to start low, as the pins are after being set
+ * as outputs.
+ *
+ * @param p State to initialize.
+ * @param g Generator (DDS and scaled period) that produces the samples.
+ * @param period_us Sample period (at least 1 us).
+ */
+void dac_pace_init(dac_pace_t *p, gen_state_t *g, uint32_t period_us) {
+    p->gen = g;
+    p->period_us = period_us ? period_us : 1;
+    p->next_us = 0;
+    p->bus = 0;
+    p->played = 0;
+    p->skipped = 0;
+}
+
+/**
+ * @brief Start the timeline one period from now.
+ */
+void dac_pace_start(dac_pace_t *p) {
+    p->next_us = dac_pace_hw_now_us() + p->period_us;
+}
+
+/**
+ * @brief Write one code to the bus now, toggling only the lines that change.
+ */
+void dac_pace_put(dac_pace_t *p, uint8_t code) {
+    uint32_t word = dac_pace_gpio(code);
+    if (word != p->bus) {
+        dac_pace_hw_toggle(word ^ p->bus);
+        p->bus = word;
+    }
+}
+
+/**
+ * @brief Skip the samples whose deadline has already gone by a whole period.
+ *
+ * A change waiting for the period boundary is applied at once: the
+ * skipped span may have held the boundary.
+ */
+static void dac_pace_catch_up(dac_pace_t *p, uint32_t now) {
+    uint32_t behind = now - p->next_us;
+    if (behind < p->period_us) {
+        return;
+    }
+    uint32_t late = behind / p->period_us;
+    dds_t *d = &p->gen->dds;
+    d->phase += d->tuning * late;
+    if (p->gen->cache->pending) {
+        wave_cache_apply(p->gen->cache, d);
+    }
+    p->next_us += late * p->period_us;
+    p->skipped += late;
+}
+
+/**
+ * @brief Play the generator on the timeline for a slice of time.
+ *
+ * Busy-waits on the timer for each deadline; returns once the next
+ * deadline is past the end of the slice, so the caller gets the time up
+ * to it.
+ *
+ * @param p State started with dac_pace_start().
+ * @param slice_us Length of the slice from now.
+ * @return Samples written.
+ */
+uint32_t dac_pace_run(dac_pace_t *p, uint32_t slice_us) {
+    uint32_t end = dac_pace_hw_now_us() + slice_us;
+    uint32_t played = 0;
+    while ((int32_t)(end - p->next_us) > 0) {
+        uint32_t now;
+        while ((int32_t)((now = dac_pace_hw_now_us()) - p->next_us) < 0) {
+        }
+        dac_pace_catch_up(p, now);
+        dac_pace_put(p, gen_next(p->gen));
+        p->next_us += p->period_us;
+        played++;
+    }
+    p->played += played;
+    return played;
+}
+
+/**
+ * @brief Write a block of codes, back to back or one per period.
+ *
+ * The block has its own timeline starting now; no code is skipped, a
+ * late one is written as soon as possible and counted.
+ *
+ * @param p State (only the bus word is used).
+ * @param codes DAC codes.
+ * @param count Number of codes.
+ * @param period_us Time between codes (0: as fast as possible).
+ * @return Codes written after their deadline.
+ */
+uint32_t dac_pace_write(dac_pace_t *p, const uint8_t *codes, uint32_t count, uint32_t period_us) {
+    uint32_t late = 0;
+    uint32_t next = period_us ? dac_pace_hw_now_us() : 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (period_us) {
+            uint32_t now;
+            while ((int32_t)((now = dac_pace_hw_now_us()) - next) < 0) {
+            }
+            late += now - next >= period_us;
+            next += period_us;
+        }
+        dac_pace_put(p, codes[i]);
+    }
+    return late;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file dac_pace.h
+ * @brief Timer-paced DAC writes from a loop, for hosts without PIO or IRQ access.
+ *
+ * The MicroPython native module (py_native/) cannot claim a DMA channel or
+ * an alarm interrupt, so it writes the bus from a loop that polls the
+ * 1 us timer. Every sample has a deadline on a fixed timeline (start +
+ * n * period); the loop waits for it, writes the eight lines with one
+ * GPIO toggle, and returns once the deadlines reach the end of the slice
+ * it was given, so the interpreter can scan the keypad in between.
+ *
+ * Samples whose deadline passed while the interpreter ran are skipped:
+ * the DDS phase moves on by the same number of steps, so the output stays
+ * on the timeline (right frequency and phase) instead of stretching.
+ *
+ * The loop is portable; the timer and the GPIO toggle are a backend
+ * (py_native/siggen_native.c on the board, host/dac_pace_host.c on Linux).
+ */
+
+// Avoid duplication in code
+#ifndef _DAC_PACE_H_
+#define _DAC_PACE_H_
+
+#include <stdint.h>
+
+#include "dac_stream.h"
+#include "gen_block.h"
+
+/**
+ * @brief Paced output state.
+ */
+typedef struct {
+    gen_state_t *gen;     ///< Generador que produce las muestras
+    uint32_t period_us;   ///< Periodo de muestreo
+    uint32_t next_us;     ///< Plazo de la proxima muestra
+    uint32_t bus;         ///< Palabra GPIO escrita en el bus (para conmutar solo lo que cambia)
+    uint32_t played;      ///< Muestras escritas
+    uint32_t skipped;     ///< Muestras saltadas por llegar tarde
+} dac_pace_t;
+
+/**
+ * @brief GPIO word of an 8-bit DAC code (D0-D6 on GPIO 16-22, D7 on GPIO 26).
+ */
+static inline uint32_t dac_pace_gpio(uint8_t code) {
+    return (uint32_t)dac_bus_encode(code) << DAC_BUS_PIN_BASE;
+}
+
+void dac_pace_init(dac_pace_t *p, gen_state_t *g, uint32_t period_us);
+void dac_pace_start(dac_pace_t *p);
+void dac_pace_put(dac_pace_t *p, uint8_t code);
+uint32_t dac_pace_run(dac_pace_t *p, uint32_t slice_us);
+uint32_t dac_pace_write(dac_pace_t *p, const uint8_t *codes, uint32_t count, uint32_t period_us);
+
+// Backend, implemented once per platform
+uint32_t dac_pace_hw_now_us(void);
+void dac_pace_hw_toggle(uint32_t mask);
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * @file dac_stream.c
+ * @brief Pacing and block hand-off for the PIO + DMA DAC stream.
+ *
+ * Nothing in this file touches the hardware, so it builds unchanged for the
+ * RP2040 and for the host.
+ */
+
+#include "dac_stream.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize a stream with its code producer.
+ *
+ * @param s Stream to initialize.
+ * @param fill Callback that produces DAC codes.
+ * @param ctx Context passed to @p fill.
+ */
+void dac_stream_init(dac_stream_t *s, dac_stream_fill_t fill, void *ctx) {
+    memset(s, 0, sizeof(*s));
+    s->fill = fill;
+    s->ctx = ctx;
+    s->hold = 1;
+    s->div_int = 1;
+}
+
+/**
+ * @brief Work out the PIO divider for a sample rate, without touching a stream.
+ *
+ * The state machine outputs one word per PIO cycle, so the rate is
+ * sys_hz / divider. Rates below what the 16.8 divider can reach are obtained
+ * by repeating each code @c hold times.
+ *
+ * @param sys_hz System clock feeding the PIO.
+ * @param rate_hz Requested sample rate.
+ * @param div256 Divider in 16.8 format.
+ * @param hold Repeats of each code.
+ * @return Achieved sample rate in Hz (rounded).
+ */
+uint32_t dac_stream_divider(uint32_t sys_hz, uint32_t rate_hz, uint32_t *div256, uint32_t *hold) {
+    if (rate_hz == 0) {
+        rate_hz = 1;
+    }
+    if (rate_hz > sys_hz) {
+        rate_hz = sys_hz;
+    }
+
+    uint64_t sys256 = (uint64_t)sys_hz << 8;
+    uint64_t per_hold = (uint64_t)rate_hz * DAC_STREAM_DIV_MAX;
+    uint32_t n = (uint32_t)((sys256 + per_hold - 1) / per_hold);
+    if (n == 0) {
+        n = 1;
+    }
+
+    uint64_t step = (uint64_t)rate_hz * n;
+    uint64_t div = (sys256 + step / 2) / step;
+    if (div < DAC_STREAM_DIV_MIN) {
+        div = DAC_STREAM_DIV_MIN;
+    } else if (div > DAC_STREAM_DIV_MAX) {
+        div = DAC_STREAM_DIV_MAX;
+    }
+    *div256 = (uint32_t)div;
+    *hold = n;
+
+    uint64_t cycles = div * n;
+    return (uint32_t)((sys256 + cycles / 2) / cycles);
+}
+
+/**
+ * @brief Load a divider and a hold count worked out elsewhere (a clock plan).
+ *
+ * @param s Stream to configure.
+ * @param sys_hz System clock feeding the PIO.
+ * @param div256 Divider in 16.8 format (DAC_STREAM_DIV_MIN to DAC_STREAM_DIV_MAX).
+ * @param hold Repeats of each code (at least 1).
+ * @return Achieved sample rate in Hz (rounded).
+ */
+uint32_t dac_stream_set_divider(dac_stream_t *s, uint32_t sys_hz, uint32_t div256, uint32_t hold) {
+    if (hold != s->hold) {
+        s->hold_left = 0;
+    }
+    uint64_t sys256 = (uint64_t)sys_hz << 8;
+    uint64_t cycles = (uint64_t)div256 * hold;
+    s->sys_hz = sys_hz;
+    s->rate_hz = (uint32_t)((sys256 + cycles / 2) / cycles);
+    s->hold = hold;
+    s->div_int = (uint16_t)(div256 >> 8);
+    s->div_frac = (uint8_t)(div256 & 0xFF);
+    return s->rate_hz;
+}
+
+/**
+ * @brief Work out the PIO divider for a sample rate and load it.
+ *
+ * @param s Stream to configure.
+ * @param sys_hz System clock feeding the PIO.
+ * @param rate_hz Requested sample rate.
+ * @return Achieved sample rate in Hz.
+ */
+uint32_t dac_stream_set_rate(dac_stream_t *s, uint32_t sys_hz, uint32_t rate_hz) {
+    uint32_t div256, hold;
+    dac_stream_divider(sys_hz, rate_hz, &div256, &hold);
+    return dac_stream_set_divider(s, sys_hz, div256, hold);
+}
+
+/**
+ * @brief Fill one DMA block with encoded bus words.
+ */
+static void dac_stream_render(dac_stream_t *s, uint16_t *dst) {
+    if (s->hold == 1) {
+        s->fill(s->codes, DAC_STREAM_BLOCK_LEN, s->ctx);
+        for (uint32_t i = 0; i < DAC_STREAM_BLOCK_LEN; i++) {
+            dst[i] = dac_bus_encode(s->codes[i]);
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < DAC_STREAM_BLOCK_LEN; i++) {
+        if (s->hold_left == 0) {
+            uint8_t code;
+            s->fill(&code, 1, s->ctx);
+            s->held_word = dac_bus_encode(code);
+            s->hold_left = s->hold;
+        }
+        dst[i] = s->held_word;
+        s->hold_left--;
+    }
+}
+
+/**
+ * @brief Fill both blocks before the DMA is started.
+ */
+void dac_stream_prime(dac_stream_t *s) {
+    dac_stream_render(s, s->block[0]);
+    dac_stream_render(s, s->block[1]);
+    s->pending[0] = 0;
+    s->pending[1] = 0;
+}
+
+/**
+ * @brief Hand a played block back to the CPU.
+ *
+ * Called by the backend (DMA interrupt) when block @p idx has been sent to
+ * the PIO and the DMA has moved on to the other one.
+ *
+ * @param s Stream.
+ * @param idx Block that finished playing.
+ */
+void dac_stream_block_done(dac_stream_t *s, uint32_t idx) {
+    s->blocks_played++;
+    if (s->pending[idx ^ 1]) {
+        s->underruns++; ///< El DMA esta reproduciendo un bloque sin rellenar
+    }
+    s->pending[idx] = 1;
+}
+
+/**
+ * @brief Refill every block the DMA has handed back.
+ *
+ * @param s Stream.
+ * @return true if at least one block was refilled.
+ */
+bool dac_stream_service(dac_stream_t *s) {
+    bool refilled = false;
+    for (uint32_t i = 0; i < 2; i++) {
+        if (s->pending[i]) {
+            dac_stream_render(s, s->block[i]);
+            s->pending[i] = 0;
+            refilled = true;
+        }
+    }
+    return refilled;
+}
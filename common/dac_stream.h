@@ -0,0 +1,85 @@
+/**
+ * @file dac_stream.h
+ * @brief PIO + DMA streaming output for the DAC0808 bus.
+ *
+ * One PIO state machine writes the eight DAC lines in a single cycle from a
+ * ring of two DMA blocks. The CPU only refills the block that has just been
+ * played. The pacing (fractional clock divider) and the block hand-off live
+ * here and are portable; the hardware side is provided by a backend
+ * (dac_stream_rp2040.c on the board, host/dac_stream_host.c on Linux).
+ */
+
+// Avoid duplication in code
+#ifndef _DAC_STREAM_H_
+#define _DAC_STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DAC_BUS_PIN_BASE 16           ///< Primer GPIO del bus (D0)
+#define DAC_BUS_PIN_MASK 0x047F0000u  ///< D0-D6 en GPIO 16-22, D7 en GPIO 26
+
+#define DAC_STREAM_BLOCK_LEN 256      ///< Muestras por bloque DMA (dos bloques en el anillo)
+#define DAC_STREAM_DIV_MIN 0x000100u  ///< Divisor 1.0 en formato 16.8
+#define DAC_STREAM_DIV_MAX 0xFFFFFFu  ///< Divisor 65535 + 255/256 en formato 16.8
+
+/**
+ * @brief Callback that produces the next DAC codes.
+ *
+ * @param codes Destination for @p count 8-bit DAC codes.
+ * @param count Number of codes requested.
+ * @param ctx User context given to dac_stream_init().
+ */
+typedef void (*dac_stream_fill_t)(uint8_t *codes, uint32_t count, void *ctx);
+
+/**
+ * @brief Streaming engine state.
+ *
+ * Each bus word holds one sample already laid out for the PIO: bits 0-6 go to
+ * GPIO 16-22 and bit 7 is moved to bit 10 (GPIO 26).
+ */
+typedef struct {
+    uint16_t block[2][DAC_STREAM_BLOCK_LEN] __attribute__((aligned(4))); ///< Anillo de dos bloques leido por el DMA
+    uint8_t codes[DAC_STREAM_BLOCK_LEN];  ///< Codigos temporales entregados por el callback
+    dac_stream_fill_t fill;               ///< Productor de codigos
+    void *ctx;                            ///< Contexto del productor
+    uint32_t sys_hz;                      ///< Reloj del sistema usado para el divisor
+    uint32_t rate_hz;                     ///< Tasa de muestreo lograda (redondeada)
+    uint32_t hold;                        ///< Veces que se repite cada codigo (tasas bajas)
+    uint32_t hold_left;                   ///< Repeticiones restantes del codigo actual
+    uint16_t held_word;                   ///< Palabra del bus que se esta repitiendo
+    uint16_t div_int;                     ///< Parte entera del divisor del PIO
+    uint8_t div_frac;                     ///< Parte fraccionaria (1/256) del divisor del PIO
+    volatile uint8_t pending[2];          ///< Bloques ya reproducidos que esperan relleno
+    volatile uint32_t blocks_played;      ///< Bloques entregados por el DMA
+    volatile uint32_t underruns;          ///< Bloques reproducidos sin haber sido rellenados
+} dac_stream_t;
+
+/**
+ * @brief Map an 8-bit DAC code onto the PIO output word.
+ */
+static inline uint16_t dac_bus_encode(uint8_t code) {
+    return (uint16_t)((code & 0x7Fu) | ((code & 0x80u) << 3));
+}
+
+/**
+ * @brief Recover the 8-bit DAC code from a PIO output word.
+ */
+static inline uint8_t dac_bus_decode(uint16_t word) {
+    return (uint8_t)((word & 0x7Fu) | ((word >> 3) & 0x80u));
+}
+
+void dac_stream_init(dac_stream_t *s, dac_stream_fill_t fill, void *ctx);
+uint32_t dac_stream_divider(uint32_t sys_hz, uint32_t rate_hz, uint32_t *div256, uint32_t *hold);
+uint32_t dac_stream_set_divider(dac_stream_t *s, uint32_t sys_hz, uint32_t div256, uint32_t hold);
+uint32_t dac_stream_set_rate(dac_stream_t *s, uint32_t sys_hz, uint32_t rate_hz);
+void dac_stream_prime(dac_stream_t *s);
+void dac_stream_block_done(dac_stream_t *s, uint32_t idx);
+bool dac_stream_service(dac_stream_t *s);
+
+// Backend, implemented once per platform
+bool dac_stream_hw_start(dac_stream_t *s);
+void dac_stream_hw_apply_rate(dac_stream_t *s);
+void dac_stream_hw_stop(dac_stream_t *s);
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file dac_stream_rp2040.c
+ * @brief PIO + DMA backend of the DAC stream for the RP2040.
+ *
+ * Two DMA channels are chained in a ring, one per block. When a channel
+ * finishes, its interrupt rewinds the read address and hands the block back
+ * to dac_stream_service() for refilling while the other channel plays.
+ */
+
+#include "dac_stream.h"
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "dac_bus.pio.h"
+
+static PIO dac_pio; ///< PIO usado para el bus
+static uint dac_sm; ///< Maquina de estados del bus
+static uint dac_offset; ///< Posicion del programa en la memoria del PIO
+static int dac_dma[2] = {-1, -1}; ///< Canal DMA de cada bloque
+static dac_stream_t *dac_active; ///< Stream en reproduccion
+
+/**
+ * @brief DMA completion handler.
+ */
+static void dac_stream_dma_handler(void) {
+    for (uint32_t i = 0; i < 2; i++) {
+        uint32_t bit = 1u << dac_dma[i];
+        if (dma_hw->ints0 & bit) {
+            dma_hw->ints0 = bit; ///< Reconocer la interrupcion
+            dma_channel_set_read_addr(dac_dma[i], dac_active->block[i], false);
+            dac_stream_block_done(dac_active, i);
+        }
+    }
+}
+
+/**
+ * @brief Start streaming a primed stream.
+ *
+ * @param s Stream, already primed with dac_stream_prime().
+ * @return false if no state machine or DMA channel is free.
+ */
+bool dac_stream_hw_start(dac_stream_t *s) {
+    dac_pio = pio0;
+    int sm = pio_claim_unused_sm(dac_pio, false);
+    if (sm < 0) {
+        return false;
+    }
+    dac_sm = (uint)sm;
+    dac_offset = pio_add_program(dac_pio, &dac_bus_program);
+    dac_bus_program_init(dac_pio, dac_sm, dac_offset, DAC_BUS_PIN_BASE, DAC_BUS_PIN_MASK, s->div_int, s->div_frac);
+
+    dac_active = s;
+    for (uint32_t i = 0; i < 2; i++) {
+        dac_dma[i] = dma_claim_unused_channel(true);
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        dma_channel_config c = dma_channel_get_default_config(dac_dma[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, pio_get_dreq(dac_pio, dac_sm, true));
+        channel_config_set_chain_to(&c, dac_dma[i ^ 1]);
+        dma_channel_configure(dac_dma[i], &c, &dac_pio->txf[dac_sm], s->block[i], DAC_STREAM_BLOCK_LEN / 2, false);
+        dma_channel_set_irq0_enabled(dac_dma[i], true);
+    }
+
+    irq_set_exclusive_handler(DMA_IRQ_0, dac_stream_dma_handler);
+    irq_set_enabled(DMA_IRQ_0, true);
+    pio_sm_set_enabled(dac_pio, dac_sm, true);
+    dma_channel_start(dac_dma[0]);
+    return true;
+}
+
+/**
+ * @brief Load the divider set by dac_stream_set_rate() or dac_stream_set_divider() into the PIO.
+ *
+ * Does nothing before dac_stream_hw_start(), which loads it itself.
+ */
+void dac_stream_hw_apply_rate(dac_stream_t *s) {
+    if (dac_active != s) {
+        return;
+    }
+    pio_sm_set_clkdiv_int_frac(dac_pio, dac_sm, s->div_int, s->div_frac);
+}
+
+/**
+ * @brief Stop the DMA ring and release the state machine.
+ */
+void dac_stream_hw_stop(dac_stream_t *s) {
+    (void)s;
+    irq_set_enabled(DMA_IRQ_0, false);
+    for (uint32_t i = 0; i < 2; i++) {
+        dma_channel_set_irq0_enabled(dac_dma[i], false);
+        dma_channel_abort(dac_dma[i]);
+        dma_channel_unclaim(dac_dma[i]);
+        dac_dma[i] = -1;
+    }
+    pio_sm_set_enabled(dac_pio, dac_sm, false);
+    pio_remove_program(dac_pio, &dac_bus_program, dac_offset);
+    pio_sm_unclaim(dac_pio, dac_sm);
+    dac_active = NULL;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file dds.c
+ * @brief Direct digital synthesis: set-up and frequency conversion.
+ *
+ * The divisions here only run when the frequency changes, never per sample.
+ */
+
+#include "dds.h"
+
+/**
+ * @brief Initialize the DDS for a table of @p length points.
+ *
+ * @param d DDS state.
+ * @param length Points per period in the table.
+ * @param interpolate Interpolate linearly between table points.
+ */
+void dds_init(dds_t *d, uint32_t length, bool interpolate) {
+    d->phase = 0;
+    d->tuning = 0;
+    d->length = length;
+    d->interpolate = interpolate;
+    d->shift = 0;
+    if (length >= 2 && (length & (length - 1)) == 0) {
+        uint8_t bits = 0;
+        while ((1u << bits) < length) {
+            bits++;
+        }
+        d->shift = (uint8_t)(32 - bits);
+    }
+}
+
+/**
+ * @brief Tuning word for a frequency.
+ *
+ * @param freq_mhz Output frequency in millihertz.
+ * @param sample_rate_hz Sample clock in Hz.
+ * @return Phase increment per sample, limited to just below Nyquist.
+ */
+uint32_t dds_tuning_word(uint32_t freq_mhz, uint32_t sample_rate_hz) {
+    if (sample_rate_hz == 0) {
+        return 0;
+    }
+    uint64_t rate_mhz = (uint64_t)sample_rate_hz * 1000u;
+    if ((uint64_t)freq_mhz * 2u >= rate_mhz) {
+        return 0x7FFFFFFFu;
+    }
+    return (uint32_t)((((uint64_t)freq_mhz << 32) + rate_mhz / 2) / rate_mhz);
+}
+
+/**
+ * @brief Frequency actually produced by a tuning word.
+ *
+ * @param tuning Phase increment per sample.
+ * @param sample_rate_hz Sample clock in Hz.
+ * @return Output frequency in millihertz.
+ */
+uint32_t dds_frequency_mhz(uint32_t tuning, uint32_t sample_rate_hz) {
+    uint64_t hz_q32 = (uint64_t)tuning * sample_rate_hz;
+    uint64_t frac_mhz = ((hz_q32 & 0xFFFFFFFFu) * 1000u + (1ull << 31)) >> 32;
+    return (uint32_t)((hz_q32 >> 32) * 1000u + frac_mhz);
+}
+
+/**
+ * @brief Retune the DDS without touching its phase.
+ *
+ * @param d DDS state.
+ * @param freq_mhz Output frequency in millihertz.
+ * @param sample_rate_hz Sample clock in Hz.
+ */
+void dds_set_frequency(dds_t *d, uint32_t freq_mhz, uint32_t sample_rate_hz) {
+    d->tuning = dds_tuning_word(freq_mhz, sample_rate_hz);
+}
+
+/**
+ * @brief Parse a keypad frequency entry.
+ *
+ * Digits give whole hertz and '*' acts as the decimal point, so "12*5" is
+ * 12.5 Hz. Parsing stops at the first other character.
+ *
+ * @param text Text to parse.
+ * @return Frequency in millihertz, or UINT32_MAX if it does not fit (so
+ *         any range check rejects it).
+ */
+uint32_t dds_parse_mhz(const char *text) {
+    uint32_t mhz = 0;
+    uint32_t scale = 0; ///< Peso de la siguiente cifra decimal (0 = parte entera)
+
+    for (; *text; text++) {
+        if (*text >= '0' && *text <= '9') {
+            uint32_t digit = (uint32_t)(*text - '0');
+            if (scale == 0) {
+                if (mhz > (UINT32_MAX - digit * 1000u) / 10u) {
+                    return UINT32_MAX;
+                }
+                mhz = mhz * 10u + digit * 1000u;
+            } else {
+                if (mhz > UINT32_MAX - digit * scale) {
+                    return UINT32_MAX;
+                }
+                mhz += digit * scale;
+                scale /= 10u;
+                if (scale == 0) {
+                    break;
+                }
+            }
+        } else if (*text == '*' && scale == 0) {
+            scale = 100;
+        } else {
+            break;
+        }
+    }
+    return mhz;
+}
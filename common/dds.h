@@ -0,0 +1,69 @@
+/**
+ * @file dds.h
+ * @brief Direct digital synthesis over a one-period waveform table.
+ *
+ * A 32-bit phase accumulator advances by a tuning word on every tick of a
+ * fixed sample clock, so the output frequency is tuning * fs / 2^32 with a
+ * resolution of fs / 2^32 (a few microhertz at audio rates). The per-sample
+ * cost does not depend on the frequency and uses no division or modulo.
+ */
+
+// Avoid duplication in code
+#ifndef _DDS_H_
+#define _DDS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief DDS state.
+ */
+typedef struct {
+    uint32_t phase;     ///< Acumulador de fase (un periodo = 2^32)
+    uint32_t tuning;    ///< Incremento de fase por muestra
+    uint32_t length;    ///< Puntos de la tabla
+    uint8_t shift;      ///< 32 - log2(length) si length es potencia de 2, 0 si no
+    bool interpolate;   ///< Interpolacion lineal entre puntos de la tabla
+} dds_t;
+
+void dds_init(dds_t *d, uint32_t length, bool interpolate);
+uint32_t dds_tuning_word(uint32_t freq_mhz, uint32_t sample_rate_hz);
+uint32_t dds_frequency_mhz(uint32_t tuning, uint32_t sample_rate_hz);
+void dds_set_frequency(dds_t *d, uint32_t freq_mhz, uint32_t sample_rate_hz);
+uint32_t dds_parse_mhz(const char *text);
+
+/**
+ * @brief Produce the next sample and advance the phase.
+ *
+ * @param d DDS state.
+ * @param table One period of @c d->length points.
+ * @return Table value at the current phase.
+ */
+static inline uint8_t dds_next(dds_t *d, const uint8_t *table) {
+    uint32_t phase = d->phase;
+    uint32_t idx;
+    uint32_t frac;
+
+    d->phase = phase + d->tuning;
+    if (d->shift) {
+        idx = phase >> d->shift;
+        frac = (phase << (32 - d->shift)) >> 24;
+    } else {
+        uint64_t pos = (uint64_t)phase * d->length;
+        idx = (uint32_t)(pos >> 32);
+        frac = (uint32_t)pos >> 24;
+    }
+
+    uint8_t a = table[idx];
+    if (!d->interpolate) {
+        return a;
+    }
+    uint32_t next = idx + 1;
+    if (next == d->length) {
+        next = 0;
+    }
+    int32_t delta = (int32_t)table[next] - (int32_t)a;
+    return (uint8_t)(a + ((delta * (int32_t)frac) >> 8));
+}
+
+#endif
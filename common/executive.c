@@ -0,0 +1,169 @@
+/**
+ * @file executive.c
+ * @brief Task selection, timing and report of the cooperative executive.
+ */
+
+#include "executive.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Initialize an empty executive.
+ */
+void exec_init(exec_t *e) {
+    memset(e, 0, sizeof(*e));
+}
+
+/**
+ * @brief Add a task below the ones already added.
+ *
+ * @param e Executive.
+ * @param t Task storage, owned by the caller.
+ * @param name Name in the report.
+ * @param step Task step.
+ * @param ctx Context for @p step.
+ * @param period_us Period; 0 for a background task that runs when nothing else is ready.
+ * @param deadline_us Hard deadline after each release; 0 for none.
+ * @param first_release Absolute time of the first release.
+ * @return false if the executive is full.
+ */
+bool exec_add(exec_t *e, exec_task_t *t, const char *name, exec_step_t step, void *ctx,
+              uint32_t period_us, uint32_t deadline_us, uint32_t first_release) {
+    if (e->count >= EXEC_MAX_TASKS) {
+        return false;
+    }
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->step = step;
+    t->ctx = ctx;
+    t->period = period_us;
+    t->deadline = deadline_us;
+    t->release = first_release;
+    e->tasks[e->count++] = t;
+    return true;
+}
+
+/**
+ * @brief Declare the worst-case duration of one step of a task.
+ *
+ * Raises the budget used to hold the task back from a hard deadline; a
+ * longer step measured later raises it further. Not cleared by
+ * exec_reset_stats().
+ */
+void exec_set_budget(exec_task_t *t, uint32_t budget_us) {
+    if (budget_us > t->budget) {
+        t->budget = budget_us;
+    }
+}
+
+/**
+ * @brief Whether a task is ready to run a step.
+ */
+static bool exec_ready(const exec_task_t *t, uint32_t now) {
+    return t->period == 0 || t->more || (int32_t)(now - t->release) >= 0;
+}
+
+/**
+ * @brief Whether running @p t now could push a hard deadline of a higher task.
+ */
+static bool exec_would_block(const exec_t *e, uint32_t index, uint32_t now) {
+    uint32_t run = e->tasks[index]->budget;
+    for (uint32_t i = 0; i < index; i++) {
+        const exec_task_t *h = e->tasks[i];
+        if (h->deadline == 0 || h->period == 0 || run >= h->period) {
+            continue; ///< sin plazo, o el paso no cabe nunca: no retener
+        }
+        int32_t until = (int32_t)(h->release - now);
+        if (until >= 0 && (uint32_t)until < run) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Run at most one step of the highest-priority ready task.
+ *
+ * @return true if a step ran.
+ */
+bool exec_poll(exec_t *e) {
+    uint32_t now = exec_hw_now();
+    for (uint32_t i = 0; i < e->count; i++) {
+        exec_task_t *t = e->tasks[i];
+        if (!exec_ready(t, now)) {
+            continue;
+        }
+        if (exec_would_block(e, i, now)) {
+            e->held++;
+            return false; ///< esperar a la tarea de plazo estricto
+        }
+
+        bool released = t->period && !t->more;
+        if (released) {
+            uint32_t late = now - t->release;
+            if (late > t->worst_late) {
+                t->worst_late = late;
+            }
+            if (t->deadline && late > t->deadline) {
+                t->missed++;
+            }
+        }
+        t->more = t->step(t->ctx);
+        uint32_t end = exec_hw_now();
+        if (end - now > t->worst_run) {
+            t->worst_run = end - now;
+        }
+        exec_set_budget(t, end - now);
+        t->runs++;
+
+        if (released) {
+            t->release += t->period;
+            if ((int32_t)(end - t->release) >= (int32_t)t->period) {
+                uint32_t skipped = (end - t->release) / t->period; ///< periodos que ya terminaron
+                t->release += skipped * t->period;
+                t->missed += skipped;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Clear the measurements of every task (the budgets are kept).
+ */
+void exec_reset_stats(exec_t *e) {
+    e->held = 0;
+    for (uint32_t i = 0; i < e->count; i++) {
+        exec_task_t *t = e->tasks[i];
+        t->runs = 0;
+        t->missed = 0;
+        t->worst_late = 0;
+        t->worst_run = 0;
+    }
+}
+
+/**
+ * @brief Format one line of the report.
+ *
+ * Index 0 is the header "task,period_us,deadline_us,runs,missed,worst_late_us,worst_run_us";
+ * index i is task i - 1. Printing one line per step keeps the report
+ * itself a bounded task.
+ *
+ * @return Length written, 0 past the last task.
+ */
+uint32_t exec_report_line(const exec_t *e, uint32_t index, char *buf, uint32_t len) {
+    int n;
+    if (index == 0) {
+        n = snprintf(buf, len, "task,period_us,deadline_us,runs,missed,worst_late_us,worst_run_us\n");
+    } else if (index <= e->count) {
+        const exec_task_t *t = e->tasks[index - 1];
+        n = snprintf(buf, len, "%s,%lu,%lu,%lu,%lu,%lu,%lu\n", t->name, (unsigned long)t->period,
+                     (unsigned long)t->deadline, (unsigned long)t->runs, (unsigned long)t->missed,
+                     (unsigned long)t->worst_late, (unsigned long)t->worst_run);
+    } else {
+        return 0;
+    }
+    return n < 0 ? 0 : (uint32_t)n;
+}
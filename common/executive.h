@@ -0,0 +1,81 @@
+/**
+ * @file executive.h
+ * @brief Cooperative, deadline-aware task executive for the polling build.
+ *
+ * Tasks are polled in priority order (the order they were added) and each
+ * call runs at most one bounded step of one task. Periodic tasks are
+ * released on absolute times (release += period), so loop jitter never
+ * turns into drift. A lower-priority step is held back when a task with a
+ * hard deadline is due before that step's budget would end, so the sample
+ * task is only delayed by steps that fit in the gap. The budget is the
+ * larger of a declared worst case (exec_set_budget()) and the longest step
+ * measured so far, so even the first step of a long task is held back.
+ * Every task's worst lateness and worst runtime are measured for the
+ * report.
+ *
+ * The clock comes from a backend (executive_rp2040.c on the board,
+ * host/executive_host.c on Linux).
+ */
+
+// Avoid duplication in code
+#ifndef _EXECUTIVE_H_
+#define _EXECUTIVE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EXEC_MAX_TASKS 8 ///< Tareas por ejecutivo
+
+/**
+ * @brief Task step.
+ *
+ * @param ctx User context given to exec_add().
+ * @return true if the task has more steps to run right away (a sliced job
+ *         in progress), false when it is done until its next release.
+ */
+typedef bool (*exec_step_t)(void *ctx);
+
+/**
+ * @brief Output callback for the report (one line, with its newline).
+ */
+typedef void (*exec_write_t)(const char *line, void *ctx);
+
+/**
+ * @brief Task.
+ */
+typedef struct {
+    const char *name;      ///< Nombre en el informe
+    exec_step_t step;      ///< Paso de la tarea
+    void *ctx;             ///< Contexto del paso
+    uint32_t period;       ///< Periodo (us); 0 = en segundo plano, siempre lista
+    uint32_t deadline;     ///< Plazo tras la liberacion (us); 0 = sin plazo estricto
+    uint32_t release;      ///< Instante absoluto de la proxima liberacion
+    bool more;             ///< Tiene pasos pendientes de un trabajo troceado
+    uint32_t runs;         ///< Pasos ejecutados
+    uint32_t missed;       ///< Plazos incumplidos y periodos saltados
+    uint32_t worst_late;   ///< Peor retraso respecto a la liberacion (us)
+    uint32_t worst_run;    ///< Peor duracion de un paso (us)
+    uint32_t budget;       ///< Duracion supuesta de un paso para la retencion (us)
+} exec_task_t;
+
+/**
+ * @brief Executive.
+ */
+typedef struct {
+    exec_task_t *tasks[EXEC_MAX_TASKS]; ///< Tareas por prioridad (0 = la mas alta)
+    uint32_t count;                     ///< Tareas registradas
+    uint32_t held;                      ///< Pasos retenidos para no invadir un plazo estricto
+} exec_t;
+
+void exec_init(exec_t *e);
+bool exec_add(exec_t *e, exec_task_t *t, const char *name, exec_step_t step, void *ctx,
+              uint32_t period_us, uint32_t deadline_us, uint32_t first_release);
+void exec_set_budget(exec_task_t *t, uint32_t budget_us);
+bool exec_poll(exec_t *e);
+void exec_reset_stats(exec_t *e);
+uint32_t exec_report_line(const exec_t *e, uint32_t index, char *buf, uint32_t len);
+
+// Backend
+uint32_t exec_hw_now(void);
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * @file executive_rp2040.c
+ * @brief RP2040 clock of the cooperative executive.
+ */
+
+#include "executive.h"
+
+#include "pico/stdlib.h"
+
+/**
+ * @brief Current time in microseconds (wraps every 71 minutes).
+ */
+uint32_t exec_hw_now(void) {
+    return time_us_32();
+}
@@ -0,0 +1,198 @@
+/**
+ * @file gen_block.c
+ * @brief Block kernels and the cache-aware block fill.
+ *
+ * The kernels only read the scaled period, so they never interpolate (the
+ * cached codes already carry the 8-bit wrap of the legacy scaling). The
+ * power-of-two path is an index shift and is the one the vector kernels
+ * handle; other lengths go through the 64-bit multiply of gen_kernel_ref().
+ */
+
+#include "gen_block.h"
+
+#if GEN_BLOCK_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Reference kernel: one sample per iteration, as dds_next().
+ */
+void gen_kernel_ref(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n) {
+    uint32_t phase = d->phase;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t idx;
+        if (d->shift) {
+            idx = phase >> d->shift;
+        } else {
+            idx = (uint32_t)(((uint64_t)phase * d->length) >> 32);
+        }
+        out[i] = codes[idx];
+        phase += d->tuning;
+    }
+    d->phase = phase;
+}
+
+/**
+ * @brief Unrolled scalar kernel (the one used on the RP2040).
+ *
+ * Four samples per iteration with the phase, tuning and shift kept in
+ * registers; the M0+ has no multiply-high, so non power-of-two lengths fall
+ * back to the reference kernel.
+ */
+void gen_kernel_scalar(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n) {
+    if (!d->shift) {
+        gen_kernel_ref(codes, d, out, n);
+        return;
+    }
+    uint32_t phase = d->phase;
+    uint32_t tuning = d->tuning;
+    uint32_t shift = d->shift;
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        out[i] = codes[phase >> shift];
+        phase += tuning;
+        out[i + 1] = codes[phase >> shift];
+        phase += tuning;
+        out[i + 2] = codes[phase >> shift];
+        phase += tuning;
+        out[i + 3] = codes[phase >> shift];
+        phase += tuning;
+    }
+    for (; i < n; i++) {
+        out[i] = codes[phase >> shift];
+        phase += tuning;
+    }
+    d->phase = phase;
+}
+
+#if GEN_BLOCK_X86
+/**
+ * @brief SSE2 kernel: phases and indices eight at a time, byte loads.
+ *
+ * SSE2 has no gather, so only the phase arithmetic is vectorized.
+ */
+void gen_kernel_sse2(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n) {
+    if (!d->shift) {
+        gen_kernel_ref(codes, d, out, n);
+        return;
+    }
+    uint32_t t = d->tuning;
+    __m128i lo = _mm_setr_epi32((int)d->phase, (int)(d->phase + t), (int)(d->phase + 2 * t), (int)(d->phase + 3 * t));
+    __m128i hi = _mm_add_epi32(lo, _mm_set1_epi32((int)(4 * t)));
+    __m128i step = _mm_set1_epi32((int)(8 * t));
+    __m128i count = _mm_cvtsi32_si128(d->shift);
+    uint32_t idx[8] __attribute__((aligned(16)));
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm_store_si128((__m128i *)idx, _mm_srl_epi32(lo, count));
+        _mm_store_si128((__m128i *)(idx + 4), _mm_srl_epi32(hi, count));
+        for (uint32_t k = 0; k < 8; k++) {
+            out[i + k] = codes[idx[k]];
+        }
+        lo = _mm_add_epi32(lo, step);
+        hi = _mm_add_epi32(hi, step);
+    }
+    d->phase += i * t;
+    gen_kernel_scalar(codes, d, out + i, n - i);
+}
+
+/**
+ * @brief AVX2 kernel: eight 32-bit gathers per iteration, packed to bytes.
+ *
+ * Each gather reads the code and the three bytes after it, which is why the
+ * cache buffers carry WAVE_CACHE_PAD spare bytes.
+ */
+__attribute__((target("avx2")))
+void gen_kernel_avx2(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n) {
+    if (!d->shift) {
+        gen_kernel_ref(codes, d, out, n);
+        return;
+    }
+    uint32_t t = d->tuning;
+    __m256i phase = _mm256_add_epi32(_mm256_set1_epi32((int)d->phase),
+                                     _mm256_mullo_epi32(_mm256_set1_epi32((int)t), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    __m256i step = _mm256_set1_epi32((int)(8 * t));
+    __m128i count = _mm_cvtsi32_si128(d->shift);
+    __m256i low_bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                         0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i lanes = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i idx = _mm256_srl_epi32(phase, count);
+        __m256i words = _mm256_i32gather_epi32((const int *)codes, idx, 1);
+        __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(words, low_bytes), lanes);
+        _mm_storel_epi64((__m128i *)(out + i), _mm256_castsi256_si128(packed));
+        phase = _mm256_add_epi32(phase, step);
+    }
+    d->phase += i * t;
+    gen_kernel_scalar(codes, d, out + i, n - i);
+}
+
+/**
+ * @brief Whether the running CPU can execute gen_kernel_avx2().
+ */
+bool gen_kernel_avx2_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/**
+ * @brief Fastest kernel for the running CPU.
+ */
+gen_kernel_t gen_kernel_best(void) {
+#if GEN_BLOCK_X86
+    static gen_kernel_t best;
+    if (!best) {
+        best = gen_kernel_avx2_supported() ? gen_kernel_avx2 : gen_kernel_sse2;
+    }
+    return best;
+#else
+    return gen_kernel_scalar;
+#endif
+}
+
+/**
+ * @brief Fill a buffer with the next @p n DAC codes.
+ *
+ * Produces the same samples as @p n calls to gen_next(), including a
+ * pending cache change being applied right after the sample on which the
+ * phase crosses its phase, or on which it has waited its bound. A change
+ * published while the block is being filled is picked up in a later block.
+ *
+ * @param g Generator state.
+ * @param out Destination for @p n codes.
+ * @param n Number of samples.
+ */
+void gen_block_fill(gen_state_t *g, uint8_t *out, uint32_t n) {
+    gen_kernel_t kernel = gen_kernel_best();
+    wave_cache_t *c = g->cache;
+    dds_t *d = &g->dds;
+
+    while (n) {
+        uint32_t run = n;
+        bool swap = false;
+        if (c->pending) {
+            /* Samples up to and including the one whose phase step crosses c->at */
+            uint64_t to_cross = 1;
+            if (d->tuning) {
+                uint64_t dist = (uint32_t)(c->at - d->phase);
+                to_cross = ((dist ? dist : 1ull << 32) + d->tuning - 1) / d->tuning;
+            }
+            if (c->wait && c->wait - c->age < to_cross) {
+                to_cross = c->wait - c->age;
+            }
+            if (to_cross <= n) {
+                run = (uint32_t)to_cross;
+                swap = true;
+            }
+            c->age += run;
+        }
+        kernel(c->buf[c->active], d, out, run);
+        if (swap) {
+            wave_cache_apply(c, d);
+        }
+        out += run;
+        n -= run;
+    }
+}
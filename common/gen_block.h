@@ -0,0 +1,64 @@
+/**
+ * @file gen_block.h
+ * @brief Block generator: N samples per call from an explicit state.
+ *
+ * The state (DDS phase/tuning and the scaled period being played) lives in
+ * a gen_state_t owned by the caller, so the same code fills DMA blocks,
+ * file buffers or single samples. All kernels are bit-exact with
+ * gen_kernel_ref(); none of them interpolates.
+ */
+
+// Avoid duplication in code
+#ifndef _GEN_BLOCK_H_
+#define _GEN_BLOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dds.h"
+#include "wave_cache.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEN_BLOCK_X86 1 ///< Kernels SSE2/AVX2 disponibles
+#else
+#define GEN_BLOCK_X86 0
+#endif
+
+/**
+ * @brief Generator state.
+ */
+typedef struct {
+    dds_t dds;           ///< Fase, palabra de sintonia y longitud del periodo
+    wave_cache_t *cache; ///< Periodo escalado que se reproduce
+} gen_state_t;
+
+/**
+ * @brief Block kernel.
+ *
+ * @param codes Scaled period of @c d->length points, followed by
+ *              WAVE_CACHE_PAD readable bytes.
+ * @param d DDS state; its phase is advanced by @p n samples.
+ * @param out Destination for @p n DAC codes.
+ * @param n Number of samples.
+ */
+typedef void (*gen_kernel_t)(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n);
+
+void gen_kernel_ref(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n);
+void gen_kernel_scalar(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n);
+#if GEN_BLOCK_X86
+void gen_kernel_sse2(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n);
+void gen_kernel_avx2(const uint8_t *codes, dds_t *d, uint8_t *out, uint32_t n);
+bool gen_kernel_avx2_supported(void);
+#endif
+gen_kernel_t gen_kernel_best(void);
+
+void gen_block_fill(gen_state_t *g, uint8_t *out, uint32_t n);
+
+/**
+ * @brief Single-sample path, same output as gen_block_fill().
+ */
+static inline uint8_t gen_next(gen_state_t *g) {
+    return wave_cache_next(g->cache, &g->dds);
+}
+
+#endif
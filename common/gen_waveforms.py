@@ -0,0 +1,209 @@
+"""
+ * @file gen_waveforms.py
+ * @brief Genera en tiempo de compilacion las tablas de forma de onda.
+
+Writes waveform_tables.h / waveform_tables.c with one period of the sine,
+triangle, sawtooth and square waves for the requested length and bit depth.
+The tables are emitted as const arrays, so on the RP2040 they stay in flash.
+
+The sine and triangle are built from their first quarter and unfolded with
+the same rules as waveform_compact_at(), so both halves are exact mirrors of
+each other; the sawtooth and square are computed with integer arithmetic.
+The quarters are always emitted; with --compact the full-period tables are
+left out and the firmware unfolds the quarters at run time.
+
+With --bandlimited the triangle, sawtooth and square also get one
+band-limited table per octave (WAVEFORM_BANDS of them), summed from their
+Fourier series: table b keeps the harmonics up to (length / 2) >> b, so it
+can be played up to a fundamental of fs / 2 / ((length / 2) >> b) without
+any harmonic folding back. Each one is in phase with the plain table and
+scaled to its own peak, so the Gibbs overshoot does not clip.
+
+Usage: gen_waveforms.py --length 256 --bits 8 [--compact] [--bandlimited] --out <dir>
+"""
+
+import argparse
+import math
+import os
+import time
+
+
+def quarter_sine(length, full):
+    """First quarter (length/4 + 1 points) of a sine centred at full/2."""
+    half = full / 2.0
+    return [int(math.floor(half + half * math.sin(2.0 * math.pi * i / length) + 0.5))
+            for i in range(length // 4 + 1)]
+
+
+def quarter_triangle(length, full):
+    """First quarter (length/4 + 1 points) of a triangle rising from 0."""
+    return [int(math.floor(full * i / (length // 2) + 0.5)) for i in range(length // 4 + 1)]
+
+
+def unfold_sine(quarter, length, full):
+    """Full period of a sine from its first quarter."""
+    q = length // 4
+    first = [quarter[i] if i <= q else quarter[2 * q - i] for i in range(2 * q)]
+    return first + [full - v for v in first]
+
+
+def unfold_triangle(quarter, length, full):
+    """Full period of a triangle from its first quarter."""
+    q = length // 4
+    rising = [quarter[i] if i <= q else full - quarter[2 * q - i] for i in range(2 * q + 1)]
+    return rising + [rising[length - i] for i in range(2 * q + 1, length)]
+
+
+def sawtooth(length, bits):
+    """Ramp starting at mid scale, wrapping once per period."""
+    mask = (1 << bits) - 1
+    return [(((i << bits) // length) + (1 << (bits - 1))) & mask for i in range(length)]
+
+
+def square(length, full):
+    """High for the first half of the period, low for the second."""
+    return [full if i < length // 2 else 0 for i in range(length)]
+
+
+def band_count(length):
+    """Octaves below the plain tables: the last one keeps the fundamental only."""
+    return (length // 2).bit_length() - 1
+
+
+def band_limited(shape, length, harmonics, full):
+    """One period of a shape with its harmonics above @p harmonics removed."""
+    series = []
+    for i in range(length):
+        x = 2.0 * math.pi * i / length
+        if shape == "triangular":
+            v = -sum(math.cos(n * x) / (n * n) for n in range(1, harmonics + 1, 2))
+        elif shape == "sierra":
+            v = sum((1 if n % 2 else -1) * math.sin(n * x) / n for n in range(1, harmonics + 1))
+        else:
+            v = sum(math.sin(n * x) / n for n in range(1, harmonics + 1, 2))
+        series.append(v)
+    peak = max(abs(v) for v in series)
+    half = full / 2.0
+    return [int(math.floor(half + half * v / peak + 0.5)) for v in series]
+
+
+def c_array(name, ctype, values, size):
+    """Format a const C array, 16 values per line."""
+    lines = ["const %s %s[%s] = {" % (ctype, name, size)]
+    for i in range(0, len(values), 16):
+        lines.append("    " + ", ".join("%d" % v for v in values[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[2])
+    parser.add_argument("--length", type=int, default=256, help="points per period (multiple of 4)")
+    parser.add_argument("--bits", type=int, default=8, help="bit depth, 8 to 16")
+    parser.add_argument("--compact", action="store_true", help="emit only the quarter-period tables")
+    parser.add_argument("--bandlimited", action="store_true",
+                        help="also emit one band-limited table per octave of the non-sine shapes")
+    parser.add_argument("--out", required=True, help="output directory")
+    args = parser.parse_args()
+
+    length, bits = args.length, args.bits
+    if length < 4 or length % 4:
+        parser.error("--length must be a multiple of 4")
+    if not 8 <= bits <= 16:
+        parser.error("--bits must be between 8 and 16")
+
+    start = time.perf_counter()
+    full = (1 << bits) - 1
+    ctype = "uint8_t" if bits <= 8 else "uint16_t"
+    sine_q = quarter_sine(length, full)
+    triangle_q = quarter_triangle(length, full)
+    quarters = [("seno_cuarto", sine_q), ("triangular_cuarto", triangle_q)]
+    tables = [] if args.compact else [
+        ("seno", unfold_sine(sine_q, length, full)),
+        ("triangular", unfold_triangle(triangle_q, length, full)),
+        ("sierra", sawtooth(length, bits)),
+        ("cuadrada", square(length, full)),
+    ]
+    bands = band_count(length) if args.bandlimited else 0
+    banded = [(name + "_banda", [band_limited(name, length, (length // 2) >> b, full) for b in range(1, bands + 1)])
+              for name in ("triangular", "sierra", "cuadrada")] if bands else []
+
+    header = """/**
+ * @file waveform_tables.h
+ * @brief Waveform tables generated by gen_waveforms.py (do not edit).
+ */
+
+// Avoid duplication in code
+#ifndef _WAVEFORM_TABLES_H_
+#define _WAVEFORM_TABLES_H_
+
+#include <stdint.h>
+
+#define WAVEFORM_LENGTH %d ///< Puntos por periodo
+#define WAVEFORM_BITS %d ///< Bits por punto
+#define WAVEFORM_COMPACT %d ///< 1 si solo hay tablas de cuarto de periodo
+#define WAVEFORM_QUARTER (WAVEFORM_LENGTH / 4) ///< Puntos en un cuarto de periodo
+#define WAVEFORM_BANDS %d ///< Tablas de banda limitada por forma (una por octava, 0: ninguna)
+
+typedef %s waveform_sample_t; ///< Tipo de un punto de la tabla
+
+extern const waveform_sample_t seno_cuarto[WAVEFORM_QUARTER + 1];
+extern const waveform_sample_t triangular_cuarto[WAVEFORM_QUARTER + 1];
+""" % (length, bits, int(args.compact), bands, ctype)
+    if not args.compact:
+        header += """extern const waveform_sample_t seno[WAVEFORM_LENGTH];
+extern const waveform_sample_t triangular[WAVEFORM_LENGTH];
+extern const waveform_sample_t sierra[WAVEFORM_LENGTH];
+extern const waveform_sample_t cuadrada[WAVEFORM_LENGTH];
+"""
+    if bands:
+        header += """extern const waveform_sample_t triangular_banda[WAVEFORM_BANDS][WAVEFORM_LENGTH];
+extern const waveform_sample_t sierra_banda[WAVEFORM_BANDS][WAVEFORM_LENGTH];
+extern const waveform_sample_t cuadrada_banda[WAVEFORM_BANDS][WAVEFORM_LENGTH];
+"""
+    header += """
+#endif
+"""
+
+    source = ["/**",
+              " * @file waveform_tables.c",
+              " * @brief Waveform tables generated by gen_waveforms.py (do not edit).",
+              " */",
+              "",
+              '#include "waveform_tables.h"',
+              ""]
+    for name, values in quarters:
+        source.append(c_array(name, "waveform_sample_t", values, "WAVEFORM_QUARTER + 1"))
+        source.append("")
+    for name, values in tables:
+        source.append(c_array(name, "waveform_sample_t", values, "WAVEFORM_LENGTH"))
+        source.append("")
+    for name, levels in banded:
+        source.append("const waveform_sample_t %s[WAVEFORM_BANDS][WAVEFORM_LENGTH] = {" % name)
+        for values in levels:
+            rows = c_array("", "", values, "").splitlines()[1:-1]
+            source.append("    {")
+            source.extend("    " + row for row in rows)
+            source.append("    },")
+        source.append("};")
+        source.append("")
+
+    os.makedirs(args.out, exist_ok=True)
+    with open(os.path.join(args.out, "waveform_tables.h"), "w") as f:
+        f.write(header)
+    with open(os.path.join(args.out, "waveform_tables.c"), "w") as f:
+        f.write("\n".join(source))
+
+    elapsed_ms = (time.perf_counter() - start) * 1000.0
+    width = 1 if bits <= 8 else 2
+    full_bytes = len(tables) * length * width
+    quarter_bytes = sum(len(v) for _, v in quarters) * width
+    print("waveform tables: %d points x %d bit, %d B full + %d B quarter-wave of flash, generated in %.1f ms"
+          % (length, bits, full_bytes, quarter_bytes, elapsed_ms))
+    for name, levels in banded:
+        print("band-limited %s: %d octaves (%d to %d harmonics), %d B of flash"
+              % (name, bands, (length // 2) >> 1, (length // 2) >> bands, len(levels) * length * width))
+
+
+if __name__ == "__main__":
+    main()
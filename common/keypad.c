@@ -0,0 +1,107 @@
+/**
+ * @file keypad.c
+ * @brief Debounce state machines and event queue of the keypad.
+ */
+
+#include "keypad.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize the keypad state, all keys released.
+ *
+ * @param k Keypad.
+ * @param keymap KEYPAD_KEYS characters, row by row.
+ * @param debounce Consecutive equal scans needed to accept a change (at least 1).
+ */
+void keypad_init(keypad_t *k, const char *keymap, uint8_t debounce) {
+    memset(k, 0, sizeof(*k));
+    k->keymap = keymap;
+    k->debounce = debounce ? debounce : 1;
+    atomic_init(&k->head, 0);
+    atomic_init(&k->tail, 0);
+}
+
+/**
+ * @brief Append an event (scanner side); counted as dropped if the queue is full.
+ */
+static void keypad_push(keypad_t *k, uint32_t key, bool pressed) {
+    uint32_t head = atomic_load_explicit(&k->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&k->tail, memory_order_acquire);
+    if (head - tail >= KEYPAD_QUEUE_LEN) {
+        k->dropped++;
+        return;
+    }
+    k->queue[head % KEYPAD_QUEUE_LEN].key = k->keymap[key];
+    k->queue[head % KEYPAD_QUEUE_LEN].pressed = pressed;
+    atomic_store_explicit(&k->head, head + 1, memory_order_release);
+}
+
+/**
+ * @brief Step the state machine of one key with one raw reading.
+ */
+static void keypad_step(keypad_t *k, uint32_t key, bool raw) {
+    switch (k->state[key]) {
+    case KEYPAD_UP:
+        if (raw) {
+            k->state[key] = KEYPAD_PRESSING;
+            k->count[key] = 0;
+        } else {
+            break;
+        }
+        /* fall through */
+    case KEYPAD_PRESSING:
+        if (!raw) {
+            k->state[key] = KEYPAD_UP; ///< rebote o pulso espurio
+        } else if (++k->count[key] >= k->debounce) {
+            k->state[key] = KEYPAD_DOWN;
+            keypad_push(k, key, true);
+        }
+        break;
+    case KEYPAD_DOWN:
+        if (!raw) {
+            k->state[key] = KEYPAD_RELEASING;
+            k->count[key] = 0;
+        } else {
+            break;
+        }
+        /* fall through */
+    case KEYPAD_RELEASING:
+        if (raw) {
+            k->state[key] = KEYPAD_DOWN;
+        } else if (++k->count[key] >= k->debounce) {
+            k->state[key] = KEYPAD_UP;
+            keypad_push(k, key, false);
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Feed the column readings of one row.
+ *
+ * @param k Keypad.
+ * @param row Row that was driven (0 to KEYPAD_ROWS - 1).
+ * @param columns Bit c set if column c read high.
+ */
+void keypad_feed_row(keypad_t *k, uint32_t row, uint32_t columns) {
+    for (uint32_t c = 0; c < KEYPAD_COLUMNS; c++) {
+        keypad_step(k, row * KEYPAD_COLUMNS + c, (columns >> c) & 1u);
+    }
+}
+
+/**
+ * @brief Take the oldest event (consumer side).
+ *
+ * @return false if there is no event.
+ */
+bool keypad_pop(keypad_t *k, keypad_event_t *ev) {
+    uint32_t tail = atomic_load_explicit(&k->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&k->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *ev = k->queue[tail % KEYPAD_QUEUE_LEN];
+    atomic_store_explicit(&k->tail, tail + 1, memory_order_release);
+    return true;
+}
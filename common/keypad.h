@@ -0,0 +1,72 @@
+/**
+ * @file keypad.h
+ * @brief 4x4 matrix keypad: per-key debounce and a lock-free event queue.
+ *
+ * The scanner drives one row at a time and feeds the four column bits of
+ * that row to a small state machine per key; a key is reported pressed or
+ * released only after KEYPAD_DEBOUNCE_SCANS consecutive scans agree, so a
+ * bounce or a one-scan glitch produces no event. Events go into a
+ * single-producer/single-consumer queue: the scan (timer task or polling
+ * loop) only appends, the command parser only removes, and neither waits.
+ *
+ * The state machine is portable; the GPIO side is in keypad_rp2040.c.
+ */
+
+// Avoid duplication in code
+#ifndef _KEYPAD_H_
+#define _KEYPAD_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define KEYPAD_ROWS 4             ///< Filas de la matriz
+#define KEYPAD_COLUMNS 4          ///< Columnas de la matriz
+#define KEYPAD_KEYS (KEYPAD_ROWS * KEYPAD_COLUMNS)
+#define KEYPAD_DEBOUNCE_SCANS 3   ///< Lecturas iguales para aceptar un cambio
+#define KEYPAD_QUEUE_LEN 16       ///< Eventos en cola (potencia de 2)
+
+/**
+ * @brief Debounce state of one key.
+ */
+enum {
+    KEYPAD_UP,            ///< Suelta
+    KEYPAD_PRESSING,      ///< Suelta, leyendo pulsada
+    KEYPAD_DOWN,          ///< Pulsada
+    KEYPAD_RELEASING,     ///< Pulsada, leyendo suelta
+};
+
+/**
+ * @brief Key event.
+ */
+typedef struct {
+    char key;      ///< Caracter de la tecla
+    bool pressed;  ///< true al pulsar, false al soltar
+} keypad_event_t;
+
+/**
+ * @brief Keypad state.
+ */
+typedef struct {
+    const char *keymap;                      ///< Caracteres por fila y columna (KEYPAD_KEYS)
+    uint8_t state[KEYPAD_KEYS];              ///< Estado de cada tecla
+    uint8_t count[KEYPAD_KEYS];              ///< Lecturas consecutivas en el estado candidato
+    uint8_t debounce;                        ///< Lecturas para aceptar un cambio
+    uint8_t row;                             ///< Fila que se esta excitando
+    uint32_t row_base;                       ///< GPIO de la primera fila
+    uint32_t col_base;                       ///< GPIO de la primera columna
+    keypad_event_t queue[KEYPAD_QUEUE_LEN];  ///< Cola de eventos
+    _Atomic uint32_t head;                   ///< Eventos escritos (solo el escaner)
+    _Atomic uint32_t tail;                   ///< Eventos leidos (solo el consumidor)
+    volatile uint32_t dropped;               ///< Eventos perdidos con la cola llena
+} keypad_t;
+
+void keypad_init(keypad_t *k, const char *keymap, uint8_t debounce);
+void keypad_feed_row(keypad_t *k, uint32_t row, uint32_t columns);
+bool keypad_pop(keypad_t *k, keypad_event_t *ev);
+
+// GPIO side
+void keypad_hw_init(keypad_t *k, uint32_t row_base, uint32_t col_base);
+void keypad_hw_scan(keypad_t *k);
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file keypad_rp2040.c
+ * @brief GPIO side of the keypad scanner.
+ *
+ * Rows and columns must be on consecutive GPIOs. Each scan step is one
+ * masked read of the columns of the row driven by the previous step (so
+ * the lines have had a whole step to settle) and one masked write that
+ * drives the next row.
+ */
+
+#include "keypad.h"
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+/**
+ * @brief Configure the row outputs and the pulled-down column inputs.
+ *
+ * @param k Keypad (already initialized with keypad_init()).
+ * @param row_base GPIO of row 0.
+ * @param col_base GPIO of column 0.
+ */
+void keypad_hw_init(keypad_t *k, uint32_t row_base, uint32_t col_base) {
+    uint32_t rows = ((1u << KEYPAD_ROWS) - 1) << row_base;
+    uint32_t cols = ((1u << KEYPAD_COLUMNS) - 1) << col_base;
+    k->row_base = row_base;
+    k->col_base = col_base;
+    k->row = 0;
+    gpio_init_mask(rows | cols);
+    gpio_set_dir_out_masked(rows);
+    gpio_set_dir_in_masked(cols);
+    for (uint32_t c = 0; c < KEYPAD_COLUMNS; c++) {
+        gpio_pull_down(col_base + c);
+    }
+    gpio_put_masked(rows, 1u << row_base);
+}
+
+/**
+ * @brief One scan step: read the driven row, drive the next one.
+ */
+void keypad_hw_scan(keypad_t *k) {
+    uint32_t columns = (gpio_get_all() >> k->col_base) & ((1u << KEYPAD_COLUMNS) - 1);
+    keypad_feed_row(k, k->row, columns);
+    k->row = (k->row + 1) % KEYPAD_ROWS;
+    gpio_put_masked(((1u << KEYPAD_ROWS) - 1) << k->row_base, 1u << (k->row_base + k->row));
+}
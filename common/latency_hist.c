@@ -0,0 +1,136 @@
+/**
+ * @file latency_hist.c
+ * @brief Histogram aggregation and CSV export.
+ *
+ * The export reads the histograms while the handlers may still be adding
+ * to them; a line can therefore be off by the few values recorded while it
+ * was being formatted.
+ */
+
+#include "latency_hist.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Clear a histogram.
+ */
+void latency_hist_reset(latency_hist_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+/**
+ * @brief Smallest value that falls in a bin.
+ */
+uint32_t latency_hist_bin_low(uint32_t bin) {
+    if (bin < 16) {
+        return bin;
+    }
+    uint32_t e = 4 + (bin - 16) / 8;
+    return (8 + (bin - 16) % 8) << (e - 3);
+}
+
+/**
+ * @brief Largest value that falls in a bin.
+ */
+uint32_t latency_hist_bin_high(uint32_t bin) {
+    if (bin >= LATENCY_HIST_BINS - 1) {
+        return UINT32_MAX;
+    }
+    return latency_hist_bin_low(bin + 1) - 1;
+}
+
+/**
+ * @brief Percentile of a histogram.
+ *
+ * @param h Histogram.
+ * @param permille Percentile in thousandths (990 = p99).
+ * @return Upper bound of the bin holding the percentile, never above the
+ *         maximum; 0 for an empty histogram.
+ */
+uint32_t latency_hist_percentile(const latency_hist_t *h, uint32_t permille) {
+    if (h->count == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)h->count * permille + 999) / 1000; ///< valores que deben quedar por debajo
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < LATENCY_HIST_BINS; b++) {
+        seen += h->bins[b];
+        if (seen >= rank) {
+            uint32_t high = latency_hist_bin_high(b);
+            return high < h->max ? high : h->max;
+        }
+    }
+    return h->max;
+}
+
+/**
+ * @brief Count, min, mean, p99 and max of a histogram.
+ */
+void latency_hist_summary(const latency_hist_t *h, latency_summary_t *s) {
+    s->count = h->count;
+    s->min = h->min;
+    s->max = h->max;
+    s->mean = h->count ? (uint32_t)(h->sum / h->count) : 0;
+    s->p99 = latency_hist_percentile(h, 990);
+}
+
+/**
+ * @brief Clear both histograms of a probe.
+ */
+void latency_probe_reset(latency_probe_t *p) {
+    latency_hist_reset(&p->late);
+    latency_hist_reset(&p->run);
+}
+
+/**
+ * @brief Write the summary of one histogram, and optionally its bins.
+ */
+static void dump_hist(const char *probe, const char *metric, const latency_hist_t *h, bool bins,
+                      latency_write_t write, void *ctx) {
+    char line[96];
+    latency_summary_t s;
+
+    if (h->count == 0) {
+        return;
+    }
+    latency_hist_summary(h, &s);
+    snprintf(line, sizeof(line), "%s,%s,%lu,%lu,%lu,%lu,%lu\n", probe, metric, (unsigned long)s.count,
+             (unsigned long)s.min, (unsigned long)s.mean, (unsigned long)s.p99, (unsigned long)s.max);
+    write(line, ctx);
+    if (!bins) {
+        return;
+    }
+    for (uint32_t b = 0; b < LATENCY_HIST_BINS; b++) {
+        if (h->bins[b]) {
+            snprintf(line, sizeof(line), "%s,%s,bin,%lu,%lu\n", probe, metric,
+                     (unsigned long)latency_hist_bin_low(b), (unsigned long)h->bins[b]);
+            write(line, ctx);
+        }
+    }
+}
+
+/**
+ * @brief Export probes as CSV.
+ *
+ * Summary lines are "probe,metric,count,min,mean,p99,max"; with @p bins,
+ * each is followed by "probe,metric,bin,<lowest value>,<count>" lines for
+ * the non-empty bins. Empty histograms are skipped.
+ *
+ * @param probes Probes.
+ * @param count Number of probes.
+ * @param bins Also write the bins.
+ * @param write Line output.
+ * @param ctx Context for @p write.
+ */
+void latency_probe_dump_csv(const latency_probe_t *probes, uint32_t count, bool bins,
+                            latency_write_t write, void *ctx) {
+    write("probe,metric,count,min,mean,p99,max\n", ctx);
+    for (uint32_t i = 0; i < count; i++) {
+        dump_hist(probes[i].name, "late", &probes[i].late, bins, write, ctx);
+        dump_hist(probes[i].name, "run", &probes[i].run, bins, write, ctx);
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file latency_hist.h
+ * @brief Fixed-size latency histograms and per-handler probes.
+ *
+ * Values (microseconds on the board) go into log-linear bins: exact below
+ * 16, then eight bins per power of two, so the error of a percentile is at
+ * most 1/8 of its value up to LATENCY_HIST_LIMIT. Adding a value is a few
+ * shifts and increments, with no allocation and no division, so it can run
+ * inside the interrupt handlers it measures.
+ */
+
+// Avoid duplication in code
+#ifndef _LATENCY_HIST_H_
+#define _LATENCY_HIST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LATENCY_HIST_BINS 128 ///< Bins por histograma (el ultimo acumula el desborde)
+#define LATENCY_HIST_LIMIT (1u << 18) ///< Primer valor que cae en el bin de desborde
+
+/**
+ * @brief Histogram of one metric.
+ */
+typedef struct {
+    uint32_t bins[LATENCY_HIST_BINS]; ///< Cuentas por bin
+    uint32_t count;                   ///< Valores registrados
+    uint32_t min;                     ///< Valor minimo
+    uint32_t max;                     ///< Valor maximo
+    uint64_t sum;                     ///< Suma de los valores (para la media)
+} latency_hist_t;
+
+/**
+ * @brief Scheduled-vs-actual and duration histograms of one handler.
+ */
+typedef struct {
+    const char *name;     ///< Nombre en la exportacion
+    latency_hist_t late;  ///< Retraso de la entrada respecto a la alarma programada
+    latency_hist_t run;   ///< Duracion del manejador
+} latency_probe_t;
+
+/**
+ * @brief Summary of a histogram.
+ */
+typedef struct {
+    uint32_t count; ///< Valores registrados
+    uint32_t min;   ///< Minimo exacto
+    uint32_t mean;  ///< Media exacta (redondeada hacia abajo)
+    uint32_t p99;   ///< Percentil 99 (limite superior de su bin)
+    uint32_t max;   ///< Maximo exacto
+} latency_summary_t;
+
+/**
+ * @brief Output callback for the CSV export (one line, with its newline).
+ */
+typedef void (*latency_write_t)(const char *line, void *ctx);
+
+void latency_hist_reset(latency_hist_t *h);
+uint32_t latency_hist_bin_low(uint32_t bin);
+uint32_t latency_hist_bin_high(uint32_t bin);
+uint32_t latency_hist_percentile(const latency_hist_t *h, uint32_t permille);
+void latency_hist_summary(const latency_hist_t *h, latency_summary_t *s);
+void latency_probe_reset(latency_probe_t *p);
+void latency_probe_dump_csv(const latency_probe_t *probes, uint32_t count, bool bins,
+                            latency_write_t write, void *ctx);
+
+/**
+ * @brief Bin of a value.
+ */
+static inline uint32_t latency_hist_bin(uint32_t v) {
+    if (v < 16) {
+        return v;
+    }
+    if (v >= LATENCY_HIST_LIMIT) {
+        return LATENCY_HIST_BINS - 1;
+    }
+    uint32_t e = 31 - (uint32_t)__builtin_clz(v); ///< potencia de 2 (4 a 17)
+    return 16 + (e - 4) * 8 + ((v >> (e - 3)) & 7);
+}
+
+/**
+ * @brief Record one value.
+ */
+static inline void latency_hist_add(latency_hist_t *h, uint32_t v) {
+    h->bins[latency_hist_bin(v)]++;
+    if (h->count == 0 || v < h->min) {
+        h->min = v;
+    }
+    if (v > h->max) {
+        h->max = v;
+    }
+    h->count++;
+    h->sum += v;
+}
+
+/**
+ * @brief Record the lateness of a handler entry.
+ *
+ * @param p Probe.
+ * @param scheduled Time the alarm was set for.
+ * @param now Time at the start of the handler (same clock, wrapping).
+ */
+static inline void latency_probe_enter(latency_probe_t *p, uint32_t scheduled, uint32_t now) {
+    int32_t late = (int32_t)(now - scheduled);
+    latency_hist_add(&p->late, late > 0 ? (uint32_t)late : 0);
+}
+
+/**
+ * @brief Record the duration of a handler.
+ *
+ * @param p Probe.
+ * @param start Time at the start of the handler.
+ * @param now Time at the end of the handler.
+ */
+static inline void latency_probe_exit(latency_probe_t *p, uint32_t start, uint32_t now) {
+    latency_hist_add(&p->run, now - start);
+}
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file log_msgs.h
+ * @brief Message catalog of the deferred log, shared by the firmwares and the host decoder.
+ *
+ * X(id, args, format): @c args is the number of 32-bit arguments (at most
+ * LOG_ARGS), or LOG_TEXT for one short text argument. The format is a
+ * printf format that takes exactly those arguments as unsigned ints (%s for
+ * LOG_TEXT) and carries its own line break. Ids are sent on the wire, so
+ * new messages go at the end.
+ */
+
+// Avoid duplication in code
+#ifndef _LOG_MSGS_H_
+#define _LOG_MSGS_H_
+
+#define LOG_TEXT 255 ///< El argumento es un texto corto
+
+#define LOG_MESSAGES(X) \
+    X(LOG_DROPPED, 3, "Registros perdidos: anillo %u, %u nuevos, %u en total\n") \
+    X(LOG_BOOT, 0, "Generador de señales\n") \
+    X(LOG_TEXT_INPUT, LOG_TEXT, "Texto ingresado: %s\n") \
+    X(LOG_TEXT_TOO_LONG, 0, "Texto demasiado largo. Presione 'D' para finalizar.\n") \
+    X(LOG_SET_AMPLITUDE, 1, "Configuracion ingresada: Amplitud -> %u\n") \
+    X(LOG_BAD_AMPLITUDE, 0, "Configuracion de amplitud invalida\n") \
+    X(LOG_SET_OFFSET, 1, "Configuracion ingresada: Offset -> %u\n") \
+    X(LOG_BAD_OFFSET, 0, "Configuracion de offset invalida\n") \
+    X(LOG_SET_FREQUENCY, 2, "Configuracion ingresada: Frecuencia -> %u.%03u\n") \
+    X(LOG_BAD_FREQUENCY, 0, "Configuracion de frecuencia invalida\n") \
+    X(LOG_SET_MODULATION, 3, "Configuracion ingresada: Modulacion -> %u, %u, %u\n") \
+    X(LOG_BAD_MODULATION, 0, "Configuracion de modulacion invalida\n") \
+    X(LOG_SET_PHASE, 1, "Configuracion ingresada: Desfase -> %u\n") \
+    X(LOG_STATUS_SINE, 4, "Sinusoidal: Amp: %u, Offset: %u, Freq: %u.%03u\n") \
+    X(LOG_STATUS_TRIANGLE, 4, "Triangular: Amp: %u, Offset: %u, Freq: %u.%03u\n") \
+    X(LOG_STATUS_SAWTOOTH, 4, "Saw tooth: Amp: %u, Offset: %u, Freq: %u.%03u\n") \
+    X(LOG_STATUS_SQUARE, 4, "Square: Amp: %u, Offset: %u, Freq: %u.%03u\n") \
+    X(LOG_STATUS_SWEEP_LIN, 2, "Modulacion: Barrido lineal %u %u\n") \
+    X(LOG_STATUS_SWEEP_LOG, 2, "Modulacion: Barrido logaritmico %u %u\n") \
+    X(LOG_STATUS_AM, 2, "Modulacion: AM %u %u\n") \
+    X(LOG_STATUS_FM, 2, "Modulacion: FM %u %u\n") \
+    X(LOG_STATUS_PHASE, 1, "Desfase canal 1: %u\n") \
+    X(LOG_MISSED, 1, "Plazos perdidos: %u\n") \
+    X(LOG_EXEC_HEADER, 0, "task,period_us,deadline_us,runs,missed,worst_late_us,worst_run_us\n") \
+    X(LOG_EXEC_NAME, LOG_TEXT, "%s,") \
+    X(LOG_EXEC_PERIOD, 2, "%u,%u,") \
+    X(LOG_EXEC_TIMES, 4, "%u,%u,%u,%u\n") \
+    X(LOG_STATUS_USER, 4, "Usuario: Amp: %u, Offset: %u, Freq: %u.%03u\n") \
+    X(LOG_WAVE_LOADED, 2, "Forma de onda cargada: %u puntos, tabla %u\n") \
+    X(LOG_TXN_APPLIED, 2, "Cambio aplicado: espera %u us, preparacion %u us\n") \
+    X(LOG_BOOT_CONFIG, LOG_TEXT, "Configuracion de arranque: %s\n") \
+    X(LOG_FIRST_SAMPLE, 2, "Primera muestra a %u us del arranque (lectura de la flash %u us)\n") \
+    X(LOG_PRESET_SAVED, LOG_TEXT, "Guardado: %s\n") \
+    X(LOG_PRESET_LOADED, LOG_TEXT, "Cargado: %s\n") \
+    X(LOG_BAD_PRESET, 1, "Preset %u vacio o no valido\n") \
+    X(LOG_PRESET_FAILED, 1, "Error de la flash al guardar el slot %u\n") \
+    X(LOG_CLOCK_PLAN, 4, "Reloj: %u kHz, %u puntos por periodo, muestreo %u Hz, carga %u%%\n") \
+    X(LOG_CLOCK_ERROR_HIGH, 3, "Frecuencia lograda: %u.%03u Hz (+%u ppb)\n") \
+    X(LOG_CLOCK_ERROR_LOW, 3, "Frecuencia lograda: %u.%03u Hz (-%u ppb)\n")
+
+#define LOG_MSG_ID(id, args, format) id,
+enum { LOG_MESSAGES(LOG_MSG_ID) LOG_MSG_COUNT };
+#undef LOG_MSG_ID
+
+#endif
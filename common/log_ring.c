@@ -0,0 +1,376 @@
+/**
+ * @file log_ring.c
+ * @brief Record rings, drain, text formatting and binary frames of the deferred log.
+ *
+ * The producer owns @c head and @c dropped, the drain owns @c tail (see
+ * mailbox.c). Nothing on the producer side formats, blocks or loops.
+ */
+
+#include "log_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_MSG_ARGS(id, args, format) args,
+static const uint8_t log_args[LOG_MSG_COUNT] = { LOG_MESSAGES(LOG_MSG_ARGS) };
+#undef LOG_MSG_ARGS
+
+#define LOG_MSG_FORMAT(id, args, format) format,
+static const char *const log_formats[LOG_MSG_COUNT] = { LOG_MESSAGES(LOG_MSG_FORMAT) };
+#undef LOG_MSG_FORMAT
+
+/**
+ * @brief Initialize an empty ring.
+ */
+void log_ring_init(log_ring_t *r) {
+    memset(r->slot, 0, sizeof(r->slot));
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->dropped, 0);
+}
+
+/**
+ * @brief Claim the next slot, or count a drop if the ring is full.
+ */
+static log_record_t *log_claim(log_ring_t *r, uint32_t *head) {
+    *head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (*head - tail >= LOG_RING_DEPTH) {
+        atomic_store_explicit(&r->dropped, atomic_load_explicit(&r->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return NULL;
+    }
+    return &r->slot[*head % LOG_RING_DEPTH];
+}
+
+/**
+ * @brief Log a message with integer arguments (producer side).
+ *
+ * Safe from an interrupt as long as the ring has no other producer.
+ *
+ * @param r Ring of the calling context.
+ * @param id Message (LOG_*); unused arguments are ignored.
+ * @return false if the ring was full and the record was dropped.
+ */
+bool log_put(log_ring_t *r, uint16_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    uint32_t head;
+    log_record_t *rec = log_claim(r, &head);
+    if (!rec) {
+        return false;
+    }
+    rec->time = log_hw_now();
+    rec->id = id;
+    rec->arg[0] = a;
+    rec->arg[1] = b;
+    rec->arg[2] = c;
+    rec->arg[3] = d;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Log a message with a text argument, cut to LOG_TEXT_LEN characters.
+ */
+bool log_put_text(log_ring_t *r, uint16_t id, const char *text) {
+    uint32_t head;
+    log_record_t *rec = log_claim(r, &head);
+    if (!rec) {
+        return false;
+    }
+    rec->time = log_hw_now();
+    rec->id = id;
+    strncpy(rec->text, text, LOG_TEXT_LEN);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Oldest record of a ring without taking it.
+ */
+static const log_record_t *log_peek(log_ring_t *r) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return head == tail ? NULL : &r->slot[tail % LOG_RING_DEPTH];
+}
+
+/**
+ * @brief Take the oldest record (drain side).
+ *
+ * @return false if the ring is empty.
+ */
+bool log_take(log_ring_t *r, log_record_t *rec) {
+    const log_record_t *next = log_peek(r);
+    if (!next) {
+        return false;
+    }
+    *rec = *next;
+    atomic_store_explicit(&r->tail, atomic_load_explicit(&r->tail, memory_order_relaxed) + 1,
+                          memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Records dropped by a ring since it was initialized.
+ */
+uint32_t log_dropped(const log_ring_t *r) {
+    return atomic_load_explicit(&r->dropped, memory_order_relaxed);
+}
+
+/**
+ * @brief Initialize a drain with no rings, in text mode.
+ *
+ * @param d Drain.
+ * @param write Output; it may block, the drain runs at the lowest priority.
+ * @param ctx Context of the output.
+ */
+void log_drain_init(log_drain_t *d, log_write_t write, void *ctx) {
+    memset(d, 0, sizeof(*d));
+    d->write = write;
+    d->ctx = ctx;
+}
+
+/**
+ * @brief Add a ring to a drain.
+ *
+ * @return false if the drain already has LOG_MAX_RINGS rings.
+ */
+bool log_drain_add(log_drain_t *d, log_ring_t *r) {
+    if (d->count >= LOG_MAX_RINGS) {
+        return false;
+    }
+    d->dropped_seen[d->count] = log_dropped(r);
+    d->ring[d->count++] = r;
+    return true;
+}
+
+/**
+ * @brief Switch between text and binary (telemetry) output.
+ */
+void log_drain_set_binary(log_drain_t *d, bool binary) {
+    d->binary = binary;
+}
+
+/**
+ * @brief Send one record in the drain's output format.
+ */
+static void log_emit(log_drain_t *d, const log_record_t *rec) {
+    if (d->binary) {
+        uint8_t frame[LOG_FRAME_MAX];
+        d->write(frame, log_encode(rec, frame, sizeof(frame)), d->ctx);
+    } else {
+        char line[LOG_LINE_MAX];
+        d->write((const uint8_t *)line, log_format(rec, line, sizeof(line)), d->ctx);
+    }
+}
+
+/**
+ * @brief Send up to @p max records, oldest first across the rings.
+ *
+ * New drops of a ring are reported, as one LOG_DROPPED record, before the
+ * ring's next record.
+ *
+ * @param d Drain.
+ * @param max Records to send at most (bounds the time of one step).
+ * @return Records sent.
+ */
+uint32_t log_drain_step(log_drain_t *d, uint32_t max) {
+    uint32_t sent = 0;
+    while (sent < max) {
+        for (uint32_t i = 0; i < d->count && sent < max; i++) {
+            uint32_t dropped = log_dropped(d->ring[i]);
+            if (dropped != d->dropped_seen[i]) {
+                log_record_t rec = { .time = log_hw_now(), .id = LOG_DROPPED, .ring = (uint16_t)i };
+                rec.arg[0] = i;
+                rec.arg[1] = dropped - d->dropped_seen[i];
+                rec.arg[2] = dropped;
+                d->dropped_seen[i] = dropped;
+                log_emit(d, &rec);
+                sent++;
+            }
+        }
+        int32_t oldest = -1;
+        const log_record_t *first = NULL;
+        for (uint32_t i = 0; i < d->count; i++) {
+            const log_record_t *next = log_peek(d->ring[i]);
+            if (next && (!first || (int32_t)(next->time - first->time) < 0)) {
+                first = next;
+                oldest = (int32_t)i;
+            }
+        }
+        if (oldest < 0 || sent >= max) {
+            break;
+        }
+        log_record_t rec;
+        log_take(d->ring[oldest], &rec);
+        rec.ring = (uint16_t)oldest;
+        log_emit(d, &rec);
+        sent++;
+    }
+    return sent;
+}
+
+/**
+ * @brief Records dropped by all the rings of a drain.
+ */
+uint32_t log_drain_dropped(const log_drain_t *d) {
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < d->count; i++) {
+        total += log_dropped(d->ring[i]);
+    }
+    return total;
+}
+
+/**
+ * @brief Arguments of a message: a count, LOG_TEXT, or 0 for an unknown id.
+ */
+uint8_t log_msg_args(uint16_t id) {
+    return id < LOG_MSG_COUNT ? log_args[id] : 0;
+}
+
+/**
+ * @brief Text of a record, as printed by the catalog format.
+ *
+ * @return Length written (without the terminator).
+ */
+uint32_t log_format(const log_record_t *rec, char *buf, uint32_t len) {
+    int n;
+    if (rec->id >= LOG_MSG_COUNT) {
+        n = snprintf(buf, len, "? mensaje %u\n", (unsigned)rec->id);
+    } else if (log_args[rec->id] == LOG_TEXT) {
+        char text[LOG_TEXT_LEN + 1];
+        memcpy(text, rec->text, LOG_TEXT_LEN);
+        text[LOG_TEXT_LEN] = '\0';
+        n = snprintf(buf, len, log_formats[rec->id], text);
+    } else {
+        n = snprintf(buf, len, log_formats[rec->id], (unsigned)rec->arg[0], (unsigned)rec->arg[1],
+                     (unsigned)rec->arg[2], (unsigned)rec->arg[3]);
+    }
+    if (n < 0) {
+        return 0;
+    }
+    return (uint32_t)n < len ? (uint32_t)n : len - 1;
+}
+
+static uint32_t log_put_varint(uint8_t *p, uint32_t v) {
+    uint32_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/**
+ * @brief Binary frame of a record.
+ *
+ * @param buf Destination, at least LOG_FRAME_MAX bytes.
+ * @return Length of the frame, 0 if @p buf is too short.
+ */
+uint32_t log_encode(const log_record_t *rec, uint8_t *buf, uint32_t len) {
+    uint8_t args = log_msg_args(rec->id);
+    uint32_t n = 0;
+    if (len < LOG_FRAME_MAX) {
+        return 0;
+    }
+    buf[n++] = LOG_FRAME_MAGIC;
+    buf[n++] = (uint8_t)rec->id;
+    n += log_put_varint(&buf[n], rec->time);
+    if (args == LOG_TEXT) {
+        uint8_t t = (uint8_t)strnlen(rec->text, LOG_TEXT_LEN);
+        buf[n++] = t;
+        memcpy(&buf[n], rec->text, t);
+        n += t;
+    } else {
+        for (uint32_t i = 0; i < args && i < LOG_ARGS; i++) {
+            n += log_put_varint(&buf[n], rec->arg[i]);
+        }
+    }
+    uint8_t sum = 0;
+    for (uint32_t i = 1; i < n; i++) {
+        sum += buf[i];
+    }
+    buf[n++] = (uint8_t)~sum;
+    return n;
+}
+
+/**
+ * @brief Read a varint.
+ *
+ * @return Bytes used, 0 if the buffer ends first, -1 if it is too long.
+ */
+static int32_t log_get_varint(const uint8_t *p, uint32_t len, uint32_t *v) {
+    *v = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        if (i == 5) {
+            return -1;
+        }
+        *v |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            return (int32_t)i + 1;
+        }
+    }
+    return len >= 5 ? -1 : 0;
+}
+
+/**
+ * @brief Parse one binary frame at the start of a buffer.
+ *
+ * @return Bytes used by the frame, 0 if the buffer holds only part of it,
+ *         -1 if it is not a valid frame (skip one byte and retry).
+ */
+int32_t log_decode(const uint8_t *buf, uint32_t len, log_record_t *rec) {
+    uint32_t n = 2;
+    int32_t used;
+    if (len < 1) {
+        return 0;
+    }
+    if (buf[0] != LOG_FRAME_MAGIC) {
+        return -1;
+    }
+    if (len < 2) {
+        return 0;
+    }
+    memset(rec, 0, sizeof(*rec));
+    rec->id = buf[1];
+    uint8_t args = log_msg_args(rec->id);
+    if (rec->id >= LOG_MSG_COUNT) {
+        return -1;
+    }
+    used = log_get_varint(&buf[n], len - n, &rec->time);
+    if (used <= 0) {
+        return used;
+    }
+    n += (uint32_t)used;
+    if (args == LOG_TEXT) {
+        if (n >= len) {
+            return 0;
+        }
+        uint8_t t = buf[n++];
+        if (t > LOG_TEXT_LEN) {
+            return -1;
+        }
+        if (n + t > len) {
+            return 0;
+        }
+        memcpy(rec->text, &buf[n], t);
+        n += t;
+    } else {
+        for (uint32_t i = 0; i < args; i++) {
+            used = log_get_varint(&buf[n], len - n, &rec->arg[i]);
+            if (used <= 0) {
+                return used;
+            }
+            n += (uint32_t)used;
+        }
+    }
+    if (n >= len) {
+        return 0;
+    }
+    uint8_t sum = 0;
+    for (uint32_t i = 1; i < n; i++) {
+        sum += buf[i];
+    }
+    sum = (uint8_t)~sum;
+    return buf[n] == sum ? (int32_t)n + 1 : -1;
+}
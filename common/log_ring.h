@@ -0,0 +1,102 @@
+/**
+ * @file log_ring.h
+ * @brief Deferred logging: fixed-size binary records, formatted later.
+ *
+ * Interrupt handlers and hot loops never call printf. They store a record
+ * (time, message id from log_msgs.h, up to LOG_ARGS integers or a short
+ * text) in a lock-free ring; a record that does not fit is counted as
+ * dropped instead of waiting. Every producer context (each interrupt
+ * priority, the main loop, each core) has its own single-producer ring, so
+ * a put is a few stores and an index release, as in mailbox.c.
+ *
+ * A low-priority drain takes the records of all its rings, oldest first,
+ * and sends them through a write callback either as the text of the
+ * catalog or, in telemetry mode, as compact binary frames:
+ *
+ *     0xA5, id, varint time (us), args as varints | text length + bytes, check
+ *
+ * where check is the complement of the 8-bit sum of the bytes after 0xA5.
+ * Periodic state (the status records) then costs a few bytes per second,
+ * and host/log_decode.c turns the stream back into text. When a ring has
+ * dropped records the drain sends a LOG_DROPPED record first.
+ */
+
+// Avoid duplication in code
+#ifndef _LOG_RING_H_
+#define _LOG_RING_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "log_msgs.h"
+
+#define LOG_RING_DEPTH 32 ///< Registros por anillo (potencia de 2)
+#define LOG_ARGS 4 ///< Argumentos por registro
+#define LOG_TEXT_LEN (LOG_ARGS * 4) ///< Caracteres de un argumento de texto
+#define LOG_MAX_RINGS 4 ///< Anillos por drenaje
+#define LOG_FRAME_MAGIC 0xA5 ///< Primer byte de una trama binaria
+#define LOG_FRAME_MAX (3 + 5 + LOG_ARGS * 5) ///< Bytes de la trama mas larga
+#define LOG_LINE_MAX 96 ///< Caracteres de un mensaje con formato
+
+/**
+ * @brief One log record.
+ */
+typedef struct {
+    uint32_t time;                  ///< Instante (us)
+    uint16_t id;                    ///< Mensaje (LOG_*)
+    uint16_t ring;                  ///< Anillo de origen (lo pone el drenaje)
+    union {
+        uint32_t arg[LOG_ARGS];     ///< Argumentos enteros
+        char text[LOG_TEXT_LEN];    ///< Argumento de texto (sin terminador si ocupa todo)
+    };
+} log_record_t;
+
+/**
+ * @brief Single-producer ring of records.
+ */
+typedef struct {
+    log_record_t slot[LOG_RING_DEPTH]; ///< Registros
+    _Atomic uint32_t head;             ///< Registros escritos (solo el productor)
+    _Atomic uint32_t tail;             ///< Registros leidos (solo el drenaje)
+    _Atomic uint32_t dropped;          ///< Registros descartados por anillo lleno (solo el productor)
+} log_ring_t;
+
+/**
+ * @brief Output of the drain.
+ */
+typedef void (*log_write_t)(const uint8_t *buf, uint32_t len, void *ctx);
+
+/**
+ * @brief Drain of several rings.
+ */
+typedef struct {
+    log_ring_t *ring[LOG_MAX_RINGS];        ///< Anillos drenados
+    uint32_t dropped_seen[LOG_MAX_RINGS];   ///< Descartes ya informados de cada anillo
+    uint32_t count;                         ///< Anillos registrados
+    bool binary;                            ///< Tramas binarias (telemetria) en vez de texto
+    log_write_t write;                      ///< Salida
+    void *ctx;                              ///< Contexto de la salida
+} log_drain_t;
+
+void log_ring_init(log_ring_t *r);
+bool log_put(log_ring_t *r, uint16_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+bool log_put_text(log_ring_t *r, uint16_t id, const char *text);
+bool log_take(log_ring_t *r, log_record_t *rec);
+uint32_t log_dropped(const log_ring_t *r);
+
+void log_drain_init(log_drain_t *d, log_write_t write, void *ctx);
+bool log_drain_add(log_drain_t *d, log_ring_t *r);
+void log_drain_set_binary(log_drain_t *d, bool binary);
+uint32_t log_drain_step(log_drain_t *d, uint32_t max);
+uint32_t log_drain_dropped(const log_drain_t *d);
+
+uint8_t log_msg_args(uint16_t id);
+uint32_t log_format(const log_record_t *rec, char *buf, uint32_t len);
+uint32_t log_encode(const log_record_t *rec, uint8_t *buf, uint32_t len);
+int32_t log_decode(const uint8_t *buf, uint32_t len, log_record_t *rec);
+
+// Backend
+uint32_t log_hw_now(void);
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * @file log_rp2040.c
+ * @brief RP2040 clock of the deferred log.
+ */
+
+#include "log_ring.h"
+
+#include "pico/stdlib.h"
+
+/**
+ * @brief Time stamp of a record in microseconds (wraps every 71 minutes).
+ */
+uint32_t log_hw_now(void) {
+    return time_us_32();
+}
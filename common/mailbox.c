@@ -0,0 +1,71 @@
+/**
+ * @file mailbox.c
+ * @brief SPSC mailbox of parameter sets.
+ *
+ * The producer owns @c head and the consumer owns @c tail; each side only
+ * reads the other's index. A slot is written before @c head is released and
+ * read before @c tail is released, so neither side can see a half-copied
+ * message.
+ */
+
+#include "mailbox.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize an empty mailbox.
+ */
+void mailbox_init(mailbox_t *m) {
+    memset(m->slot, 0, sizeof(m->slot));
+    atomic_init(&m->head, 0);
+    atomic_init(&m->tail, 0);
+}
+
+/**
+ * @brief Queue a parameter set (producer side).
+ *
+ * @param m Mailbox.
+ * @param msg Parameter set, copied into the mailbox.
+ * @return false if the mailbox is full.
+ */
+bool mailbox_post(mailbox_t *m, const siggen_params_t *msg) {
+    uint32_t head = atomic_load_explicit(&m->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&m->tail, memory_order_acquire);
+    if (head - tail >= MAILBOX_DEPTH) {
+        return false;
+    }
+    m->slot[head % MAILBOX_DEPTH] = *msg;
+    atomic_store_explicit(&m->head, head + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Take the oldest parameter set (consumer side).
+ *
+ * @param m Mailbox.
+ * @param msg Destination.
+ * @return false if the mailbox is empty.
+ */
+bool mailbox_take(mailbox_t *m, siggen_params_t *msg) {
+    uint32_t tail = atomic_load_explicit(&m->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&m->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *msg = m->slot[tail % MAILBOX_DEPTH];
+    atomic_store_explicit(&m->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Drain the mailbox, keeping only the newest parameter set.
+ *
+ * @return false if the mailbox was empty (@p msg is left untouched).
+ */
+bool mailbox_take_latest(mailbox_t *m, siggen_params_t *msg) {
+    bool any = false;
+    while (mailbox_take(m, msg)) {
+        any = true;
+    }
+    return any;
+}
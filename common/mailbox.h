@@ -0,0 +1,52 @@
+/**
+ * @file mailbox.h
+ * @brief Lock-free single-producer/single-consumer mailbox of parameter sets.
+ *
+ * Carries complete parameter sets from the UI side to the sample engine,
+ * possibly on the other core. Every message is a whole snapshot, so the
+ * engine never sees an amplitude from one command next to an offset from
+ * another. Only plain 32-bit atomic loads and stores are used, which the
+ * Cortex-M0+ provides without exclusive-access instructions.
+ */
+
+// Avoid duplication in code
+#ifndef _MAILBOX_H_
+#define _MAILBOX_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAILBOX_DEPTH 8 ///< Mensajes en cola (potencia de 2)
+
+/**
+ * @brief Parameters of the sample engine.
+ */
+typedef struct {
+    uint8_t shape;      ///< Forma de onda (WAVEFORM_*)
+    uint32_t amplitude; ///< Amplitud en mV pico a pico
+    uint32_t offset;    ///< Offset en mV
+    uint32_t freq_mhz;  ///< Frecuencia en mHz
+    uint32_t phase_deg; ///< Desfase del segundo canal en grados (SIGGEN_IQ_OUTPUT)
+    uint8_t mod;        ///< Modulacion (MOD_*)
+    uint32_t mod_arg;   ///< Fin del barrido o desviacion de FM (mHz), profundidad de AM (%)
+    uint32_t mod_time;  ///< Duracion del barrido (ms) o frecuencia moduladora (mHz)
+    uint32_t user_gen;  ///< Tablas cargadas por el puerto serie (0: ninguna)
+    uint32_t at_phase;  ///< Fase en la que entra el cambio (2^32 = un periodo, 0: fin del periodo)
+} siggen_params_t;
+
+/**
+ * @brief SPSC ring of parameter sets.
+ */
+typedef struct {
+    siggen_params_t slot[MAILBOX_DEPTH]; ///< Mensajes
+    _Atomic uint32_t head;               ///< Mensajes escritos (solo el productor)
+    _Atomic uint32_t tail;               ///< Mensajes leidos (solo el consumidor)
+} mailbox_t;
+
+void mailbox_init(mailbox_t *m);
+bool mailbox_post(mailbox_t *m, const siggen_params_t *msg);
+bool mailbox_take(mailbox_t *m, siggen_params_t *msg);
+bool mailbox_take_latest(mailbox_t *m, siggen_params_t *msg);
+
+#endif
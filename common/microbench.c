@@ -0,0 +1,228 @@
+/**
+ * @file microbench.c
+ * @brief Kernel variants and runner of the microbenchmark suite.
+ *
+ * - scale: the old generator() (table pick and both divisions of the
+ *   scaling on every sample), the scaling precomputed (one division per
+ *   sample) and the active waveform cache (a table read).
+ * - lookup_<shape>: one point of the shape from the full table, from the
+ *   quarter-wave table unfolded at run time, and synthesized from the
+ *   phase with integer arithmetic (a parabola for the sine).
+ * - bus: writing a code on the DAC bus with eight gpio_put, one
+ *   gpio_put_masked, or toggling only the bits that changed.
+ * - empty: the loop and the batch timing alone.
+ */
+
+#include "microbench.h"
+
+#include <stdio.h>
+
+static uint8_t raw_table[WAVE_CACHE_MAX_LEN + WAVE_CACHE_PAD]; ///< Tabla de la forma reducida a 8 bits
+static wave_cache_t bench_cache;
+
+/**
+ * @brief Point index of the current phase, then advance the phase.
+ */
+static inline uint32_t microbench_index(dds_t *d) {
+    uint32_t phase = d->phase;
+    d->phase = phase + d->tuning;
+    return d->shift ? phase >> d->shift : (uint32_t)(((uint64_t)phase * d->length) >> 32);
+}
+
+static inline void microbench_mix(microbench_ctx_t *c, uint32_t v) {
+    c->check = c->check * 31u + v;
+}
+
+static void scale_generator(microbench_ctx_t *c, uint32_t ops) {
+    volatile uint32_t *amp = &c->amplitude; ///< el firmware los relee en cada muestra
+    volatile uint32_t *dc = &c->offset;
+    for (uint32_t i = 0; i < ops; i++) {
+        microbench_mix(c, waveform_scale(dds_next(&c->dds, raw_table), *amp, *dc));
+    }
+}
+
+static void scale_precomputed(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        microbench_mix(c, waveform_apply(dds_next(&c->dds, raw_table), c->k));
+    }
+}
+
+static void scale_cached(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        microbench_mix(c, wave_cache_next(c->cache, &c->dds));
+    }
+}
+
+#if !WAVEFORM_COMPACT
+static void lookup_table(microbench_ctx_t *c, uint32_t ops) {
+    const waveform_sample_t *table = waveform_table(c->shape);
+    for (uint32_t i = 0; i < ops; i++) {
+        microbench_mix(c, waveform_to_dac(table[microbench_index(&c->dds)]));
+    }
+}
+#endif
+
+static void lookup_compact(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        microbench_mix(c, waveform_to_dac(waveform_compact_at(c->shape, microbench_index(&c->dds))));
+    }
+}
+
+/**
+ * @brief 8-bit point of a shape computed from the phase alone.
+ */
+static inline uint8_t synth_point(uint8_t shape, uint32_t phase) {
+    switch (shape) {
+    case WAVEFORM_TRIANGLE: {
+        uint32_t t = phase >> 23; ///< 0-511: sube en la primera mitad, baja en la segunda
+        return (uint8_t)(t < 256 ? t : 511 - t);
+    }
+    case WAVEFORM_SAWTOOTH:
+        return (uint8_t)((phase >> 24) + 128);
+    case WAVEFORM_SQUARE:
+        return phase < 0x80000000u ? 255 : 0;
+    default: {
+        uint32_t half = (phase >> 16) & 0x7FFF; ///< posicion dentro del semiperiodo
+        uint32_t y = (half * (0x8000 - half)) >> 21; ///< parabola, 0-128
+        if (y > 127) {
+            y = 127;
+        }
+        return (uint8_t)(phase < 0x80000000u ? 128 + y : 128 - y);
+    }
+    }
+}
+
+static void lookup_synth(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        uint32_t phase = c->dds.phase;
+        c->dds.phase = phase + c->dds.tuning;
+        microbench_mix(c, synth_point(c->shape, phase));
+    }
+}
+
+static void bus_put8(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        uint8_t code = wave_cache_next(c->cache, &c->dds);
+        microbench_hw_bus_put8(code);
+        microbench_mix(c, code);
+    }
+}
+
+static void bus_masked(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        uint8_t code = wave_cache_next(c->cache, &c->dds);
+        microbench_hw_bus_masked(code);
+        microbench_mix(c, code);
+    }
+}
+
+static void bus_toggle(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        uint8_t code = wave_cache_next(c->cache, &c->dds);
+        microbench_hw_bus_toggle(code);
+        microbench_mix(c, code);
+    }
+}
+
+static void empty(microbench_ctx_t *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        microbench_mix(c, i);
+    }
+}
+
+#if WAVEFORM_COMPACT
+#define LOOKUP(name, shape) \
+    { name, "compact", shape, lookup_compact }, { name, "synth", shape, lookup_synth }
+#else
+#define LOOKUP(name, shape) \
+    { name, "table", shape, lookup_table }, { name, "compact", shape, lookup_compact }, \
+    { name, "synth", shape, lookup_synth }
+#endif
+
+const microbench_t microbench_suite[] = {
+    { "scale", "generator", WAVEFORM_SINE, scale_generator },
+    { "scale", "precomputed", WAVEFORM_SINE, scale_precomputed },
+    { "scale", "cached", WAVEFORM_SINE, scale_cached },
+    LOOKUP("lookup_sine", WAVEFORM_SINE),
+    LOOKUP("lookup_triangle", WAVEFORM_TRIANGLE),
+    LOOKUP("lookup_sawtooth", WAVEFORM_SAWTOOTH),
+    LOOKUP("lookup_square", WAVEFORM_SQUARE),
+    { "bus", "put8", WAVEFORM_SINE, bus_put8 },
+    { "bus", "masked", WAVEFORM_SINE, bus_masked },
+    { "bus", "toggle", WAVEFORM_SINE, bus_toggle },
+    { "empty", "loop", WAVEFORM_SINE, empty },
+};
+
+const uint32_t microbench_count = sizeof(microbench_suite) / sizeof(microbench_suite[0]);
+
+/**
+ * @brief Start a kernel from the same state on every target.
+ */
+static void microbench_reset(microbench_ctx_t *c, uint8_t shape) {
+    c->shape = shape;
+    c->amplitude = 1000;
+    c->offset = 100;
+    c->k = waveform_scaling(c->amplitude, c->offset);
+    c->cache = &bench_cache;
+    c->check = 0;
+    dds_init(&c->dds, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&c->dds, 1234567, 20000); ///< 1234.567 Hz a 20 kHz: recorre todos los puntos
+    wave_cache_init(&bench_cache, WAVEFORM_LENGTH);
+    wave_cache_rebuild_shape(&bench_cache, shape, c->amplitude, c->offset);
+    wave_cache_swap(&bench_cache);
+    for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+        raw_table[i] = waveform_to_dac(waveform_at(shape, i));
+    }
+}
+
+/**
+ * @brief Time one kernel variant.
+ *
+ * One warm-up batch runs first (caches, flash XIP), then the state is
+ * reset and @p ops operations are timed batch by batch.
+ *
+ * @param b Kernel variant.
+ * @param ops Operations to time.
+ * @param r Result.
+ */
+void microbench_run(const microbench_t *b, uint32_t ops, microbench_result_t *r) {
+    microbench_ctx_t c;
+    microbench_reset(&c, b->shape);
+    b->run(&c, MICROBENCH_BATCH);
+    microbench_reset(&c, b->shape);
+
+    r->ops = ops;
+    r->ticks = 0;
+    for (uint32_t done = 0; done < ops;) {
+        uint32_t n = ops - done < MICROBENCH_BATCH ? ops - done : MICROBENCH_BATCH;
+        uint32_t start = microbench_hw_ticks();
+        b->run(&c, n);
+        r->ticks += microbench_hw_elapsed(start, microbench_hw_ticks());
+        done += n;
+    }
+    r->check = c.check;
+}
+
+/**
+ * @brief CSV header of the suite.
+ *
+ * @return Length written.
+ */
+uint32_t microbench_csv_header(char *buf, uint32_t len) {
+    int n = snprintf(buf, len, "target,kernel,variant,ops,ticks,tick_hz,ns_per_op,ticks_per_op,check\n");
+    return n < 0 ? 0 : (uint32_t)n;
+}
+
+/**
+ * @brief CSV line of one result.
+ *
+ * @return Length written.
+ */
+uint32_t microbench_csv_line(const microbench_t *b, const microbench_result_t *r, char *buf, uint32_t len) {
+    uint32_t hz = microbench_hw_tick_hz();
+    double per_op = r->ops ? (double)r->ticks / r->ops : 0.0;
+    int n = snprintf(buf, len, "%s,%s,%s,%lu,%llu,%lu,%.3f,%.3f,%08lx\n", microbench_hw_target(), b->kernel,
+                     b->variant, (unsigned long)r->ops, (unsigned long long)r->ticks, (unsigned long)hz,
+                     per_op * 1e9 / hz, per_op, (unsigned long)r->check);
+    return n < 0 ? 0 : (uint32_t)n;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file microbench.h
+ * @brief Microbenchmarks of the sample path kernels, same code on host and RP2040.
+ *
+ * Each kernel runs a number of operations (one sample, one table point or
+ * one bus write) in batches, and the runner accumulates the ticks of every
+ * batch. A tick is a CPU cycle on the RP2040 (SysTick, which is 24 bits
+ * wide, hence the short batches) and a nanosecond of the steady clock on
+ * the host. Both print the same CSV:
+ *
+ *     target,kernel,variant,ops,ticks,tick_hz,ns_per_op,ticks_per_op,check
+ *
+ * @c check is a checksum of everything the kernel produced: variants of
+ * the same kernel that compute the same thing print the same value, on
+ * every target. The "synth" lookups are approximations of the tables and
+ * differ on purpose.
+ *
+ * The timer and the DAC bus come from a backend (microbench_rp2040.c on
+ * the board, host/microbench_host.c on Linux).
+ */
+
+// Avoid duplication in code
+#ifndef _MICROBENCH_H_
+#define _MICROBENCH_H_
+
+#include <stdint.h>
+
+#include "dds.h"
+#include "wave_cache.h"
+#include "waveform.h"
+
+#define MICROBENCH_BATCH 256 ///< Operaciones entre dos lecturas del contador
+#define MICROBENCH_BUS_MASK ((0x7Fu << 16) | (1u << 26)) ///< D0-D6 en GPIO16-22, D7 en GPIO26
+
+/**
+ * @brief GPIO levels of a DAC code on the c_irq/c_pol wiring.
+ */
+static inline uint32_t microbench_bus_bits(uint8_t code) {
+    return ((uint32_t)(code & 0x7F) << 16) | ((uint32_t)(code & 0x80) << 19);
+}
+
+/**
+ * @brief State shared by the kernels of one run.
+ */
+typedef struct {
+    dds_t dds;                 ///< Fase del recorrido
+    wave_cache_t *cache;       ///< Periodo ya escalado
+    waveform_scaling_t k;      ///< Escalado precalculado
+    uint32_t amplitude;        ///< Amplitud (mV pico a pico)
+    uint32_t offset;           ///< Offset (mV)
+    uint8_t shape;             ///< Forma de onda
+    uint32_t check;            ///< Suma de comprobacion de lo producido
+} microbench_ctx_t;
+
+/**
+ * @brief One kernel variant.
+ */
+typedef struct {
+    const char *kernel;                              ///< Nucleo medido
+    const char *variant;                             ///< Variante
+    uint8_t shape;                                   ///< Forma de onda usada
+    void (*run)(microbench_ctx_t *c, uint32_t ops);  ///< Ejecuta @p ops operaciones
+} microbench_t;
+
+/**
+ * @brief Result of one kernel variant.
+ */
+typedef struct {
+    uint32_t ops;   ///< Operaciones medidas
+    uint64_t ticks; ///< Ticks acumulados
+    uint32_t check; ///< Suma de comprobacion
+} microbench_result_t;
+
+extern const microbench_t microbench_suite[];
+extern const uint32_t microbench_count;
+
+void microbench_run(const microbench_t *b, uint32_t ops, microbench_result_t *r);
+uint32_t microbench_csv_header(char *buf, uint32_t len);
+uint32_t microbench_csv_line(const microbench_t *b, const microbench_result_t *r, char *buf, uint32_t len);
+
+// Backend
+void microbench_hw_init(void);
+const char *microbench_hw_target(void);
+uint32_t microbench_hw_tick_hz(void);
+uint32_t microbench_hw_ticks(void);
+uint32_t microbench_hw_elapsed(uint32_t start, uint32_t end);
+void microbench_hw_bus_put8(uint8_t code);
+void microbench_hw_bus_masked(uint8_t code);
+void microbench_hw_bus_toggle(uint8_t code);
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file microbench_rp2040.c
+ * @brief SysTick cycle counter and SIO bus writes of the microbenchmarks.
+ *
+ * SysTick counts processor clock cycles down from 2^24 - 1 and wraps every
+ * 134 ms at 125 MHz, much longer than a batch of the runner.
+ */
+
+#include "microbench.h"
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/structs/systick.h"
+
+#define SYSTICK_MAX 0x00FFFFFFu ///< Cuenta de 24 bits
+
+static uint32_t bus_last; ///< Niveles escritos por la ultima conmutacion
+
+/**
+ * @brief Start SysTick on the processor clock and drive the DAC bus pins.
+ */
+void microbench_hw_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; ///< ENABLE | CLKSOURCE (reloj del procesador), sin interrupcion
+    gpio_init_mask(MICROBENCH_BUS_MASK);
+    gpio_set_dir_out_masked(MICROBENCH_BUS_MASK);
+    gpio_put_masked(MICROBENCH_BUS_MASK, 0);
+    bus_last = 0;
+}
+
+const char *microbench_hw_target(void) {
+    return "rp2040";
+}
+
+uint32_t microbench_hw_tick_hz(void) {
+    return clock_get_hz(clk_sys);
+}
+
+uint32_t microbench_hw_ticks(void) {
+    return systick_hw->cvr;
+}
+
+/**
+ * @brief Cycles between two readings of the down counter.
+ */
+uint32_t microbench_hw_elapsed(uint32_t start, uint32_t end) {
+    return (start - end) & SYSTICK_MAX;
+}
+
+/**
+ * @brief Bus write of set_dac_value(): one gpio_put per line.
+ */
+void microbench_hw_bus_put8(uint8_t code) {
+    gpio_put(16, code & 0x01);
+    gpio_put(17, code & 0x02);
+    gpio_put(18, code & 0x04);
+    gpio_put(19, code & 0x08);
+    gpio_put(20, code & 0x10);
+    gpio_put(21, code & 0x20);
+    gpio_put(22, code & 0x40);
+    gpio_put(26, code & 0x80);
+}
+
+/**
+ * @brief Bus write with one masked SIO access (all lines change together).
+ */
+void microbench_hw_bus_masked(uint8_t code) {
+    gpio_put_masked(MICROBENCH_BUS_MASK, microbench_bus_bits(code));
+}
+
+/**
+ * @brief Bus write that toggles only the lines that changed.
+ */
+void microbench_hw_bus_toggle(uint8_t code) {
+    uint32_t bits = microbench_bus_bits(code);
+    gpio_xor_mask(bits ^ bus_last);
+    bus_last = bits;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file modulation.c
+ * @brief Set-up of the sweeps and the AM/FM modulators.
+ *
+ * The set-up runs outside the sample path and may use divisions and
+ * floating point; it fills a mod_t that the sample path only steps.
+ */
+
+#include "modulation.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Initialize an unmodulated state.
+ */
+void mod_init(mod_t *m) {
+    memset(m, 0, sizeof(*m));
+    m->kind = MOD_NONE;
+}
+
+/**
+ * @brief Load one period of a shape as the modulator, centered on zero.
+ */
+static void mod_load_wave(mod_t *m, uint8_t shape, uint32_t fm_mhz, uint32_t sample_rate_hz) {
+    for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+        int32_t v = 2 * (int32_t)waveform_at(shape, i) - (int32_t)WAVEFORM_FULL; ///< centrado: media nula
+        m->mod_wave[i] = (int16_t)((v * (MOD_Q15 - 1)) / (int32_t)WAVEFORM_FULL); ///< +-1 en Q15
+    }
+    dds_init(&m->mod_dds, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&m->mod_dds, fm_mhz, sample_rate_hz);
+}
+
+/**
+ * @brief Set up a frequency sweep.
+ *
+ * @param m Modulation.
+ * @param kind MOD_SWEEP_LIN or MOD_SWEEP_LOG.
+ * @param f0_mhz Start frequency in millihertz.
+ * @param f1_mhz End frequency in millihertz (may be lower than the start).
+ * @param duration_ms Time from the start to the end frequency.
+ * @param repeat Start over after the end (chirp train) instead of holding it.
+ * @param sample_rate_hz Sample clock in Hz.
+ * @return false if the sweep cannot be done (zero length, a log sweep from or
+ *         to 0 Hz, or a log step too large for the per-sample ratio).
+ */
+bool mod_sweep(mod_t *m, uint8_t kind, uint32_t f0_mhz, uint32_t f1_mhz, uint32_t duration_ms, bool repeat,
+               uint32_t sample_rate_hz) {
+    uint32_t samples = (uint32_t)(((uint64_t)duration_ms * sample_rate_hz) / 1000u);
+    uint32_t start = dds_tuning_word(f0_mhz, sample_rate_hz);
+    uint32_t end = dds_tuning_word(f1_mhz, sample_rate_hz);
+    int64_t step = 0;
+    int32_t ratio = 0;
+
+    if (samples == 0 || (kind != MOD_SWEEP_LIN && kind != MOD_SWEEP_LOG)) {
+        return false;
+    }
+    if (kind == MOD_SWEEP_LIN) {
+        int64_t diff = (int64_t)end - (int64_t)start;
+        uint64_t mag = (uint64_t)(diff < 0 ? -diff : diff);
+        uint64_t q32 = ((mag / samples) << 32) + (((mag % samples) << 32) / samples); ///< sin 128 bits
+        step = diff < 0 ? -(int64_t)q32 : (int64_t)q32;
+    } else {
+        if (start == 0 || end == 0) {
+            return false;
+        }
+        double r = expm1(log((double)end / start) / samples); ///< razon por muestra menos uno
+        if (fabs(r) >= 0.5) {
+            return false;
+        }
+        ratio = (int32_t)llround(r * 4294967296.0);
+    }
+    mod_init(m);
+    m->samples = samples;
+    m->start = start;
+    m->end = end;
+    m->tuning = (uint64_t)start << 32;
+    m->step = step;
+    m->ratio = ratio;
+    m->repeat = repeat;
+    m->kind = kind;
+    return true;
+}
+
+/**
+ * @brief Set up amplitude modulation of the carrier.
+ *
+ * @param m Modulation.
+ * @param depth_pct Modulation depth, 0-100 %.
+ * @param fm_mhz Modulating frequency in millihertz.
+ * @param shape Modulating waveform (WAVEFORM_*).
+ * @param Amp Carrier amplitude (mV peak to peak), as given to the cache.
+ * @param DC Carrier offset (mV), as given to the cache.
+ * @param sample_rate_hz Sample clock in Hz.
+ * @return false if the depth is above 100 %.
+ */
+bool mod_am(mod_t *m, uint32_t depth_pct, uint32_t fm_mhz, uint8_t shape, uint32_t Amp, uint32_t DC,
+            uint32_t sample_rate_hz) {
+    if (depth_pct > 100) {
+        return false;
+    }
+    waveform_scaling_t k = waveform_scaling(Amp, DC);
+    mod_init(m);
+    mod_load_wave(m, shape, fm_mhz, sample_rate_hz);
+    m->gain_base = (int32_t)((MOD_Q15 * 100u) / (100u + depth_pct));
+    m->gain_depth = (int32_t)((MOD_Q15 * depth_pct) / (100u + depth_pct));
+    m->center = (waveform_apply(0, k) + waveform_apply(255, k) + 1) / 2; ///< mitad del recorrido del DAC
+    m->kind = MOD_AM;
+    return true;
+}
+
+/**
+ * @brief Set up frequency modulation of the carrier.
+ *
+ * @param m Modulation.
+ * @param carrier_mhz Carrier frequency in millihertz.
+ * @param dev_mhz Peak deviation in millihertz.
+ * @param fm_mhz Modulating frequency in millihertz.
+ * @param shape Modulating waveform (WAVEFORM_*).
+ * @param sample_rate_hz Sample clock in Hz.
+ * @return false if the swing would reach 0 Hz or Nyquist.
+ */
+bool mod_fm(mod_t *m, uint32_t carrier_mhz, uint32_t dev_mhz, uint32_t fm_mhz, uint8_t shape,
+            uint32_t sample_rate_hz) {
+    uint32_t carrier = dds_tuning_word(carrier_mhz, sample_rate_hz);
+    uint32_t dev = dds_tuning_word(dev_mhz, sample_rate_hz);
+    if (dev >= carrier || (uint64_t)carrier + dev >= 0x7FFFFFFFu) {
+        return false;
+    }
+    mod_init(m);
+    mod_load_wave(m, shape, fm_mhz, sample_rate_hz);
+    m->start = carrier;
+    m->deviation = dev;
+    m->kind = MOD_FM;
+    return true;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file modulation.h
+ * @brief Frequency sweeps, chirps and AM/FM on top of the waveform cache.
+ *
+ * Everything that needs a division, a logarithm or floating point is
+ * worked out once by the set-up functions; per sample the engine only adds
+ * and multiplies integers:
+ *
+ * - Linear sweep: the tuning word, kept in Q32.32, grows by a constant step.
+ * - Log sweep: the tuning word is multiplied by a constant ratio, applied as
+ *   tuning * (ratio - 1) in Q32 (one 32x32 multiply).
+ * - AM: a gain in Q15 follows the modulator, (1 + m s) / (1 + m), so the
+ *   envelope peak is the carrier amplitude and the depth is m.
+ * - FM: the tuning word is the carrier plus the deviation times the
+ *   modulator, with 32-bit products only.
+ *
+ * A sweep ends on exactly the end frequency and then holds it, or starts
+ * over (a chirp train). The modulator is one period of a waveform shape in
+ * Q15 played by its own DDS.
+ */
+
+// Avoid duplication in code
+#ifndef _MODULATION_H_
+#define _MODULATION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dds.h"
+#include "wave_cache.h"
+#include "waveform.h"
+
+#define MOD_NONE 0       ///< Portadora sin modular
+#define MOD_SWEEP_LIN 1  ///< Barrido lineal de frecuencia
+#define MOD_SWEEP_LOG 2  ///< Barrido logaritmico de frecuencia
+#define MOD_AM 3         ///< Modulacion de amplitud
+#define MOD_FM 4         ///< Modulacion de frecuencia
+
+#define MOD_Q15 32768 ///< Uno en Q15
+
+/**
+ * @brief Modulation state.
+ */
+typedef struct {
+    uint8_t kind;                         ///< MOD_*
+    bool repeat;                          ///< El barrido vuelve a empezar al terminar
+    uint32_t count;                       ///< Muestras hechas del barrido
+    uint32_t samples;                     ///< Muestras del barrido
+    uint32_t start;                       ///< Sintonia inicial del barrido o de la portadora (FM)
+    uint32_t end;                         ///< Sintonia final del barrido
+    uint64_t tuning;                      ///< Sintonia actual del barrido (Q32.32)
+    int64_t step;                         ///< Incremento lineal por muestra (Q32.32)
+    int32_t ratio;                        ///< Razon logaritmica por muestra menos uno (Q32)
+    uint32_t deviation;                   ///< Desviacion de FM (palabra de sintonia)
+    int32_t gain_base;                    ///< Ganancia de AM con la moduladora en cero (Q15)
+    int32_t gain_depth;                   ///< Ganancia de AM por unidad de moduladora (Q15)
+    int32_t center;                       ///< Codigo del centro de la portadora
+    dds_t mod_dds;                        ///< Fase de la moduladora
+    int16_t mod_wave[WAVEFORM_LENGTH];    ///< Un periodo de la moduladora (Q15)
+} mod_t;
+
+void mod_init(mod_t *m);
+bool mod_sweep(mod_t *m, uint8_t kind, uint32_t f0_mhz, uint32_t f1_mhz, uint32_t duration_ms, bool repeat,
+               uint32_t sample_rate_hz);
+bool mod_am(mod_t *m, uint32_t depth_pct, uint32_t fm_mhz, uint8_t shape, uint32_t Amp, uint32_t DC,
+            uint32_t sample_rate_hz);
+bool mod_fm(mod_t *m, uint32_t carrier_mhz, uint32_t dev_mhz, uint32_t fm_mhz, uint8_t shape,
+            uint32_t sample_rate_hz);
+
+/**
+ * @brief Next modulator point (Q15) and advance its phase.
+ */
+static inline int32_t mod_wave_next(mod_t *m) {
+    uint32_t phase = m->mod_dds.phase;
+    m->mod_dds.phase = phase + m->mod_dds.tuning;
+    uint32_t idx = m->mod_dds.shift ? phase >> m->mod_dds.shift
+                                    : (uint32_t)(((uint64_t)phase * m->mod_dds.length) >> 32);
+    return m->mod_wave[idx];
+}
+
+/**
+ * @brief Tuning word of the next sample of a sweep.
+ */
+static inline uint32_t mod_sweep_next(mod_t *m) {
+    uint32_t t = (uint32_t)(m->tuning >> 32);
+    if (m->count == m->samples) {
+        if (m->repeat) {
+            m->count = 0;
+            m->tuning = (uint64_t)m->start << 32;
+        }
+        return m->end; ///< el ultimo punto es exacto, sin el error acumulado
+    }
+    m->count++;
+    if (m->kind == MOD_SWEEP_LIN) {
+        m->tuning += (uint64_t)m->step;
+    } else {
+        m->tuning += (uint64_t)((int64_t)t * m->ratio);
+    }
+    return t;
+}
+
+/**
+ * @brief Tuning word of the next sample of an FM carrier.
+ *
+ * deviation * s >> 15 is split in two 16-bit halves of the deviation so
+ * that both products fit in 32 bits.
+ */
+static inline uint32_t mod_fm_next(mod_t *m) {
+    int32_t s = mod_wave_next(m);
+    int32_t hi = (int32_t)(m->deviation >> 16) * s;
+    int32_t lo = (int32_t)(m->deviation & 0xFFFF) * s;
+    return m->start + (uint32_t)(hi * 2 + (lo >> 15));
+}
+
+/**
+ * @brief Apply the AM gain of the next sample to a carrier code.
+ */
+static inline uint8_t mod_am_next(mod_t *m, uint8_t code) {
+    int32_t gain = m->gain_base + ((m->gain_depth * mod_wave_next(m)) >> 15);
+    int32_t v = m->center + ((((int32_t)code - m->center) * gain) >> 15);
+    return (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+/**
+ * @brief Next DAC code of the modulated carrier.
+ *
+ * @param m Modulation.
+ * @param c Scaled carrier period.
+ * @param d Carrier DDS; sweeps and FM rewrite its tuning word every sample.
+ * @return DAC code.
+ */
+static inline uint8_t mod_next(mod_t *m, wave_cache_t *c, dds_t *d) {
+    switch (m->kind) {
+    case MOD_SWEEP_LIN:
+    case MOD_SWEEP_LOG:
+        d->tuning = mod_sweep_next(m);
+        return wave_cache_next(c, d);
+    case MOD_FM:
+        d->tuning = mod_fm_next(m);
+        return wave_cache_next(c, d);
+    case MOD_AM:
+        return mod_am_next(m, wave_cache_next(c, d));
+    default:
+        return wave_cache_next(c, d);
+    }
+}
+
+#endif
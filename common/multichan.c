@@ -0,0 +1,148 @@
+/**
+ * @file multichan.c
+ * @brief Set-up, pin maps and period rebuilds of the multi-channel engine.
+ *
+ * Rebuilds run on the core that owns the engine, outside the sample
+ * interrupt, and may be preempted by it (see wave_cache.c).
+ */
+
+#include "multichan.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize the channels with no pins and silent periods.
+ *
+ * @param m Engine.
+ * @param count Channels (at most MULTICHAN_MAX).
+ * @param length Points per period.
+ */
+void multichan_init(multichan_t *m, uint32_t count, uint32_t length) {
+    memset(m, 0, sizeof(*m));
+    m->count = count > MULTICHAN_MAX ? MULTICHAN_MAX : count;
+    dds_init(&m->dds, length, false);
+    for (uint32_t c = 0; c < MULTICHAN_MAX; c++) {
+        wave_cache_init(&m->cache[c], length);
+        m->table[c] = m->cache[c].buf[0];
+    }
+}
+
+/**
+ * @brief Wire a channel's bus.
+ *
+ * @param m Engine.
+ * @param ch Channel.
+ * @param pins GPIO of D0..D7.
+ * @return false if a pin does not exist or is already used by another line.
+ */
+bool multichan_set_pins(multichan_t *m, uint32_t ch, const uint8_t pins[MULTICHAN_BITS]) {
+    uint32_t mask = 0;
+    uint32_t others = 0;
+    if (ch >= m->count) {
+        return false;
+    }
+    for (uint32_t c = 0; c < m->count; c++) {
+        if (c != ch) {
+            others |= m->lut_lo[c][15] | m->lut_hi[c][15];
+        }
+    }
+    for (uint32_t b = 0; b < MULTICHAN_BITS; b++) {
+        if (pins[b] >= MULTICHAN_GPIOS) {
+            return false;
+        }
+        uint32_t bit = 1u << pins[b];
+        if ((mask | others) & bit) {
+            return false;
+        }
+        mask |= bit;
+    }
+    for (uint32_t v = 0; v < 16; v++) {
+        uint32_t lo = 0;
+        uint32_t hi = 0;
+        for (uint32_t b = 0; b < 4; b++) {
+            if (v & (1u << b)) {
+                lo |= 1u << pins[b];
+                hi |= 1u << pins[b + 4];
+            }
+        }
+        m->lut_lo[ch][v] = lo;
+        m->lut_hi[ch][v] = hi;
+    }
+    m->bus_mask = others | mask;
+    return true;
+}
+
+/**
+ * @brief Rebuild a channel's period; it plays from the next wrap.
+ *
+ * @param band Band-limited table of the shape (waveform_band(), 0: the plain table).
+ */
+void multichan_set_wave(multichan_t *m, uint32_t ch, uint8_t shape, uint32_t band, uint32_t Amp, uint32_t DC) {
+    if (ch >= m->count) {
+        return;
+    }
+    m->shape[ch] = shape;
+    m->amplitude[ch] = Amp;
+    m->offset[ch] = DC;
+    wave_cache_begin(&m->cache[ch]);
+    wave_cache_fill_band(&m->cache[ch], shape, band, Amp, DC);
+    wave_cache_commit(&m->cache[ch], 0, 0);
+    m->pending = 1; ///< despues del pending del canal: el swap los encuentra en ese orden
+}
+
+/**
+ * @brief Set a channel's phase offset; it applies from the next tick.
+ *
+ * @param phase Offset as a fraction of the period (2^32 = one period).
+ */
+void multichan_set_phase(multichan_t *m, uint32_t ch, uint32_t phase) {
+    if (ch < m->count) {
+        m->phase[ch] = phase;
+    }
+}
+
+/**
+ * @brief Phase offset of a whole number of degrees.
+ */
+uint32_t multichan_phase_deg(uint32_t deg) {
+    return (uint32_t)(((uint64_t)(deg % 360) << 32) / 360);
+}
+
+/**
+ * @brief Make every pending period active right away.
+ *
+ * Only for use while the sample path is stopped (start-up).
+ */
+void multichan_swap(multichan_t *m) {
+    for (uint32_t c = 0; c < m->count; c++) {
+        wave_cache_swap(&m->cache[c]);
+        m->table[c] = m->cache[c].buf[m->cache[c].active];
+    }
+    m->pending = 0;
+}
+
+/**
+ * @brief Activate the pending periods at a wrap of the shared phase.
+ *
+ * Called from multichan_tick() in the sample path.
+ */
+void multichan_wrap(multichan_t *m) {
+    m->pending = 0;
+    atomic_signal_fence(memory_order_seq_cst); ///< un canal publicado despues se ve en el siguiente cruce
+    for (uint32_t c = 0; c < m->count; c++) {
+        wave_cache_t *cache = &m->cache[c];
+        if (cache->pending) {
+            wave_cache_apply(cache, &m->dds);
+            m->table[c] = cache->buf[cache->active];
+        }
+    }
+}
+
+/**
+ * @brief Produce @p n ticks of bus levels.
+ */
+void multichan_fill(multichan_t *m, uint32_t *out, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        out[i] = multichan_tick(m);
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file multichan.h
+ * @brief Phase-locked multi-channel generation with structure-of-arrays state.
+ *
+ * All channels share one sample clock and one phase accumulator; each one
+ * adds its own phase offset and reads its own scaled period, so I/Q pairs
+ * or a reference plus a shifted copy stay locked by construction. Per-tick
+ * work is one phase update, then per channel an add, a shift, a table load
+ * and two lookups that map the code onto that channel's GPIO pins; the bus
+ * levels of every channel come out as one word for a single masked write.
+ * The fixed part of a tick (interrupt, phase, bus write) is paid once, so
+ * the cost grows much slower than the channel count.
+ *
+ * The state the tick reads is kept per field across channels (offsets,
+ * active tables, pin lookups), apart from the double-buffered periods,
+ * which are rebuilt like wave_cache.h: a change of shape, amplitude or
+ * offset becomes active at the next wrap of the shared phase.
+ */
+
+// Avoid duplication in code
+#ifndef _MULTICHAN_H_
+#define _MULTICHAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dds.h"
+#include "wave_cache.h"
+
+#define MULTICHAN_MAX 3 ///< Canales por motor (8 lineas cada uno en 30 GPIO)
+#define MULTICHAN_BITS 8 ///< Lineas del bus de cada canal
+#define MULTICHAN_GPIOS 30 ///< GPIO del banco 0
+
+/**
+ * @brief Channels sharing one sample clock.
+ */
+typedef struct {
+    dds_t dds;                                ///< Fase y sintonia compartidas
+    uint32_t count;                           ///< Canales activos
+    uint32_t phase[MULTICHAN_MAX];            ///< Desfase de cada canal (2^32 = un periodo)
+    const uint8_t *table[MULTICHAN_MAX];      ///< Periodo activo de cada canal
+    uint32_t lut_lo[MULTICHAN_MAX][16];       ///< Niveles GPIO de los bits 0-3 del codigo
+    uint32_t lut_hi[MULTICHAN_MAX][16];       ///< Niveles GPIO de los bits 4-7 del codigo
+    uint32_t bus_mask;                        ///< Pines de todos los canales
+    volatile uint8_t pending;                 ///< Algun canal tiene un periodo nuevo
+    uint8_t shape[MULTICHAN_MAX];             ///< Forma de onda de cada canal
+    uint32_t amplitude[MULTICHAN_MAX];        ///< Amplitud de cada canal (mV pico a pico)
+    uint32_t offset[MULTICHAN_MAX];           ///< Offset de cada canal (mV)
+    wave_cache_t cache[MULTICHAN_MAX];        ///< Periodos escalados (activo y de respaldo)
+} multichan_t;
+
+void multichan_init(multichan_t *m, uint32_t count, uint32_t length);
+bool multichan_set_pins(multichan_t *m, uint32_t ch, const uint8_t pins[MULTICHAN_BITS]);
+void multichan_set_wave(multichan_t *m, uint32_t ch, uint8_t shape, uint32_t band, uint32_t Amp, uint32_t DC);
+void multichan_set_phase(multichan_t *m, uint32_t ch, uint32_t phase);
+uint32_t multichan_phase_deg(uint32_t deg);
+void multichan_swap(multichan_t *m);
+void multichan_wrap(multichan_t *m);
+void multichan_fill(multichan_t *m, uint32_t *out, uint32_t n);
+
+/**
+ * @brief One tick of every channel.
+ *
+ * @return GPIO levels of all the channel buses (write them under @c bus_mask).
+ */
+static inline uint32_t multichan_tick(multichan_t *m) {
+    uint32_t phase = m->dds.phase;
+    uint32_t next = phase + m->dds.tuning;
+    uint32_t bits = 0;
+
+    m->dds.phase = next;
+    for (uint32_t c = 0; c < m->count; c++) {
+        uint32_t p = phase + m->phase[c];
+        uint32_t idx = m->dds.shift ? p >> m->dds.shift : (uint32_t)(((uint64_t)p * m->dds.length) >> 32);
+        uint8_t code = m->table[c][idx];
+        bits |= m->lut_lo[c][code & 0xF] | m->lut_hi[c][code >> 4];
+    }
+    if (m->pending && (next < phase || m->dds.tuning == 0)) {
+        multichan_wrap(m);
+    }
+    return bits;
+}
+
+/**
+ * @brief Code of one channel in a word of bus levels.
+ */
+static inline uint8_t multichan_decode(const multichan_t *m, uint32_t ch, uint32_t bits) {
+    uint8_t code = 0;
+    for (uint32_t b = 0; b < MULTICHAN_BITS; b++) {
+        uint32_t pin = b < 4 ? m->lut_lo[ch][1u << b] : m->lut_hi[ch][1u << (b - 4)];
+        code |= (uint8_t)(((bits & pin) != 0) << b);
+    }
+    return code;
+}
+
+// Backend
+void multichan_hw_init(const multichan_t *m);
+void multichan_hw_put(const multichan_t *m, uint32_t bits);
+
+#endif
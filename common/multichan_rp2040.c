@@ -0,0 +1,27 @@
+/**
+ * @file multichan_rp2040.c
+ * @brief GPIO side of the multi-channel engine.
+ */
+
+#include "multichan.h"
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+/**
+ * @brief Drive the pins of every channel as outputs, all low.
+ *
+ * @param m Engine, with its pins already set.
+ */
+void multichan_hw_init(const multichan_t *m) {
+    gpio_init_mask(m->bus_mask);
+    gpio_set_dir_out_masked(m->bus_mask);
+    gpio_put_masked(m->bus_mask, 0);
+}
+
+/**
+ * @brief Write one tick of every channel with a single SIO access.
+ */
+void multichan_hw_put(const multichan_t *m, uint32_t bits) {
+    gpio_put_masked(m->bus_mask, bits);
+}
@@ -0,0 +1,189 @@
+/**
+ * @file param_txn.c
+ * @brief Staging, commit and engine side of the parameter transactions.
+ */
+
+#include "param_txn.h"
+
+#include "dds.h"
+#include "modulation.h"
+
+/**
+ * @brief Start a transaction from the parameters in use.
+ */
+void param_txn_begin(param_txn_t *t, const siggen_params_t *base) {
+    t->params = *base;
+    t->params.at_phase = 0;
+    t->staged = 0;
+}
+
+/**
+ * @brief Stage a shape (WAVEFORM_*).
+ */
+void param_txn_shape(param_txn_t *t, uint8_t shape) {
+    t->params.shape = shape;
+    t->staged |= PARAM_SHAPE;
+}
+
+/**
+ * @brief Stage an amplitude in mV peak to peak.
+ */
+void param_txn_amplitude(param_txn_t *t, uint32_t amplitude) {
+    t->params.amplitude = amplitude;
+    t->staged |= PARAM_AMPLITUDE;
+}
+
+/**
+ * @brief Stage an offset in mV.
+ */
+void param_txn_offset(param_txn_t *t, uint32_t offset) {
+    t->params.offset = offset;
+    t->staged |= PARAM_OFFSET;
+}
+
+/**
+ * @brief Stage a frequency in mHz.
+ */
+void param_txn_frequency(param_txn_t *t, uint32_t freq_mhz) {
+    t->params.freq_mhz = freq_mhz;
+    t->staged |= PARAM_FREQ;
+}
+
+/**
+ * @brief Stage the phase offset of the second channel, in degrees.
+ */
+void param_txn_phase(param_txn_t *t, uint32_t phase_deg) {
+    t->params.phase_deg = phase_deg;
+    t->staged |= PARAM_PHASE;
+}
+
+/**
+ * @brief Stage a modulation (MOD_* and its arguments, as in siggen_params_t).
+ */
+void param_txn_modulation(param_txn_t *t, uint8_t mod, uint32_t arg, uint32_t time) {
+    t->params.mod = mod;
+    t->params.mod_arg = arg;
+    t->params.mod_time = time;
+    t->staged |= PARAM_MOD;
+}
+
+/**
+ * @brief Make the transaction take effect at a phase instead of the period boundary.
+ *
+ * @param phase Fraction of the period (2^32 = one period).
+ */
+void param_txn_at(param_txn_t *t, uint32_t phase) {
+    t->params.at_phase = phase;
+}
+
+/**
+ * @brief Finish a transaction.
+ *
+ * @param t Transaction; empty again afterwards.
+ * @param out Complete parameter set to hand to the engine (untouched if nothing was staged).
+ * @return Fields staged (0: nothing to hand over).
+ */
+uint32_t param_txn_commit(param_txn_t *t, siggen_params_t *out) {
+    uint32_t staged = t->staged;
+    if (staged) {
+        *out = t->params;
+    }
+    t->staged = 0;
+    return staged;
+}
+
+/**
+ * @brief Fields that differ between two parameter sets.
+ */
+uint32_t param_txn_diff(const siggen_params_t *a, const siggen_params_t *b) {
+    uint32_t changed = 0;
+    changed |= a->shape != b->shape ? PARAM_SHAPE : 0;
+    changed |= a->amplitude != b->amplitude ? PARAM_AMPLITUDE : 0;
+    changed |= a->offset != b->offset ? PARAM_OFFSET : 0;
+    changed |= a->freq_mhz != b->freq_mhz ? PARAM_FREQ : 0;
+    changed |= a->phase_deg != b->phase_deg ? PARAM_PHASE : 0;
+    changed |= a->mod != b->mod || a->mod_arg != b->mod_arg || a->mod_time != b->mod_time ? PARAM_MOD : 0;
+    changed |= a->user_gen != b->user_gen ? PARAM_USER : 0;
+    return changed;
+}
+
+/**
+ * @brief Longest wait for a period boundary, in samples.
+ */
+uint32_t param_txn_wait(uint32_t sample_rate_hz) {
+    uint32_t wait = (uint32_t)((uint64_t)sample_rate_hz * PARAM_TXN_MAX_WAIT_US / 1000000u);
+    return wait ? wait : 1;
+}
+
+/**
+ * @brief Band-limited table for a parameter set.
+ *
+ * Picked for the highest fundamental the set plays: the far end of a
+ * sweep, the carrier plus the deviation and the modulating frequency for
+ * FM, and the carrier plus the modulating frequency (its upper sideband)
+ * for AM.
+ *
+ * @return Band for waveform_band_table().
+ */
+uint32_t param_txn_band(const siggen_params_t *p, uint32_t sample_rate_hz) {
+    uint64_t top = p->freq_mhz;
+    switch (p->mod) {
+    case MOD_SWEEP_LIN:
+    case MOD_SWEEP_LOG:
+        top = p->mod_arg > top ? p->mod_arg : top;
+        break;
+    case MOD_AM:
+        top += p->mod_time;
+        break;
+    case MOD_FM:
+        top += (uint64_t)p->mod_arg + p->mod_time;
+        break;
+    }
+    return waveform_band(p->shape, top > UINT32_MAX ? UINT32_MAX : (uint32_t)top, sample_rate_hz);
+}
+
+/**
+ * @brief Hand the period and frequency changes of a parameter set to the sample path.
+ *
+ * Runs on the core that owns the engine. Both go out in one change, so no
+ * sample is produced with the new period and the old frequency or the
+ * other way round. A change that moves the set to another band rebuilds
+ * the period even if the shape, amplitude and offset are the same.
+ *
+ * @param c Cache read by the sample path.
+ * @param p New parameter set.
+ * @param changed Fields that changed (param_txn_diff()).
+ * @param sample_rate_hz Sample clock.
+ * @return false if nothing in the cache had to change.
+ */
+bool param_txn_stage(wave_cache_t *c, const siggen_params_t *p, uint32_t changed, uint32_t sample_rate_hz) {
+    return param_txn_stage_tuning(c, p, changed, sample_rate_hz, dds_tuning_word(p->freq_mhz, sample_rate_hz));
+}
+
+/**
+ * @brief param_txn_stage() with a tuning word worked out by the caller.
+ *
+ * For a sample path whose clock is planned with the frequency
+ * (clock_plan.h), where the step is exact and not rounded from the rate.
+ *
+ * @param tuning DDS step that goes with @p sample_rate_hz.
+ */
+bool param_txn_stage_tuning(wave_cache_t *c, const siggen_params_t *p, uint32_t changed, uint32_t sample_rate_hz,
+                            uint32_t tuning) {
+    uint32_t band = param_txn_band(p, sample_rate_hz);
+    if (band != c->band) {
+        changed |= PARAM_SHAPE; ///< otra octava: otra tabla
+    }
+    if (!(changed & (PARAM_WAVE | PARAM_FREQ))) {
+        return false;
+    }
+    wave_cache_begin(c);
+    if (changed & PARAM_WAVE) {
+        wave_cache_fill_band(c, p->shape, band, p->amplitude, p->offset);
+    }
+    if (changed & PARAM_FREQ) {
+        wave_cache_retune(c, tuning);
+    }
+    wave_cache_commit(c, p->at_phase, param_txn_wait(sample_rate_hz));
+    return true;
+}
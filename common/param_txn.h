@@ -0,0 +1,68 @@
+/**
+ * @file param_txn.h
+ * @brief Batched parameter transactions with phase-continuous updates.
+ *
+ * The UI stages any combination of shape, amplitude, offset, frequency,
+ * phase and modulation into a transaction and commits it as one complete
+ * parameter set (through the mailbox in the dual-core build). The engine
+ * then stages the new period and the new tuning word into the wave cache
+ * together, and the sample path applies both on the same sample: at the
+ * next period boundary, or at the phase the transaction chose. The phase
+ * accumulator is never touched, so the output stays phase-continuous.
+ *
+ * The period is built from the band-limited table (waveform_band()) of
+ * the highest frequency the parameter set plays, so a frequency change
+ * that crosses an octave also rebuilds the period.
+ *
+ * The wait for the boundary is bounded by PARAM_TXN_MAX_WAIT_US; a period
+ * longer than that changes mid-period (still phase-continuous). The wave
+ * cache records how many samples each change waited.
+ */
+
+// Avoid duplication in code
+#ifndef _PARAM_TXN_H_
+#define _PARAM_TXN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mailbox.h"
+#include "wave_cache.h"
+
+#define PARAM_TXN_MAX_WAIT_US 100000 ///< Espera maxima de un cambio por el fin del periodo
+
+// Campos de un conjunto de parametros
+#define PARAM_SHAPE (1u << 0)     ///< Forma de onda
+#define PARAM_AMPLITUDE (1u << 1) ///< Amplitud
+#define PARAM_OFFSET (1u << 2)    ///< Offset
+#define PARAM_FREQ (1u << 3)      ///< Frecuencia
+#define PARAM_PHASE (1u << 4)     ///< Desfase del segundo canal
+#define PARAM_MOD (1u << 5)       ///< Modulacion
+#define PARAM_USER (1u << 6)      ///< Tabla cargada por el puerto serie
+#define PARAM_WAVE (PARAM_SHAPE | PARAM_AMPLITUDE | PARAM_OFFSET | PARAM_USER) ///< Cambian el periodo
+
+/**
+ * @brief Parameter transaction being staged.
+ */
+typedef struct {
+    siggen_params_t params; ///< Parametros con los cambios preparados
+    uint32_t staged;        ///< Campos cambiados (PARAM_*)
+} param_txn_t;
+
+void param_txn_begin(param_txn_t *t, const siggen_params_t *base);
+void param_txn_shape(param_txn_t *t, uint8_t shape);
+void param_txn_amplitude(param_txn_t *t, uint32_t amplitude);
+void param_txn_offset(param_txn_t *t, uint32_t offset);
+void param_txn_frequency(param_txn_t *t, uint32_t freq_mhz);
+void param_txn_phase(param_txn_t *t, uint32_t phase_deg);
+void param_txn_modulation(param_txn_t *t, uint8_t mod, uint32_t arg, uint32_t time);
+void param_txn_at(param_txn_t *t, uint32_t phase);
+uint32_t param_txn_commit(param_txn_t *t, siggen_params_t *out);
+uint32_t param_txn_diff(const siggen_params_t *a, const siggen_params_t *b);
+uint32_t param_txn_wait(uint32_t sample_rate_hz);
+uint32_t param_txn_band(const siggen_params_t *p, uint32_t sample_rate_hz);
+bool param_txn_stage(wave_cache_t *c, const siggen_params_t *p, uint32_t changed, uint32_t sample_rate_hz);
+bool param_txn_stage_tuning(wave_cache_t *c, const siggen_params_t *p, uint32_t changed, uint32_t sample_rate_hz,
+                            uint32_t tuning);
+
+#endif
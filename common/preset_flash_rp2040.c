@@ -0,0 +1,58 @@
+/**
+ * @file preset_flash_rp2040.c
+ * @brief Preset region in the last sectors of the RP2040 program flash.
+ *
+ * The region is read through XIP. Erasing and programming stop XIP, so
+ * they run through flash_safe_execute(), which masks the interrupts of
+ * this core and parks the other one (if it called
+ * flash_safe_execute_core_init()): the sample output holds its last code
+ * for about 1 ms per page program and 50 ms per sector erase.
+ */
+
+#include "preset_store.h"
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#define PRESET_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - PRESET_REGION_LEN) ///< Al final de la flash, lejos del programa
+#define PRESET_FLASH_TIMEOUT_MS 100 ///< Espera maxima a que el otro nucleo se detenga
+
+/**
+ * @brief One erase or program, run with XIP stopped.
+ */
+typedef struct {
+    uint32_t offset;        ///< Desplazamiento en la region
+    const uint8_t *page;    ///< Pagina a programar (NULL: borrar el sector)
+} preset_flash_op_t;
+
+static void preset_flash_run(void *param) {
+    const preset_flash_op_t *op = param;
+    if (op->page) {
+        flash_range_program(PRESET_FLASH_OFFSET + op->offset, op->page, PRESET_PAGE_LEN);
+    } else {
+        flash_range_erase(PRESET_FLASH_OFFSET + op->offset, PRESET_SECTOR_LEN);
+    }
+}
+
+/**
+ * @brief Region as mapped by XIP.
+ */
+const uint8_t *preset_flash_hw_region(void) {
+    return (const uint8_t *)(XIP_BASE + PRESET_FLASH_OFFSET);
+}
+
+/**
+ * @brief Erase the sector at @p offset of the region.
+ */
+bool preset_flash_hw_erase(uint32_t offset) {
+    preset_flash_op_t op = { offset, NULL };
+    return flash_safe_execute(preset_flash_run, &op, PRESET_FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+/**
+ * @brief Program the page at @p offset of the region.
+ */
+bool preset_flash_hw_program(uint32_t offset, const uint8_t *page) {
+    preset_flash_op_t op = { offset, page };
+    return flash_safe_execute(preset_flash_run, &op, PRESET_FLASH_TIMEOUT_MS) == PICO_OK;
+}
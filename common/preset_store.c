@@ -0,0 +1,216 @@
+/**
+ * @file preset_store.c
+ * @brief Record format, mount scan and log-structured writes of the presets.
+ *
+ * Only the main loop saves; a save programs one page, and every
+ * PRESET_SECTOR_RECORDS records or so also erases a sector.
+ */
+
+#include "preset_store.h"
+
+#include <string.h>
+
+#include "wave_upload.h"
+
+#define PRESET_CRC_AT (PRESET_RECORD_LEN - 2) ///< Posicion del CRC en el registro
+
+static uint32_t get32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static const uint8_t *preset_record(uint32_t index) {
+    return preset_flash_hw_region() + index * PRESET_RECORD_LEN;
+}
+
+static bool preset_blank(const uint8_t *r) {
+    for (uint32_t i = 0; i < PRESET_RECORD_LEN; i++) {
+        if (r[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void preset_encode(uint8_t *r, uint32_t slot, const preset_t *p) {
+    const siggen_params_t *q = &p->params;
+    memset(r, 0, PRESET_RECORD_LEN);
+    r[0] = PRESET_MAGIC;
+    r[1] = PRESET_FORMAT;
+    r[2] = (uint8_t)slot;
+    r[3] = q->shape;
+    put32(&r[4], p->seq);
+    put32(&r[8], q->amplitude);
+    put32(&r[12], q->offset);
+    put32(&r[16], q->freq_mhz);
+    put32(&r[20], q->phase_deg);
+    r[24] = q->mod;
+    put32(&r[28], q->mod_arg);
+    put32(&r[32], q->mod_time);
+    memcpy(&r[36], p->name, strlen(p->name));
+    uint16_t crc = wave_upload_crc(0xFFFF, r, PRESET_CRC_AT);
+    r[PRESET_CRC_AT] = (uint8_t)crc;
+    r[PRESET_CRC_AT + 1] = (uint8_t)(crc >> 8);
+}
+
+static bool preset_decode(const uint8_t *r, preset_t *p) {
+    uint16_t crc = wave_upload_crc(0xFFFF, r, PRESET_CRC_AT);
+    if (r[PRESET_CRC_AT] != (uint8_t)crc || r[PRESET_CRC_AT + 1] != (uint8_t)(crc >> 8)) {
+        return false;
+    }
+    memset(p, 0, sizeof(*p));
+    p->params.shape = r[3];
+    p->seq = get32(&r[4]);
+    p->params.amplitude = get32(&r[8]);
+    p->params.offset = get32(&r[12]);
+    p->params.freq_mhz = get32(&r[16]);
+    p->params.phase_deg = get32(&r[20]);
+    p->params.mod = r[24];
+    p->params.mod_arg = get32(&r[28]);
+    p->params.mod_time = get32(&r[32]);
+    memcpy(p->name, &r[36], PRESET_NAME_LEN);
+    return true;
+}
+
+/**
+ * @brief Newest record of a slot below a limit, by header only.
+ *
+ * Records are ordered by sequence and then by position, so a torn record
+ * that happens to carry the sequence of a good one does not hide it.
+ *
+ * @return Key (sequence << 32 | index) of the record, 0 if there is none.
+ */
+static uint64_t preset_newest(uint32_t slot, uint64_t limit) {
+    uint64_t best = 0;
+    for (uint32_t i = 0; i < PRESET_SECTORS * PRESET_SECTOR_RECORDS; i++) {
+        const uint8_t *r = preset_record(i);
+        if (r[0] != PRESET_MAGIC || r[1] != PRESET_FORMAT || r[2] != slot) {
+            continue;
+        }
+        uint64_t key = ((uint64_t)get32(&r[4]) << 32) | i;
+        if (key > best && key < limit) {
+            best = key;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Read the newest good record of every slot and find the write position.
+ *
+ * Writing goes on in the sector of the newest good record, after its last
+ * non-blank record (a torn one included). A region with no good record
+ * starts at sector 0.
+ */
+void preset_store_mount(preset_store_t *s) {
+    memset(s, 0, sizeof(*s));
+    for (uint32_t slot = 0; slot < PRESET_SLOTS; slot++) {
+        uint64_t limit = UINT64_MAX;
+        uint64_t key;
+        while ((key = preset_newest(slot, limit)) != 0) {
+            uint32_t index = (uint32_t)key;
+            if (preset_decode(preset_record(index), &s->slot[slot])) {
+                if (s->slot[slot].seq >= s->seq) {
+                    s->seq = s->slot[slot].seq;
+                    s->sector = index / PRESET_SECTOR_RECORDS;
+                }
+                break;
+            }
+            s->torn++;
+            limit = key;
+        }
+    }
+    s->next = PRESET_SECTOR_RECORDS;
+    while (s->next && preset_blank(preset_record(s->sector * PRESET_SECTOR_RECORDS + s->next - 1))) {
+        s->next--;
+    }
+}
+
+/**
+ * @brief Append one record of a slot at the write position.
+ *
+ * The record gets the next sequence number. The page is programmed with
+ * 0xFF around the record, which leaves the other records as they are.
+ * The position is used up even if programming fails (it may be half
+ * written).
+ */
+static bool preset_append(preset_store_t *s, uint32_t slot, preset_t *p) {
+    uint8_t page[PRESET_PAGE_LEN];
+    uint32_t at = s->sector * PRESET_SECTOR_LEN + s->next * PRESET_RECORD_LEN;
+    memset(page, 0xFF, sizeof(page));
+    p->seq = s->seq + 1;
+    preset_encode(&page[at % PRESET_PAGE_LEN], slot, p);
+    s->next++;
+    if (!preset_flash_hw_program(at - at % PRESET_PAGE_LEN, page)) {
+        return false;
+    }
+    s->seq = p->seq;
+    s->writes++;
+    return true;
+}
+
+/**
+ * @brief Move on to the next sector: erase it and copy the live slots into it.
+ *
+ * @param skip Slot about to be written anyway (not copied).
+ */
+static bool preset_compact(preset_store_t *s, uint32_t skip) {
+    uint32_t sector = (s->sector + 1) % PRESET_SECTORS;
+    if (!preset_flash_hw_erase(sector * PRESET_SECTOR_LEN)) {
+        return false;
+    }
+    s->erases++;
+    s->sector = sector;
+    s->next = 0;
+    for (uint32_t slot = 0; slot < PRESET_SLOTS; slot++) {
+        if (slot != skip && s->slot[slot].seq && !preset_append(s, slot, &s->slot[slot])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Save a parameter set into a slot.
+ *
+ * The at_phase and user_gen fields are not kept: a preset starts at the
+ * period boundary, and an uploaded table does not survive a reset.
+ *
+ * @param s Mounted region.
+ * @param slot Slot (PRESET_LAST or a preset).
+ * @param p Parameter set.
+ * @param name Name, cut to PRESET_NAME_LEN characters.
+ * @return false if the slot does not exist or the flash failed; the slot
+ *         keeps its previous value.
+ */
+bool preset_store_save(preset_store_t *s, uint32_t slot, const siggen_params_t *p, const char *name) {
+    if (slot >= PRESET_SLOTS) {
+        return false;
+    }
+    preset_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.params = *p;
+    rec.params.user_gen = 0;
+    rec.params.at_phase = 0;
+    strncpy(rec.name, name, PRESET_NAME_LEN);
+    if (s->next >= PRESET_SECTOR_RECORDS && !preset_compact(s, slot)) {
+        return false;
+    }
+    if (!preset_append(s, slot, &rec)) {
+        return false;
+    }
+    s->slot[slot] = rec;
+    return true;
+}
+
+/**
+ * @brief Value of a slot, NULL if it was never saved.
+ */
+const preset_t *preset_store_get(const preset_store_t *s, uint32_t slot) {
+    return slot < PRESET_SLOTS && s->slot[slot].seq ? &s->slot[slot] : NULL;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file preset_store.h
+ * @brief Parameter presets kept in a wear-levelled flash region.
+ *
+ * Slot PRESET_LAST holds the last committed configuration, which the
+ * firmware starts from at boot; the other slots are named presets saved
+ * and recalled from the keypad.
+ *
+ * The region is a log of fixed-size records spread over PRESET_SECTORS
+ * erase sectors used as a ring. Saving a slot appends a record with a
+ * higher sequence number (one page program, no erase); the newest record
+ * of a slot with a good CRC is its value. When the sector in use is full,
+ * the next one (the oldest) is erased and the newest record of every other
+ * slot is copied into it first, so every sector is erased once per turn
+ * of the ring. A power cut at any point loses at most the record being
+ * written: a torn record fails its CRC and the previous one is used.
+ *
+ * Each record (little-endian):
+ *
+ *     'P', format, slot, shape, seq(u32), amplitude(u32), offset(u32),
+ *     freq_mhz(u32), phase_deg(u32), mod, 0, 0, 0, mod_arg(u32),
+ *     mod_time(u32), name[PRESET_NAME_LEN], 0..., crc(u16)
+ *
+ * with crc the CRC-16/CCITT of the uploads (wave_upload_crc) over the
+ * bytes before it. Mounting reads the headers once and checks the CRC of
+ * the newest record of each slot only, so it costs little more than one
+ * pass over the region.
+ *
+ * The backend (preset_flash_rp2040.c, host/preset_flash_host.c) maps the
+ * region and erases and programs it.
+ */
+
+// Avoid duplication in code
+#ifndef _PRESET_STORE_H_
+#define _PRESET_STORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mailbox.h"
+
+#define PRESET_PAGE_LEN 256 ///< Unidad de programacion de la flash
+#define PRESET_SECTOR_LEN 4096 ///< Unidad de borrado de la flash
+#define PRESET_SECTORS 4 ///< Sectores de la region, usados en anillo
+#define PRESET_REGION_LEN (PRESET_SECTORS * PRESET_SECTOR_LEN)
+#define PRESET_RECORD_LEN 64 ///< Bytes de un registro (divide a la pagina)
+#define PRESET_SECTOR_RECORDS (PRESET_SECTOR_LEN / PRESET_RECORD_LEN)
+#define PRESET_SLOTS 5 ///< Ultima configuracion y presets con nombre
+#define PRESET_LAST 0 ///< Slot de la ultima configuracion confirmada
+#define PRESET_NAME_LEN 12 ///< Caracteres del nombre de un preset
+#define PRESET_MAGIC 'P' ///< Primer byte de un registro
+#define PRESET_FORMAT 1 ///< Version del formato del registro
+
+/**
+ * @brief Value of one slot.
+ */
+typedef struct {
+    siggen_params_t params;          ///< Parametros guardados
+    char name[PRESET_NAME_LEN + 1];  ///< Nombre
+    uint32_t seq;                    ///< Secuencia del registro (0: slot vacio)
+} preset_t;
+
+/**
+ * @brief Mounted region: the newest value of every slot and the write position.
+ */
+typedef struct {
+    preset_t slot[PRESET_SLOTS];     ///< Ultimo valor de cada slot
+    uint32_t seq;                    ///< Secuencia del ultimo registro valido
+    uint32_t sector;                 ///< Sector en que se escribe
+    uint32_t next;                   ///< Siguiente registro libre del sector
+    uint32_t writes;                 ///< Registros escritos desde el montaje
+    uint32_t erases;                 ///< Sectores borrados desde el montaje
+    uint32_t torn;                   ///< Registros con CRC erroneo descartados al montar
+} preset_store_t;
+
+void preset_store_mount(preset_store_t *s);
+bool preset_store_save(preset_store_t *s, uint32_t slot, const siggen_params_t *p, const char *name);
+const preset_t *preset_store_get(const preset_store_t *s, uint32_t slot);
+
+// Backend
+const uint8_t *preset_flash_hw_region(void);
+bool preset_flash_hw_erase(uint32_t offset);
+bool preset_flash_hw_program(uint32_t offset, const uint8_t *page);
+
+#endif
@@ -0,0 +1,96 @@
+# Shared signal generation code used by c_irq, c_pol and the host tools.
+#
+# Firmware projects include this file after pico_sdk_init() and call
+# siggen_target_rp2040(<target>); the host project only uses the portable
+# source list.
+
+set(SIGGEN_COMMON_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# Waveform tables are generated at build time by gen_waveforms.py
+set(SIGGEN_TABLE_LENGTH 256 CACHE STRING "Points per waveform period (multiple of 4; a power of two keeps the DDS on its shift path)")
+set(SIGGEN_TABLE_BITS 8 CACHE STRING "Bit depth of the waveform tables (8-16)")
+option(SIGGEN_COMPACT_TABLES "Store only quarter-period sine/triangle tables and unfold them at run time" OFF)
+# The band-limited sets take a full-length table per octave (about 45 KB per
+# shape at 4096 points), which would undo the compact tables: off by default
+# with them
+if (SIGGEN_COMPACT_TABLES)
+    set(SIGGEN_BANDLIMITED_DEFAULT OFF)
+else()
+    set(SIGGEN_BANDLIMITED_DEFAULT ON)
+endif()
+option(SIGGEN_BANDLIMITED_TABLES "Add one band-limited table per octave of the triangle, sawtooth and square" ${SIGGEN_BANDLIMITED_DEFAULT})
+if (SIGGEN_COMPACT_TABLES AND SIGGEN_BANDLIMITED_TABLES)
+    message(WARNING "SIGGEN_BANDLIMITED_TABLES adds full-length tables to SIGGEN_COMPACT_TABLES, "
+                    "cancelling most of its flash savings; pass -DSIGGEN_BANDLIMITED_TABLES=OFF to keep them")
+endif()
+find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+# Portable sources, no Pico SDK dependency
+set(SIGGEN_COMMON_SOURCES
+    ${SIGGEN_COMMON_DIR}/alarm_sched.c
+    ${SIGGEN_COMMON_DIR}/clock_plan.c
+    ${SIGGEN_COMMON_DIR}/dac_stream.c
+    ${SIGGEN_COMMON_DIR}/dds.c
+    ${SIGGEN_COMMON_DIR}/executive.c
+    ${SIGGEN_COMMON_DIR}/gen_block.c
+    ${SIGGEN_COMMON_DIR}/keypad.c
+    ${SIGGEN_COMMON_DIR}/latency_hist.c
+    ${SIGGEN_COMMON_DIR}/log_ring.c
+    ${SIGGEN_COMMON_DIR}/mailbox.c
+    ${SIGGEN_COMMON_DIR}/modulation.c
+    ${SIGGEN_COMMON_DIR}/multichan.c
+    ${SIGGEN_COMMON_DIR}/param_txn.c
+    ${SIGGEN_COMMON_DIR}/preset_store.c
+    ${SIGGEN_COMMON_DIR}/stream_rx.c
+    ${SIGGEN_COMMON_DIR}/wave_cache.c
+    ${SIGGEN_COMMON_DIR}/wave_upload.c
+    ${SIGGEN_COMMON_DIR}/waveform.c
+)
+
+# Generate the waveform tables and add them to a target
+function(siggen_generate_waveforms target)
+    set(out ${CMAKE_CURRENT_BINARY_DIR}/siggen_generated)
+    set(flags)
+    if (SIGGEN_COMPACT_TABLES)
+        set(flags --compact)
+    endif()
+    if (SIGGEN_BANDLIMITED_TABLES)
+        list(APPEND flags --bandlimited)
+    endif()
+    # Regenerate when the table options change
+    file(WRITE ${out}/tables.cfg.tmp "${SIGGEN_TABLE_LENGTH} ${SIGGEN_TABLE_BITS} ${flags}\n")
+    configure_file(${out}/tables.cfg.tmp ${out}/tables.cfg COPYONLY)
+    add_custom_command(
+        OUTPUT ${out}/waveform_tables.c ${out}/waveform_tables.h
+        COMMAND ${Python3_EXECUTABLE} ${SIGGEN_COMMON_DIR}/gen_waveforms.py
+                --length ${SIGGEN_TABLE_LENGTH} --bits ${SIGGEN_TABLE_BITS} ${flags} --out ${out}
+        DEPENDS ${SIGGEN_COMMON_DIR}/gen_waveforms.py ${out}/tables.cfg
+        COMMENT "Generating ${SIGGEN_TABLE_LENGTH}-point ${SIGGEN_TABLE_BITS}-bit waveform tables"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE ${out}/waveform_tables.c ${out}/waveform_tables.h)
+    target_include_directories(${target} PUBLIC ${out})
+endfunction()
+
+# Add the shared sources and RP2040 backends to a firmware target
+function(siggen_target_rp2040 target)
+    target_sources(${target} PRIVATE
+        ${SIGGEN_COMMON_SOURCES}
+        ${SIGGEN_COMMON_DIR}/alarm_sched_rp2040.c
+        ${SIGGEN_COMMON_DIR}/dac_stream_rp2040.c
+        ${SIGGEN_COMMON_DIR}/executive_rp2040.c
+        ${SIGGEN_COMMON_DIR}/keypad_rp2040.c
+        ${SIGGEN_COMMON_DIR}/log_rp2040.c
+        ${SIGGEN_COMMON_DIR}/multichan_rp2040.c
+        ${SIGGEN_COMMON_DIR}/preset_flash_rp2040.c
+    )
+    target_include_directories(${target} PRIVATE ${SIGGEN_COMMON_DIR})
+    siggen_generate_waveforms(${target})
+    pico_generate_pio_header(${target} ${SIGGEN_COMMON_DIR}/dac_bus.pio)
+    target_link_libraries(${target}
+        hardware_pio
+        hardware_dma
+        hardware_flash
+        pico_flash
+    )
+endfunction()
@@ -0,0 +1,215 @@
+/**
+ * @file stream_rx.c
+ * @brief Receive side, state changes and credit reports of the sample stream.
+ *
+ * Everything here runs in the main loop, the only producer of the ring;
+ * the sample interrupt only calls stream_rx_pop().
+ */
+
+#include "stream_rx.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize a receiver with no stream.
+ */
+void stream_rx_init(stream_rx_t *s) {
+    memset(s->ring, 0, sizeof(s->ring));
+    atomic_init(&s->head, 0);
+    atomic_init(&s->tail, 0);
+    atomic_init(&s->underruns, 0);
+    atomic_init(&s->state, STREAM_OFF);
+    s->last = 0;
+    s->block = 0;
+    s->overruns = 0;
+    s->received = 0;
+    s->received_seen = 0;
+    s->last_us = 0;
+    s->reported = 0;
+    s->reported_state = STREAM_OFF;
+}
+
+/**
+ * @brief Start a stream (serial command 'S'); ignored while one is running.
+ *
+ * The counters are reset here, while the sample interrupt is not reading
+ * the ring. The next report grants the whole ring.
+ */
+void stream_rx_start(stream_rx_t *s, uint32_t now_us) {
+    if (atomic_load_explicit(&s->state, memory_order_relaxed) != STREAM_OFF) {
+        return;
+    }
+    atomic_store_explicit(&s->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->underruns, 0, memory_order_relaxed);
+    s->block = 0;
+    s->overruns = 0;
+    s->received_seen = s->received;
+    s->last_us = now_us;
+    s->reported_state = STREAM_OFF;
+    atomic_store_explicit(&s->state, STREAM_PRIMING, memory_order_release);
+}
+
+/**
+ * @brief Take one byte of the stream: a block length or a code.
+ *
+ * A code goes straight into the ring; with the ring full it is dropped
+ * and counted.
+ */
+void stream_rx_feed(stream_rx_t *s, uint8_t byte) {
+    uint8_t state = atomic_load_explicit(&s->state, memory_order_relaxed);
+    if (state != STREAM_PRIMING && state != STREAM_PLAYING) {
+        return; ///< nada despues del fin
+    }
+    s->received++;
+    if (!s->block) {
+        if (byte) {
+            s->block = byte;
+        } else {
+            atomic_store_explicit(&s->state, STREAM_DRAINING, memory_order_release);
+        }
+        return;
+    }
+    s->block--;
+    uint32_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&s->tail, memory_order_acquire) >= STREAM_RX_DEPTH) {
+        s->overruns++;
+        return;
+    }
+    s->ring[head % STREAM_RX_DEPTH] = byte;
+    atomic_store_explicit(&s->head, head + 1, memory_order_release);
+}
+
+/**
+ * @brief Where the next codes of the current block can be written in place.
+ *
+ * For a transport that reads in bulk: read at most the returned count into
+ * @p *dst, then call stream_rx_commit(). With 0 (a block length is next,
+ * or the ring is full) the next byte goes through stream_rx_feed().
+ *
+ * @return Codes that fit contiguously.
+ */
+uint32_t stream_rx_span(stream_rx_t *s, uint8_t **dst) {
+    uint8_t state = atomic_load_explicit(&s->state, memory_order_relaxed);
+    if ((state != STREAM_PRIMING && state != STREAM_PLAYING) || !s->block) {
+        return 0;
+    }
+    uint32_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    uint32_t free = STREAM_RX_DEPTH - (head - atomic_load_explicit(&s->tail, memory_order_acquire));
+    uint32_t wrap = STREAM_RX_DEPTH - head % STREAM_RX_DEPTH;
+    uint32_t n = s->block < free ? s->block : free;
+    *dst = &s->ring[head % STREAM_RX_DEPTH];
+    return n < wrap ? n : wrap;
+}
+
+/**
+ * @brief Publish @p n codes written at the span of stream_rx_span().
+ */
+void stream_rx_commit(stream_rx_t *s, uint32_t n) {
+    s->block -= n;
+    s->received += n;
+    atomic_store_explicit(&s->head, atomic_load_explicit(&s->head, memory_order_relaxed) + n,
+                          memory_order_release);
+}
+
+/**
+ * @brief Codes waiting in the ring.
+ */
+uint32_t stream_rx_fill(const stream_rx_t *s) {
+    return atomic_load_explicit(&s->head, memory_order_acquire) - atomic_load_explicit(&s->tail, memory_order_acquire);
+}
+
+/**
+ * @brief State changes: start playing once primed, end on silence or when played out.
+ */
+void stream_rx_poll(stream_rx_t *s, uint32_t now_us) {
+    uint8_t state = atomic_load_explicit(&s->state, memory_order_relaxed);
+    if (state == STREAM_OFF) {
+        return;
+    }
+    if (s->received != s->received_seen) {
+        s->received_seen = s->received;
+        s->last_us = now_us;
+    }
+    if ((state == STREAM_PRIMING || state == STREAM_PLAYING) && now_us - s->last_us > STREAM_RX_IDLE_US) {
+        state = STREAM_DRAINING; ///< el host se fue sin cerrar el flujo
+    } else if (state == STREAM_PRIMING && stream_rx_fill(s) >= STREAM_RX_PREFILL) {
+        state = STREAM_PLAYING;
+    } else if (state == STREAM_DRAINING && stream_rx_fill(s) == 0) {
+        state = STREAM_OFF;
+    }
+    atomic_store_explicit(&s->state, state, memory_order_release);
+}
+
+/**
+ * @brief Credit report, when there is something new to tell.
+ *
+ * With no stream, only the end of one is told: a receiver that was never
+ * started, or whose end was already reported, keeps quiet on the console.
+ *
+ * @param buf Destination, STREAM_RX_REPORT_LEN bytes.
+ * @param force Report even if neither the state nor the credit changed enough.
+ * @return Length of the report, 0 if there is none to send.
+ */
+uint32_t stream_rx_report(stream_rx_t *s, uint8_t *buf, bool force) {
+    uint8_t state = atomic_load_explicit(&s->state, memory_order_relaxed);
+    uint32_t granted = atomic_load_explicit(&s->tail, memory_order_acquire) + STREAM_RX_DEPTH;
+    uint32_t underruns = atomic_load_explicit(&s->underruns, memory_order_relaxed);
+    if (!force && state == s->reported_state
+        && (state == STREAM_OFF || granted - s->reported < STREAM_RX_CREDIT_STEP)) {
+        return 0;
+    }
+    s->reported = granted;
+    s->reported_state = state;
+    buf[0] = STREAM_RX_REPORT;
+    buf[1] = 's';
+    buf[2] = state;
+    for (int i = 0; i < 4; i++) {
+        buf[3 + i] = (uint8_t)(granted >> (8 * i));
+        buf[7 + i] = (uint8_t)(underruns >> (8 * i));
+    }
+    uint8_t sum = 0;
+    for (int i = 2; i < 11; i++) {
+        sum += buf[i];
+    }
+    buf[11] = (uint8_t)~sum;
+    return STREAM_RX_REPORT_LEN;
+}
+
+/**
+ * @brief Parse a credit report at the start of a buffer.
+ *
+ * @return Bytes used, 0 if the buffer holds only part of it, -1 if it is
+ *         not a report (skip one byte and retry).
+ */
+int stream_rx_parse_report(const uint8_t *buf, uint32_t len, uint8_t *state, uint32_t *granted,
+                           uint32_t *underruns) {
+    static const uint8_t head[2] = { STREAM_RX_REPORT, 's' };
+    for (uint32_t i = 0; i < 2; i++) {
+        if (i >= len) {
+            return 0;
+        }
+        if (buf[i] != head[i]) {
+            return -1;
+        }
+    }
+    if (len < STREAM_RX_REPORT_LEN) {
+        return 0;
+    }
+    uint8_t sum = 0;
+    for (int i = 2; i < 11; i++) {
+        sum += buf[i];
+    }
+    sum = (uint8_t)~sum;
+    if (buf[11] != sum || buf[2] > STREAM_DRAINING) {
+        return -1;
+    }
+    *state = buf[2];
+    *granted = 0;
+    *underruns = 0;
+    for (int i = 0; i < 4; i++) {
+        *granted |= (uint32_t)buf[3 + i] << (8 * i);
+        *underruns |= (uint32_t)buf[7 + i] << (8 * i);
+    }
+    return STREAM_RX_REPORT_LEN;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file stream_rx.h
+ * @brief Sample streaming from the host into the DAC, with credit-based flow control.
+ *
+ * After the serial command 'S' the host sends blocks of DAC codes:
+ *
+ *     n(u8) code[n]        n = 1-255
+ *     0                    end of the stream
+ *
+ * The codes go straight from the USB receive path into a single-producer
+ * ring (the main loop) that the sample interrupt drains one code per tick
+ * (single consumer), as in mailbox.c. The host may only send codes it has
+ * credit for. The device grants credit in reports, sent on the same port
+ * as the log:
+ *
+ *     0x16 's' state(u8) granted(u32) underruns(u32) ~sum
+ *
+ * where @c granted is the number of codes the host may have sent since the
+ * start (codes played plus the ring size), so a lost or late report only
+ * delays the host. Playback starts once half the ring is filled. An empty
+ * ring while playing is an underrun: the last code is held and counted.
+ * Codes received with the ring full (a host ignoring its credit) are
+ * dropped and counted as overruns. The stream ends with the end block, or
+ * after STREAM_RX_IDLE_US without input, once the ring has played out.
+ */
+
+// Avoid duplication in code
+#ifndef _STREAM_RX_H_
+#define _STREAM_RX_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define STREAM_RX_DEPTH 4096 ///< Codigos en el anillo (potencia de 2)
+#define STREAM_RX_PREFILL (STREAM_RX_DEPTH / 2) ///< Codigos recibidos antes de empezar a sonar
+#define STREAM_RX_CREDIT_STEP (STREAM_RX_DEPTH / 8) ///< Credito nuevo que justifica un informe
+#define STREAM_RX_IDLE_US 1000000 ///< Silencio tras el que se da el flujo por terminado
+#define STREAM_RX_REPORT_LEN 12 ///< Bytes de un informe
+#define STREAM_RX_REPORT 0x16 ///< Primer byte de un informe
+
+// Estados del flujo
+#define STREAM_OFF 0       ///< Sin flujo: suena el generador
+#define STREAM_PRIMING 1   ///< Llenando el anillo
+#define STREAM_PLAYING 2   ///< Sonando
+#define STREAM_DRAINING 3  ///< Fin recibido: sonando lo que queda
+
+/**
+ * @brief Stream receiver.
+ */
+typedef struct {
+    uint8_t ring[STREAM_RX_DEPTH];  ///< Codigos recibidos
+    _Atomic uint32_t head;          ///< Codigos escritos (solo el bucle principal)
+    _Atomic uint32_t tail;          ///< Codigos reproducidos (solo la interrupcion)
+    _Atomic uint32_t underruns;     ///< Muestras sin codigo mientras sonaba (solo la interrupcion)
+    _Atomic uint8_t state;          ///< STREAM_* (solo el bucle principal)
+    uint8_t last;                   ///< Ultimo codigo reproducido (solo la interrupcion)
+    uint32_t block;                 ///< Codigos que faltan del bloque en curso
+    uint32_t overruns;              ///< Codigos descartados por anillo lleno
+    uint32_t received;              ///< Bytes recibidos (cabeceras incluidas)
+    uint32_t received_seen;         ///< Bytes recibidos en la ultima revision
+    uint32_t last_us;               ///< Instante en que se vio llegar el ultimo byte
+    uint32_t reported;              ///< Credito del ultimo informe
+    uint8_t reported_state;         ///< Estado del ultimo informe
+} stream_rx_t;
+
+void stream_rx_init(stream_rx_t *s);
+void stream_rx_start(stream_rx_t *s, uint32_t now_us);
+void stream_rx_feed(stream_rx_t *s, uint8_t byte);
+uint32_t stream_rx_span(stream_rx_t *s, uint8_t **dst);
+void stream_rx_commit(stream_rx_t *s, uint32_t n);
+void stream_rx_poll(stream_rx_t *s, uint32_t now_us);
+uint32_t stream_rx_report(stream_rx_t *s, uint8_t *buf, bool force);
+uint32_t stream_rx_fill(const stream_rx_t *s);
+int stream_rx_parse_report(const uint8_t *buf, uint32_t len, uint8_t *state, uint32_t *granted,
+                           uint32_t *underruns);
+
+/**
+ * @brief Whether serial input belongs to the stream (until its end block).
+ */
+static inline bool stream_rx_receiving(const stream_rx_t *s) {
+    uint8_t state = atomic_load_explicit(&s->state, memory_order_relaxed);
+    return state == STREAM_PRIMING || state == STREAM_PLAYING;
+}
+
+/**
+ * @brief Whether the stream owns the DAC (the generator is silent).
+ */
+static inline bool stream_rx_active(const stream_rx_t *s) {
+    uint8_t state = atomic_load_explicit(&s->state, memory_order_relaxed);
+    return state == STREAM_PLAYING || state == STREAM_DRAINING;
+}
+
+/**
+ * @brief Next code to output, from the sample interrupt.
+ *
+ * @param s Receiver.
+ * @param code Code to output when the stream owns the DAC.
+ * @return false if it does not (output the generator instead).
+ */
+static inline bool stream_rx_pop(stream_rx_t *s, uint8_t *code) {
+    uint8_t state = atomic_load_explicit(&s->state, memory_order_acquire);
+    if (state != STREAM_PLAYING && state != STREAM_DRAINING) {
+        return false;
+    }
+    uint32_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+    if (atomic_load_explicit(&s->head, memory_order_acquire) == tail) {
+        if (state == STREAM_PLAYING) {
+            atomic_store_explicit(&s->underruns, atomic_load_explicit(&s->underruns, memory_order_relaxed) + 1,
+                                  memory_order_relaxed);
+        }
+        *code = s->last; ///< mantener el nivel
+        return true;
+    }
+    s->last = s->ring[tail % STREAM_RX_DEPTH];
+    atomic_store_explicit(&s->tail, tail + 1, memory_order_release);
+    *code = s->last;
+    return true;
+}
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * @file wave_cache.c
+ * @brief Rebuild of the active waveform cache.
+ *
+ * The rebuild runs in the context that accepts the command (keypad
+ * callback, main loop) and may be preempted by the sample interrupt. It
+ * clears @c pending before touching the back buffer, so the interrupt never
+ * swaps in a half-written period. A change that the interrupt had not
+ * applied yet is then told apart by its sequence number: @c applied
+ * lags @c published.
+ */
+
+#include "wave_cache.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize an empty cache.
+ *
+ * @param c Cache.
+ * @param length Points per period (at most WAVE_CACHE_MAX_LEN).
+ */
+void wave_cache_init(wave_cache_t *c, uint32_t length) {
+    memset(c, 0, sizeof(*c));
+    c->length = length > WAVE_CACHE_MAX_LEN ? WAVE_CACHE_MAX_LEN : length;
+}
+
+/**
+ * @brief Start preparing a change; the sample path stops applying one.
+ *
+ * Whatever an earlier change staged and the sample path has not applied
+ * yet stays staged, and goes out with this one.
+ */
+void wave_cache_begin(wave_cache_t *c) {
+    c->pending = 0;
+    atomic_signal_fence(memory_order_seq_cst); ///< el swap no puede ocurrir a partir de aqui
+    if (c->applied == c->published) {
+        c->staged = 0;
+    }
+}
+
+/**
+ * @brief Scale a table into the back buffer (between begin and commit).
+ *
+ * @param c Cache.
+ * @param table One period of table points (@c c->length points).
+ * @param Amp Amplitude of the signal.
+ * @param DC DC offset of the signal.
+ */
+void wave_cache_fill(wave_cache_t *c, const waveform_sample_t *table, uint32_t Amp, uint32_t DC) {
+    waveform_scaling_t k = waveform_scaling(Amp, DC);
+    uint8_t *back = c->buf[c->active ^ 1];
+    for (uint32_t i = 0; i < c->length; i++) {
+        back[i] = waveform_apply(waveform_to_dac(table[i]), k);
+    }
+    c->band = 0;
+    c->staged |= WAVE_CACHE_PERIOD;
+}
+
+/**
+ * @brief Scale one of the built-in shapes into the back buffer (between begin and commit).
+ *
+ * Works with both the full-period and the quarter-wave table formats.
+ *
+ * @param c Cache (its length must be WAVEFORM_LENGTH).
+ * @param shape One of the WAVEFORM_* shapes.
+ * @param Amp Amplitude of the signal.
+ * @param DC DC offset of the signal.
+ */
+void wave_cache_fill_shape(wave_cache_t *c, uint8_t shape, uint32_t Amp, uint32_t DC) {
+    wave_cache_fill_band(c, shape, 0, Amp, DC);
+}
+
+/**
+ * @brief Scale a band-limited table of a shape into the back buffer (between begin and commit).
+ *
+ * @param c Cache (its length must be WAVEFORM_LENGTH).
+ * @param shape One of the WAVEFORM_* shapes.
+ * @param band Band from waveform_band() (0: the plain table).
+ * @param Amp Amplitude of the signal.
+ * @param DC DC offset of the signal.
+ */
+void wave_cache_fill_band(wave_cache_t *c, uint8_t shape, uint32_t band, uint32_t Amp, uint32_t DC) {
+    waveform_scaling_t k = waveform_scaling(Amp, DC);
+    const waveform_sample_t *table = waveform_band_table(shape, band);
+    uint8_t *back = c->buf[c->active ^ 1];
+    for (uint32_t i = 0; i < c->length; i++) {
+        back[i] = waveform_apply(waveform_to_dac(table ? table[i] : waveform_at(shape, i)), k);
+    }
+    c->band = table ? (uint8_t)band : 0;
+    c->staged |= WAVE_CACHE_PERIOD;
+}
+
+/**
+ * @brief Stage a new tuning word (between begin and commit).
+ */
+void wave_cache_retune(wave_cache_t *c, uint32_t tuning) {
+    c->tuning = tuning;
+    c->staged |= WAVE_CACHE_TUNING;
+}
+
+/**
+ * @brief Publish what was staged since wave_cache_begin().
+ *
+ * @param c Cache.
+ * @param at Phase at which the change takes effect (0: the period boundary).
+ * @param wait Samples after which it takes effect anyway (0: no bound).
+ */
+void wave_cache_commit(wave_cache_t *c, uint32_t at, uint32_t wait) {
+    if (!c->staged) {
+        return;
+    }
+    c->at = at;
+    c->wait = wait;
+    c->age = 0;
+    c->published++;
+    atomic_thread_fence(memory_order_release);
+    c->pending = c->staged;
+}
+
+/**
+ * @brief Scale a table into the back buffer, for the next period boundary.
+ *
+ * @param c Cache.
+ * @param table One period of table points (@c c->length points).
+ * @param Amp Amplitude of the signal.
+ * @param DC DC offset of the signal.
+ */
+void wave_cache_rebuild(wave_cache_t *c, const waveform_sample_t *table, uint32_t Amp, uint32_t DC) {
+    wave_cache_begin(c);
+    wave_cache_fill(c, table, Amp, DC);
+    wave_cache_commit(c, 0, 0);
+}
+
+/**
+ * @brief Scale one of the built-in shapes into the back buffer, for the next period boundary.
+ *
+ * @param c Cache (its length must be WAVEFORM_LENGTH).
+ * @param shape One of the WAVEFORM_* shapes.
+ * @param Amp Amplitude of the signal.
+ * @param DC DC offset of the signal.
+ */
+void wave_cache_rebuild_shape(wave_cache_t *c, uint8_t shape, uint32_t Amp, uint32_t DC) {
+    wave_cache_begin(c);
+    wave_cache_fill_shape(c, shape, Amp, DC);
+    wave_cache_commit(c, 0, 0);
+}
+
+/**
+ * @brief Make a pending period active right away.
+ *
+ * Only for use while no sample path is reading the cache (start-up); a
+ * pending tuning word is dropped, the caller tunes its DDS itself.
+ */
+void wave_cache_swap(wave_cache_t *c) {
+    if (c->pending & WAVE_CACHE_PERIOD) {
+        c->active ^= 1;
+    }
+    c->pending = 0;
+    c->staged = 0;
+    c->applied = c->published;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file wave_cache.h
+ * @brief Active waveform cache: one period already scaled and offset.
+ *
+ * The amplitude, offset and shape only change when the user enters a new
+ * command, so the scaled period is built once into a back buffer and the
+ * sample path is reduced to a table load. The back buffer becomes active at
+ * the next period boundary, so a change never produces a torn period.
+ *
+ * A change may also carry a new tuning word, which the sample path loads
+ * on the same sample as the new period (the phase is kept, so the output
+ * stays phase-continuous), and may take effect at another phase than the
+ * wrap, or after a bounded number of samples if the period is too long to
+ * wait for.
+ */
+
+// Avoid duplication in code
+#ifndef _WAVE_CACHE_H_
+#define _WAVE_CACHE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dds.h"
+#include "waveform.h"
+
+#define WAVE_CACHE_MAX_LEN WAVEFORM_LENGTH ///< Puntos maximos por periodo
+#define WAVE_CACHE_PAD 4 ///< Bytes legibles tras el ultimo punto (lecturas vectoriales de 32 bits)
+
+// Partes de un cambio pendiente
+#define WAVE_CACHE_PERIOD 1 ///< El buffer de respaldo tiene un periodo nuevo
+#define WAVE_CACHE_TUNING 2 ///< Hay una sintonia nueva
+
+/**
+ * @brief Double-buffered scaled period.
+ */
+typedef struct {
+    uint8_t buf[2][WAVE_CACHE_MAX_LEN + WAVE_CACHE_PAD]; ///< Buffer activo y buffer de respaldo
+    uint32_t length;                    ///< Puntos por periodo
+    uint8_t band;                       ///< Tabla de banda limitada del ultimo periodo preparado (waveform_band())
+    volatile uint8_t active;            ///< Buffer que lee el generador
+    volatile uint8_t pending;           ///< Cambio publicado y aun no aplicado (WAVE_CACHE_*)
+    uint8_t staged;                     ///< Partes preparadas desde el ultimo cambio aplicado (solo el escritor)
+    uint32_t tuning;                    ///< Sintonia que entra con el cambio
+    uint32_t at;                        ///< Fase en la que entra el cambio (0: fin del periodo)
+    uint32_t wait;                      ///< Muestras que puede esperar el cambio (0: sin limite)
+    uint32_t age;                       ///< Muestras que lleva esperando el cambio
+    uint32_t published;                 ///< Cambios publicados (solo el escritor)
+    volatile uint32_t applied;          ///< Ultimo cambio aplicado (solo el generador)
+    volatile uint32_t waited;           ///< Muestras que espero el ultimo cambio aplicado
+} wave_cache_t;
+
+void wave_cache_init(wave_cache_t *c, uint32_t length);
+void wave_cache_rebuild(wave_cache_t *c, const waveform_sample_t *table, uint32_t Amp, uint32_t DC);
+void wave_cache_rebuild_shape(wave_cache_t *c, uint8_t shape, uint32_t Amp, uint32_t DC);
+void wave_cache_begin(wave_cache_t *c);
+void wave_cache_fill(wave_cache_t *c, const waveform_sample_t *table, uint32_t Amp, uint32_t DC);
+void wave_cache_fill_shape(wave_cache_t *c, uint8_t shape, uint32_t Amp, uint32_t DC);
+void wave_cache_fill_band(wave_cache_t *c, uint8_t shape, uint32_t band, uint32_t Amp, uint32_t DC);
+void wave_cache_retune(wave_cache_t *c, uint32_t tuning);
+void wave_cache_commit(wave_cache_t *c, uint32_t at, uint32_t wait);
+void wave_cache_swap(wave_cache_t *c);
+
+/**
+ * @brief Apply the pending change, from the sample path.
+ *
+ * @param c Cache.
+ * @param d DDS driving the cache; a new tuning word is loaded into it.
+ */
+static inline void wave_cache_apply(wave_cache_t *c, dds_t *d) {
+    uint8_t what = c->pending;
+    if (what & WAVE_CACHE_PERIOD) {
+        c->active ^= 1;
+    }
+    if (what & WAVE_CACHE_TUNING) {
+        d->tuning = c->tuning;
+    }
+    c->waited = c->age;
+    c->applied = c->published;
+    c->pending = 0;
+}
+
+/**
+ * @brief Next DAC code from the active buffer.
+ *
+ * A pending change is applied right after the sample whose phase step
+ * crosses its phase (the wrap, i.e. the last sample of a period, unless
+ * another phase was chosen), or once it has waited its bound.
+ *
+ * @param c Cache.
+ * @param d DDS driving the cache (its length must match the cache).
+ * @return DAC code.
+ */
+static inline uint8_t wave_cache_next(wave_cache_t *c, dds_t *d) {
+    uint32_t before = d->phase;
+    uint8_t code = dds_next(d, c->buf[c->active]);
+    if (c->pending && (++c->age == c->wait || d->phase - c->at < before - c->at || d->tuning == 0)) {
+        wave_cache_apply(c, d);
+    }
+    return code;
+}
+
+#endif
@@ -0,0 +1,283 @@
+/**
+ * @file wave_upload.c
+ * @brief Receiver and frame builders of the waveform upload protocol.
+ *
+ * The receiver runs in the main loop, one byte at a time, and only writes
+ * its own back buffer: the sample path keeps reading the waveform cache
+ * until the firmware rebuilds it from a complete table.
+ */
+
+#include "wave_upload.h"
+
+#include <string.h>
+
+/**
+ * @brief CRC-16/CCITT (polynomial 0x1021), bit by bit.
+ *
+ * @param crc 0xFFFF for a new CRC, or the previous result to continue.
+ */
+uint16_t wave_upload_crc(uint16_t crc, const uint8_t *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)(buf[i] << 8);
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put16(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * @brief Initialize a receiver with no transfer in progress.
+ *
+ * @param u Receiver.
+ * @param length Points of an accepted table (at most WAVE_UPLOAD_MAX_POINTS).
+ * @param reply Output of the replies (the same stream as the log).
+ * @param ctx Context of the output.
+ */
+void wave_upload_init(wave_upload_t *u, uint32_t length, wave_upload_reply_t reply, void *ctx) {
+    memset(u, 0, sizeof(*u));
+    u->length = length > WAVE_UPLOAD_MAX_POINTS ? WAVE_UPLOAD_MAX_POINTS : length;
+    u->reply = reply;
+    u->ctx = ctx;
+}
+
+static void wave_upload_answer(wave_upload_t *u, uint8_t status, uint8_t seq) {
+    uint8_t buf[5] = { WAVE_UPLOAD_REPLY, 'u', status, seq, (uint8_t)~(status + seq) };
+    if (status != WAVE_UPLOAD_OK) {
+        u->errors++;
+    }
+    u->reply(buf, sizeof(buf), u->ctx);
+}
+
+/**
+ * @brief Expected length of the frame in progress, type byte included.
+ *
+ * @return 0 while the length is still unknown.
+ */
+static uint32_t wave_upload_expected(const wave_upload_t *u) {
+    switch (u->frame[0]) {
+        case 'B':
+            return 7;
+        case 'D':
+            return u->frame_len < 5 ? 0 : 7 + (uint32_t)u->frame[4];
+        case 'C':
+            return 5;
+        default:
+            return 1;
+    }
+}
+
+/**
+ * @brief Act on a complete frame.
+ *
+ * @return WAVE_UPLOAD_DONE for an accepted commit, WAVE_UPLOAD_BUSY otherwise.
+ */
+static int wave_upload_frame(wave_upload_t *u) {
+    const uint8_t *f = u->frame;
+    uint32_t bytes = u->points * 2;
+    if (f[0] == 'B' || f[0] == 'C' || f[0] == 'D') {
+        uint32_t body = u->frame_len - 3; ///< entre el tipo y el CRC
+        if (wave_upload_crc(0xFFFF, &f[1], body) != get16(&f[1 + body])) {
+            wave_upload_answer(u, WAVE_UPLOAD_BAD_CRC, f[0] == 'D' ? f[1] : 0);
+            return WAVE_UPLOAD_BUSY;
+        }
+    }
+    switch (f[0]) {
+        case 'B': {
+            uint32_t points = get16(&f[1]);
+            if (points != u->length) {
+                u->points = 0;
+                wave_upload_answer(u, WAVE_UPLOAD_BAD_RANGE, 0);
+                break;
+            }
+            u->points = points;
+            u->crc = get16(&f[3]);
+            memset(u->received, 0, sizeof(u->received));
+            wave_upload_answer(u, WAVE_UPLOAD_OK, 0);
+            break;
+        }
+        case 'D': {
+            uint8_t seq = f[1];
+            uint32_t offset = get16(&f[2]);
+            uint32_t n = f[4];
+            if (!u->points) {
+                wave_upload_answer(u, WAVE_UPLOAD_NO_START, seq);
+            } else if (offset % WAVE_UPLOAD_CHUNK || !n || offset + n > bytes ||
+                       (n != WAVE_UPLOAD_CHUNK && offset + n != bytes)) {
+                wave_upload_answer(u, WAVE_UPLOAD_BAD_RANGE, seq);
+            } else {
+                memcpy(&u->table[offset], &f[5], n);
+                u->received[offset / WAVE_UPLOAD_CHUNK] = 1;
+                wave_upload_answer(u, WAVE_UPLOAD_OK, seq);
+            }
+            break;
+        }
+        case 'C': {
+            if (!u->points) {
+                bool again = u->done && get16(&f[1]) == u->done_crc; ///< se perdio la respuesta
+                wave_upload_answer(u, again ? WAVE_UPLOAD_OK : WAVE_UPLOAD_NO_START, 0);
+                break;
+            }
+            uint32_t chunks = (bytes + WAVE_UPLOAD_CHUNK - 1) / WAVE_UPLOAD_CHUNK;
+            bool complete = true;
+            for (uint32_t i = 0; i < chunks; i++) {
+                complete = complete && u->received[i];
+            }
+            if (!complete || get16(&f[1]) != u->crc || wave_upload_crc(0xFFFF, u->table, bytes) != u->crc) {
+                wave_upload_answer(u, WAVE_UPLOAD_BAD_TABLE, 0);
+                break;
+            }
+            u->points = 0;
+            u->done = true;
+            u->done_crc = u->crc;
+            wave_upload_answer(u, WAVE_UPLOAD_OK, 0);
+            return WAVE_UPLOAD_DONE;
+        }
+        case 'A':
+            u->points = 0;
+            wave_upload_answer(u, WAVE_UPLOAD_OK, 0);
+            break;
+        default:
+            wave_upload_answer(u, WAVE_UPLOAD_BAD_TYPE, 0);
+            break;
+    }
+    return WAVE_UPLOAD_BUSY;
+}
+
+/**
+ * @brief Feed one byte received on the serial port.
+ *
+ * @param u Receiver.
+ * @param byte Byte received.
+ * @param now_us Current time, for the timeout of a stalled frame.
+ * During a transfer, bytes outside a frame are the remains of a damaged
+ * one and are dropped rather than taken as commands.
+ *
+ * @return WAVE_UPLOAD_PASS if the byte is an ordinary command for the
+ *         caller, WAVE_UPLOAD_DONE when a table has just been completed
+ *         (read it with wave_upload_export()), WAVE_UPLOAD_BUSY otherwise.
+ */
+int wave_upload_feed(wave_upload_t *u, uint8_t byte, uint32_t now_us) {
+    if (u->in_frame && now_us - u->last_us > WAVE_UPLOAD_TIMEOUT_US) {
+        u->in_frame = false;
+        u->errors++;
+    }
+    if (!u->in_frame) {
+        if (u->points && now_us - u->last_us > WAVE_UPLOAD_SESSION_US) {
+            u->points = 0; ///< transferencia abandonada
+        }
+        if (byte != WAVE_UPLOAD_SYNC) {
+            return u->points ? WAVE_UPLOAD_BUSY : WAVE_UPLOAD_PASS; ///< restos de una trama danada
+        }
+        u->in_frame = true;
+        u->frame_len = 0;
+        u->last_us = now_us;
+        return WAVE_UPLOAD_BUSY;
+    }
+    u->last_us = now_us;
+    u->frame[u->frame_len++] = byte;
+    if (u->frame[0] == 'D' && u->frame_len == 5 && u->frame[4] > WAVE_UPLOAD_CHUNK) {
+        u->in_frame = false; ///< longitud danada: no cabe en la trama
+        wave_upload_answer(u, WAVE_UPLOAD_BAD_CRC, u->frame[1]);
+        return WAVE_UPLOAD_BUSY;
+    }
+    uint32_t expected = wave_upload_expected(u);
+    if (!expected || u->frame_len < expected) {
+        return WAVE_UPLOAD_BUSY;
+    }
+    u->in_frame = false;
+    return wave_upload_frame(u);
+}
+
+/**
+ * @brief Copy the last complete table, scaled to the sample width of the tables.
+ *
+ * @param dst Destination of u->length samples.
+ */
+void wave_upload_export(const wave_upload_t *u, waveform_sample_t *dst) {
+    for (uint32_t i = 0; i < u->length; i++) {
+        dst[i] = (waveform_sample_t)(get16(&u->table[2 * i]) >> (16 - WAVEFORM_BITS));
+    }
+}
+
+/**
+ * @brief Start frame, with the CRC of the whole table.
+ *
+ * @param buf Destination, at least WAVE_UPLOAD_FRAME_MAX + 1 bytes (the same for every builder).
+ * @return Length of the frame.
+ */
+uint32_t wave_upload_frame_begin(uint8_t *buf, uint32_t points, uint16_t crc) {
+    buf[0] = WAVE_UPLOAD_SYNC;
+    buf[1] = 'B';
+    put16(&buf[2], points);
+    put16(&buf[4], crc);
+    put16(&buf[6], wave_upload_crc(0xFFFF, &buf[2], 4));
+    return 8;
+}
+
+/**
+ * @brief Data frame of @p n bytes (at most WAVE_UPLOAD_CHUNK) at byte @p offset.
+ */
+uint32_t wave_upload_frame_data(uint8_t *buf, uint8_t seq, uint32_t offset, const uint8_t *data, uint32_t n) {
+    buf[0] = WAVE_UPLOAD_SYNC;
+    buf[1] = 'D';
+    buf[2] = seq;
+    put16(&buf[3], offset);
+    buf[5] = (uint8_t)n;
+    memcpy(&buf[6], data, n);
+    put16(&buf[6 + n], wave_upload_crc(0xFFFF, &buf[2], 4 + n));
+    return 8 + n;
+}
+
+/**
+ * @brief Commit frame, with the CRC of the whole table.
+ */
+uint32_t wave_upload_frame_commit(uint8_t *buf, uint16_t crc) {
+    buf[0] = WAVE_UPLOAD_SYNC;
+    buf[1] = 'C';
+    put16(&buf[2], crc);
+    put16(&buf[4], wave_upload_crc(0xFFFF, &buf[2], 2));
+    return 6;
+}
+
+uint32_t wave_upload_frame_abort(uint8_t *buf) {
+    buf[0] = WAVE_UPLOAD_SYNC;
+    buf[1] = 'A';
+    return 2;
+}
+
+/**
+ * @brief Parse a reply at the start of a buffer.
+ *
+ * @return Bytes used, 0 if the buffer holds only part of it, -1 if it is
+ *         not a reply (skip one byte and retry).
+ */
+int wave_upload_parse_reply(const uint8_t *buf, uint32_t len, uint8_t *status, uint8_t *seq) {
+    static const uint8_t head[2] = { WAVE_UPLOAD_REPLY, 'u' };
+    for (uint32_t i = 0; i < 2; i++) {
+        if (i >= len) {
+            return 0;
+        }
+        if (buf[i] != head[i]) {
+            return -1;
+        }
+    }
+    if (len < 5) {
+        return 0;
+    }
+    if (buf[4] != (uint8_t)~(buf[2] + buf[3])) {
+        return -1;
+    }
+    *status = buf[2];
+    *seq = buf[3];
+    return 5;
+}
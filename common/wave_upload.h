@@ -0,0 +1,97 @@
+/**
+ * @file wave_upload.h
+ * @brief Chunked upload of a custom waveform period over the USB serial port.
+ *
+ * The host sends frames, each starting with the sync byte 'U' and a type:
+ *
+ *     'U' 'B' points(u16) table(u16) crc(u16)             start
+ *     'U' 'D' seq(u8) offset(u16) n(u8) data[n] crc(u16)  n bytes at a byte offset
+ *     'U' 'C' table(u16) crc(u16)                         commit
+ *     'U' 'A'                                             abort
+ *
+ * Numbers are little-endian; @c table is the CRC of the whole table and
+ * @c crc the CRC-16/CCITT of the frame from the byte after the type. The
+ * table is @c points 16-bit samples (full scale 0-65535), received into a
+ * back buffer that the sample path never reads. Every frame is answered
+ * with
+ *
+ *     0x16 'u' status seq ~(status + seq)
+ *
+ * A commit with every byte received and a matching table CRC completes
+ * the upload; the firmware then rebuilds its waveform cache from the
+ * table, which swaps in at the next period boundary. A commit repeated
+ * because its reply was lost is answered OK again without a second
+ * completion. Outside a frame any
+ * other byte is handed back to the caller as an ordinary serial command.
+ * A frame that stalls for WAVE_UPLOAD_TIMEOUT_US is dropped, so a lost
+ * byte costs one retry instead of desynchronizing the stream; a transfer
+ * idle for WAVE_UPLOAD_SESSION_US is abandoned.
+ */
+
+// Avoid duplication in code
+#ifndef _WAVE_UPLOAD_H_
+#define _WAVE_UPLOAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "waveform.h"
+
+#define WAVE_UPLOAD_SYNC 'U' ///< Primer byte de una trama
+#define WAVE_UPLOAD_REPLY 0x16 ///< Primer byte de una respuesta
+#define WAVE_UPLOAD_CHUNK 64 ///< Bytes de datos por trama como maximo
+#define WAVE_UPLOAD_MAX_POINTS WAVEFORM_LENGTH ///< Puntos de la tabla recibida
+#define WAVE_UPLOAD_TIMEOUT_US 200000 ///< Pausa maxima dentro de una trama
+#define WAVE_UPLOAD_SESSION_US 2000000 ///< Pausa tras la que se abandona una transferencia
+#define WAVE_UPLOAD_FRAME_MAX (7 + WAVE_UPLOAD_CHUNK) ///< Bytes de la trama mas larga (sin el sync)
+
+// Estado devuelto en las respuestas
+#define WAVE_UPLOAD_OK 0          ///< Trama aceptada
+#define WAVE_UPLOAD_BAD_CRC 1     ///< CRC de la trama incorrecto
+#define WAVE_UPLOAD_BAD_RANGE 2   ///< Longitud u offset fuera de la tabla
+#define WAVE_UPLOAD_BAD_TABLE 3   ///< Faltan bytes o el CRC de la tabla no coincide
+#define WAVE_UPLOAD_NO_START 4    ///< Datos o commit sin inicio
+#define WAVE_UPLOAD_BAD_TYPE 5    ///< Tipo de trama desconocido
+
+// Resultado de wave_upload_feed()
+#define WAVE_UPLOAD_PASS 0  ///< El byte no es del protocolo: es un comando
+#define WAVE_UPLOAD_BUSY 1  ///< Byte consumido
+#define WAVE_UPLOAD_DONE 2  ///< Tabla nueva completa
+
+/**
+ * @brief Output of the replies.
+ */
+typedef void (*wave_upload_reply_t)(const uint8_t *buf, uint32_t len, void *ctx);
+
+/**
+ * @brief Receiver state.
+ */
+typedef struct {
+    uint8_t table[WAVE_UPLOAD_MAX_POINTS * 2];  ///< Tabla en recepcion (muestras de 16 bits)
+    uint8_t received[(WAVE_UPLOAD_MAX_POINTS * 2 + WAVE_UPLOAD_CHUNK - 1) / WAVE_UPLOAD_CHUNK]; ///< Trozos de 64 bytes ya recibidos (el ultimo puede ser corto)
+    uint8_t frame[WAVE_UPLOAD_FRAME_MAX];       ///< Trama en curso (sin el sync)
+    uint32_t frame_len;                         ///< Bytes de la trama en curso
+    bool in_frame;                              ///< Se recibio el sync
+    uint32_t last_us;                           ///< Instante del ultimo byte de una trama
+    uint32_t points;                            ///< Puntos anunciados (0 = sin transferencia)
+    uint16_t crc;                               ///< CRC anunciado de la tabla
+    uint16_t done_crc;                          ///< CRC de la ultima tabla completada
+    bool done;                                  ///< Hay una tabla completada
+    uint32_t length;                            ///< Puntos que acepta el receptor
+    uint32_t errors;                            ///< Tramas rechazadas
+    wave_upload_reply_t reply;                  ///< Salida de las respuestas
+    void *ctx;                                  ///< Contexto de la salida
+} wave_upload_t;
+
+uint16_t wave_upload_crc(uint16_t crc, const uint8_t *buf, uint32_t len);
+void wave_upload_init(wave_upload_t *u, uint32_t length, wave_upload_reply_t reply, void *ctx);
+int wave_upload_feed(wave_upload_t *u, uint8_t byte, uint32_t now_us);
+void wave_upload_export(const wave_upload_t *u, waveform_sample_t *dst);
+
+uint32_t wave_upload_frame_begin(uint8_t *buf, uint32_t points, uint16_t crc);
+uint32_t wave_upload_frame_data(uint8_t *buf, uint8_t seq, uint32_t offset, const uint8_t *data, uint32_t n);
+uint32_t wave_upload_frame_commit(uint8_t *buf, uint16_t crc);
+uint32_t wave_upload_frame_abort(uint8_t *buf);
+int wave_upload_parse_reply(const uint8_t *buf, uint32_t len, uint8_t *status, uint8_t *seq);
+
+#endif
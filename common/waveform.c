@@ -0,0 +1,145 @@
+/**
+ * @file waveform.c
+ * @brief Amplitude/offset scaling of the DAC codes and choice of the band-limited tables.
+ *
+ * Amplitude is given in mV peak to peak (100-2500) and offset in mV
+ * (50-1250), as entered on the keypad with the A and B commands.
+ */
+
+#include "waveform.h"
+
+#include <stddef.h>
+
+const waveform_sample_t *waveform_user = NULL;
+
+/**
+ * @brief Precompute the scaling for an amplitude and offset.
+ *
+ * @param Amp Amplitude of the signal.
+ * @param DC DC offset of the signal.
+ * @return Divisor and offset to use with waveform_apply().
+ */
+waveform_scaling_t waveform_scaling(uint32_t Amp, uint32_t DC) {
+    waveform_scaling_t k;
+    Amp /= 2;
+    if (Amp == 0) {
+        Amp = 1;
+    }
+    k.norm_Amp = (uint16_t)(2500 / Amp);
+    if (k.norm_Amp == 0) {
+        k.norm_Amp = 1;
+    }
+    k.norm_DC = (uint16_t)(255 - ((DC * 255) / 1250));
+    return k;
+}
+
+/**
+ * @brief Scale one table value, working out the scaling on every call.
+ *
+ * This is what generator() used to do for every sample; it is kept as the
+ * reference for the cached path.
+ *
+ * @param raw Table value.
+ * @param Amp Amplitude of the signal.
+ * @param DC DC offset of the signal.
+ * @return DAC code.
+ */
+uint8_t waveform_scale(uint8_t raw, uint32_t Amp, uint32_t DC) {
+    return waveform_apply(raw, waveform_scaling(Amp, DC));
+}
+
+/**
+ * @brief Band-limited table to play a shape at a frequency.
+ *
+ * Band b (1 to WAVEFORM_BANDS) keeps the harmonics up to
+ * (WAVEFORM_LENGTH / 2) >> b; the plain table (band 0) already stops at
+ * WAVEFORM_LENGTH / 2. The band returned is the richest one whose top
+ * harmonic stays at or below half the sample rate. Called when the
+ * frequency changes, never per sample.
+ *
+ * @param shape One of the WAVEFORM_* shapes; the sine and the uploaded
+ *        shape only have band 0.
+ * @param freq_mhz Highest fundamental to be played, in mHz.
+ * @param sample_rate_hz Sample clock.
+ * @return Band, 0 to WAVEFORM_BANDS.
+ */
+uint32_t waveform_band(uint8_t shape, uint32_t freq_mhz, uint32_t sample_rate_hz) {
+    uint32_t band = 0;
+#if WAVEFORM_BANDS
+    if (shape < WAVEFORM_TRIANGLE || shape > WAVEFORM_SQUARE || freq_mhz == 0) {
+        return 0;
+    }
+    uint64_t harmonics = (uint64_t)sample_rate_hz * 500u / freq_mhz; ///< armonicos por debajo de fs / 2
+    while (band < WAVEFORM_BANDS && ((uint32_t)(WAVEFORM_LENGTH / 2) >> band) > harmonics) {
+        band++;
+    }
+#else
+    (void)shape;
+    (void)freq_mhz;
+    (void)sample_rate_hz;
+#endif
+    return band;
+}
+
+/**
+ * @brief Band-limited period of a shape.
+ *
+ * @param shape One of the WAVEFORM_* shapes.
+ * @param band Band from waveform_band().
+ * @return One period of WAVEFORM_LENGTH points, NULL for band 0 (use
+ *         waveform_at()) or if the tables were built without bands.
+ */
+const waveform_sample_t *waveform_band_table(uint8_t shape, uint32_t band) {
+#if WAVEFORM_BANDS
+    if (band == 0 || band > WAVEFORM_BANDS) {
+        return NULL;
+    }
+    switch (shape) {
+    case WAVEFORM_TRIANGLE:
+        return triangular_banda[band - 1];
+    case WAVEFORM_SAWTOOTH:
+        return sierra_banda[band - 1];
+    case WAVEFORM_SQUARE:
+        return cuadrada_banda[band - 1];
+    }
+#else
+    (void)shape;
+    (void)band;
+#endif
+    return NULL;
+}
+
+/**
+ * @brief Select the table of WAVEFORM_USER.
+ *
+ * Only call it from the core that rebuilds the waveform caches: the table
+ * is read by the rebuilds, never by the sample path.
+ *
+ * @param table One period of WAVEFORM_LENGTH points, or NULL for the sine.
+ */
+void waveform_set_user(const waveform_sample_t *table) {
+    waveform_user = table;
+}
+
+#if !WAVEFORM_COMPACT
+/**
+ * @brief Table of a waveform shape.
+ *
+ * @param shape One of the WAVEFORM_* shapes; anything else selects the sine.
+ * @return One period of WAVEFORM_LENGTH points.
+ */
+const waveform_sample_t *waveform_table(uint8_t shape) {
+    switch (shape) {
+    case WAVEFORM_USER:
+        return waveform_user ? waveform_user : seno;
+    case WAVEFORM_TRIANGLE:
+        return triangular;
+    case WAVEFORM_SAWTOOTH:
+        return sierra;
+    case WAVEFORM_SQUARE:
+        return cuadrada;
+    default:
+        return seno;
+    }
+}
+#endif
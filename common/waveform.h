@@ -0,0 +1,107 @@
+/**
+ * @file waveform.h
+ * @brief Waveform shapes and the amplitude/offset scaling of the DAC codes.
+ */
+
+// Avoid duplication in code
+#ifndef _WAVEFORM_H_
+#define _WAVEFORM_H_
+
+#include <stdint.h>
+
+#include "waveform_tables.h"
+
+#define WAVEFORM_SINE 0      ///< Senoidal
+#define WAVEFORM_TRIANGLE 1  ///< Triangular
+#define WAVEFORM_SAWTOOTH 2  ///< Diente de sierra
+#define WAVEFORM_SQUARE 3    ///< Cuadrada
+#define WAVEFORM_COUNT 4     ///< Numero de formas de onda fijas
+#define WAVEFORM_USER 4      ///< Forma cargada por el puerto serie (wave_upload.h)
+
+/**
+ * @brief Precomputed amplitude/offset scaling.
+ */
+typedef struct {
+    uint16_t norm_Amp; ///< Divisor de la amplitud (2500 / (Amp / 2))
+    uint16_t norm_DC;  ///< Desplazamiento restado (255 - DC * 255 / 1250)
+} waveform_scaling_t;
+
+waveform_scaling_t waveform_scaling(uint32_t Amp, uint32_t DC);
+
+/**
+ * @brief Apply a precomputed scaling to a table value.
+ *
+ * Same arithmetic (and the same 8-bit wrap) as the firmware generator().
+ */
+static inline uint8_t waveform_apply(uint8_t raw, waveform_scaling_t k) {
+    uint16_t signal = raw;
+    signal = (signal / k.norm_Amp) - k.norm_DC;
+    return (uint8_t)signal;
+}
+
+uint8_t waveform_scale(uint8_t raw, uint32_t Amp, uint32_t DC);
+#if !WAVEFORM_COMPACT
+const waveform_sample_t *waveform_table(uint8_t shape);
+#endif
+
+uint32_t waveform_band(uint8_t shape, uint32_t freq_mhz, uint32_t sample_rate_hz);
+const waveform_sample_t *waveform_band_table(uint8_t shape, uint32_t band);
+
+extern const waveform_sample_t *waveform_user; ///< Tabla de WAVEFORM_USER (NULL: la senoidal)
+void waveform_set_user(const waveform_sample_t *table);
+
+#define WAVEFORM_FULL ((waveform_sample_t)((1u << WAVEFORM_BITS) - 1)) ///< Fondo de escala
+
+/**
+ * @brief Point @p i of a shape, unfolded from the quarter-wave tables.
+ *
+ * The sine and triangle are read from their first quarter (mirrored and
+ * inverted as needed); the sawtooth and square are computed. The result is
+ * bit-exact with the full-period tables written by gen_waveforms.py.
+ *
+ * @param shape One of the WAVEFORM_* shapes; anything else selects the sine.
+ * @param i Point index, 0 to WAVEFORM_LENGTH - 1.
+ * @return Table point.
+ */
+static inline waveform_sample_t waveform_compact_at(uint8_t shape, uint32_t i) {
+    switch (shape) {
+    case WAVEFORM_TRIANGLE:
+        if (i > 2 * WAVEFORM_QUARTER) {
+            i = WAVEFORM_LENGTH - i; ///< flanco de bajada: espejo del de subida
+        }
+        return i <= WAVEFORM_QUARTER ? triangular_cuarto[i]
+                                     : (waveform_sample_t)(WAVEFORM_FULL - triangular_cuarto[2 * WAVEFORM_QUARTER - i]);
+    case WAVEFORM_SAWTOOTH:
+        return (waveform_sample_t)((((i << WAVEFORM_BITS) / WAVEFORM_LENGTH) + (1u << (WAVEFORM_BITS - 1))) & WAVEFORM_FULL);
+    case WAVEFORM_SQUARE:
+        return i < 2 * WAVEFORM_QUARTER ? WAVEFORM_FULL : 0;
+    default: {
+        uint32_t j = i >= 2 * WAVEFORM_QUARTER ? i - 2 * WAVEFORM_QUARTER : i;
+        waveform_sample_t v = j <= WAVEFORM_QUARTER ? seno_cuarto[j] : seno_cuarto[2 * WAVEFORM_QUARTER - j];
+        return i >= 2 * WAVEFORM_QUARTER ? (waveform_sample_t)(WAVEFORM_FULL - v) : v; ///< medio periodo negativo
+    }
+    }
+}
+
+/**
+ * @brief Point @p i of a shape, whichever table format was built.
+ */
+static inline waveform_sample_t waveform_at(uint8_t shape, uint32_t i) {
+    if (shape == WAVEFORM_USER && waveform_user) {
+        return waveform_user[i];
+    }
+#if WAVEFORM_COMPACT
+    return waveform_compact_at(shape, i);
+#else
+    return waveform_table(shape)[i];
+#endif
+}
+
+/**
+ * @brief Reduce a table point to the 8 bits of the DAC0808.
+ */
+static inline uint8_t waveform_to_dac(waveform_sample_t v) {
+    return (uint8_t)(v >> (WAVEFORM_BITS - 8));
+}
+
+#endif
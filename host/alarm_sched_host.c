@@ -0,0 +1,47 @@
+/**
+ * @file alarm_sched_host.c
+ * @brief Host stand-in for the RP2040 timer alarms, on a virtual clock.
+ *
+ * Time only moves when the caller sets or advances it, so a driver can
+ * "fire" an alarm at its deadline plus any latency it wants to model, and
+ * task bodies can advance the clock to model their own duration.
+ */
+
+#include "alarm_sched_host.h"
+
+static uint64_t host_now; ///< Reloj virtual (us)
+static uint64_t host_armed[4]; ///< Plazo armado en cada alarma
+
+bool alarm_sched_hw_init(alarm_sched_t *s) {
+    return s->alarm <= 3;
+}
+
+bool alarm_sched_hw_arm(alarm_sched_t *s, uint64_t deadline) {
+    host_armed[s->alarm] = deadline;
+    return deadline > host_now;
+}
+
+uint64_t alarm_sched_hw_now(void) {
+    return host_now;
+}
+
+/**
+ * @brief Deadline the scheduler's alarm is armed for.
+ */
+uint64_t alarm_sched_host_armed(const alarm_sched_t *s) {
+    return host_armed[s->alarm];
+}
+
+/**
+ * @brief Set the virtual clock.
+ */
+void alarm_sched_host_set_now(uint64_t now) {
+    host_now = now;
+}
+
+/**
+ * @brief Advance the virtual clock.
+ */
+void alarm_sched_host_advance(uint32_t us) {
+    host_now += us;
+}
@@ -0,0 +1,16 @@
+/**
+ * @file alarm_sched_host.h
+ * @brief Virtual-clock backend of the alarm scheduler.
+ */
+
+// Avoid duplication in code
+#ifndef _ALARM_SCHED_HOST_H_
+#define _ALARM_SCHED_HOST_H_
+
+#include "alarm_sched.h"
+
+uint64_t alarm_sched_host_armed(const alarm_sched_t *s);
+void alarm_sched_host_set_now(uint64_t now);
+void alarm_sched_host_advance(uint32_t us);
+
+#endif
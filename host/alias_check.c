@@ -0,0 +1,203 @@
+/**
+ * @file alias_check.c
+ * @brief FFT-measured alias suppression of the band-limited waveform tables.
+ *
+ * Plays the triangle, sawtooth and square through the wave cache and the
+ * DDS at the c_irq sample rate, once from the plain table and once from
+ * the band-limited table waveform_band() picks, and takes the spectrum of
+ * the DAC codes (Blackman-Harris window, radix-2 FFT). The alias level is
+ * the strongest component at the folded frequency of a harmonic above
+ * fs / 2, in dB below the fundamental; components within a few bins of a
+ * harmonic that belongs in the band are left out.
+ *
+ * Every band-limited case must keep its alias level below CHECK_ALIAS_DBC
+ * and never above the plain table's; where the plain table aliases above
+ * CHECK_ALIASING_DBC it must gain at least CHECK_GAIN_DB, or reach the
+ * truncation floor. The fundamental must stay within CHECK_FUNDAMENTAL_DB
+ * of the plain one.
+ *
+ * The DDS reads the table without interpolation, so it truncates the phase
+ * to one of WAVEFORM_LENGTH points and adds spurs of its own, up to about
+ * 20 log10(pi / (2 WAVEFORM_LENGTH)) dBc (-6.02 dB per index bit + 3.92 dB)
+ * whatever the table holds: -44 dBc at 256 points, but -38 dBc at 128 and
+ * -36 dBc at 100 (the multiply path). No table can alias below that floor,
+ * so for short tables the bound is the floor instead of CHECK_ALIAS_DBC.
+ * Prints one line per case and the flash used by each table set. Exits
+ * non-zero on any failure.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "check.h"
+#include "gen_block.h"
+
+#define CHECK_RATE_HZ 20000 ///< Reloj de muestreo de c_irq
+#define CHECK_N 65536u ///< Muestras por espectro (potencia de dos)
+#define CHECK_GUARD 6 ///< Bins alrededor de un armonico legitimo que no se miden
+#define CHECK_SPAN 3 ///< Bins a cada lado de una posicion de alias
+#define CHECK_ALIAS_DBC -40.0 ///< Alias maximo con la tabla de banda limitada
+#define CHECK_ALIASING_DBC -30.0 ///< Alias de la tabla normal a partir del cual se exige mejora
+#define CHECK_GAIN_DB 15.0 ///< Mejora minima frente a la tabla normal
+#define CHECK_FUNDAMENTAL_DB 4.0 ///< Diferencia maxima de la fundamental (una cuadrada reducida a su fundamental pierde 4/pi, una sierra gana pi/2)
+#define CHECK_PI 3.14159265358979323846
+
+static const uint32_t freqs_mhz[] = { 97300, 311700, 1013900, 2477100, 4391300 };
+static const char *names[WAVEFORM_COUNT] = { "sine", "triangle", "sawtooth", "square" };
+
+static double re[CHECK_N];
+static double im[CHECK_N];
+static double mag[CHECK_N / 2];
+static uint8_t codes[CHECK_N];
+
+/**
+ * @brief In-place iterative radix-2 FFT of re + j im.
+ */
+static void fft(void) {
+    for (uint32_t i = 1, j = 0; i < CHECK_N; i++) {
+        uint32_t bit = CHECK_N >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            double t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+    for (uint32_t len = 2; len <= CHECK_N; len <<= 1) {
+        double a = -2.0 * CHECK_PI / len;
+        for (uint32_t i = 0; i < CHECK_N; i += len) {
+            for (uint32_t k = 0; k < len / 2; k++) {
+                double wr = cos(a * k), wi = sin(a * k);
+                double *ur = &re[i + k], *ui = &im[i + k];
+                double *vr = &re[i + k + len / 2], *vi = &im[i + k + len / 2];
+                double tr = *vr * wr - *vi * wi;
+                double ti = *vr * wi + *vi * wr;
+                *vr = *ur - tr;
+                *vi = *ui - ti;
+                *ur += tr;
+                *ui += ti;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Magnitude spectrum of the DAC codes of a shape played from a band.
+ */
+static void spectrum(uint8_t shape, uint32_t band, uint32_t freq_mhz) {
+    static wave_cache_t cache;
+    gen_state_t gen = { .cache = &cache };
+    dds_init(&gen.dds, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&gen.dds, freq_mhz, CHECK_RATE_HZ);
+    wave_cache_init(&cache, WAVEFORM_LENGTH);
+    wave_cache_begin(&cache);
+    wave_cache_fill_band(&cache, shape, band, 2500, 1250);
+    wave_cache_commit(&cache, 0, 0);
+    wave_cache_swap(&cache);
+    gen_block_fill(&gen, codes, CHECK_N);
+
+    double mean = 0.0;
+    for (uint32_t i = 0; i < CHECK_N; i++) {
+        mean += codes[i];
+    }
+    mean /= CHECK_N;
+    for (uint32_t i = 0; i < CHECK_N; i++) {
+        double x = 2.0 * CHECK_PI * i / CHECK_N;
+        double w = 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x) - 0.01168 * cos(3 * x); ///< Blackman-Harris
+        re[i] = (codes[i] - mean) * w;
+        im[i] = 0.0;
+    }
+    fft();
+    for (uint32_t k = 0; k < CHECK_N / 2; k++) {
+        mag[k] = hypot(re[k], im[k]);
+    }
+}
+
+/**
+ * @brief Strongest bin within CHECK_SPAN of a frequency.
+ */
+static double peak(double hz) {
+    long centre = lround(hz * CHECK_N / CHECK_RATE_HZ);
+    double best = 0.0;
+    for (long k = centre - CHECK_SPAN; k <= centre + CHECK_SPAN; k++) {
+        if (k > 0 && k < (long)(CHECK_N / 2) && mag[k] > best) {
+            best = mag[k];
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Where harmonic @p n of @p f lands after sampling.
+ */
+static double folded(double f, uint32_t n) {
+    double g = fmod(n * f, CHECK_RATE_HZ);
+    return g > CHECK_RATE_HZ / 2.0 ? CHECK_RATE_HZ - g : g;
+}
+
+/**
+ * @brief Strongest alias of the last spectrum, in dB below the fundamental.
+ */
+static double alias_dbc(double f, double fundamental) {
+    double bin = (double)CHECK_RATE_HZ / CHECK_N;
+    double worst = 0.0;
+    for (uint32_t n = 2; n <= 2 * WAVEFORM_LENGTH; n++) {
+        if (n * f <= CHECK_RATE_HZ / 2.0) {
+            continue; ///< armonico legitimo
+        }
+        double g = folded(f, n);
+        bool legit = g < (CHECK_GUARD + CHECK_SPAN) * bin; ///< peak() mira CHECK_SPAN bins mas alla
+        for (uint32_t m = 1; m * f <= CHECK_RATE_HZ / 2.0 && !legit; m++) {
+            legit = fabs(g - m * f) < (CHECK_GUARD + CHECK_SPAN) * bin;
+        }
+        double a = legit ? 0.0 : peak(g);
+        worst = a > worst ? a : worst;
+    }
+    return worst > 0.0 ? 20.0 * log10(worst / fundamental) : -200.0;
+}
+
+int main(void) {
+#if WAVEFORM_BANDS
+    double floor_dbc = 20.0 * log10(CHECK_PI / (2.0 * WAVEFORM_LENGTH)); ///< espurias del truncado de fase
+    double limit_dbc = floor_dbc > CHECK_ALIAS_DBC ? floor_dbc : CHECK_ALIAS_DBC;
+    printf("alias bound %.1f dBc (phase truncation floor of %u points: %.1f dBc)\n", limit_dbc, WAVEFORM_LENGTH,
+           floor_dbc);
+    printf("%-9s %10s %5s %14s %14s %12s\n", "shape", "freq", "band", "plain (dBc)", "limited (dBc)", "fund. (dB)");
+    for (uint8_t shape = WAVEFORM_TRIANGLE; shape <= WAVEFORM_SQUARE; shape++) {
+        for (uint32_t i = 0; i < sizeof(freqs_mhz) / sizeof(freqs_mhz[0]); i++) {
+            double f = freqs_mhz[i] / 1000.0;
+            uint32_t band = waveform_band(shape, freqs_mhz[i], CHECK_RATE_HZ);
+
+            spectrum(shape, 0, freqs_mhz[i]);
+            double plain_fund = peak(f);
+            double plain = alias_dbc(f, plain_fund);
+            spectrum(shape, band, freqs_mhz[i]);
+            double limited_fund = peak(f);
+            double limited = alias_dbc(f, limited_fund);
+            double fund_db = 20.0 * log10(limited_fund / plain_fund);
+
+            bool ok = limited <= limit_dbc && limited <= plain + 0.5 && fabs(fund_db) <= CHECK_FUNDAMENTAL_DB;
+            if (plain > CHECK_ALIASING_DBC) {
+                ok = ok && (plain - limited >= CHECK_GAIN_DB || limited <= floor_dbc);
+            }
+            printf("%-9s %8.1f Hz %5u %14.1f %14.1f %12.2f%s\n", names[shape], f, band, plain, limited, fund_db,
+                   ok ? "" : "  FAIL");
+            check_quiet(ok, "%s at %.1f Hz", names[shape], f);
+        }
+    }
+
+    uint32_t width = sizeof(waveform_sample_t);
+    printf("memory: %u B per band-limited set (%u octaves of %u points x %u B), %u B for the three shapes\n",
+           (unsigned)sizeof(sierra_banda), WAVEFORM_BANDS, WAVEFORM_LENGTH, width,
+           (unsigned)(sizeof(triangular_banda) + sizeof(sierra_banda) + sizeof(cuadrada_banda)));
+#else
+    printf("built without band-limited tables (SIGGEN_BANDLIMITED_TABLES=OFF)\n");
+#endif
+    return check_result();
+}
@@ -0,0 +1,29 @@
+/**
+ * @file bench.h
+ * @brief Timing helpers shared by the host benchmarks.
+ */
+
+// Avoid duplication in code
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Monotonic time in nanoseconds.
+ */
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Samples per second for @p samples produced in @p ns nanoseconds.
+ */
+static inline double bench_rate(uint64_t samples, uint64_t ns) {
+    return ns ? (double)samples * 1e9 / (double)ns : 0.0;
+}
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file bench_gen_block.c
+ * @brief Samples per second of the block kernels for block sizes 16 to 64K.
+ *
+ * Every kernel fills the same number of samples in blocks of the given
+ * size from a rebuilt sine period; its output is compared byte for byte
+ * with gen_kernel_ref(). A non power-of-two length is also run to cover the
+ * multiply path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "gen_block.h"
+
+#define BENCH_SAMPLES (1u << 26)
+#define BENCH_MAX_BLOCK (64u * 1024u)
+
+typedef struct {
+    const char *name;
+    gen_kernel_t kernel;
+} bench_kernel_t;
+
+static uint8_t out_ref[BENCH_MAX_BLOCK];
+static uint8_t out[BENCH_MAX_BLOCK];
+static volatile uint8_t sink; ///< Evita que el compilador descarte los bloques
+
+/**
+ * @brief Run @p samples samples in blocks of @p block and return samples/s.
+ *
+ * @return Samples/s, or a negative value if the output differs from the reference.
+ */
+static double bench_kernel(gen_kernel_t kernel, const wave_cache_t *cache, uint32_t length,
+                           uint32_t block, uint32_t samples) {
+    dds_t d;
+    dds_t r;
+    dds_init(&d, length, false);
+    dds_set_frequency(&d, 1234567, 1000000);
+    r = d;
+
+    const uint8_t *codes = cache->buf[cache->active];
+    bool match = true;
+    for (uint32_t b = 0; b < 64; b++) { ///< se verifican los primeros bloques
+        kernel(codes, &d, out, block);
+        gen_kernel_ref(codes, &r, out_ref, block);
+        match = match && memcmp(out, out_ref, block) == 0 && d.phase == r.phase;
+    }
+
+    uint32_t blocks = samples / block;
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t b = 0; b < blocks; b++) {
+        kernel(codes, &d, out, block);
+        sink ^= out[b & (block - 1)];
+    }
+    uint64_t ns = bench_now_ns() - t0;
+    return match ? bench_rate((uint64_t)blocks * block, ns) : -1.0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t samples = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_SAMPLES;
+    bench_kernel_t kernels[4];
+    uint32_t kernel_count = 0;
+    static wave_cache_t cache;
+    int status = 0;
+
+    kernels[kernel_count++] = (bench_kernel_t){ "ref", gen_kernel_ref };
+    kernels[kernel_count++] = (bench_kernel_t){ "scalar", gen_kernel_scalar };
+#if GEN_BLOCK_X86
+    kernels[kernel_count++] = (bench_kernel_t){ "sse2", gen_kernel_sse2 };
+    if (gen_kernel_avx2_supported()) {
+        kernels[kernel_count++] = (bench_kernel_t){ "avx2", gen_kernel_avx2 };
+    }
+#endif
+
+    uint32_t lengths[2] = { WAVEFORM_LENGTH, WAVEFORM_LENGTH - 4 };
+    printf("kernel,length,block,samples_per_s,match\n");
+    for (uint32_t l = 0; l < 2; l++) {
+        wave_cache_init(&cache, lengths[l]);
+        wave_cache_rebuild_shape(&cache, WAVEFORM_SINE, 1000, 100);
+        wave_cache_swap(&cache);
+        for (uint32_t k = 0; k < kernel_count; k++) {
+            for (uint32_t block = 16; block <= BENCH_MAX_BLOCK; block *= 4) {
+                double rate = bench_kernel(kernels[k].kernel, &cache, lengths[l], block, samples);
+                printf("%s,%u,%u,%.0f,%s\n", kernels[k].name, lengths[l], block, rate < 0 ? 0.0 : rate,
+                       rate < 0 ? "no" : "yes");
+                if (rate < 0) {
+                    status = 1;
+                }
+            }
+        }
+    }
+    return status;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file bench_micro.c
+ * @brief The microbenchmark suite on the host (c_bench runs it on the RP2040).
+ *
+ * Usage: bench_micro [ops]. Prints the CSV described in microbench.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "microbench.h"
+
+#define BENCH_OPS (1u << 22)
+
+int main(int argc, char **argv) {
+    uint32_t ops = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_OPS;
+    char line[160];
+
+    microbench_hw_init();
+    microbench_csv_header(line, sizeof(line));
+    fputs(line, stdout);
+    for (uint32_t i = 0; i < microbench_count; i++) {
+        microbench_result_t r;
+        microbench_run(&microbench_suite[i], ops, &r);
+        microbench_csv_line(&microbench_suite[i], &r, line, sizeof(line));
+        fputs(line, stdout);
+    }
+    return 0;
+}
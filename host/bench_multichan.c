@@ -0,0 +1,132 @@
+/**
+ * @file bench_multichan.c
+ * @brief Per-tick cost of 1 to MULTICHAN_MAX phase-locked channels.
+ *
+ * "separate" runs one single-channel generator per channel, each with its
+ * own phase and its own eight-line bus write (what the firmware would do
+ * with copies of its globals). "multichan" is the shared-clock engine with
+ * one masked write per tick. The bus is a set of volatile words standing
+ * in for the SIO registers. Every channel of the engine is also checked
+ * against its separate generator, phase offsets included.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "gen_block.h"
+#include "multichan.h"
+
+#define BENCH_TICKS 20000000u
+#define BENCH_CHECK_TICKS 100000u
+
+static volatile uint32_t sio_set;  ///< Registro GPIO_OUT_SET
+static volatile uint32_t sio_clr;  ///< Registro GPIO_OUT_CLR
+static volatile uint32_t sio_togl; ///< Registro GPIO_OUT_XOR
+static volatile uint32_t sio_out;  ///< Registro GPIO_OUT
+
+// Bus de c_irq, el del segundo DAC de c_irq (SIGGEN_IQ_OUTPUT) y uno mas solo para el host
+static const uint8_t pins[MULTICHAN_MAX][MULTICHAN_BITS] = {
+    { 16, 17, 18, 19, 20, 21, 22, 26 },
+    { 10, 11, 12, 13, 14, 15, 27, 28 },
+    { 0, 2, 3, 4, 5, 6, 7, 8 },
+};
+
+static multichan_t engine;
+static wave_cache_t caches[MULTICHAN_MAX];
+static gen_state_t gens[MULTICHAN_MAX];
+
+/**
+ * @brief set_dac_value() on a channel's pins.
+ */
+static inline void bus_put8(const uint8_t *p, uint8_t code) {
+    for (uint32_t b = 0; b < MULTICHAN_BITS; b++) {
+        if (code & (1u << b)) {
+            sio_set = 1u << p[b];
+        } else {
+            sio_clr = 1u << p[b];
+        }
+    }
+}
+
+/**
+ * @brief Set up @p count channels of different shapes, 90 degrees apart.
+ */
+static void setup(uint32_t count) {
+    multichan_init(&engine, count, WAVEFORM_LENGTH);
+    dds_set_frequency(&engine.dds, 1234567, 20000);
+    for (uint32_t c = 0; c < count; c++) {
+        uint8_t shape = (uint8_t)(c % WAVEFORM_COUNT);
+        uint32_t amp = 1000 + 300 * c;
+        uint32_t dc = 100 + 200 * c;
+        uint32_t phase = multichan_phase_deg(90 * c);
+        multichan_set_pins(&engine, c, pins[c]);
+        multichan_set_wave(&engine, c, shape, 0, amp, dc);
+        multichan_set_phase(&engine, c, phase);
+
+        wave_cache_init(&caches[c], WAVEFORM_LENGTH);
+        wave_cache_rebuild_shape(&caches[c], shape, amp, dc);
+        wave_cache_swap(&caches[c]);
+        gens[c].cache = &caches[c];
+        gens[c].dds = engine.dds;
+        gens[c].dds.phase = phase;
+    }
+    multichan_swap(&engine);
+}
+
+/**
+ * @brief Compare every channel of the engine with its separate generator.
+ */
+static bool check(uint32_t count) {
+    setup(count);
+    for (uint32_t i = 0; i < BENCH_CHECK_TICKS; i++) {
+        uint32_t bits = multichan_tick(&engine);
+        if (bits & ~engine.bus_mask) {
+            return false;
+        }
+        for (uint32_t c = 0; c < count; c++) {
+            if (multichan_decode(&engine, c, bits) != gen_next(&gens[c])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t ticks = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_TICKS;
+    double base_sep = 0;
+    double base_multi = 0;
+    int status = 0;
+
+    printf("channels,separate_ns_per_tick,multichan_ns_per_tick,separate_vs_1,multichan_vs_1,match\n");
+    for (uint32_t count = 1; count <= MULTICHAN_MAX; count++) {
+        bool match = check(count);
+
+        setup(count);
+        uint64_t t0 = bench_now_ns();
+        for (uint32_t i = 0; i < ticks; i++) {
+            for (uint32_t c = 0; c < count; c++) {
+                bus_put8(pins[c], gen_next(&gens[c]));
+            }
+        }
+        uint64_t t1 = bench_now_ns();
+        for (uint32_t i = 0; i < ticks; i++) {
+            sio_togl = (sio_out ^ multichan_tick(&engine)) & engine.bus_mask; ///< gpio_put_masked()
+        }
+        uint64_t t2 = bench_now_ns();
+
+        double sep = (double)(t1 - t0) / ticks;
+        double multi = (double)(t2 - t1) / ticks;
+        if (count == 1) {
+            base_sep = sep;
+            base_multi = multi;
+        }
+        printf("%u,%.3f,%.3f,%.2f,%.2f,%s\n", count, sep, multi, sep / base_sep, multi / base_multi,
+               match ? "yes" : "no");
+        if (!match) {
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file bench_wave_cache.c
+ * @brief Samples per second: per-sample scaling vs. the active waveform cache.
+ *
+ * The "generator" column does what generator() did before the cache: pick
+ * the table, step the DDS and scale with two divisions on every sample. The
+ * "cache" column is the current sample path. Both must produce the same
+ * codes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "dds.h"
+#include "wave_cache.h"
+#include "waveform.h"
+
+#define BENCH_POINTS WAVEFORM_LENGTH
+#define BENCH_SAMPLES 20000000u
+
+static uint8_t tables[WAVEFORM_COUNT][BENCH_POINTS]; ///< Tablas reducidas a 8 bits
+static volatile uint8_t signal_count = WAVEFORM_SINE; ///< Leidos en cada muestra, como en el firmware
+static volatile uint32_t amplitude = 1000;
+static volatile uint32_t offsete = 100;
+
+/**
+ * @brief Per-sample path of the old generator().
+ */
+static uint8_t generator_uncached(dds_t *d) {
+    const uint8_t *table = tables[signal_count < WAVEFORM_COUNT ? signal_count : 0];
+    return waveform_scale(dds_next(d, table), amplitude, offsete);
+}
+
+int main(int argc, char **argv) {
+    uint32_t samples = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_SAMPLES;
+
+    for (uint8_t shape = 0; shape < WAVEFORM_COUNT; shape++) {
+        for (uint32_t i = 0; i < BENCH_POINTS; i++) {
+            tables[shape][i] = waveform_to_dac(waveform_at(shape, i));
+        }
+    }
+
+    printf("shape,generator_sps,cache_sps,speedup,match\n");
+    for (uint8_t shape = 0; shape < WAVEFORM_COUNT; shape++) {
+        dds_t a;
+        dds_t b;
+        wave_cache_t cache;
+        uint32_t sum_a = 0;
+        uint32_t sum_b = 0;
+
+        signal_count = shape;
+        dds_init(&a, BENCH_POINTS, false);
+        dds_set_frequency(&a, 123456, 20000);
+        b = a;
+        wave_cache_init(&cache, BENCH_POINTS);
+        wave_cache_rebuild_shape(&cache, shape, amplitude, offsete);
+        wave_cache_swap(&cache);
+
+        uint64_t t0 = bench_now_ns();
+        for (uint32_t i = 0; i < samples; i++) {
+            sum_a = sum_a * 31u + generator_uncached(&a);
+        }
+        uint64_t t1 = bench_now_ns();
+        for (uint32_t i = 0; i < samples; i++) {
+            sum_b = sum_b * 31u + wave_cache_next(&cache, &b);
+        }
+        uint64_t t2 = bench_now_ns();
+
+        double rate_a = bench_rate(samples, t1 - t0);
+        double rate_b = bench_rate(samples, t2 - t1);
+        printf("%u,%.0f,%.0f,%.2f,%s\n", shape, rate_a, rate_b, rate_b / rate_a, sum_a == sum_b ? "yes" : "no");
+    }
+    return 0;
+}
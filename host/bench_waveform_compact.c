@@ -0,0 +1,91 @@
+/**
+ * @file bench_waveform_compact.c
+ * @brief Size and speed of the quarter-wave tables against the full tables.
+ *
+ * Every shape is read once with a DDS sweep (how the sample path walks a
+ * table) and once at random points (how several channels or a modulator
+ * hit it). The compact lookup is also checked point by point against the
+ * full tables.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "dds.h"
+#include "waveform.h"
+
+#define BENCH_LOOKUPS 20000000u
+
+static const char *shape_names[WAVEFORM_COUNT] = {"sine", "triangle", "sawtooth", "square"};
+
+/**
+ * @brief Xorshift generator for the random access pattern.
+ */
+static inline uint32_t bench_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Next point index of the access pattern.
+ */
+static inline uint32_t bench_index(int random, dds_t *d, uint32_t *state) {
+    if (random) {
+        return bench_random(state) % WAVEFORM_LENGTH;
+    }
+    uint32_t phase = d->phase;
+    d->phase += d->tuning;
+    return (uint32_t)(((uint64_t)phase * WAVEFORM_LENGTH) >> 32);
+}
+
+int main(int argc, char **argv) {
+    uint32_t lookups = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_LOOKUPS;
+    uint32_t width = (uint32_t)sizeof(waveform_sample_t);
+    uint32_t full_bytes[WAVEFORM_COUNT] = {WAVEFORM_LENGTH * width, WAVEFORM_LENGTH * width,
+                                           WAVEFORM_LENGTH * width, WAVEFORM_LENGTH * width};
+    uint32_t compact_bytes[WAVEFORM_COUNT] = {(WAVEFORM_QUARTER + 1) * width, (WAVEFORM_QUARTER + 1) * width, 0, 0};
+
+    printf("shape,access,full_bytes,compact_bytes,full_lps,compact_lps,compact_vs_full,bit_exact\n");
+    for (uint8_t shape = 0; shape < WAVEFORM_COUNT; shape++) {
+        const waveform_sample_t *table = waveform_table(shape);
+        int exact = 1;
+        for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+            if (waveform_compact_at(shape, i) != table[i]) {
+                exact = 0;
+            }
+        }
+
+        for (int random = 0; random < 2; random++) {
+            dds_t d;
+            uint32_t state = 2463534242u;
+            uint32_t sum_full = 0;
+            uint32_t sum_compact = 0;
+
+            dds_init(&d, WAVEFORM_LENGTH, false);
+            dds_set_frequency(&d, 1234567, 1000000);
+            uint64_t t0 = bench_now_ns();
+            for (uint32_t n = 0; n < lookups; n++) {
+                sum_full += table[bench_index(random, &d, &state)];
+            }
+            uint64_t t1 = bench_now_ns();
+            d.phase = 0;
+            state = 2463534242u;
+            for (uint32_t n = 0; n < lookups; n++) {
+                sum_compact += waveform_compact_at(shape, bench_index(random, &d, &state));
+            }
+            uint64_t t2 = bench_now_ns();
+
+            double full = bench_rate(lookups, t1 - t0);
+            double compact = bench_rate(lookups, t2 - t1);
+            printf("%s,%s,%u,%u,%.0f,%.0f,%.2f,%s\n", shape_names[shape], random ? "random" : "dds",
+                   full_bytes[shape], compact_bytes[shape], full, compact, compact / full,
+                   exact && sum_full == sum_compact ? "yes" : "no");
+        }
+    }
+    return 0;
+}
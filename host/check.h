@@ -0,0 +1,112 @@
+/**
+ * @file check.h
+ * @brief Pass/fail bookkeeping and random numbers shared by the host checks.
+ *
+ * A check program reports each condition with check(), check_value() or,
+ * inside long loops, check_quiet(), and ends with
+ * "return check_result();", which prints PASS or FAIL and gives the exit
+ * status. check_rand() is a small deterministic generator, so every run
+ * sees the same cases.
+ */
+
+// Avoid duplication in code
+#ifndef _CHECK_H_
+#define _CHECK_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define CHECK_MAX_REPORTS 10 ///< Fallos de check_quiet() que se imprimen
+#define CHECK_SEED 2024u     ///< Semilla por defecto de check_rand()
+
+/**
+ * @brief State of the checks of the program.
+ */
+typedef struct {
+    int failures;  ///< Comprobaciones fallidas
+    uint32_t rng;  ///< Estado de check_rand()
+} check_state_t;
+
+static inline check_state_t *check_state(void) {
+    static check_state_t state = { 0, CHECK_SEED };
+    return &state;
+}
+
+/**
+ * @brief Count a condition and print it.
+ */
+static inline void check(bool ok, const char *what) {
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        check_state()->failures++;
+    }
+}
+
+/**
+ * @brief Count a condition and print it with the measured and the expected value.
+ */
+static inline void check_value(bool ok, const char *what, double got, double want) {
+    printf("%-36s got %16.6f want %16.6f  %s\n", what, got, want, ok ? "ok" : "FAIL");
+    if (!ok) {
+        check_state()->failures++;
+    }
+}
+
+/**
+ * @brief Count a condition, printing only the first CHECK_MAX_REPORTS failures.
+ *
+ * @param fmt What failed, printf style (formatted only on a failure).
+ */
+static inline __attribute__((format(printf, 2, 3))) void check_quiet(bool ok, const char *fmt, ...) {
+    if (ok) {
+        return;
+    }
+    if (check_state()->failures++ < CHECK_MAX_REPORTS) {
+        va_list args;
+        va_start(args, fmt);
+        printf("FAIL ");
+        vprintf(fmt, args);
+        printf("\n");
+        va_end(args);
+    }
+}
+
+/**
+ * @brief Failures so far.
+ */
+static inline int check_failures(void) {
+    return check_state()->failures;
+}
+
+/**
+ * @brief Print PASS or FAIL.
+ *
+ * @return Exit status of the program: 0 if every check passed.
+ */
+static inline int check_result(void) {
+    printf("%s\n", check_failures() ? "FAIL" : "PASS");
+    return check_failures() ? 1 : 0;
+}
+
+/**
+ * @brief Restart check_rand() (@p seed not 0).
+ */
+static inline void check_seed(uint32_t seed) {
+    check_state()->rng = seed;
+}
+
+/**
+ * @brief Small deterministic generator (xorshift32).
+ */
+static inline uint32_t check_rand(void) {
+    uint32_t r = check_state()->rng;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    check_state()->rng = r;
+    return r;
+}
+
+#endif
@@ -0,0 +1,219 @@
+/**
+ * @file clock_plan_check.c
+ * @brief Clock plans checked against the PLL and PIO limits, from 1 Hz to 1 MHz.
+ *
+ * Builds the planner with the firmware defaults and checks:
+ *
+ * - The clock table: every clock the PLL can make within the limits as a
+ *   whole number of kHz is in it, once, in ascending order, with a PLL
+ *   setting that really gives it.
+ * - Every plan of a sweep of log-spaced and random frequencies: the PLL
+ *   setting, the PIO divider range, the points per period (a power of two
+ *   whose step is exact, or a rounded step with at least the minimum), the
+ *   CPU load, and the achieved frequency and error worked out again here
+ *   from the clocks alone.
+ * - Low frequencies run from low system clocks, and planning again with
+ *   the clock in use keeps it.
+ * - No plan is worse than the fixed configuration (boot clock at
+ *   PIO_SAMPLE_RATE_HZ) by more than the tolerance.
+ *
+ * Prints the error of both, the clocks used and the cost of a plan. Exits
+ * non-zero on any failure.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "check.h"
+#include "clock_plan.h"
+#include "dac_stream.h"
+#include "dds.h"
+#include "waveform.h"
+
+#define CHECK_MIN_MHZ 1000u           ///< 1 Hz
+#define CHECK_MAX_MHZ 1000000000u     ///< 1 MHz
+#define CHECK_LOG_STEPS 600u          ///< Frecuencias espaciadas logaritmicamente
+#define CHECK_RANDOM 3000u            ///< Frecuencias al azar (mHz)
+#define CHECK_FIXED_KHZ 125000u       ///< Reloj de arranque del RP2040
+#define CHECK_FIXED_RATE 1000000u     ///< PIO_SAMPLE_RATE_HZ de c_irq
+/// Por debajo de 1 kHz (o de 256 kSa/s con la tabla entera, si pasa de 256 puntos)...
+#define CHECK_LOW_MHZ (WAVEFORM_LENGTH > 256 ? 256000000u / WAVEFORM_LENGTH : 1000000u)
+#define CHECK_LOW_KHZ 48000u          ///< ...el reloj no pasa de 48 MHz
+#define CHECK_TOO_HIGH_MHZ 4000000000u   ///< 4 MHz: ningun plan llega
+
+
+static clock_planner_t planner;
+
+
+
+/**
+ * @brief Error of a plan, worked out again from its clocks.
+ *
+ * @return Error in ppb.
+ */
+static double recompute_ppb(const clock_plan_t *p, uint32_t freq_mhz) {
+    double sys = 12e6 * (p->vco_khz / 12000u) / (p->postdiv1 * p->postdiv2);
+    double fs = sys * 256.0 / ((double)p->div256 * p->hold);
+    double f = fs * p->tuning / 4294967296.0;
+    return (f * 1000.0 - freq_mhz) / freq_mhz * 1e9;
+}
+
+static void check_table(void) {
+    const clock_plan_limits_t *l = &planner.limits;
+    uint32_t expected = 0;
+    for (uint32_t khz = l->sys_min_khz; khz <= l->sys_max_khz; khz++) {
+        bool possible = false;
+        for (uint32_t pd1 = 1; pd1 <= CLOCK_PLAN_POSTDIV_MAX && !possible; pd1++) {
+            for (uint32_t pd2 = 1; pd2 <= CLOCK_PLAN_POSTDIV_MAX && !possible; pd2++) {
+                uint64_t vco = (uint64_t)khz * pd1 * pd2;
+                possible = vco % CLOCK_PLAN_XOSC_KHZ == 0 && vco >= CLOCK_PLAN_VCO_MIN_KHZ
+                           && vco <= CLOCK_PLAN_VCO_MAX_KHZ;
+            }
+        }
+        if (possible) {
+            const clock_plan_pll_t *c = clock_planner_find(&planner, khz);
+            check_quiet(c != NULL, "clock missing from the table (%u kHz)", khz);
+            expected++;
+        }
+    }
+    check_quiet(planner.count == expected, "table size (%u clocks)", planner.count);
+    for (uint32_t i = 0; i < planner.count; i++) {
+        const clock_plan_pll_t *c = &planner.clocks[i];
+        uint32_t vco = CLOCK_PLAN_XOSC_KHZ * c->fbdiv;
+        check_quiet(i == 0 || c[-1].sys_khz < c->sys_khz, "table sorted and unique (%u kHz)", c->sys_khz);
+        check_quiet(vco >= CLOCK_PLAN_VCO_MIN_KHZ && vco <= CLOCK_PLAN_VCO_MAX_KHZ, "VCO range (%u kHz)", c->sys_khz);
+        check_quiet(c->postdiv1 >= 1 && c->postdiv1 <= CLOCK_PLAN_POSTDIV_MAX && c->postdiv2 >= 1
+                    && c->postdiv2 <= c->postdiv1, "post dividers (%u kHz)", c->sys_khz);
+        check_quiet(vco == c->sys_khz * c->postdiv1 * c->postdiv2, "PLL gives the clock (%u kHz)", c->sys_khz);
+    }
+    printf("table: %u clocks from %u to %u kHz\n", planner.count, planner.clocks[0].sys_khz,
+           planner.clocks[planner.count - 1].sys_khz);
+}
+
+/**
+ * @brief Statistics of one side of the comparison.
+ */
+typedef struct {
+    double worst_ppb;
+    double sum_ppb;
+    uint32_t count;
+} error_stats_t;
+
+static void add_error(error_stats_t *s, double ppb) {
+    ppb = fabs(ppb);
+    s->worst_ppb = ppb > s->worst_ppb ? ppb : s->worst_ppb;
+    s->sum_ppb += ppb;
+    s->count++;
+}
+
+static error_stats_t planned_stats, fixed_stats;
+static uint32_t max_tried = 0, low_max_khz = 0, rounded_steps = 0, clocks_used[CLOCK_PLAN_MAX_CLOCKS];
+
+static void check_plan(uint32_t freq_mhz) {
+    const clock_plan_limits_t *l = &planner.limits;
+    clock_plan_t p, again, fixed;
+    if (!clock_plan(&planner, freq_mhz, 0, &p)) {
+        check_quiet(false, "no plan (%u mHz)", freq_mhz);
+        return;
+    }
+    max_tried = p.tried > max_tried ? p.tried : max_tried;
+
+    const clock_plan_pll_t *c = clock_planner_find(&planner, p.sys_khz);
+    check_quiet(c && p.vco_khz == CLOCK_PLAN_XOSC_KHZ * c->fbdiv && p.postdiv1 == c->postdiv1
+                    && p.postdiv2 == c->postdiv2, "PLL setting from the table (%u mHz)", freq_mhz);
+    check_quiet(p.div256 >= DAC_STREAM_DIV_MIN && p.div256 <= DAC_STREAM_DIV_MAX && p.hold >= 1,
+                "PIO divider range (%u mHz)", freq_mhz);
+    if (p.points) {
+        check_quiet(p.points >= l->min_points && p.points <= l->max_points && (p.points & (p.points - 1)) == 0,
+                    "power of two points (%u mHz)", freq_mhz);
+        check_quiet((uint64_t)p.tuning * p.points == (uint64_t)1 << 32, "exact step (%u mHz)", freq_mhz);
+    } else {
+        check_quiet((double)p.tuning * l->min_points <= 4294967296.0,
+                    "rounded step with the minimum points (%u mHz)", freq_mhz);
+        rounded_steps++;
+    }
+    double load = (double)l->sample_cycles * 25600.0 / p.div256;
+    check_quiet(load <= l->max_load_pct && p.load_pct >= load && p.load_pct < load + 1.0, "CPU load (%u mHz)",
+                freq_mhz);
+
+    double ppb = recompute_ppb(&p, freq_mhz);
+    check_quiet(fabs(ppb - p.error_ppb) <= 1.0, "reported error (%u mHz)", freq_mhz);
+    check_quiet(fabs(freq_mhz * (1.0 + ppb * 1e-9) - p.freq_mhz) <= 0.5 + 1e-6, "achieved frequency (%u mHz)",
+                freq_mhz);
+    double rate = p.sys_khz * 256000.0 / ((double)p.div256 * p.hold);
+    check_quiet(fabs(rate - p.rate_hz) <= 0.5 + 1e-6, "sample rate (%u mHz)", freq_mhz);
+
+    check_quiet(clock_plan(&planner, freq_mhz, p.sys_khz, &again) && again.sys_khz == p.sys_khz,
+                "the clock in use is kept (%u mHz)", freq_mhz);
+    if (freq_mhz < CHECK_LOW_MHZ) {
+        check_quiet(p.sys_khz <= CHECK_LOW_KHZ, "low frequency on a low clock (%u mHz)", freq_mhz);
+        low_max_khz = p.sys_khz > low_max_khz ? p.sys_khz : low_max_khz;
+    }
+    clocks_used[c ? c - planner.clocks : 0]++;
+
+    check_quiet(clock_plan_rate(&planner, CHECK_FIXED_KHZ, CHECK_FIXED_RATE, freq_mhz, &fixed),
+                "fixed plan (%u mHz)", freq_mhz);
+    double fixed_ppb = recompute_ppb(&fixed, freq_mhz);
+    check_quiet(fabs(fixed_ppb - fixed.error_ppb) <= 1.0, "fixed reported error (%u mHz)", freq_mhz);
+    check_quiet(fabs(ppb) <= fabs(fixed_ppb) + l->tolerance_ppb, "no worse than the fixed clocks (%u mHz)", freq_mhz);
+    add_error(&planned_stats, ppb);
+    add_error(&fixed_stats, fixed_ppb);
+}
+
+/**
+ * @brief clock_plan_rate() must pace as dac_stream_set_rate() does.
+ */
+static void check_rate_plan(void) {
+    static const uint32_t rates[] = { 20000, 44100, 250000, 1000000, 3000000 };
+    for (uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        dac_stream_t s;
+        clock_plan_t p;
+        dac_stream_init(&s, NULL, NULL);
+        uint32_t rate = dac_stream_set_rate(&s, CHECK_FIXED_KHZ * 1000u, rates[i]);
+        bool ok = clock_plan_rate(&planner, CHECK_FIXED_KHZ, rates[i], 1000000, &p);
+        check_quiet(ok && p.rate_hz == rate && p.hold == s.hold && p.div256 == ((uint32_t)s.div_int << 8 | s.div_frac)
+                        && p.tuning == dds_tuning_word(1000000, rate),
+                    "fixed pacing as dac_stream (%u Hz)", rates[i]);
+    }
+}
+
+int main(void) {
+    check_seed(2024);
+    clock_plan_limits_t limits;
+    clock_plan_defaults(&limits, WAVEFORM_LENGTH);
+    clock_planner_init(&planner, &limits);
+    check_table();
+    check_rate_plan();
+
+    for (uint32_t i = 0; i <= CHECK_LOG_STEPS; i++) {
+        double f = CHECK_MIN_MHZ * pow((double)CHECK_MAX_MHZ / CHECK_MIN_MHZ, (double)i / CHECK_LOG_STEPS);
+        check_plan((uint32_t)(f + 0.5));
+    }
+    for (uint32_t i = 0; i < CHECK_RANDOM; i++) {
+        double f = CHECK_MIN_MHZ * pow((double)CHECK_MAX_MHZ / CHECK_MIN_MHZ, (check_rand() % 1000000u) / 1e6);
+        check_plan((uint32_t)f + check_rand() % 1000u);
+    }
+    clock_plan_t p;
+    check_quiet(!clock_plan(&planner, CHECK_TOO_HIGH_MHZ, 0, &p), "out of reach (%u mHz)", CHECK_TOO_HIGH_MHZ);
+
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i <= CHECK_LOG_STEPS; i++) {
+        double f = CHECK_MIN_MHZ * pow((double)CHECK_MAX_MHZ / CHECK_MIN_MHZ, (double)i / CHECK_LOG_STEPS);
+        clock_plan(&planner, (uint32_t)(f + 0.5), 0, &p);
+    }
+    uint64_t ns = bench_now_ns() - t0;
+
+    uint32_t distinct = 0;
+    for (uint32_t i = 0; i < planner.count; i++) {
+        distinct += clocks_used[i] != 0;
+    }
+    printf("planned: worst %.1f ppb, mean %.1f ppb over %u frequencies (1 Hz - 1 MHz)\n", planned_stats.worst_ppb,
+           planned_stats.sum_ppb / planned_stats.count, planned_stats.count);
+    printf("fixed %u kHz at %u Sa/s: worst %.1f ppb, mean %.1f ppb\n", CHECK_FIXED_KHZ, CHECK_FIXED_RATE,
+           fixed_stats.worst_ppb, fixed_stats.sum_ppb / fixed_stats.count);
+    printf("clocks: %u distinct, up to %u kHz below %u Hz; %u plans with a rounded step\n", distinct, low_max_khz,
+           CHECK_LOW_MHZ / 1000, rounded_steps);
+    printf("cost: up to %u combinations, %.1f us per plan on the host\n", max_tried, ns / 1e3 / (CHECK_LOG_STEPS + 1));
+    return check_result();
+}
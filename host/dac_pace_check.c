@@ -0,0 +1,158 @@
+/**
+ * @file dac_pace_check.c
+ * @brief Timeline, skip and bus checks of the paced DAC writes of the MicroPython module.
+ *
+ * Runs the deadline loop of dac_pace.c on the virtual clock of
+ * dac_pace_host.c, the way py_native/siggen_native.c is driven from
+ * Polling_Python_final.py: slices of output with random stalls in between
+ * (the interpreter scanning the keypad).
+ *
+ * - Timeline: in every slice, the bus holds in the middle of each sample
+ *   period the code a free-running reference generator gives for that
+ *   period, so the skipped samples keep the frequency and the phase.
+ * - Latency: no code reaches the bus more than one timer read after its
+ *   deadline, except the first one of a slice.
+ * - Accounting: written plus skipped samples cover the timeline.
+ * - A change pending across a stall is applied; the toggles never touch a
+ *   GPIO outside the DAC lines; a paced block write keeps its order and
+ *   counts the codes it could not write in time.
+ *
+ * Exits non-zero on any failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "check.h"
+#include "dac_pace_host.h"
+
+#define CHECK_PERIOD_US 5u          ///< 200 kHz, como py_native/siggen.py
+#define CHECK_READ_NS 180u          ///< Lectura del temporizador + muestra (estimado para el M0+ a 125 MHz)
+#define CHECK_SLICE_US 20000u       ///< Rebanada entregada por Python
+#define CHECK_STALL_MAX_US 3000u    ///< Tiempo maximo de Python entre rebanadas
+#define CHECK_SLICES 100u
+#define CHECK_FREQ_MHZ 1234567u     ///< Frecuencia sin paso exacto
+#define CHECK_SAMPLES (CHECK_SLICES * (CHECK_SLICE_US + CHECK_STALL_MAX_US) / CHECK_PERIOD_US + 16)
+
+
+static uint8_t reference[CHECK_SAMPLES];
+
+
+
+/**
+ * @brief Generator with one shape at CHECK_FREQ_MHZ and the sample rate of CHECK_PERIOD_US.
+ */
+static void setup_gen(gen_state_t *g, wave_cache_t *c, uint8_t shape) {
+    g->cache = c;
+    dds_init(&g->dds, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&g->dds, CHECK_FREQ_MHZ, 1000000u / CHECK_PERIOD_US);
+    wave_cache_init(c, WAVEFORM_LENGTH);
+    wave_cache_begin(c);
+    wave_cache_fill_shape(c, shape, 2500, 1250);
+    wave_cache_commit(c, 0, 0);
+    wave_cache_swap(c);
+}
+
+static void check_timeline(void) {
+    static wave_cache_t cache, ref_cache;
+    gen_state_t gen, ref;
+    dac_pace_t pace;
+    setup_gen(&gen, &cache, WAVEFORM_SAWTOOTH); ///< casi todas las muestras cambian el bus
+    setup_gen(&ref, &ref_cache, WAVEFORM_SAWTOOTH);
+    for (uint32_t k = 0; k < CHECK_SAMPLES; k++) {
+        reference[k] = gen_next(&ref);
+    }
+
+    dac_pace_host_reset(CHECK_READ_NS);
+    dac_pace_host_stall(123);
+    dac_pace_init(&pace, &gen, CHECK_PERIOD_US);
+    dac_pace_start(&pace);
+    uint64_t first_ns = (uint64_t)pace.next_us * 1000u;
+    uint64_t period_ns = CHECK_PERIOD_US * 1000u;
+    uint32_t checked = 0, worst_late_ns = 0, stalled_us = 0;
+
+    for (uint32_t s = 0; s < CHECK_SLICES; s++) {
+        if (s) {
+            uint32_t stall = check_rand() % CHECK_STALL_MAX_US;
+            dac_pace_host_stall(stall);
+            stalled_us += stall;
+        }
+        uint64_t begin_ns = dac_pace_host_now_ns();
+        const dac_pace_host_event_t *ev;
+        uint32_t first_event = dac_pace_host_events(&ev);
+        dac_pace_run(&pace, CHECK_SLICE_US);
+        uint64_t end_ns = dac_pace_host_now_ns();
+        uint32_t events = dac_pace_host_events(&ev);
+
+        // The bus in the middle of every period the slice covered
+        uint64_t k = begin_ns > first_ns ? (begin_ns - first_ns + period_ns - 1) / period_ns : 0;
+        for (; first_ns + k * period_ns + period_ns / 2 < end_ns && k < CHECK_SAMPLES; k++) {
+            uint64_t mid = first_ns + k * period_ns + period_ns / 2;
+            check_quiet(dac_pace_host_code_at(mid) == reference[k], "code on the timeline (sample %u)", (uint32_t)k);
+            checked++;
+        }
+        // How late each code reached the bus
+        for (uint32_t i = first_event + 1; i < events; i++) {
+            uint64_t late = (ev[i].at_ns - first_ns) % period_ns;
+            worst_late_ns = late > worst_late_ns ? (uint32_t)late : worst_late_ns;
+        }
+    }
+    check_quiet(worst_late_ns <= CHECK_READ_NS + 1000u, "write latency (%u ns)", worst_late_ns);
+    check_quiet(pace.played + pace.skipped == (uint32_t)(((uint64_t)pace.next_us * 1000u - first_ns) / period_ns),
+                "written plus skipped cover the timeline (%u)", pace.played + pace.skipped);
+    // A slice ends up to one period before its next deadline, and a stall skips only whole periods
+    check_quiet(pace.skipped >= stalled_us / CHECK_PERIOD_US - 2 * CHECK_SLICES
+                    && pace.skipped <= stalled_us / CHECK_PERIOD_US,
+                "skipped samples match the stalls (%u)", pace.skipped);
+    check_quiet(dac_pace_host_stray() == 0, "toggles only on the DAC lines (%u stray)", dac_pace_host_stray());
+    printf("timeline: %u written, %u skipped over %u ms of stalls, %u periods checked, "
+           "worst write %u ns after its deadline\n",
+           pace.played, pace.skipped, stalled_us / 1000, checked, worst_late_ns);
+
+    // A change waiting for the period boundary when the interpreter stalls
+    wave_cache_begin(&cache);
+    wave_cache_fill_shape(&cache, WAVEFORM_SQUARE, 2500, 1250);
+    wave_cache_commit(&cache, 0, 0);
+    dac_pace_host_stall(CHECK_STALL_MAX_US);
+    dac_pace_run(&pace, CHECK_PERIOD_US);
+    check_quiet(!cache.pending && cache.applied == cache.published, "change applied across a stall");
+}
+
+static void check_block(void) {
+    static wave_cache_t cache;
+    gen_state_t gen;
+    dac_pace_t pace;
+    uint8_t codes[1000];
+    setup_gen(&gen, &cache, WAVEFORM_SINE);
+    dac_pace_init(&pace, &gen, CHECK_PERIOD_US);
+    for (uint32_t i = 0; i < sizeof(codes); i++) {
+        codes[i] = (uint8_t)(i * 7 + 1); ///< consecutivos siempre distintos
+    }
+
+    for (uint32_t slow = 0; slow < 2; slow++) {
+        dac_pace_host_reset(slow ? 2 * CHECK_PERIOD_US * 1000u : CHECK_READ_NS);
+        pace.bus = 0;
+        uint32_t late = dac_pace_write(&pace, codes, sizeof(codes), CHECK_PERIOD_US);
+        const dac_pace_host_event_t *ev;
+        uint32_t events = dac_pace_host_events(&ev);
+        bool order = events == sizeof(codes);
+        for (uint32_t i = 0; i < events && order; i++) {
+            order = ev[i].code == codes[i];
+        }
+        check_quiet(order, "block written in order (%u events)", events);
+        check_quiet(slow ? late > sizeof(codes) / 2 : late == 0, "late codes counted (%u late)", late);
+        check_quiet(slow || dac_pace_host_now_ns() >= (sizeof(codes) - 1) * CHECK_PERIOD_US * 1000u,
+                    "block paced (%u us)", (uint32_t)(dac_pace_host_now_ns() / 1000u));
+    }
+    dac_pace_host_reset(CHECK_READ_NS);
+    dac_pace_write(&pace, codes, sizeof(codes), 0);
+    check_quiet(dac_pace_host_now_ns() == 0, "back to back block reads no timer");
+    printf("block: %u codes in order, paced and back to back\n", (unsigned)sizeof(codes));
+}
+
+int main(void) {
+    check_seed(2024);
+    check_timeline();
+    check_block();
+    return check_result();
+}
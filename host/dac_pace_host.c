@@ -0,0 +1,84 @@
+/**
+ * @file dac_pace_host.c
+ * @brief Host stand-in for the timer and GPIO backend of the paced DAC writes.
+ */
+
+#include "dac_pace_host.h"
+
+#define HOST_EVENTS (1u << 21) ///< Cambios del bus que se guardan
+
+static uint64_t host_ns; ///< Reloj virtual
+static uint32_t host_read_ns; ///< Coste de cada lectura del temporizador
+static uint32_t host_bus; ///< Palabra GPIO en el bus
+static uint32_t host_stray; ///< Conmutaciones fuera de las lineas del DAC
+static uint32_t host_count; ///< Cambios guardados
+static dac_pace_host_event_t host_events[HOST_EVENTS];
+
+uint32_t dac_pace_hw_now_us(void) {
+    host_ns += host_read_ns;
+    return (uint32_t)(host_ns / 1000u);
+}
+
+void dac_pace_hw_toggle(uint32_t mask) {
+    host_bus ^= mask;
+    host_stray += (mask & ~DAC_BUS_PIN_MASK) != 0;
+    if (host_count < HOST_EVENTS) {
+        uint8_t code = dac_bus_decode((uint16_t)(host_bus >> DAC_BUS_PIN_BASE));
+        host_events[host_count++] = (dac_pace_host_event_t){ host_ns, code };
+    }
+}
+
+/**
+ * @brief Start over: clock at 0, bus low, log empty.
+ *
+ * @param read_ns Time each timer read takes.
+ */
+void dac_pace_host_reset(uint32_t read_ns) {
+    host_ns = 0;
+    host_read_ns = read_ns;
+    host_bus = 0;
+    host_stray = 0;
+    host_count = 0;
+}
+
+/**
+ * @brief Let time pass without reading the timer (the interpreter running).
+ */
+void dac_pace_host_stall(uint32_t us) {
+    host_ns += (uint64_t)us * 1000u;
+}
+
+uint64_t dac_pace_host_now_ns(void) {
+    return host_ns;
+}
+
+/**
+ * @brief Code the bus held at an instant.
+ */
+uint8_t dac_pace_host_code_at(uint64_t at_ns) {
+    uint32_t lo = 0, hi = host_count;
+    while (lo < hi) { ///< primer cambio posterior al instante
+        uint32_t mid = (lo + hi) / 2;
+        if (host_events[mid].at_ns <= at_ns) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo ? host_events[lo - 1].code : 0;
+}
+
+/**
+ * @brief Logged changes of the bus, in time order.
+ */
+uint32_t dac_pace_host_events(const dac_pace_host_event_t **events) {
+    *events = host_events;
+    return host_count;
+}
+
+/**
+ * @brief Toggles that touched a GPIO outside the DAC lines.
+ */
+uint32_t dac_pace_host_stray(void) {
+    return host_stray;
+}
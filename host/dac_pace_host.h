@@ -0,0 +1,31 @@
+/**
+ * @file dac_pace_host.h
+ * @brief Host stand-in for the timer and GPIO backend of the paced DAC writes.
+ *
+ * A virtual clock in nanoseconds moves forward by a fixed cost on every
+ * timer read, and by hand for the time the interpreter would take between
+ * slices. Every toggle of the bus is logged with its time.
+ */
+
+// Avoid duplication in code
+#ifndef _DAC_PACE_HOST_H_
+#define _DAC_PACE_HOST_H_
+
+#include "dac_pace.h"
+
+/**
+ * @brief One change of the bus.
+ */
+typedef struct {
+    uint64_t at_ns; ///< Instante del cambio
+    uint8_t code;   ///< Codigo en el bus desde ese instante
+} dac_pace_host_event_t;
+
+void dac_pace_host_reset(uint32_t read_ns);
+void dac_pace_host_stall(uint32_t us);
+uint64_t dac_pace_host_now_ns(void);
+uint8_t dac_pace_host_code_at(uint64_t at_ns);
+uint32_t dac_pace_host_events(const dac_pace_host_event_t **events);
+uint32_t dac_pace_host_stray(void);
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * @file dac_stream_check.c
+ * @brief Block hand-off, underrun counting and pacing of the DAC stream.
+ *
+ * Runs the portable side of the PIO + DMA stream (dac_stream.c) on the host
+ * stand-in (dac_stream_host.c), with a producer that numbers its codes:
+ *
+ * - hand-off: refilling each block as soon as it is handed back, the bus
+ *   carries the codes in the order they were produced, one block after the
+ *   other, and no underrun is counted;
+ * - underruns: a refill that comes after the other block has finished too
+ *   counts one underrun per block played stale (and the stale codes are
+ *   indeed replayed), while one that comes within the next block counts
+ *   none;
+ * - pacing: for rates from 10 Hz to 5.5 MHz, the virtual PIO time of the
+ *   words played gives back the rate of dac_stream_divider(), each code is
+ *   held for its hold count, and the rate is within the divider resolution
+ *   of the requested one.
+ *
+ * Exits non-zero on any failure.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "check.h"
+#include "dac_stream_host.h"
+
+/**
+ * @brief Producer that outputs 0, 1, 2... (modulo 256).
+ */
+static void count_fill(uint8_t *codes, uint32_t count, void *ctx) {
+    uint32_t *next = ctx;
+    for (uint32_t i = 0; i < count; i++) {
+        codes[i] = (uint8_t)(*next)++;
+    }
+}
+
+/**
+ * @brief Codes played in production order, refilling after every block.
+ */
+static void check_handoff(void) {
+    static dac_stream_t s;
+    uint32_t next = 0;
+    uint8_t out[DAC_STREAM_BLOCK_LEN];
+    const uint32_t blocks = 64;
+
+    dac_stream_init(&s, count_fill, &next);
+    dac_stream_set_rate(&s, 125000000, 1000000);
+    dac_stream_prime(&s);
+    dac_stream_hw_start(&s);
+    check_value(dac_stream_host_running(), "hand-off: stream attached", dac_stream_host_running(), 1);
+
+    uint32_t out_of_order = 0;
+    uint32_t expected = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        dac_stream_host_run(&s, out, DAC_STREAM_BLOCK_LEN);
+        for (uint32_t i = 0; i < DAC_STREAM_BLOCK_LEN; i++) {
+            out_of_order += out[i] != (uint8_t)expected++;
+        }
+        dac_stream_service(&s);
+    }
+    check_value(out_of_order == 0, "hand-off: codes in order", out_of_order, 0);
+    check_value(s.blocks_played == blocks, "hand-off: blocks played", s.blocks_played, blocks);
+    check_value(s.underruns == 0, "hand-off: underruns", s.underruns, 0);
+
+    dac_stream_hw_stop(&s);
+    bool stopped = !dac_stream_host_running() && dac_stream_host_run(&s, out, 1) == 0;
+    check_value(stopped, "hand-off: stopped", !stopped, 0);
+}
+
+/**
+ * @brief Underruns counted when the refill comes late, and only then.
+ */
+static void check_underruns(void) {
+    static dac_stream_t s;
+    uint32_t next = 0;
+    uint8_t out[4 * DAC_STREAM_BLOCK_LEN];
+
+    dac_stream_init(&s, count_fill, &next);
+    dac_stream_set_rate(&s, 125000000, 1000000);
+    dac_stream_prime(&s);
+    dac_stream_hw_start(&s);
+
+    // Refill half way through the next block: in time
+    dac_stream_host_run(&s, out, DAC_STREAM_BLOCK_LEN + DAC_STREAM_BLOCK_LEN / 2);
+    dac_stream_service(&s);
+    dac_stream_host_run(&s, out, DAC_STREAM_BLOCK_LEN / 2);
+    dac_stream_service(&s);
+    check_value(s.underruns == 0, "late refill within a block", s.underruns, 0);
+
+    // Four blocks without a refill: the last three are played stale
+    dac_stream_host_run(&s, out, 4 * DAC_STREAM_BLOCK_LEN);
+    check_value(s.underruns == 3, "no refill for four blocks", s.underruns, 3);
+    uint32_t stale = 0;
+    for (uint32_t i = 2 * DAC_STREAM_BLOCK_LEN; i < 4 * DAC_STREAM_BLOCK_LEN; i++) {
+        stale += out[i] == out[i - 2 * DAC_STREAM_BLOCK_LEN];
+    }
+    check_value(stale == 2 * DAC_STREAM_BLOCK_LEN, "stale blocks replayed", stale, 2 * DAC_STREAM_BLOCK_LEN);
+
+    // Back in time: no new underruns
+    dac_stream_service(&s);
+    for (uint32_t b = 0; b < 8; b++) {
+        dac_stream_host_run(&s, out, DAC_STREAM_BLOCK_LEN);
+        dac_stream_service(&s);
+    }
+    check_value(s.underruns == 3, "refills back in time", s.underruns, 3);
+    dac_stream_hw_stop(&s);
+}
+
+/**
+ * @brief Virtual PIO time of the played words against dac_stream_divider().
+ */
+static void check_pacing(uint32_t sys_hz, uint32_t rate_hz) {
+    static dac_stream_t s;
+    uint32_t next = 0;
+    uint8_t out[DAC_STREAM_BLOCK_LEN];
+    uint32_t div256, hold;
+    uint32_t planned = dac_stream_divider(sys_hz, rate_hz, &div256, &hold);
+
+    dac_stream_init(&s, count_fill, &next);
+    uint32_t loaded = dac_stream_set_divider(&s, sys_hz, div256, hold);
+    dac_stream_prime(&s);
+    dac_stream_hw_start(&s);
+
+    // Dos bloques de codigos, cada uno repetido hold veces
+    uint32_t words = 2 * DAC_STREAM_BLOCK_LEN * hold;
+    uint32_t held_wrong = 0;
+    uint64_t index = 0;
+    for (uint32_t done = 0; done < words; done += DAC_STREAM_BLOCK_LEN) {
+        dac_stream_host_run(&s, out, DAC_STREAM_BLOCK_LEN);
+        for (uint32_t i = 0; i < DAC_STREAM_BLOCK_LEN; i++, index++) {
+            held_wrong += out[i] != (uint8_t)(index / hold);
+        }
+        dac_stream_service(&s);
+    }
+    double seconds = dac_stream_host_time_ns(&s) / 1e9;
+    double measured = (double)words / hold / seconds;
+    double exact = (double)sys_hz * 256.0 / ((double)div256 * hold);
+    dac_stream_hw_stop(&s);
+
+    char what[64];
+    snprintf(what, sizeof(what), "%9u Hz @%3u MHz: hold %u", rate_hz, sys_hz / 1000000, hold);
+    check_value(held_wrong == 0 && loaded == planned && s.underruns == 0, what, held_wrong, 0);
+    snprintf(what, sizeof(what), "%9u Hz @%3u MHz: paced rate", rate_hz, sys_hz / 1000000);
+    double tol = exact * (1e-9 / seconds + 1e-9); ///< el reloj virtual se redondea al ns
+    check_value(fabs(measured - exact) <= tol && fabs(measured - planned) <= 0.5 + tol, what, measured, planned);
+    snprintf(what, sizeof(what), "%9u Hz @%3u MHz: requested rate", rate_hz, sys_hz / 1000000);
+    check_value(fabs(measured - rate_hz) <= rate_hz * (0.5 / div256) + tol, what, measured, rate_hz);
+}
+
+int main(void) {
+    check_handoff();
+    check_underruns();
+
+    static const uint32_t rates_hz[] = { 10, 440, 1000, 20000, 44100, 1000000, 5500000 };
+    for (uint32_t i = 0; i < sizeof(rates_hz) / sizeof(rates_hz[0]); i++) {
+        check_pacing(125000000, rates_hz[i]);
+    }
+    check_pacing(48000000, 44100);
+    check_pacing(133000000, 1000000);
+
+    return check_result();
+}
@@ -0,0 +1,75 @@
+/**
+ * @file dac_stream_host.c
+ * @brief Host stand-in for the PIO + DMA backend of the DAC stream.
+ */
+
+#include "dac_stream_host.h"
+
+#include <stddef.h>
+
+static dac_stream_t *host_active; ///< Stream en reproduccion
+static uint32_t host_block; ///< Bloque que esta leyendo el "DMA"
+static uint32_t host_pos; ///< Posicion dentro del bloque
+static uint64_t host_pio_cycles; ///< Ciclos de PIO consumidos, en 1/256 de ciclo de sistema
+
+bool dac_stream_hw_start(dac_stream_t *s) {
+    host_active = s;
+    host_block = 0;
+    host_pos = 0;
+    host_pio_cycles = 0;
+    return true;
+}
+
+void dac_stream_hw_apply_rate(dac_stream_t *s) {
+    (void)s;
+}
+
+void dac_stream_hw_stop(dac_stream_t *s) {
+    (void)s;
+    host_active = NULL;
+}
+
+/**
+ * @brief Play @p count samples through the virtual PIO.
+ *
+ * @param s Stream started with dac_stream_hw_start().
+ * @param out Destination for the decoded DAC codes, or NULL.
+ * @param count Samples to play.
+ * @return Samples played (0 if the stream is not running).
+ */
+uint32_t dac_stream_host_run(dac_stream_t *s, uint8_t *out, uint32_t count) {
+    if (s != host_active) {
+        return 0;
+    }
+    uint32_t div256 = ((uint32_t)s->div_int << 8) | s->div_frac;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t word = s->block[host_block][host_pos];
+        if (out) {
+            out[i] = dac_bus_decode(word);
+        }
+        host_pio_cycles += div256;
+        if (++host_pos == DAC_STREAM_BLOCK_LEN) {
+            host_pos = 0;
+            dac_stream_block_done(s, host_block);
+            host_block ^= 1;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Virtual time elapsed since the stream was started.
+ */
+uint64_t dac_stream_host_time_ns(const dac_stream_t *s) {
+    if (s->sys_hz == 0) {
+        return 0;
+    }
+    return (uint64_t)((double)host_pio_cycles * (1e9 / 256.0) / s->sys_hz);
+}
+
+/**
+ * @brief Whether a stream is currently attached to the virtual PIO.
+ */
+bool dac_stream_host_running(void) {
+    return host_active != NULL;
+}
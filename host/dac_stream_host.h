@@ -0,0 +1,21 @@
+/**
+ * @file dac_stream_host.h
+ * @brief Host stand-in for the PIO + DMA backend of the DAC stream.
+ *
+ * Instead of a DMA engine the host pulls words out of the ring on demand,
+ * raising dac_stream_block_done() at every block boundary exactly as the DMA
+ * interrupt does on the board, and keeps a virtual clock derived from the PIO
+ * divider.
+ */
+
+// Avoid duplication in code
+#ifndef _DAC_STREAM_HOST_H_
+#define _DAC_STREAM_HOST_H_
+
+#include "dac_stream.h"
+
+uint32_t dac_stream_host_run(dac_stream_t *s, uint8_t *out, uint32_t count);
+uint64_t dac_stream_host_time_ns(const dac_stream_t *s);
+bool dac_stream_host_running(void);
+
+#endif
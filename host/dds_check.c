@@ -0,0 +1,206 @@
+/**
+ * @file dds_check.c
+ * @brief Output frequency of the DDS against the requested one.
+ *
+ * For each table length (256 points, the shift path, and 100 points, the
+ * multiply path) and sample clock of the firmwares (20 kHz c_irq, 10 kHz
+ * c_pol), from 1 mHz to Nyquist:
+ *
+ * - a ramp table (point i holds i) shows the table index on the output, so
+ *   the phase wraps are counted where the index falls back; with the index
+ *   of the last sample that gives the periods played, and so the frequency,
+ *   to one table point over the run;
+ * - with interpolation on, a sine table is played and its upward crossings
+ *   of mid scale are timed instead, up to a quarter of the clock (closer to
+ *   Nyquist two samples per period no longer cross once per period). The
+ *   interpolated output must also stay within about one code of the ideal
+ *   sine and closer to it than the plain table lookup.
+ *
+ * Frequencies at or above Nyquist must give the highest tuning word, just
+ * below it. Keypad entries parse to millihertz, and those too large for 32
+ * bits saturate instead of wrapping into range. Exits non-zero on any
+ * failure.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "check.h"
+#include "dds.h"
+
+#define CHECK_MIN_SAMPLES 200000u ///< Muestras minimas de cada medida
+#define CHECK_MIN_PERIODS 2u      ///< Periodos minimos de cada medida
+#define CHECK_SINE_MID 128        ///< Nivel medio de la tabla senoidal
+#define CHECK_SINE_AMP 127.0      ///< Amplitud de la tabla senoidal
+
+static const uint32_t lengths[] = { 256, 100 };     ///< Camino de desplazamiento y de multiplicacion
+static const uint32_t rates_hz[] = { 20000, 10000 }; ///< Relojes de c_irq y c_pol
+
+/**
+ * @brief Samples to play for @p periods periods of @p freq_mhz.
+ */
+static uint32_t check_samples(uint32_t freq_mhz, uint32_t rate_hz, uint32_t periods) {
+    uint64_t n = (uint64_t)rate_hz * 1000u * periods / freq_mhz + 1;
+    return n < CHECK_MIN_SAMPLES ? CHECK_MIN_SAMPLES : (uint32_t)n;
+}
+
+/**
+ * @brief Largest gap between the requested and the produced frequency (mHz).
+ *
+ * The tuning word is rounded to the nearest step of fs / 2^32; at or above
+ * Nyquist the produced frequency sits just below it.
+ */
+static double check_quantum_mhz(uint32_t rate_hz) {
+    return rate_hz * 1000.0 / 4294967296.0;
+}
+
+/**
+ * @brief Count phase wraps on a ramp table and compare with the request.
+ */
+static void check_wraps(uint32_t length, uint32_t rate_hz, uint32_t freq_mhz) {
+    uint8_t ramp[256];
+    for (uint32_t i = 0; i < length; i++) {
+        ramp[i] = (uint8_t)i;
+    }
+    dds_t d;
+    dds_init(&d, length, false);
+    dds_set_frequency(&d, freq_mhz, rate_hz);
+
+    uint32_t n = check_samples(freq_mhz, rate_hz, CHECK_MIN_PERIODS);
+    uint64_t wraps = 0;
+    uint8_t prev = dds_next(&d, ramp);
+    for (uint32_t i = 1; i < n; i++) {
+        uint8_t idx = dds_next(&d, ramp);
+        wraps += idx < prev;
+        prev = idx;
+    }
+    double seconds = (double)(n - 1) / rate_hz;
+    double got = (wraps + (double)prev / length) / seconds * 1000.0;
+    double nyquist = rate_hz * 500.0;
+    double want = freq_mhz < nyquist ? freq_mhz : nyquist;
+    double tol = check_quantum_mhz(rate_hz) + 1000.0 / (length * seconds) + 1e-9 * want;
+
+    char what[64];
+    snprintf(what, sizeof(what), "%s %3u @%5u %10.3f Hz", d.shift ? "shift" : "mul", length, rate_hz,
+             freq_mhz / 1000.0);
+    check_value(fabs(got - want) <= tol && got < nyquist, what, got, want);
+}
+
+/**
+ * @brief Time the mid-scale crossings of an interpolated sine.
+ */
+static void check_interpolated(uint32_t length, uint32_t rate_hz, uint32_t freq_mhz) {
+    uint8_t sine[256];
+    for (uint32_t i = 0; i < length; i++) {
+        sine[i] = (uint8_t)lround(CHECK_SINE_MID + CHECK_SINE_AMP * sin(2 * M_PI * i / length));
+    }
+    dds_t d;
+    dds_init(&d, length, true);
+    dds_set_frequency(&d, freq_mhz, rate_hz);
+
+    uint32_t n = check_samples(freq_mhz, rate_hz, CHECK_MIN_PERIODS + 1); ///< el primer cruce es tras el primer periodo
+    uint64_t crossings = 0, first = 0, last = 0;
+    uint8_t prev = dds_next(&d, sine);
+    for (uint32_t i = 1; i < n; i++) {
+        uint8_t v = dds_next(&d, sine);
+        if (prev < CHECK_SINE_MID && v >= CHECK_SINE_MID) {
+            if (crossings++ == 0) {
+                first = i;
+            }
+            last = i;
+        }
+        prev = v;
+    }
+    double got = 0;
+    if (crossings >= 2) {
+        got = (crossings - 1) * (double)rate_hz * 1000.0 / (double)(last - first);
+    }
+    double tol = check_quantum_mhz(rate_hz) + 2.0 * freq_mhz / (double)(last - first + 1);
+
+    char what[64];
+    snprintf(what, sizeof(what), "interp %s %3u @%5u %10.3f Hz", d.shift ? "shift" : "mul", length, rate_hz,
+             freq_mhz / 1000.0);
+    check_value(crossings >= 2 && fabs(got - freq_mhz) <= tol, what, got, freq_mhz);
+}
+
+/**
+ * @brief Worst gap to the ideal sine, with and without interpolation.
+ */
+static double check_sine_error(uint32_t length, bool interpolate, uint32_t rate_hz, uint32_t freq_mhz) {
+    uint8_t sine[256];
+    for (uint32_t i = 0; i < length; i++) {
+        sine[i] = (uint8_t)lround(CHECK_SINE_MID + CHECK_SINE_AMP * sin(2 * M_PI * i / length));
+    }
+    dds_t d;
+    dds_init(&d, length, interpolate);
+    dds_set_frequency(&d, freq_mhz, rate_hz);
+
+    double worst = 0;
+    for (uint32_t i = 0; i < rate_hz; i++) {
+        double ideal = CHECK_SINE_MID + CHECK_SINE_AMP * sin(2 * M_PI * (d.phase / 4294967296.0));
+        double err = fabs(dds_next(&d, sine) - ideal);
+        worst = err > worst ? err : worst;
+    }
+    return worst;
+}
+
+/**
+ * @brief A keypad entry and the millihertz it must parse to.
+ */
+typedef struct {
+    const char *text;
+    uint32_t mhz;
+} parse_case_t;
+
+static const parse_case_t parse_cases[] = {
+    { "1000", 1000000 },
+    { "12*5", 12500 },
+    { "0*001", 1 },
+    { "0*0015", 1 },          ///< mas de tres decimales se ignoran
+    { "7D", 7000 },
+    { "4294967", 4294967000u },
+    { "4294967*295", UINT32_MAX },
+    { "4294967*296", UINT32_MAX },
+    { "4294968", UINT32_MAX }, ///< se envolvia a 704 mHz
+    { "99999999999", UINT32_MAX },
+};
+
+int main(void) {
+    for (uint32_t i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        char what[64];
+        uint32_t got = dds_parse_mhz(parse_cases[i].text);
+        snprintf(what, sizeof(what), "parse \"%s\"", parse_cases[i].text);
+        check_value(got == parse_cases[i].mhz, what, got, parse_cases[i].mhz);
+    }
+
+    for (uint32_t r = 0; r < sizeof(rates_hz) / sizeof(rates_hz[0]); r++) {
+        uint32_t fs = rates_hz[r];
+        uint32_t nyquist_mhz = fs * 500u;
+        const uint32_t freqs[] = {
+            1, 10, 1000, 12500, 1000000, 1234567, nyquist_mhz / 2, nyquist_mhz - 1,
+        };
+        for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            for (uint32_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+                check_wraps(lengths[l], fs, freqs[f]);
+            }
+            check_wraps(lengths[l], fs, nyquist_mhz);
+            check_wraps(lengths[l], fs, nyquist_mhz * 2);
+            for (uint32_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]) && freqs[f] <= nyquist_mhz / 2; f++) {
+                check_interpolated(lengths[l], fs, freqs[f]);
+            }
+        }
+        uint32_t top = dds_tuning_word(nyquist_mhz, fs);
+        check_value(top == 0x7FFFFFFFu && dds_tuning_word(UINT32_MAX, fs) == top, "tuning word at Nyquist", top,
+                    0x7FFFFFFFu);
+    }
+
+    for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        char what[64];
+        double plain = check_sine_error(lengths[l], false, 20000, 1000);
+        double interp = check_sine_error(lengths[l], true, 20000, 1000);
+        snprintf(what, sizeof(what), "interp sine error %u points", lengths[l]);
+        check_value(interp <= 1.5 && interp < plain, what, interp, plain);
+    }
+
+    return check_result();
+}
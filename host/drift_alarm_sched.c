@@ -0,0 +1,99 @@
+/**
+ * @file drift_alarm_sched.c
+ * @brief Virtual-clock run of the alarm scheduler over 10^7 sample periods.
+ *
+ * The three c_irq tasks (20 kHz sample, 2 ms keypad scan, 1 s print) share
+ * one alarm. Every alarm fires late by a random interrupt latency, with an
+ * occasional long stall, and every task body advances the clock by its own
+ * duration. Every run records the deadline its body was called for, and
+ * that deadline must lie on the ideal grid (first deadline plus a whole
+ * number of periods), after the previous one and not after the clock:
+ * zero cumulative drift, and never early. The drift the old
+ * "time_us_64() + period" re-arm would have accumulated from the same
+ * latencies is printed for comparison. Each task must also end within one
+ * period of the clock, i.e. it neither fell behind nor ran ahead. Exits
+ * non-zero on any drift.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alarm_sched_host.h"
+#include "check.h"
+
+#define DRIFT_PERIODS 10000000ull ///< Periodos de la tarea de muestreo
+
+/**
+ * @brief Simulated task.
+ */
+typedef struct {
+    const char *name;     ///< Nombre en la salida
+    uint32_t period;      ///< Periodo (us)
+    uint32_t duration;    ///< Duracion simulada del cuerpo (us)
+    uint64_t first;       ///< Primer plazo
+    uint64_t last;        ///< Plazo de la ultima ejecucion (0: ninguna)
+    uint64_t grid_error;  ///< Mayor distancia de un plazo a la rejilla ideal (us)
+    uint32_t disorder;    ///< Ejecuciones con un plazo no posterior al anterior
+    uint32_t early;       ///< Ejecuciones antes de su plazo
+    uint64_t rearm_drift; ///< Deriva acumulada con el re-armado relativo
+    alarm_task_t task;    ///< Tarea del planificador
+} drift_task_t;
+
+/**
+ * @brief Task body: check the deadline it runs against, account the lateness and take the simulated time.
+ */
+static void drift_body(alarm_task_t *t, void *ctx) {
+    drift_task_t *d = ctx;
+    uint64_t deadline = t->deadline;
+    uint64_t now = alarm_sched_hw_now();
+    uint64_t offset = deadline >= d->first ? (deadline - d->first) % d->period : d->first - deadline;
+    uint64_t error = offset <= d->period / 2 ? offset : d->period - offset;
+    d->grid_error = error > d->grid_error ? error : d->grid_error;
+    d->disorder += d->last && deadline <= d->last;
+    d->early += now < deadline;
+    d->last = deadline;
+    d->rearm_drift += alarm_sched_hw_now() - t->deadline; ///< el re-armado relativo hereda este retraso
+    alarm_sched_host_advance(d->duration);
+}
+
+int main(int argc, char **argv) {
+    uint64_t periods = argc > 1 ? strtoull(argv[1], NULL, 0) : DRIFT_PERIODS;
+    drift_task_t tasks[3] = {
+        { .name = "signal", .period = 50, .duration = 2 },
+        { .name = "sequence", .period = 2000, .duration = 3 },
+        { .name = "print", .period = 1000000, .duration = 400 },
+    };
+    alarm_sched_t sched;
+
+    check_seed(0x2545F491u);
+    alarm_sched_host_set_now(1000);
+    alarm_sched_init(&sched, 0);
+    for (int i = 0; i < 3; i++) {
+        tasks[i].first = 1000 + tasks[i].period;
+        alarm_sched_add(&sched, &tasks[i].task, drift_body, &tasks[i], tasks[i].period, tasks[i].first);
+    }
+    alarm_sched_start(&sched);
+
+    alarm_task_t *signal = &tasks[0].task;
+    while (signal->runs + signal->missed < periods) {
+        uint32_t latency = check_rand() % 8; ///< latencia normal de la interrupcion
+        if (check_rand() % 20000 == 0) {
+            latency += 150; ///< parada larga ocasional
+        }
+        alarm_sched_host_set_now(alarm_sched_host_armed(&sched) + latency);
+        alarm_sched_run(&sched);
+    }
+
+    uint64_t now = alarm_sched_hw_now();
+    printf("task,period_us,runs,missed,grid_error_us,disorder,early,rearm_drift_us,in_step\n");
+    for (int i = 0; i < 3; i++) {
+        drift_task_t *d = &tasks[i];
+        alarm_task_t *t = &d->task;
+        int in_step = t->deadline + t->period > now && t->deadline <= now + t->period;
+        printf("%s,%u,%u,%u,%llu,%u,%u,%llu,%s\n", d->name, d->period, t->runs, t->missed,
+               (unsigned long long)d->grid_error, d->disorder, d->early, (unsigned long long)d->rearm_drift,
+               in_step ? "yes" : "no");
+        check_quiet(d->grid_error == 0 && !d->disorder && !d->early && t->runs && in_step, "%s drift", d->name);
+    }
+    return check_result();
+}
@@ -0,0 +1,86 @@
+/**
+ * @file exec_sim.c
+ * @brief The c_pol task set on the executive, with a virtual clock.
+ *
+ * Each task body advances the clock by a modelled duration (the UI and
+ * logging steps are much longer than a sample). The clock starts just
+ * below the 32-bit wrap, as time_us_32() eventually does. After the run
+ * the executive report is printed; the sample task must have run once per
+ * period (no drift) without missing its hard deadline, or the program
+ * exits non-zero.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "executive_host.h"
+
+#define SIM_SAMPLE_PERIOD_US 100 ///< 10 kHz, como c_pol
+#define SIM_SECONDS 60
+
+/**
+ * @brief Modelled task: a fixed duration per step, optionally sliced.
+ */
+typedef struct {
+    uint32_t duration; ///< Duracion de un paso (us)
+    uint32_t slices;   ///< Pasos por trabajo
+    uint32_t left;     ///< Pasos pendientes del trabajo actual
+} sim_task_t;
+
+static bool sim_step(void *ctx) {
+    sim_task_t *s = ctx;
+    exec_host_advance(s->duration);
+    if (s->left == 0) {
+        s->left = s->slices;
+    }
+    return --s->left != 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : SIM_SECONDS;
+    uint32_t start = 0xFFFFFFFFu - 5000000u;
+    static exec_t e;
+    static exec_task_t tasks[7];
+    sim_task_t sample = { 4, 1, 0 };
+    sim_task_t keypad = { 3, 1, 0 };
+    sim_task_t button = { 2, 1, 0 };
+    sim_task_t keys = { 45, 2, 0 };     ///< analisis del comando y mensaje
+    sim_task_t status = { 70, 1, 0 };   ///< formato de la linea de estado
+    sim_task_t report = { 35, 8, 0 };   ///< una linea por paso
+    sim_task_t console = { 25, 40, 0 }; ///< 16 bytes por paso
+
+    exec_host_set_now(start);
+    exec_init(&e);
+    exec_add(&e, &tasks[0], "sample", sim_step, &sample, SIM_SAMPLE_PERIOD_US, SIM_SAMPLE_PERIOD_US / 2, start);
+    exec_add(&e, &tasks[1], "keypad", sim_step, &keypad, 2000, 0, start);
+    exec_add(&e, &tasks[2], "button", sim_step, &button, 10000, 0, start);
+    exec_add(&e, &tasks[3], "keys", sim_step, &keys, 2000, 0, start);
+    exec_add(&e, &tasks[4], "status", sim_step, &status, 1000000, 0, start + 1000000);
+    exec_add(&e, &tasks[5], "report", sim_step, &report, 1000000, 0, start + 500000);
+    exec_add(&e, &tasks[6], "console", sim_step, &console, 0, 0, start);
+    for (uint32_t i = 3; i < 7; i++) {
+        exec_set_budget(&tasks[i], 40); ///< como UI_STEP_BUDGET_US en c_pol
+    }
+
+    uint64_t end = (uint64_t)seconds * 1000000u;
+    uint64_t elapsed = 0;
+    while (elapsed < end) {
+        uint32_t before = exec_hw_now();
+        if (!exec_poll(&e)) {
+            exec_host_advance(1); ///< espera activa
+        }
+        elapsed += exec_hw_now() - before;
+    }
+
+    char line[96];
+    for (uint32_t i = 0; exec_report_line(&e, i, line, sizeof(line)); i++) {
+        fputs(line, stdout);
+    }
+    printf("held,%u\n", e.held);
+
+    exec_task_t *s = &tasks[0];
+    uint32_t expected = (uint32_t)(elapsed / SIM_SAMPLE_PERIOD_US);
+    int ok = s->missed == 0 && s->runs + 1 >= expected && s->runs <= expected + 1;
+    printf("sample_runs,%u,expected,%u,%s\n", s->runs, expected, ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file executive_host.c
+ * @brief Host stand-in for the executive clock, on a virtual clock.
+ */
+
+#include "executive_host.h"
+
+static uint32_t host_now; ///< Reloj virtual (us)
+
+uint32_t exec_hw_now(void) {
+    return host_now;
+}
+
+/**
+ * @brief Advance the virtual clock.
+ */
+void exec_host_advance(uint32_t us) {
+    host_now += us;
+}
+
+/**
+ * @brief Set the virtual clock.
+ */
+void exec_host_set_now(uint32_t now) {
+    host_now = now;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file executive_host.h
+ * @brief Virtual-clock backend of the cooperative executive.
+ */
+
+// Avoid duplication in code
+#ifndef _EXECUTIVE_HOST_H_
+#define _EXECUTIVE_HOST_H_
+
+#include "executive.h"
+
+void exec_host_advance(uint32_t us);
+void exec_host_set_now(uint32_t now);
+
+#endif
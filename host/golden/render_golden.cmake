@@ -0,0 +1,49 @@
+# Renders the golden cases with --check and compares them with the files here.
+#
+#   cmake -DRENDER=<render> -DGOLDEN_DIR=<this dir> -DOUT_DIR=<dir> -P render_golden.cmake
+#
+# With -DUPDATE=ON the renders replace the golden files instead. The files
+# are for the default tables (256 points, 8 bits); the frequencies stay low
+# enough for every shape to play its plain table (band 0).
+
+# name|render options; one period at 50 Hz on the c_irq clock
+set(cases
+    "sine_default|--shape|sine"
+    "triangle_default|--shape|triangle"
+    "sawtooth_default|--shape|sawtooth"
+    "square_default|--shape|square"
+    "sine_full|--shape|sine|--amp|2500|--offset|1250"
+    "square_low|--shape|square|--amp|100|--offset|50"
+    "triangle_mid|--shape|triangle|--amp|1800|--offset|600"
+)
+
+file(MAKE_DIRECTORY ${OUT_DIR})
+set(failed "")
+foreach(c IN LISTS cases)
+    string(REPLACE "|" ";" args "${c}")
+    list(GET args 0 name)
+    list(REMOVE_AT args 0)
+    set(out ${OUT_DIR}/${name}.csv)
+    execute_process(
+        COMMAND ${RENDER} ${args} --freq 50 --rate 20000 --duration 0.02 --format csv --out ${out} --check
+        RESULT_VARIABLE result
+    )
+    if (NOT result EQUAL 0)
+        list(APPEND failed "${name} (render exited ${result})")
+    elseif (UPDATE)
+        file(COPY ${out} DESTINATION ${GOLDEN_DIR})
+    else()
+        execute_process(
+            COMMAND ${CMAKE_COMMAND} -E compare_files ${out} ${GOLDEN_DIR}/${name}.csv
+            RESULT_VARIABLE result
+        )
+        if (NOT result EQUAL 0)
+            list(APPEND failed "${name} (differs from golden/${name}.csv)")
+        endif()
+    endif()
+endforeach()
+
+if (failed)
+    message(FATAL_ERROR "render golden FAIL: ${failed}")
+endif()
+message(STATUS "render golden PASS")
@@ -0,0 +1,122 @@
+/**
+ * @file keypad_script.c
+ * @brief Scripted bounce patterns through the keypad debounce state machines.
+ *
+ * Each script is the raw reading of one key on successive scans ('1' =
+ * closed, '0' = open) and the events it must produce, written as
+ * "<scan>+" for a press confirmed at that scan and "<scan>-" for a
+ * release. Exits non-zero if any script gives different events.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "keypad.h"
+
+/**
+ * @brief Scripted key.
+ */
+typedef struct {
+    const char *name;     ///< Nombre del caso
+    uint32_t key;         ///< Tecla (fila * 4 + columna)
+    const char *raw;      ///< Lectura en cada barrido
+    const char *expect;   ///< Eventos esperados
+} keypad_script_t;
+
+static const char keymap[KEYPAD_KEYS + 1] = "123A456B789C*0#D";
+
+static const keypad_script_t scripts[] = {
+    { "clean press", 0, "000111111111000000", "5+ 14-" },
+    { "bouncy press", 5, "0101101111111000000", "8+ 15-" },
+    { "one-scan glitch", 3, "0001000010000", "" },
+    { "two-scan glitch", 3, "00110000", "" },
+    { "chattering release", 15, "0111111101010100000", "3+ 16-" },
+    { "dropout while held", 7, "011111101111111000", "3+ 17-" },
+    { "double press", 9, "01110000011100000", "3+ 6- 11+ 14-" },
+    { "held to the end", 12, "000011111111", "6+" },
+};
+
+/**
+ * @brief Run one script and compare the events.
+ *
+ * Every scan feeds the key's row with the scripted column bit and the
+ * other rows with nothing, as keypad_hw_scan() would over a full sweep.
+ */
+static int run_script(const keypad_script_t *s) {
+    static keypad_t k;
+    char got[128] = "";
+    uint32_t row = s->key / KEYPAD_COLUMNS;
+    uint32_t col = s->key % KEYPAD_COLUMNS;
+
+    keypad_init(&k, keymap, KEYPAD_DEBOUNCE_SCANS);
+    for (uint32_t scan = 0; s->raw[scan]; scan++) {
+        for (uint32_t r = 0; r < KEYPAD_ROWS; r++) {
+            keypad_feed_row(&k, r, r == row && s->raw[scan] == '1' ? 1u << col : 0);
+        }
+        keypad_event_t ev;
+        while (keypad_pop(&k, &ev)) {
+            char item[16];
+            if (ev.key != keymap[s->key]) {
+                strcat(got, "wrong-key ");
+            }
+            snprintf(item, sizeof(item), "%u%c ", scan, ev.pressed ? '+' : '-');
+            strcat(got, item);
+        }
+    }
+    size_t len = strlen(got);
+    if (len) {
+        got[len - 1] = '\0';
+    }
+    int ok = strcmp(got, s->expect) == 0;
+    printf("%s,%c,%s,%s,%s\n", s->name, keymap[s->key], s->expect, got, ok ? "yes" : "no");
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief All 16 keys held together, then a full queue.
+ */
+static int run_all_keys(void) {
+    static keypad_t k;
+    keypad_init(&k, keymap, KEYPAD_DEBOUNCE_SCANS);
+    for (uint32_t scan = 0; scan < KEYPAD_DEBOUNCE_SCANS; scan++) {
+        for (uint32_t r = 0; r < KEYPAD_ROWS; r++) {
+            keypad_feed_row(&k, r, 0xF);
+        }
+    }
+    uint32_t events = 0;
+    char order[KEYPAD_KEYS + 1] = "";
+    keypad_event_t ev;
+    while (keypad_pop(&k, &ev)) {
+        if (ev.pressed && events < KEYPAD_KEYS) {
+            order[events] = ev.key;
+        }
+        events++;
+    }
+    order[events < KEYPAD_KEYS ? events : KEYPAD_KEYS] = '\0';
+
+    // Releasing all of them with nobody reading overflows the queue
+    for (uint32_t scan = 0; scan < KEYPAD_DEBOUNCE_SCANS; scan++) {
+        for (uint32_t r = 0; r < KEYPAD_ROWS; r++) {
+            keypad_feed_row(&k, r, 0);
+        }
+    }
+    for (uint32_t scan = 0; scan < KEYPAD_DEBOUNCE_SCANS; scan++) {
+        for (uint32_t r = 0; r < KEYPAD_ROWS; r++) {
+            keypad_feed_row(&k, r, 0xF);
+        }
+    }
+    int ok = events == KEYPAD_KEYS && strcmp(order, keymap) == 0 && k.dropped == KEYPAD_KEYS;
+    printf("all keys,*,%u presses in key order + %u dropped,%u presses %s + %u dropped,%s\n",
+           KEYPAD_KEYS, KEYPAD_KEYS, events, order, k.dropped, ok ? "yes" : "no");
+    return ok ? 0 : 1;
+}
+
+int main(void) {
+    int errors = 0;
+    printf("script,key,expected,got,match\n");
+    for (size_t i = 0; i < sizeof(scripts) / sizeof(scripts[0]); i++) {
+        errors += run_script(&scripts[i]);
+    }
+    errors += run_all_keys();
+    return errors ? 1 : 0;
+}
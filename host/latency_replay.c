@@ -0,0 +1,135 @@
+/**
+ * @file latency_replay.c
+ * @brief Feed timestamp streams through the latency probes.
+ *
+ * Without arguments, replays synthetic scheduled/actual timestamp streams
+ * (steady, uniform jitter, rare long stalls, 32-bit timer wrap) and checks
+ * the histogram summary against the exact statistics of each stream:
+ * min, mean and max must match and p99 must lie within one bin above the
+ * exact value. Exits non-zero on any mismatch.
+ *
+ * With "-", reads "scheduled,actual[,end]" lines in microseconds from stdin
+ * and prints the probe export, as the firmware's 'H' command would.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "latency_hist.h"
+
+#define REPLAY_SAMPLES 200000u
+#define REPLAY_PERIOD_US 50u ///< Periodo de TIMER_IRQ_2 a 20 kHz
+
+static uint32_t late[REPLAY_SAMPLES];
+
+/**
+ * @brief Small deterministic generator (xorshift32).
+ */
+static uint32_t replay_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void write_stdout(const char *line, void *ctx) {
+    (void)ctx;
+    fputs(line, stdout);
+}
+
+/**
+ * @brief Lateness of sample @p i of a synthetic stream.
+ */
+static uint32_t stream_late(int stream, uint32_t *rng) {
+    switch (stream) {
+    case 0:
+        return 2; ///< estable
+    case 1:
+        return 1 + replay_rand(rng) % 9; ///< jitter uniforme de 1 a 9 us
+    default:
+        if (replay_rand(rng) % 1000 < 15) {
+            return 200 + replay_rand(rng) % 1800; ///< 1.5 % de paradas largas (printf, teclado)
+        }
+        return replay_rand(rng) % 4;
+    }
+}
+
+/**
+ * @brief Replay one synthetic stream and check the summary.
+ *
+ * @return 0 if the summary matches the exact statistics.
+ */
+static int replay_synthetic(int stream, const char *name, uint32_t start) {
+    static latency_probe_t probe;
+    uint32_t rng = 0x12345678u + (uint32_t)stream;
+    uint64_t sum = 0;
+
+    latency_probe_reset(&probe);
+    probe.name = name;
+    for (uint32_t i = 0; i < REPLAY_SAMPLES; i++) {
+        uint32_t scheduled = start + i * REPLAY_PERIOD_US; ///< envuelve como time_us_32()
+        late[i] = stream_late(stream, &rng);
+        latency_probe_enter(&probe, scheduled, scheduled + late[i]);
+        sum += late[i];
+    }
+
+    qsort(late, REPLAY_SAMPLES, sizeof(late[0]), cmp_u32);
+    uint32_t exact_p99 = late[(REPLAY_SAMPLES * 990u + 999u) / 1000u - 1];
+    uint32_t exact_mean = (uint32_t)(sum / REPLAY_SAMPLES);
+    latency_summary_t s;
+    latency_hist_summary(&probe.late, &s);
+
+    uint32_t bin = latency_hist_bin(exact_p99);
+    int ok = s.count == REPLAY_SAMPLES && s.min == late[0] && s.max == late[REPLAY_SAMPLES - 1] &&
+             s.mean == exact_mean && s.p99 >= exact_p99 && s.p99 <= latency_hist_bin_high(bin);
+    printf("%s,%lu,%lu/%lu,%lu/%lu,%lu/%lu,%lu/%lu,%s\n", name, (unsigned long)s.count,
+           (unsigned long)s.min, (unsigned long)late[0], (unsigned long)s.mean, (unsigned long)exact_mean,
+           (unsigned long)s.p99, (unsigned long)exact_p99, (unsigned long)s.max,
+           (unsigned long)late[REPLAY_SAMPLES - 1], ok ? "yes" : "no");
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Read "scheduled,actual[,end]" lines from stdin and export them.
+ */
+static int replay_stdin(void) {
+    static latency_probe_t probe = { .name = "stdin" };
+    char line[128];
+    while (fgets(line, sizeof(line), stdin)) {
+        char *p = line;
+        uint32_t scheduled = (uint32_t)strtoul(p, &p, 10);
+        if (*p != ',') {
+            continue; ///< cabecera o linea vacia
+        }
+        uint32_t actual = (uint32_t)strtoul(p + 1, &p, 10);
+        latency_probe_enter(&probe, scheduled, actual);
+        if (*p == ',') {
+            latency_probe_exit(&probe, actual, (uint32_t)strtoul(p + 1, NULL, 10));
+        }
+    }
+    latency_probe_dump_csv(&probe, 1, true, write_stdout, NULL);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "-") == 0) {
+        return replay_stdin();
+    }
+
+    int errors = 0;
+    printf("stream,count,min,mean,p99,max,match\n");
+    errors += replay_synthetic(0, "steady", 1000);
+    errors += replay_synthetic(1, "uniform", 1000);
+    errors += replay_synthetic(2, "stalls", 1000);
+    errors += replay_synthetic(2, "stalls_wrap", 0xFFFFFFFFu - REPLAY_SAMPLES * REPLAY_PERIOD_US / 2);
+    return errors ? 1 : 0;
+}
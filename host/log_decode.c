@@ -0,0 +1,183 @@
+/**
+ * @file log_decode.c
+ * @brief Turn the binary telemetry stream of the firmwares back into text.
+ *
+ * Usage: log_decode [file]       decode a capture of the USB serial port
+ *        log_decode --selftest   round trip through the rings and the drain
+ *
+ * Every frame is printed as "[seconds] text" with the catalog of
+ * log_msgs.h. Bytes that are not part of a valid frame (text printed by
+ * the firmware outside the log, a frame cut by a reconnection) are
+ * skipped; the count of skipped bytes and of records the firmware dropped
+ * is printed on stderr at the end.
+ *
+ * The self test logs the same deterministic sequence twice from two rings
+ * on a virtual clock, one of them overflowing: once drained as text and
+ * once as binary frames with garbage in between. The decoded frames must
+ * format to exactly the text, and the drop reports must add up to the drop
+ * counters. Exits non-zero on any difference.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_host.h"
+
+#define DECODE_BUF 4096
+#define SELFTEST_OUT (1 << 20)
+
+typedef struct {
+    uint8_t *data;
+    uint32_t len;
+} out_buf_t;
+
+static void out_write(const uint8_t *buf, uint32_t len, void *ctx) {
+    out_buf_t *o = ctx;
+    if (o->len + len <= SELFTEST_OUT) {
+        memcpy(&o->data[o->len], buf, len);
+        o->len += len;
+    }
+}
+
+/**
+ * @brief Decode a buffer of frames.
+ *
+ * @param text If not NULL, the formatted records are appended here.
+ * @param stamp Prefix every line with its time stamp.
+ * @param dropped Sum of the LOG_DROPPED reports.
+ * @return Bytes skipped.
+ */
+static uint32_t decode(const uint8_t *buf, uint32_t len, out_buf_t *text, bool stamp, uint32_t *frames,
+                       uint32_t *dropped, uint32_t *used) {
+    uint32_t skipped = 0;
+    uint32_t pos = 0;
+    while (pos < len) {
+        log_record_t rec;
+        int32_t n = log_decode(&buf[pos], len - pos, &rec);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            pos++;
+            skipped++;
+            continue;
+        }
+        pos += (uint32_t)n;
+        (*frames)++;
+        if (rec.id == LOG_DROPPED) {
+            *dropped += rec.arg[1];
+        }
+        char line[LOG_LINE_MAX];
+        uint32_t l = log_format(&rec, line, sizeof(line));
+        if (text) {
+            out_write((const uint8_t *)line, l, text);
+        } else if (stamp) {
+            printf("[%4u.%06u] %s", rec.time / 1000000, rec.time % 1000000, line);
+        } else {
+            fputs(line, stdout);
+        }
+    }
+    *used = pos;
+    return skipped;
+}
+
+/**
+ * @brief One producer pass: both rings, a drain step every few records.
+ */
+static void selftest_run(log_drain_t *d, log_ring_t *main_ring, log_ring_t *irq_ring) {
+    static const char *inputs[] = { "A2000D", "B600D", "C1000*5D", "*25000#1D", "0123456789ABCDEF0123" };
+    log_host_set_now(0xFFFF0000u); ///< cruza el desborde del reloj de 32 bits
+    for (uint32_t i = 0; i < 2000; i++) {
+        log_host_advance(37);
+        log_put(irq_ring, (uint16_t)(LOG_STATUS_SINE + i % 4), 1000 + i, 100 + i, i * 7, i % 1000);
+        if (i % 3 == 0) {
+            log_put_text(main_ring, LOG_TEXT_INPUT, inputs[i % 5]);
+            log_put(main_ring, LOG_SET_FREQUENCY, i, i % 1000, 0, 0);
+        }
+        if (i % 500 < 100) {
+            log_put(irq_ring, LOG_MISSED, i, 0, 0, 0); ///< rafaga: el anillo se llena
+        }
+        if (i % 4 == 0) {
+            log_drain_step(d, 3);
+        }
+    }
+    while (log_drain_step(d, 8)) {
+    }
+}
+
+static int selftest(void) {
+    static log_ring_t rings[2][2];
+    static uint8_t text_data[SELFTEST_OUT];
+    static uint8_t bin_data[SELFTEST_OUT];
+    static uint8_t dec_data[SELFTEST_OUT];
+    out_buf_t text = { text_data, 0 };
+    out_buf_t bin = { bin_data, 0 };
+    out_buf_t dec = { dec_data, 0 };
+    log_drain_t d;
+    int fail = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        log_ring_init(&rings[pass][0]);
+        log_ring_init(&rings[pass][1]);
+        log_drain_init(&d, out_write, pass ? (void *)&bin : (void *)&text);
+        log_drain_add(&d, &rings[pass][0]);
+        log_drain_add(&d, &rings[pass][1]);
+        log_drain_set_binary(&d, pass == 1);
+        selftest_run(&d, &rings[pass][0], &rings[pass][1]);
+        if (pass == 1) {
+            static const uint8_t junk[] = { 'o', 'k', '\n', LOG_FRAME_MAGIC, 0x01, LOG_FRAME_MAGIC, 0xFF };
+            out_write(junk, sizeof(junk), &bin); ///< texto suelto y una trama cortada al final
+        }
+    }
+
+    uint32_t frames = 0;
+    uint32_t dropped = 0;
+    uint32_t used;
+    uint32_t skipped = decode(bin.data, bin.len, &dec, false, &frames, &dropped, &used);
+    uint32_t counted = log_dropped(&rings[1][0]) + log_dropped(&rings[1][1]);
+
+    printf("text_bytes,%u\nbinary_bytes,%u\nframes,%u\nskipped_bytes,%u\ndropped,%u\ndrop_reports,%u\n",
+           text.len, bin.len, frames, skipped, counted, dropped);
+    if (dec.len != text.len || memcmp(dec.data, text.data, text.len) != 0) {
+        printf("decoded text differs from the text drain\n");
+        fail = 1;
+    }
+    uint32_t text_dropped = log_dropped(&rings[0][0]) + log_dropped(&rings[0][1]);
+    if (counted == 0 || dropped != counted || counted != text_dropped) {
+        printf("drop reports do not match the counters\n");
+        fail = 1;
+    }
+    if (skipped != 3 || used != bin.len - 4) {
+        printf("garbage not skipped as expected\n");
+        fail = 1;
+    }
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--selftest") == 0) {
+        return selftest();
+    }
+    FILE *in = argc > 1 ? fopen(argv[1], "rb") : stdin;
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    static uint8_t buf[DECODE_BUF];
+    uint32_t len = 0;
+    uint32_t frames = 0;
+    uint32_t dropped = 0;
+    uint32_t skipped = 0;
+    size_t n;
+    while ((n = fread(&buf[len], 1, sizeof(buf) - len, in)) > 0) {
+        uint32_t used;
+        len += (uint32_t)n;
+        skipped += decode(buf, len, NULL, true, &frames, &dropped, &used);
+        memmove(buf, &buf[used], len - used);
+        len -= used;
+    }
+    fprintf(stderr, "frames %u, skipped bytes %u, dropped records %u\n", frames, skipped + len, dropped);
+    return 0;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file log_host.c
+ * @brief Host stand-in for the deferred log clock, on a virtual clock.
+ */
+
+#include "log_host.h"
+
+static uint32_t host_now; ///< Reloj virtual (us)
+
+uint32_t log_hw_now(void) {
+    return host_now;
+}
+
+/**
+ * @brief Advance the virtual clock.
+ */
+void log_host_advance(uint32_t us) {
+    host_now += us;
+}
+
+/**
+ * @brief Set the virtual clock.
+ */
+void log_host_set_now(uint32_t now) {
+    host_now = now;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file log_host.h
+ * @brief Virtual-clock backend of the deferred log.
+ */
+
+// Avoid duplication in code
+#ifndef _LOG_HOST_H_
+#define _LOG_HOST_H_
+
+#include "log_ring.h"
+
+void log_host_advance(uint32_t us);
+void log_host_set_now(uint32_t now);
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file microbench_host.c
+ * @brief Steady clock and a stand-in SIO block for the microbenchmarks.
+ *
+ * The bus writes do the same register accesses as the SDK calls on the
+ * RP2040 (a store per gpio_put, a read and a store per gpio_put_masked),
+ * on volatile words, so the host figures show the CPU side of each
+ * strategy.
+ */
+
+#include "microbench.h"
+
+#include "bench.h"
+
+/**
+ * @brief SIO GPIO registers.
+ */
+static volatile struct {
+    uint32_t out;  ///< GPIO_OUT
+    uint32_t set;  ///< GPIO_OUT_SET
+    uint32_t clr;  ///< GPIO_OUT_CLR
+    uint32_t togl; ///< GPIO_OUT_XOR
+} sio;
+
+static uint32_t bus_last; ///< Niveles escritos por la ultima conmutacion
+
+void microbench_hw_init(void) {
+    sio.out = 0;
+    bus_last = 0;
+}
+
+const char *microbench_hw_target(void) {
+    return "host";
+}
+
+uint32_t microbench_hw_tick_hz(void) {
+    return 1000000000u;
+}
+
+uint32_t microbench_hw_ticks(void) {
+    return (uint32_t)bench_now_ns();
+}
+
+uint32_t microbench_hw_elapsed(uint32_t start, uint32_t end) {
+    return end - start;
+}
+
+static inline void sio_put(uint32_t pin, uint32_t value) {
+    if (value) {
+        sio.set = 1u << pin;
+    } else {
+        sio.clr = 1u << pin;
+    }
+}
+
+void microbench_hw_bus_put8(uint8_t code) {
+    sio_put(16, code & 0x01);
+    sio_put(17, code & 0x02);
+    sio_put(18, code & 0x04);
+    sio_put(19, code & 0x08);
+    sio_put(20, code & 0x10);
+    sio_put(21, code & 0x20);
+    sio_put(22, code & 0x40);
+    sio_put(26, code & 0x80);
+}
+
+void microbench_hw_bus_masked(uint8_t code) {
+    sio.togl = (sio.out ^ microbench_bus_bits(code)) & MICROBENCH_BUS_MASK;
+}
+
+void microbench_hw_bus_toggle(uint8_t code) {
+    uint32_t bits = microbench_bus_bits(code);
+    sio.togl = bits ^ bus_last;
+    bus_last = bits;
+}
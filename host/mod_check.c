@@ -0,0 +1,179 @@
+/**
+ * @file mod_check.c
+ * @brief Endpoint and depth checks of the modulation engine.
+ *
+ * - Sweeps (linear and log, up and down, 20 kHz clock): the first sample
+ *   plays the start tuning word and sample N the end one exactly; the
+ *   midpoint is the arithmetic (linear) or geometric (log) mean, the run is
+ *   monotonic, a one-shot sweep holds the end and a chirp starts over.
+ * - AM: the envelope of a 1 kHz carrier, taken as the peak of every carrier
+ *   period, gives back the requested depth.
+ * - FM: the tuning word swings by the requested deviation around the
+ *   carrier and the carrier frequency, counted from the phase wraps, is
+ *   unchanged.
+ *
+ * The cost per sample of each mode is printed too. Exits non-zero on any
+ * failure.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "check.h"
+#include "modulation.h"
+
+#define CHECK_RATE_HZ 20000 ///< Reloj de muestreo de c_irq
+#define CHECK_BENCH_SAMPLES 10000000u
+
+static double rel(double a, double b) {
+    return fabs(a - b) / fabs(b);
+}
+
+/**
+ * @brief Run a sweep past its end and check the endpoints.
+ */
+static void check_sweep(uint8_t kind, uint32_t f0, uint32_t f1, uint32_t ms, bool repeat) {
+    mod_t m;
+    char what[64];
+    const char *name = kind == MOD_SWEEP_LIN ? "lin" : "log";
+    if (!mod_sweep(&m, kind, f0, f1, ms, repeat, CHECK_RATE_HZ)) {
+        snprintf(what, sizeof(what), "%s %u -> %u mHz accepted", name, f0, f1);
+        check(false, what);
+        return;
+    }
+    uint32_t n = m.samples;
+    uint32_t *t = malloc((n + 3) * sizeof(*t));
+    bool monotonic = true;
+    for (uint32_t i = 0; i < n + 3; i++) {
+        t[i] = mod_sweep_next(&m);
+        if (i > 0 && i <= n && (f1 > f0 ? t[i] < t[i - 1] : t[i] > t[i - 1])) {
+            monotonic = false;
+        }
+    }
+    double start = dds_tuning_word(f0, CHECK_RATE_HZ);
+    double end = dds_tuning_word(f1, CHECK_RATE_HZ);
+    double mid = kind == MOD_SWEEP_LIN ? (start + end) / 2 : sqrt(start * end);
+    snprintf(what, sizeof(what), "%s %u->%u start", name, f0 / 1000, f1 / 1000);
+    check_value(t[0] == start, what, t[0], start);
+    snprintf(what, sizeof(what), "%s %u->%u mid", name, f0 / 1000, f1 / 1000);
+    check_value(rel(t[n / 2], mid) < 1e-4, what, t[n / 2], mid);
+    snprintf(what, sizeof(what), "%s %u->%u before end", name, f0 / 1000, f1 / 1000);
+    check_value(rel(t[n - 1], end) < 1e-3, what, t[n - 1], end);
+    snprintf(what, sizeof(what), "%s %u->%u end", name, f0 / 1000, f1 / 1000);
+    check_value(t[n] == end, what, t[n], end);
+    snprintf(what, sizeof(what), "%s %u->%u monotonic", name, f0 / 1000, f1 / 1000);
+    check_value(monotonic, what, monotonic, 1);
+    snprintf(what, sizeof(what), "%s %u->%u %s", name, f0 / 1000, f1 / 1000, repeat ? "restart" : "hold");
+    double after = repeat ? start : end;
+    check_value(t[n + 1] == after && (repeat || t[n + 2] == end), what, t[n + 1], after);
+    free(t);
+}
+
+/**
+ * @brief Measure the AM depth from the envelope of the DAC codes.
+ */
+static void check_am(uint32_t depth) {
+    mod_t m;
+    wave_cache_t cache;
+    dds_t d;
+    char what[64];
+    wave_cache_init(&cache, WAVEFORM_LENGTH);
+    wave_cache_rebuild_shape(&cache, WAVEFORM_SINE, 2500, 1250);
+    wave_cache_swap(&cache);
+    dds_init(&d, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&d, 1000000, CHECK_RATE_HZ); ///< 1 kHz: 20 muestras por periodo, pasa por el pico
+    mod_am(&m, depth, 10000, WAVEFORM_SINE, 2500, 1250, CHECK_RATE_HZ);
+
+    int32_t env_max = 0;
+    int32_t env_min = 1 << 30;
+    int32_t peak = 0;
+    for (uint32_t i = 0; i < CHECK_RATE_HZ; i++) { ///< un segundo, diez periodos de la moduladora
+        int32_t v = abs((int32_t)mod_next(&m, &cache, &d) - m.center);
+        peak = v > peak ? v : peak;
+        if (i % 20 == 19) {
+            env_max = peak > env_max ? peak : env_max;
+            env_min = peak < env_min ? peak : env_min;
+            peak = 0;
+        }
+    }
+    double got = (double)(env_max - env_min) / (env_max + env_min);
+    snprintf(what, sizeof(what), "am depth %u%%", depth);
+    check_value(fabs(got - depth / 100.0) < 0.03, what, got, depth / 100.0);
+}
+
+/**
+ * @brief Measure the FM swing and the mean carrier frequency.
+ */
+static void check_fm(uint32_t carrier, uint32_t dev) {
+    mod_t m;
+    char what[64];
+    mod_fm(&m, carrier, dev, 10000, WAVEFORM_SINE, CHECK_RATE_HZ);
+    uint32_t lo = UINT32_MAX;
+    uint32_t hi = 0;
+    uint32_t phase = 0;
+    uint32_t wraps = 0;
+    for (uint32_t i = 0; i < CHECK_RATE_HZ; i++) { ///< un segundo
+        uint32_t t = mod_fm_next(&m);
+        lo = t < lo ? t : lo;
+        hi = t > hi ? t : hi;
+        wraps += phase + t < phase;
+        phase += t;
+    }
+    double want = dds_tuning_word(dev, CHECK_RATE_HZ);
+    snprintf(what, sizeof(what), "fm %u Hz dev +", dev / 1000);
+    check_value(rel(hi - (double)m.start, want) < 0.02, what, hi - (double)m.start, want);
+    snprintf(what, sizeof(what), "fm %u Hz dev -", dev / 1000);
+    check_value(rel(m.start - (double)lo, want) < 0.02, what, m.start - (double)lo, want);
+    snprintf(what, sizeof(what), "fm %u Hz carrier (Hz)", carrier / 1000);
+    check_value(fabs(wraps - carrier / 1000.0) <= 1, what, wraps, carrier / 1000.0);
+}
+
+/**
+ * @brief Time one mode of mod_next().
+ */
+static void bench(const char *name, mod_t *m, uint32_t samples) {
+    wave_cache_t cache;
+    dds_t d;
+    uint32_t sum = 0;
+    wave_cache_init(&cache, WAVEFORM_LENGTH);
+    wave_cache_rebuild_shape(&cache, WAVEFORM_SINE, 1000, 100);
+    wave_cache_swap(&cache);
+    dds_init(&d, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&d, 1000000, CHECK_RATE_HZ);
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < samples; i++) {
+        sum += mod_next(m, &cache, &d);
+    }
+    uint64_t t1 = bench_now_ns();
+    printf("%-8s %.3f ns/sample (%08x)\n", name, (double)(t1 - t0) / samples, sum);
+}
+
+int main(int argc, char **argv) {
+    uint32_t samples = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : CHECK_BENCH_SAMPLES;
+    mod_t m;
+
+    check_sweep(MOD_SWEEP_LIN, 100000, 5000000, 1000, false);
+    check_sweep(MOD_SWEEP_LIN, 5000000, 100000, 2500, true);
+    check_sweep(MOD_SWEEP_LOG, 20000, 8000000, 10000, false);
+    check_sweep(MOD_SWEEP_LOG, 8000000, 20000, 500, true);
+    for (uint32_t depth = 0; depth <= 100; depth += 25) {
+        check_am(depth);
+    }
+    check_fm(1000000, 200000);
+    check_fm(3000000, 2500000);
+
+    mod_init(&m);
+    bench("none", &m, samples);
+    mod_sweep(&m, MOD_SWEEP_LIN, 100000, 5000000, 1000, true, CHECK_RATE_HZ);
+    bench("lin", &m, samples);
+    mod_sweep(&m, MOD_SWEEP_LOG, 20000, 8000000, 1000, true, CHECK_RATE_HZ);
+    bench("log", &m, samples);
+    mod_am(&m, 50, 10000, WAVEFORM_SINE, 1000, 100, CHECK_RATE_HZ);
+    bench("am", &m, samples);
+    mod_fm(&m, 1000000, 200000, 10000, WAVEFORM_SINE, CHECK_RATE_HZ);
+    bench("fm", &m, samples);
+
+    return check_result();
+}
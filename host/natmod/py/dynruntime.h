@@ -0,0 +1,108 @@
+/**
+ * @file dynruntime.h
+ * @brief Host stand-in for MicroPython's py/dynruntime.h (native modules).
+ *
+ * Only the part of the dynamic runtime that py_native/siggen_native.c uses:
+ * small integers, tuples, buffers, ValueError and module globals, with the
+ * same names and signatures as in MicroPython. Objects live in a fixed
+ * pool (natmod_host.c) that the harness empties between calls. It lets the
+ * module build with the host compiler and run under natmod_check where the
+ * MicroPython tree is not at hand; the real build is still py_native/Makefile.
+ */
+
+// Avoid duplication in code
+#ifndef _NATMOD_DYNRUNTIME_H_
+#define _NATMOD_DYNRUNTIME_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef intptr_t mp_int_t;
+typedef uintptr_t mp_uint_t;
+typedef const char *qstr;
+
+/**
+ * @brief Object of the stand-in runtime.
+ */
+typedef struct natmod_obj {
+    uint8_t kind;                 ///< NATMOD_INT, NATMOD_TUPLE, NATMOD_BUFFER, NATMOD_FUN
+    mp_int_t value;               ///< Entero
+    size_t len;                   ///< Elementos de la tupla o bytes del buffer
+    struct natmod_obj **items;    ///< Elementos de la tupla
+    void *buf;                    ///< Datos del buffer
+} natmod_obj_t;
+
+typedef natmod_obj_t *mp_obj_t;
+
+#define NATMOD_NONE 0
+#define NATMOD_INT 1
+#define NATMOD_TUPLE 2
+#define NATMOD_BUFFER 3
+#define NATMOD_FUN 4
+
+/**
+ * @brief Function object, as MP_DEFINE_CONST_FUN_OBJ_* makes it.
+ */
+typedef struct {
+    natmod_obj_t base;            ///< kind = NATMOD_FUN
+    uint8_t n_args_min;           ///< Argumentos minimos
+    uint8_t n_args_max;           ///< Argumentos maximos
+    bool var;                     ///< Recibe (n_args, args)
+    void *fun;                    ///< Implementacion
+} mp_obj_fun_builtin_t;
+
+typedef struct {
+    int unused;
+} mp_obj_fun_bc_t;
+
+/**
+ * @brief Buffer protocol.
+ */
+typedef struct {
+    void *buf;
+    size_t len;
+    int typecode;
+} mp_buffer_info_t;
+
+#define MP_BUFFER_READ 1
+#define MP_BUFFER_WRITE 2
+
+extern natmod_obj_t natmod_none;
+#define mp_const_none (&natmod_none)
+
+#define MP_OBJ_FROM_PTR(p) ((mp_obj_t)(p))
+#define MP_OBJ_TO_PTR(o) ((void *)(o))
+#define MP_ERROR_TEXT(x) x
+
+#define MP_DEFINE_CONST_FUN_OBJ_0(name, f) \
+    const mp_obj_fun_builtin_t name = { { NATMOD_FUN, 0, 0, NULL, NULL }, 0, 0, false, (void *)(f) }
+#define MP_DEFINE_CONST_FUN_OBJ_1(name, f) \
+    const mp_obj_fun_builtin_t name = { { NATMOD_FUN, 0, 0, NULL, NULL }, 1, 1, false, (void *)(f) }
+#define MP_DEFINE_CONST_FUN_OBJ_2(name, f) \
+    const mp_obj_fun_builtin_t name = { { NATMOD_FUN, 0, 0, NULL, NULL }, 2, 2, false, (void *)(f) }
+#define MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(name, lo, hi, f) \
+    const mp_obj_fun_builtin_t name = { { NATMOD_FUN, 0, 0, NULL, NULL }, lo, hi, true, (void *)(f) }
+
+// The qstrs of the modules built against the stand-in (the real build generates them)
+#define MP_QSTR_setup "setup"
+#define MP_QSTR_start "start"
+#define MP_QSTR_run "run"
+#define MP_QSTR_fill "fill"
+#define MP_QSTR_write "write"
+#define MP_QSTR_write_block "write_block"
+#define MP_QSTR_stats "stats"
+#define MP_QSTR_code "code"
+
+#define MP_DYNRUNTIME_INIT_ENTRY (void)self; (void)n_args; (void)n_kw; (void)args;
+#define MP_DYNRUNTIME_INIT_EXIT return mp_const_none;
+
+mp_int_t mp_obj_get_int(mp_obj_t o);
+mp_obj_t mp_obj_new_int(mp_int_t value);
+mp_obj_t mp_obj_new_int_from_uint(mp_uint_t value);
+mp_obj_t mp_obj_new_tuple(size_t n, const mp_obj_t *items);
+void mp_get_buffer_raise(mp_obj_t o, mp_buffer_info_t *info, int flags);
+__attribute__((noreturn)) void mp_raise_ValueError(const char *msg);
+void mp_store_global(qstr name, mp_obj_t o);
+
+#endif
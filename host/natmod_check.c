@@ -0,0 +1,213 @@
+/**
+ * @file natmod_check.c
+ * @brief py_native/siggen_native.c built with the host compiler and run through its Python API.
+ *
+ * The module is compiled as for the unix port (ARCH=x64: virtual 1 us
+ * clock, bus kept in memory) against a stand-in for py/dynruntime.h
+ * (natmod/py/dynruntime.h), and its functions are called the way
+ * py_native/test_native.py calls them, with the same checks:
+ *
+ * - run() before setup() and a bad shape raise ValueError;
+ * - the period repeats, the square has two levels (or, with tables longer
+ *   than its 256-sample period, comes band-limited), a smaller amplitude
+ *   swings less, and a change goes in at the end of the period;
+ * - write() and write_block() leave the last code on the bus;
+ * - run() writes one sample per period and skips those left behind by a
+ *   paced block.
+ *
+ * It also times fill() + write_block() as bench_native.py does. Exits
+ * non-zero on any failure.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "check.h"
+#include "natmod_host.h"
+#include "waveform.h"
+
+#define CHECK_PERIOD_US 5       ///< 200 kHz, como test_native.py
+#define CHECK_EXACT_MHZ 781250  ///< Paso exacto (2^24): 256 muestras por periodo
+#define CHECK_BENCH_SAMPLES 20000000u
+#define CHECK_BLOCK 256
+
+/**
+ * @brief Call a module function with integer arguments.
+ *
+ * @return The integer result (0 for None); -1 if the call raised.
+ */
+static mp_int_t call_ints(const char *name, size_t n, const mp_int_t *ints, const char **error) {
+    mp_obj_t args[5];
+    mp_obj_t r;
+    natmod_host_reset();
+    for (size_t i = 0; i < n; i++) {
+        args[i] = mp_obj_new_int(ints[i]);
+    }
+    if (!natmod_host_call(name, n, args, &r, error)) {
+        return -1;
+    }
+    return r->kind == NATMOD_INT ? r->value : 0;
+}
+
+static void setup(mp_int_t shape, mp_int_t amplitude, mp_int_t offset) {
+    const mp_int_t a[5] = { shape, amplitude, offset, CHECK_EXACT_MHZ, CHECK_PERIOD_US };
+    call_ints("setup", 5, a, NULL);
+}
+
+static void fill(uint8_t *buf, size_t len) {
+    natmod_host_reset();
+    mp_obj_t b = natmod_host_buffer(buf, len);
+    natmod_host_call("fill", 1, &b, NULL, NULL);
+}
+
+static mp_int_t write_block(const uint8_t *buf, size_t len, mp_int_t period_us) {
+    natmod_host_reset();
+    mp_obj_t args[2] = { natmod_host_buffer((void *)buf, len), mp_obj_new_int(period_us) };
+    mp_obj_t r;
+    return natmod_host_call("write_block", 2, args, &r, NULL) ? r->value : -1;
+}
+
+static mp_int_t code(void) {
+    return call_ints("code", 0, NULL, NULL);
+}
+
+static void stats(mp_int_t *written, mp_int_t *skipped) {
+    mp_obj_t r;
+    natmod_host_reset();
+    natmod_host_call("stats", 0, NULL, &r, NULL);
+    *written = r->items[0]->value;
+    *skipped = r->items[1]->value;
+}
+
+static uint32_t levels(const uint8_t *buf, size_t len) {
+    bool seen[256] = { false };
+    uint32_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        n += !seen[buf[i]];
+        seen[buf[i]] = true;
+    }
+    return n;
+}
+
+static uint32_t swing(const uint8_t *buf, size_t len) {
+    uint8_t lo = 255, hi = 0;
+    for (size_t i = 0; i < len; i++) {
+        lo = buf[i] < lo ? buf[i] : lo;
+        hi = buf[i] > hi ? buf[i] : hi;
+    }
+    return (uint32_t)(hi - lo);
+}
+
+/**
+ * @brief Errors raised before and during setup().
+ */
+static void test_errors(void) {
+    const char *error = NULL;
+    const mp_int_t slice = 1000;
+    call_ints("run", 1, &slice, &error);
+    check(error && strcmp(error, "setup first") == 0, "run() before setup() raises");
+    const mp_int_t bad[5] = { WAVEFORM_COUNT, 1000, 100, 1000, CHECK_PERIOD_US };
+    error = NULL;
+    call_ints("setup", 5, bad, &error);
+    check(error && strcmp(error, "shape") == 0, "bad shape raises");
+}
+
+/**
+ * @brief The period repeats exactly and stays within the DAC range.
+ */
+static void test_period(void) {
+    uint8_t buf[512];
+    setup(WAVEFORM_SINE, 2500, 1250);
+    fill(buf, sizeof(buf));
+    check(memcmp(buf, buf + 256, 256) == 0, "sine period repeats");
+    check(swing(buf, sizeof(buf)) >= 120, "largest amplitude, half the DAC range"); ///< Amp / 2 y 2500 / Amp de generator()
+    setup(WAVEFORM_SQUARE, 2500, 1250);
+    fill(buf, sizeof(buf)); ///< el cambio entra al final del periodo en curso
+    fill(buf, sizeof(buf));
+    // Con tablas de mas de 256 puntos la cuadrada de 256 muestras viene limitada en banda
+    if (waveform_band(WAVEFORM_SQUARE, CHECK_EXACT_MHZ, 1000000u / CHECK_PERIOD_US) == 0) {
+        check(levels(buf, sizeof(buf)) == 2, "square has two levels");
+    } else {
+        check(levels(buf, sizeof(buf)) > 2 && swing(buf, sizeof(buf)) >= 120, "band-limited square");
+    }
+    setup(WAVEFORM_TRIANGLE, 1000, 100);
+    fill(buf, sizeof(buf));
+    fill(buf, sizeof(buf));
+    check(swing(buf, sizeof(buf)) < 120, "smaller amplitude, smaller swing");
+}
+
+/**
+ * @brief write() and write_block() leave the last code on the bus.
+ */
+static void test_write(void) {
+    uint8_t ramp[256];
+    for (uint32_t i = 0; i < 256; i++) {
+        ramp[i] = (uint8_t)i;
+    }
+    const mp_int_t a5 = 0xA5;
+    call_ints("write", 1, &a5, NULL);
+    check(code() == 0xA5, "write");
+    check(write_block(ramp, 256, 0) == 0 && code() == 255, "write_block back to back");
+    const uint8_t three[3] = { 1, 2, 3 };
+    check(write_block(three, 3, CHECK_PERIOD_US) == 0 && code() == 3, "write_block paced");
+}
+
+/**
+ * @brief run() writes one sample per period and skips those left behind.
+ */
+static void test_run(void) {
+    mp_int_t written, skipped, w, s;
+    static const uint8_t zeros[100];
+    setup(WAVEFORM_SINE, 2500, 1250);
+    call_ints("start", 0, NULL, NULL);
+    stats(&written, &skipped);
+    const mp_int_t slice = 10000;
+    mp_int_t n = call_ints("run", 1, &slice, NULL);
+    check(labs(n - 10000 / CHECK_PERIOD_US) <= 2, "one sample per period");
+    // Un bloque pausado de 100 periodos deja la linea de tiempo 100 muestras atras
+    write_block(zeros, sizeof(zeros), CHECK_PERIOD_US);
+    const mp_int_t short_slice = 1000;
+    call_ints("run", 1, &short_slice, NULL);
+    stats(&w, &s);
+    check(labs(s - skipped - 100) <= 2, "late samples skipped");
+    check(w >= written + n, "written count");
+}
+
+/**
+ * @brief fill() + write_block() back to back, as bench_native.py.
+ */
+static void bench(void) {
+    static uint8_t buf[CHECK_BLOCK];
+    setup(WAVEFORM_SINE, 2500, 1250);
+    natmod_host_reset();
+    mp_obj_t fill_args[1] = { natmod_host_buffer(buf, sizeof(buf)) };
+    mp_obj_t write_args[2] = { fill_args[0], mp_obj_new_int(0) };
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < CHECK_BENCH_SAMPLES / CHECK_BLOCK; i++) {
+        natmod_host_call("fill", 1, fill_args, NULL, NULL);
+        natmod_host_call("write_block", 2, write_args, NULL, NULL);
+    }
+    uint64_t t1 = bench_now_ns();
+    printf("bench: fill + write_block %.0f samples/s on the host\n",
+           bench_rate(CHECK_BENCH_SAMPLES / CHECK_BLOCK * CHECK_BLOCK, t1 - t0));
+}
+
+int main(void) {
+    mpy_init(NULL, 0, 0, NULL);
+    const char *names[] = { "setup", "start", "run", "fill", "write", "write_block", "stats", "code" };
+    bool all = true;
+    for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        all = all && natmod_host_global(names[i]) != NULL;
+    }
+    check(all, "mpy_init() stores every function");
+
+    test_errors();
+    test_period();
+    test_write();
+    test_run();
+    bench();
+
+    return check_result();
+}
@@ -0,0 +1,179 @@
+/**
+ * @file natmod_host.c
+ * @brief Host stand-in for py/dynruntime.h: object pool, globals and calls.
+ */
+
+#include "natmod_host.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+natmod_obj_t natmod_none = { NATMOD_NONE, 0, 0, NULL, NULL };
+
+static natmod_obj_t pool[NATMOD_HOST_OBJECTS]; ///< Objetos creados desde el ultimo reset
+static uint32_t pool_used;
+static mp_obj_t items[NATMOD_HOST_OBJECTS]; ///< Elementos de las tuplas
+static uint32_t items_used;
+
+static struct {
+    const char *name;
+    mp_obj_t obj;
+} globals[NATMOD_HOST_GLOBALS];
+static uint32_t globals_used;
+
+static jmp_buf *raise_to; ///< Llamada en curso (NULL: fuera de natmod_host_call())
+static const char *raised; ///< Mensaje del ultimo ValueError
+
+/**
+ * @brief Take an object from the pool.
+ */
+static mp_obj_t natmod_host_new(uint8_t kind) {
+    if (pool_used == NATMOD_HOST_OBJECTS) {
+        mp_raise_ValueError("natmod_host: object pool exhausted");
+    }
+    mp_obj_t o = &pool[pool_used++];
+    memset(o, 0, sizeof(*o));
+    o->kind = kind;
+    return o;
+}
+
+/**
+ * @brief Free every object created since the last reset.
+ */
+void natmod_host_reset(void) {
+    pool_used = 0;
+    items_used = 0;
+}
+
+/**
+ * @brief Wrap a C buffer as an object with the buffer protocol (bytes, bytearray).
+ */
+mp_obj_t natmod_host_buffer(void *buf, size_t len) {
+    mp_obj_t o = natmod_host_new(NATMOD_BUFFER);
+    o->buf = buf;
+    o->len = len;
+    return o;
+}
+
+mp_int_t mp_obj_get_int(mp_obj_t o) {
+    if (o->kind != NATMOD_INT) {
+        mp_raise_ValueError("natmod_host: not an int");
+    }
+    return o->value;
+}
+
+mp_obj_t mp_obj_new_int(mp_int_t value) {
+    mp_obj_t o = natmod_host_new(NATMOD_INT);
+    o->value = value;
+    return o;
+}
+
+mp_obj_t mp_obj_new_int_from_uint(mp_uint_t value) {
+    return mp_obj_new_int((mp_int_t)value);
+}
+
+mp_obj_t mp_obj_new_tuple(size_t n, const mp_obj_t *src) {
+    if (items_used + n > NATMOD_HOST_OBJECTS) {
+        mp_raise_ValueError("natmod_host: tuple pool exhausted");
+    }
+    mp_obj_t o = natmod_host_new(NATMOD_TUPLE);
+    o->items = &items[items_used];
+    o->len = n;
+    memcpy(o->items, src, n * sizeof(*src));
+    items_used += n;
+    return o;
+}
+
+void mp_get_buffer_raise(mp_obj_t o, mp_buffer_info_t *info, int flags) {
+    (void)flags;
+    if (o->kind != NATMOD_BUFFER) {
+        mp_raise_ValueError("natmod_host: object with no buffer protocol");
+    }
+    info->buf = o->buf;
+    info->len = o->len;
+    info->typecode = 'B';
+}
+
+void mp_raise_ValueError(const char *msg) {
+    raised = msg;
+    if (!raise_to) {
+        fprintf(stderr, "ValueError outside a call: %s\n", msg);
+        abort();
+    }
+    longjmp(*raise_to, 1);
+}
+
+void mp_store_global(qstr name, mp_obj_t o) {
+    for (uint32_t i = 0; i < globals_used; i++) {
+        if (strcmp(globals[i].name, name) == 0) {
+            globals[i].obj = o;
+            return;
+        }
+    }
+    if (globals_used < NATMOD_HOST_GLOBALS) {
+        globals[globals_used].name = name;
+        globals[globals_used++].obj = o;
+    }
+}
+
+/**
+ * @brief Global stored by the module, or NULL.
+ */
+mp_obj_t natmod_host_global(const char *name) {
+    for (uint32_t i = 0; i < globals_used; i++) {
+        if (strcmp(globals[i].name, name) == 0) {
+            return globals[i].obj;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Call a function the module stored as a global.
+ *
+ * @param name Global name.
+ * @param n_args Number of positional arguments.
+ * @param args Arguments.
+ * @param[out] result Return value (may be NULL).
+ * @param[out] error Message of the ValueError raised, if any (may be NULL).
+ * @return false if the call raised (or the name is not a function taking @p n_args).
+ */
+bool natmod_host_call(const char *name, size_t n_args, const mp_obj_t *args, mp_obj_t *result, const char **error) {
+    const mp_obj_fun_builtin_t *f = (const mp_obj_fun_builtin_t *)natmod_host_global(name);
+    if (!f || f->base.kind != NATMOD_FUN || n_args < f->n_args_min || n_args > f->n_args_max) {
+        if (error) {
+            *error = "TypeError";
+        }
+        return false;
+    }
+    jmp_buf env;
+    jmp_buf *outer = raise_to;
+    raise_to = &env;
+    mp_obj_t r;
+    if (setjmp(env)) {
+        raise_to = outer;
+        if (error) {
+            *error = raised;
+        }
+        return false;
+    }
+    if (f->var) {
+        r = ((mp_obj_t (*)(size_t, const mp_obj_t *))f->fun)(n_args, args);
+    } else if (n_args == 0) {
+        r = ((mp_obj_t (*)(void))f->fun)();
+    } else if (n_args == 1) {
+        r = ((mp_obj_t (*)(mp_obj_t))f->fun)(args[0]);
+    } else {
+        r = ((mp_obj_t (*)(mp_obj_t, mp_obj_t))f->fun)(args[0], args[1]);
+    }
+    raise_to = outer;
+    if (result) {
+        *result = r;
+    }
+    if (error) {
+        *error = NULL;
+    }
+    return true;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file natmod_host.h
+ * @brief Harness side of the host stand-in for py/dynruntime.h.
+ *
+ * Runs a native module's mpy_init(), then calls the functions it stored as
+ * globals the way the interpreter would, catching mp_raise_ValueError().
+ */
+
+// Avoid duplication in code
+#ifndef _NATMOD_HOST_H_
+#define _NATMOD_HOST_H_
+
+#include "py/dynruntime.h"
+
+#define NATMOD_HOST_GLOBALS 16  ///< Globales que puede guardar un modulo
+#define NATMOD_HOST_OBJECTS 256 ///< Objetos vivos entre dos natmod_host_reset()
+
+mp_obj_t mpy_init(mp_obj_fun_bc_t *self, size_t n_args, size_t n_kw, mp_obj_t *args);
+
+void natmod_host_reset(void);
+mp_obj_t natmod_host_buffer(void *buf, size_t len);
+mp_obj_t natmod_host_global(const char *name);
+bool natmod_host_call(const char *name, size_t n_args, const mp_obj_t *args, mp_obj_t *result, const char **error);
+
+#endif
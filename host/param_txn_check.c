@@ -0,0 +1,304 @@
+/**
+ * @file param_txn_check.c
+ * @brief Boundary, latency and tearing checks of the parameter transactions.
+ *
+ * - Boundary: random transactions (any combination of shape, amplitude,
+ *   offset and frequency, at the period boundary or at a chosen phase) are
+ *   committed at random samples. Every sample must be the one of the old
+ *   parameter set up to the expected switch sample and of the new one from
+ *   it on, both for the period and for the phase step; the switch comes
+ *   right after the phase crosses the chosen phase, or after exactly the
+ *   wait bound, and the recorded wait matches. The period is that of the
+ *   band-limited table of each set's frequency, so a frequency change
+ *   across an octave switches tables on the same sample. gen_block_fill()
+ *   must produce the same samples.
+ * - Interrupt: transactions are committed while a timer signal runs the
+ *   sample path on the same thread, preempting the commit anywhere, as
+ *   the sample interrupt preempts the main loop. Every transaction has its
+ *   own frequency, so each sample's phase step tells which set played it:
+ *   its code must come from the same set (no torn update), the sets must
+ *   follow in commit order, and a switch before the bound must fall on the
+ *   chosen phase.
+ *
+ * Exits non-zero on any failure.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "bench.h"
+#include "check.h"
+#include "gen_block.h"
+#include "param_txn.h"
+
+#define CHECK_RATE_HZ 20000 ///< Reloj de muestreo de c_irq
+#define CHECK_TRIALS 20000u
+#define CHECK_INTERRUPT_TXNS 1000u
+#define CHECK_TICK_US 50 ///< Periodo de la interrupcion simulada
+#define CHECK_FAST_MHZ 200000u ///< Frecuencia base de las transacciones pares (periodo corto)
+#define CHECK_SLOW_MHZ 2000u ///< Frecuencia base de las impares (periodo mayor que la espera maxima)
+
+
+
+
+/**
+ * @brief Code a parameter set plays at a phase.
+ */
+static uint8_t expected_code(const siggen_params_t *p, uint32_t phase) {
+    uint32_t idx = (uint32_t)(((uint64_t)phase * WAVEFORM_LENGTH) >> 32);
+    const waveform_sample_t *table = waveform_band_table(p->shape, param_txn_band(p, CHECK_RATE_HZ));
+    waveform_sample_t v = table ? table[idx] : waveform_at(p->shape, idx);
+    return waveform_apply(waveform_to_dac(v), waveform_scaling(p->amplitude, p->offset));
+}
+
+static siggen_params_t random_params(void) {
+    siggen_params_t p = { 0 };
+    p.shape = (uint8_t)(check_rand() % WAVEFORM_COUNT);
+    p.amplitude = 100 + check_rand() % 2401;
+    p.offset = 50 + check_rand() % 1201;
+    p.freq_mhz = 1 + check_rand() % 3000000;
+    return p;
+}
+
+/**
+ * @brief Start a generator playing @p p from a random phase.
+ */
+static void start(wave_cache_t *c, dds_t *d, const siggen_params_t *p) {
+    wave_cache_init(c, WAVEFORM_LENGTH);
+    param_txn_stage(c, p, PARAM_WAVE, CHECK_RATE_HZ);
+    wave_cache_swap(c);
+    dds_init(d, WAVEFORM_LENGTH, false);
+    dds_set_frequency(d, p->freq_mhz, CHECK_RATE_HZ);
+    d->phase = check_rand();
+}
+
+/**
+ * @brief Random transactions against the expected switch sample.
+ */
+static void check_boundary(void) {
+    uint32_t wait = param_txn_wait(CHECK_RATE_HZ);
+    uint32_t forced = 0;
+    uint64_t waited = 0;
+    uint8_t *block = malloc(wait + 64);
+    for (uint32_t trial = 0; trial < CHECK_TRIALS; trial++) {
+        siggen_params_t a = random_params();
+        wave_cache_t cache;
+        dds_t dds;
+        start(&cache, &dds, &a);
+        for (uint32_t n = check_rand() % 1000; n; n--) {
+            wave_cache_next(&cache, &dds);
+        }
+
+        param_txn_t txn;
+        siggen_params_t b;
+        param_txn_begin(&txn, &a);
+        uint32_t fields = check_rand();
+        if (fields & 1) {
+            param_txn_shape(&txn, (uint8_t)(check_rand() % WAVEFORM_COUNT));
+        }
+        if (fields & 2) {
+            param_txn_amplitude(&txn, 100 + check_rand() % 2401);
+        }
+        if (fields & 4) {
+            param_txn_offset(&txn, 50 + check_rand() % 1201);
+        }
+        if (fields & 8 || !(fields & 7)) {
+            param_txn_frequency(&txn, 1 + check_rand() % 3000000);
+        }
+        if (fields & 16) {
+            param_txn_at(&txn, check_rand());
+        }
+        param_txn_commit(&txn, &b);
+        bool staged = param_txn_stage(&cache, &b, param_txn_diff(&a, &b), CHECK_RATE_HZ);
+
+        // Samples up to and including the one whose step crosses the chosen phase
+        uint32_t tuning_a = dds.tuning;
+        uint32_t tuning_b = dds_tuning_word(b.freq_mhz, CHECK_RATE_HZ);
+        uint32_t switch_at = 0;
+        bool crossed = false;
+        for (uint32_t phase = dds.phase; switch_at < wait && !crossed; switch_at++) {
+            crossed = phase + tuning_a - b.at_phase < phase - b.at_phase;
+            phase += tuning_a;
+        }
+        forced += !crossed;
+        waited += switch_at;
+
+        wave_cache_t block_cache = cache;
+        dds_t block_dds = dds;
+        uint32_t samples = switch_at + 1 + check_rand() % 64;
+        gen_state_t gen = { .dds = block_dds, .cache = &block_cache };
+        gen_block_fill(&gen, block, samples);
+
+        bool ok = true;
+        for (uint32_t i = 0; i < samples; i++) {
+            const siggen_params_t *p = i < switch_at ? &a : &b;
+            uint32_t phase = dds.phase;
+            uint8_t code = wave_cache_next(&cache, &dds);
+            ok = ok && code == expected_code(p, phase) && dds.phase - phase == (i < switch_at ? tuning_a : tuning_b);
+            ok = ok && block[i] == code;
+            if (i == switch_at && crossed) {
+                ok = ok && phase - b.at_phase < tuning_a; ///< primera muestra tras cruzar la fase elegida
+            }
+        }
+        check_quiet(ok, "samples around the switch (trial %u)", trial);
+        check_quiet(!staged || (cache.waited == switch_at && block_cache.waited == switch_at),
+                    "recorded wait (trial %u)", trial);
+        check_quiet(cache.applied == cache.published && !cache.pending, "change applied (trial %u)", trial);
+    }
+    free(block);
+    printf("boundary: %u transactions, %u forced by the %u-sample bound, mean wait %.1f samples\n", CHECK_TRIALS,
+           forced, wait, (double)waited / CHECK_TRIALS);
+}
+
+// Estado compartido con la interrupcion simulada
+static wave_cache_t shared_cache;
+static dds_t shared_dds;
+static siggen_params_t txns[CHECK_INTERRUPT_TXNS];
+static volatile uint32_t committed;
+static volatile uint64_t played;
+static volatile uint32_t current;
+static volatile uint32_t switches;
+static volatile uint32_t torn;
+static volatile uint32_t out_of_order;
+static volatile uint32_t off_phase;
+static volatile uint32_t over_bound;
+static volatile bool in_stage;
+static volatile uint32_t preempted;
+
+static uint32_t txn_freq(uint32_t n) {
+    return (n & 1 ? CHECK_SLOW_MHZ : CHECK_FAST_MHZ) + n;
+}
+
+/**
+ * @brief Transaction that played a phase step, -1 if none.
+ */
+static int32_t txn_of(uint32_t step, uint32_t from) {
+    for (uint32_t n = from; n < committed; n++) {
+        if (dds_tuning_word(txns[n].freq_mhz, CHECK_RATE_HZ) == step) {
+            return (int32_t)n;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief The sample interrupt: play and check a few samples.
+ */
+static void sample_interrupt(int sig) {
+    (void)sig;
+    static uint32_t last_step;
+    static uint32_t applied;
+    static bool switched;
+    static uint32_t switch_phase;
+    static uint32_t switch_step;
+    static uint32_t switch_wait;
+    uint32_t wait = param_txn_wait(CHECK_RATE_HZ);
+    preempted += in_stage;
+    if (!played) {
+        last_step = shared_dds.tuning;
+        applied = shared_cache.applied;
+    }
+    for (uint32_t burst = 1 + (uint32_t)played % 255; burst; burst--) {
+        uint32_t phase = shared_dds.phase;
+        uint8_t code = wave_cache_next(&shared_cache, &shared_dds);
+        uint32_t step = shared_dds.phase - phase;
+        if (step != last_step) {
+            int32_t n = txn_of(step, current + 1);
+            if (n < 0) {
+                out_of_order++;
+            } else {
+                current = (uint32_t)n;
+                switches++;
+            }
+        }
+        if (switched) {
+            // Primera muestra del cambio: la anterior cruzo su fase, o espero el maximo
+            switched = false;
+            if (switch_wait > wait || (switch_wait < wait && switch_phase - txns[current].at_phase >= switch_step)) {
+                off_phase++;
+            }
+            over_bound += switch_wait > wait;
+        }
+        if (code != expected_code(&txns[current], phase)) {
+            torn++;
+        }
+        if (shared_cache.applied != applied) {
+            applied = shared_cache.applied;
+            switched = true;
+            switch_phase = shared_dds.phase;
+            switch_step = step;
+            switch_wait = shared_cache.waited;
+        }
+        last_step = step;
+        played++;
+    }
+}
+
+/**
+ * @brief Commits preempted by the sample path at random points.
+ *
+ * A POSIX interval timer plays the sample interrupt on this same thread,
+ * so it can land anywhere inside param_txn_stage(), as TIMER_IRQ_2 does
+ * inside the main loop.
+ */
+static void check_interrupt(void) {
+    txns[0] = (siggen_params_t){ .shape = WAVEFORM_SINE, .amplitude = 1000, .offset = 100, .freq_mhz = txn_freq(0) };
+    committed = 1;
+    start(&shared_cache, &shared_dds, &txns[0]);
+    signal(SIGALRM, sample_interrupt);
+    struct itimerval tick = { { 0, CHECK_TICK_US }, { 0, CHECK_TICK_US } };
+    setitimer(ITIMER_REAL, &tick, NULL);
+
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t n = 1; n < CHECK_INTERRUPT_TXNS; n++) {
+        uint32_t r = check_rand();
+        uint64_t until = played + r % 3000;
+        while (played < until) {
+        }
+        for (volatile uint32_t k = r % 20000; k; k--) {
+            ///< no empezar siempre justo despues de una interrupcion
+        }
+        param_txn_t txn;
+        param_txn_begin(&txn, &txns[n - 1]);
+        if (r & 1) {
+            param_txn_shape(&txn, (uint8_t)(r % WAVEFORM_COUNT));
+        }
+        if (r & 2) {
+            param_txn_amplitude(&txn, 100 + r % 2401);
+        }
+        if (r & 4) {
+            param_txn_offset(&txn, 50 + (r >> 8) % 1201);
+        }
+        param_txn_frequency(&txn, txn_freq(n)); ///< cada conjunto se reconoce por su sintonia
+        param_txn_at(&txn, r & 8 ? r : 0);
+        param_txn_commit(&txn, &txns[n]);
+        committed = n + 1;
+        in_stage = true;
+        param_txn_stage(&shared_cache, &txns[n], param_txn_diff(&txns[n - 1], &txns[n]), CHECK_RATE_HZ);
+        in_stage = false;
+    }
+    uint64_t until = played + 2 * param_txn_wait(CHECK_RATE_HZ);
+    while (played < until) {
+    }
+    struct itimerval off = { { 0, 0 }, { 0, 0 } };
+    setitimer(ITIMER_REAL, &off, NULL);
+    uint64_t t1 = bench_now_ns();
+
+    check_quiet(!torn, "codes from the set that owns the phase step (%u torn)", torn);
+    check_quiet(!out_of_order, "sets in commit order (%u out of order)", out_of_order);
+    check_quiet(!off_phase, "switches at the chosen phase or the bound (%u off phase)", off_phase);
+    check_quiet(!over_bound, "waits within the bound (%u over)", over_bound);
+    check_quiet(current == CHECK_INTERRUPT_TXNS - 1, "last set playing (set %u)", current);
+    printf("interrupt: %u transactions (%u preempted while staged), %u seen by the sample path (the rest merged), "
+           "%llu samples in %.2f s\n",
+           CHECK_INTERRUPT_TXNS - 1, preempted, switches, (unsigned long long)played, (double)(t1 - t0) / 1e9);
+}
+
+int main(void) {
+    check_seed(12345);
+    check_boundary();
+    check_interrupt();
+    return check_result();
+}
@@ -0,0 +1,212 @@
+/**
+ * @file preset_check.c
+ * @brief Format, wear-levelling and power-cut checks of the preset store.
+ *
+ * Runs the store against the simulated flash of preset_flash_host.c:
+ *
+ * - Round trip: every slot saved with random parameters and a name reads
+ *   back the same after mounting again; a blank and a garbage region
+ *   mount empty and accept saves.
+ * - Wear: many saves, mostly of the last-configuration slot as the
+ *   firmware does; every sector must be erased the same number of times
+ *   (within one), no byte may be programmed twice, and every remount must
+ *   give back the newest value of every slot.
+ * - Power cut: the power goes off after a random number of bytes of a
+ *   save (often inside a sector erase and its copies). After remounting,
+ *   the slot being saved must hold its old or its new value and every
+ *   other slot its old one; the flash is never reset between cuts.
+ *
+ * Prints the saves per erase and the mount time. Exits non-zero on any
+ * failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "check.h"
+#include "preset_flash_host.h"
+
+#define CHECK_WEAR_SAVES 200000u
+#define CHECK_REMOUNT_EVERY 997u ///< Guardados entre montajes de la prueba de desgaste
+#define CHECK_CUTS 20000u
+#define CHECK_ENDURANCE 100000u ///< Ciclos de borrado de la flash del RP2040 (W25Q16JV)
+
+
+
+
+static siggen_params_t random_params(void) {
+    siggen_params_t p;
+    memset(&p, 0, sizeof(p));
+    p.shape = (uint8_t)(check_rand() % 4);
+    p.amplitude = 100 + check_rand() % 2401;
+    p.offset = 50 + check_rand() % 1201;
+    p.freq_mhz = check_rand() % 100000000u;
+    p.phase_deg = check_rand() % 360;
+    p.mod = (uint8_t)(check_rand() % 5);
+    p.mod_arg = check_rand();
+    p.mod_time = check_rand();
+    return p;
+}
+
+/**
+ * @brief Expected value of one slot.
+ */
+typedef struct {
+    bool saved;
+    siggen_params_t params;
+    char name[PRESET_NAME_LEN + 1];
+} shadow_t;
+
+static bool same(const preset_t *p, const shadow_t *e) {
+    if (!e->saved) {
+        return p == NULL;
+    }
+    return p && p->params.shape == e->params.shape && p->params.amplitude == e->params.amplitude
+           && p->params.offset == e->params.offset && p->params.freq_mhz == e->params.freq_mhz
+           && p->params.phase_deg == e->params.phase_deg && p->params.mod == e->params.mod
+           && p->params.mod_arg == e->params.mod_arg && p->params.mod_time == e->params.mod_time
+           && strcmp(p->name, e->name) == 0;
+}
+
+static void save(preset_store_t *s, shadow_t *shadow, uint32_t slot, uint32_t trial) {
+    shadow_t *e = &shadow[slot];
+    e->params = random_params();
+    snprintf(e->name, sizeof(e->name), slot == PRESET_LAST ? "last" : "preset %u", trial % 1000);
+    check_quiet(preset_store_save(s, slot, &e->params, e->name), "save (trial %u)", trial);
+    e->saved = true;
+}
+
+static void check_all(const preset_store_t *s, const shadow_t *shadow, const char *what, uint32_t trial) {
+    for (uint32_t slot = 0; slot < PRESET_SLOTS; slot++) {
+        check_quiet(same(preset_store_get(s, slot), &shadow[slot]), "%s (trial %u)", what, trial);
+    }
+}
+
+static void check_round_trip(void) {
+    preset_store_t s, t;
+    shadow_t shadow[PRESET_SLOTS];
+    memset(shadow, 0, sizeof(shadow));
+
+    preset_flash_host_reset();
+    preset_store_mount(&s);
+    check_all(&s, shadow, "blank region mounts empty", 0);
+    for (uint32_t slot = 0; slot < PRESET_SLOTS; slot++) {
+        save(&s, shadow, slot, slot);
+    }
+    check_quiet(!preset_store_save(&s, PRESET_SLOTS, &shadow[0].params, "x"), "slot out of range");
+    preset_store_mount(&t);
+    check_all(&t, shadow, "round trip", 0);
+    check_quiet(t.seq == s.seq && t.sector == s.sector && t.next == s.next, "write position");
+
+    // Flash left by some other program: nothing valid, writing must still work
+    preset_flash_host_reset();
+    uint8_t page[PRESET_PAGE_LEN];
+    for (uint32_t at = 0; at < PRESET_REGION_LEN; at += PRESET_PAGE_LEN) {
+        for (uint32_t i = 0; i < PRESET_PAGE_LEN; i++) {
+            page[i] = (uint8_t)check_rand();
+        }
+        page[0] = PRESET_MAGIC; ///< cabeceras creibles con CRC erroneo
+        page[1] = PRESET_FORMAT;
+        page[2] = 0;
+        preset_flash_hw_program(at, page);
+    }
+    memset(shadow, 0, sizeof(shadow));
+    preset_store_mount(&s);
+    check_all(&s, shadow, "garbage region mounts empty", 0);
+    for (uint32_t i = 0; i < 3 * PRESET_SECTOR_RECORDS; i++) {
+        save(&s, shadow, check_rand() % PRESET_SLOTS, i);
+    }
+    preset_store_mount(&t);
+    check_all(&t, shadow, "saves over garbage", 0);
+    printf("round trip: %u slots, %u-byte records, %u per sector\n", PRESET_SLOTS, PRESET_RECORD_LEN,
+           PRESET_SECTOR_RECORDS);
+}
+
+static void check_wear(void) {
+    preset_store_t s;
+    shadow_t shadow[PRESET_SLOTS];
+    memset(shadow, 0, sizeof(shadow));
+    preset_flash_host_reset();
+    preset_store_mount(&s);
+    for (uint32_t i = 0; i < CHECK_WEAR_SAVES; i++) {
+        uint32_t slot = check_rand() % 8 ? PRESET_LAST : 1 + check_rand() % (PRESET_SLOTS - 1);
+        save(&s, shadow, slot, i);
+        if (i % CHECK_REMOUNT_EVERY == 0) {
+            preset_store_mount(&s);
+            check_all(&s, shadow, "remount", i);
+        }
+    }
+    preset_store_mount(&s);
+    check_all(&s, shadow, "final remount", CHECK_WEAR_SAVES);
+
+    uint32_t lo = UINT32_MAX, hi = 0, total = 0;
+    for (uint32_t k = 0; k < PRESET_SECTORS; k++) {
+        uint32_t e = preset_flash_host_erases(k);
+        lo = e < lo ? e : lo;
+        hi = e > hi ? e : hi;
+        total += e;
+    }
+    check_quiet(hi - lo <= 1, "erases evenly spread");
+    check_quiet(preset_flash_host_overwrites() == 0, "no byte programmed twice");
+    double per_erase = total ? (double)CHECK_WEAR_SAVES / total : 0.0;
+    printf("wear: %u saves, %u erases per sector (%u-%u), %.1f saves per erase, "
+           "%.0f million saves to %u cycles\n",
+           CHECK_WEAR_SAVES, total / PRESET_SECTORS, lo, hi, per_erase,
+           per_erase * PRESET_SECTORS * CHECK_ENDURANCE / 1e6, CHECK_ENDURANCE);
+
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < 100; i++) {
+        preset_store_mount(&s);
+    }
+    printf("mount: %.1f us on the host (full region)\n", (bench_now_ns() - t0) / 100 / 1e3);
+}
+
+static void check_power_cut(void) {
+    preset_store_t s;
+    shadow_t shadow[PRESET_SLOTS];
+    memset(shadow, 0, sizeof(shadow));
+    preset_flash_host_reset();
+    preset_store_mount(&s);
+    uint32_t in_compaction = 0, lost = 0, worst_torn = 0;
+    for (uint32_t i = 0; i < CHECK_CUTS; i++) {
+        uint32_t slot = check_rand() % PRESET_SLOTS;
+        bool compacting = s.next >= PRESET_SECTOR_RECORDS;
+        uint32_t reach = compacting ? PRESET_SECTOR_LEN + PRESET_SLOTS * PRESET_RECORD_LEN : PRESET_RECORD_LEN;
+        shadow_t before = shadow[slot];
+        shadow_t after = shadow[slot];
+        after.params = random_params();
+        snprintf(after.name, sizeof(after.name), "cut %u", i);
+        after.saved = true;
+
+        preset_flash_host_cut_after(check_rand() % (2 * reach)); ///< la mitad llega a acabar
+        bool ok = preset_store_save(&s, slot, &after.params, after.name);
+        bool cut = !preset_flash_host_powered();
+        preset_flash_host_power_on();
+        check_quiet(ok != cut, "save fails exactly on a cut (trial %u)", i);
+        in_compaction += cut && compacting;
+
+        preset_store_mount(&s);
+        worst_torn = s.torn > worst_torn ? s.torn : worst_torn;
+        const preset_t *got = preset_store_get(&s, slot);
+        if (same(got, &after)) {
+            shadow[slot] = after;
+        } else {
+            check_quiet(cut && same(got, &before), "cut slot holds its old or new value (trial %u)", i);
+            lost++;
+        }
+        check_all(&s, shadow, "other slots untouched", i);
+        check_quiet(preset_flash_host_overwrites() == 0, "no byte programmed twice (trial %u)", i);
+    }
+    check_quiet(in_compaction > 100, "cuts inside compactions");
+    printf("power cut: %u saves, %u cut (%u inside a compaction), up to %u torn records skipped at mount\n",
+           CHECK_CUTS, lost, in_compaction, worst_torn);
+}
+
+int main(void) {
+    check_seed(2024);
+    check_round_trip();
+    check_wear();
+    check_power_cut();
+    return check_result();
+}
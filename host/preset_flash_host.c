@@ -0,0 +1,115 @@
+/**
+ * @file preset_flash_host.c
+ * @brief Host stand-in for the preset flash region.
+ *
+ * Behaves like NOR flash: erasing sets a whole sector to 0xFF, programming
+ * can only clear bits (a byte programmed twice keeps the AND of both).
+ * Bytes are erased and programmed in order, so a power cut, set with
+ * preset_flash_host_cut_after(), leaves the operation half done; every
+ * operation then fails until preset_flash_host_power_on().
+ */
+
+#include "preset_flash_host.h"
+
+#include <string.h>
+
+static uint8_t region[PRESET_REGION_LEN];
+static uint32_t erases[PRESET_SECTORS]; ///< Borrados de cada sector
+static uint32_t programs;               ///< Paginas programadas
+static uint32_t overwrites;             ///< Bytes programados con bits que ya eran 0
+static uint32_t budget;                 ///< Bytes que se escriben antes del corte
+static bool cutting;                    ///< Hay un corte pendiente
+static bool powered = true;
+
+/**
+ * @brief Consume one byte of the budget before a cut.
+ *
+ * @return false if the power is (now) off.
+ */
+static bool preset_flash_host_tick(void) {
+    if (!powered) {
+        return false;
+    }
+    if (cutting && budget-- == 0) {
+        powered = false;
+        cutting = false;
+        return false;
+    }
+    return true;
+}
+
+const uint8_t *preset_flash_hw_region(void) {
+    return region;
+}
+
+bool preset_flash_hw_erase(uint32_t offset) {
+    for (uint32_t i = 0; i < PRESET_SECTOR_LEN; i++) {
+        if (!preset_flash_host_tick()) {
+            return false;
+        }
+        region[offset + i] = 0xFF;
+    }
+    erases[offset / PRESET_SECTOR_LEN]++;
+    return true;
+}
+
+bool preset_flash_hw_program(uint32_t offset, const uint8_t *page) {
+    for (uint32_t i = 0; i < PRESET_PAGE_LEN; i++) {
+        if (page[i] == 0xFF) {
+            continue; ///< nada que programar en este byte
+        }
+        if (!preset_flash_host_tick()) {
+            return false;
+        }
+        if ((region[offset + i] & page[i]) != page[i]) {
+            overwrites++;
+        }
+        region[offset + i] &= page[i];
+    }
+    programs++;
+    return true;
+}
+
+/**
+ * @brief A new chip: all erased, no counts, powered.
+ */
+void preset_flash_host_reset(void) {
+    memset(region, 0xFF, sizeof(region));
+    memset(erases, 0, sizeof(erases));
+    programs = 0;
+    overwrites = 0;
+    cutting = false;
+    powered = true;
+}
+
+/**
+ * @brief Cut the power once @p bytes more bytes have been erased or programmed.
+ */
+void preset_flash_host_cut_after(uint32_t bytes) {
+    budget = bytes;
+    cutting = true;
+}
+
+/**
+ * @brief Power up again after a cut (and cancel a pending one).
+ */
+void preset_flash_host_power_on(void) {
+    cutting = false;
+    powered = true;
+}
+
+bool preset_flash_host_powered(void) {
+    return powered;
+}
+
+uint32_t preset_flash_host_erases(uint32_t sector) {
+    return sector < PRESET_SECTORS ? erases[sector] : 0;
+}
+
+uint32_t preset_flash_host_programs(void) {
+    return programs;
+}
+
+uint32_t preset_flash_host_overwrites(void) {
+    return overwrites;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file preset_flash_host.h
+ * @brief Simulated NOR flash region of the presets, with power cuts.
+ */
+
+// Avoid duplication in code
+#ifndef _PRESET_FLASH_HOST_H_
+#define _PRESET_FLASH_HOST_H_
+
+#include "preset_store.h"
+
+void preset_flash_host_reset(void);
+void preset_flash_host_cut_after(uint32_t bytes);
+void preset_flash_host_power_on(void);
+bool preset_flash_host_powered(void);
+uint32_t preset_flash_host_erases(uint32_t sector);
+uint32_t preset_flash_host_programs(void);
+uint32_t preset_flash_host_overwrites(void);
+
+#endif
@@ -0,0 +1,292 @@
+/**
+ * @file render.c
+ * @brief Offline renderer: the firmware's DAC codes written to raw, WAV or CSV.
+ *
+ * Uses the same DDS, scaling and cache code as c_irq and c_pol, so the
+ * output is the sequence of codes generator() would put on D0-D7 at the
+ * given sample rate. Samples are produced with gen_block_fill() in chunks
+ * and written with one buffered fwrite() per chunk.
+ *
+ * Usage:
+ *   render [--shape sine|triangle|sawtooth|square] [--amp mV] [--offset mV]
+ *          [--freq Hz] [--rate Hz] [--duration s] [--format raw|wav|csv]
+ *          [--out file] [--check]
+ *
+ * The defaults are those of the firmware at power-up (sine, 1000 mV, 100 mV,
+ * 10 Hz) at the c_irq sample rate. --check also runs, on its own DDS, the
+ * arithmetic of the original generator() (a copy here, independent of
+ * waveform.c) and fails if any code differs. The renders in golden/ are
+ * compared by the render_golden target.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "gen_block.h"
+
+#define RENDER_CHUNK 65536u ///< Muestras por escritura
+#define RENDER_CSV_LINE 16u ///< Caracteres maximos por linea CSV ("4294967295,255\n")
+
+/**
+ * @brief The scaling of the original generator() of c_irq and c_pol, for --check.
+ *
+ * Kept as it was written, on purpose not shared with waveform.c, so a
+ * change to waveform_scaling() or waveform_apply() shows up as a mismatch.
+ *
+ * @param raw Table value.
+ * @param Amp Amplitude of the signal (mV).
+ * @param DC DC offset of the signal (mV).
+ * @return DAC code (the low 8 bits, as set_dac_value() wrote them).
+ */
+static uint8_t reference_generator(uint16_t raw, uint32_t Amp, uint32_t DC) {
+    Amp /= 2;
+    uint16_t signal = raw;
+    uint16_t norm_DC = 255 - ((DC * 255) / 1250);
+    uint16_t norm_Amp = 2500 / Amp;
+    signal = (signal / norm_Amp) - norm_DC;
+    return (uint8_t)signal;
+}
+
+/**
+ * @brief Output formats.
+ */
+typedef enum {
+    RENDER_RAW, ///< Un byte por muestra
+    RENDER_WAV, ///< PCM de 8 bits sin signo, mono
+    RENDER_CSV, ///< "sample,code" por linea
+} render_format_t;
+
+static uint8_t codes[RENDER_CHUNK]; ///< Bloque de codigos del DAC
+static char csv[RENDER_CHUNK * RENDER_CSV_LINE]; ///< Bloque formateado como texto
+
+/**
+ * @brief Print the usage and exit with an error.
+ */
+static void usage(void) {
+    fprintf(stderr,
+            "usage: render [--shape sine|triangle|sawtooth|square] [--amp mV] [--offset mV]\n"
+            "              [--freq Hz] [--rate Hz] [--duration s] [--format raw|wav|csv]\n"
+            "              [--out file] [--check]\n");
+    exit(2);
+}
+
+/**
+ * @brief Parse a decimal number with up to three decimals, in thousandths.
+ *
+ * Same rules as the keypad entry (dds_parse_mhz()), with '.' as the
+ * decimal point.
+ */
+static uint32_t parse_milli(const char *text) {
+    char buf[32];
+    size_t i;
+    for (i = 0; text[i] && i < sizeof(buf) - 1; i++) {
+        buf[i] = text[i] == '.' ? '*' : text[i];
+    }
+    buf[i] = '\0';
+    return dds_parse_mhz(buf);
+}
+
+/**
+ * @brief Waveform shape by name or number.
+ */
+static int parse_shape(const char *text) {
+    static const char *names[WAVEFORM_COUNT] = { "sine", "triangle", "sawtooth", "square" };
+    for (int i = 0; i < WAVEFORM_COUNT; i++) {
+        if (strcmp(text, names[i]) == 0) {
+            return i;
+        }
+    }
+    char *end;
+    long shape = strtol(text, &end, 10);
+    return *end == '\0' && shape >= 0 && shape < WAVEFORM_COUNT ? (int)shape : -1;
+}
+
+/**
+ * @brief Write a little-endian field of @p size bytes.
+ */
+static void put_le(uint8_t *p, uint32_t value, int size) {
+    for (int i = 0; i < size; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Write the 44-byte header of an 8-bit mono PCM WAV file.
+ */
+static int write_wav_header(FILE *f, uint32_t rate, uint32_t samples) {
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);
+    put_le(h + 4, 36u + samples, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le(h + 16, 16, 4);      ///< tamano del bloque fmt
+    put_le(h + 20, 1, 2);       ///< PCM
+    put_le(h + 22, 1, 2);       ///< mono
+    put_le(h + 24, rate, 4);
+    put_le(h + 28, rate, 4);    ///< bytes por segundo
+    put_le(h + 32, 1, 2);       ///< bytes por muestra
+    put_le(h + 34, 8, 2);       ///< bits por muestra
+    memcpy(h + 36, "data", 4);
+    put_le(h + 40, samples, 4);
+    return fwrite(h, sizeof(h), 1, f) == 1 ? 0 : -1;
+}
+
+/**
+ * @brief Format a chunk as "sample,code" lines.
+ *
+ * @return Number of characters written to @c csv.
+ */
+static size_t format_csv(uint64_t first, const uint8_t *c, uint32_t n) {
+    char *p = csv;
+    for (uint32_t i = 0; i < n; i++) {
+        char digits[20];
+        int len = 0;
+        uint64_t index = first + i;
+        do {
+            digits[len++] = (char)('0' + index % 10u);
+            index /= 10u;
+        } while (index);
+        while (len) {
+            *p++ = digits[--len];
+        }
+        *p++ = ',';
+        uint8_t code = c[i];
+        if (code >= 100) {
+            *p++ = (char)('0' + code / 100);
+        }
+        if (code >= 10) {
+            *p++ = (char)('0' + code / 10 % 10);
+        }
+        *p++ = (char)('0' + code % 10);
+        *p++ = '\n';
+    }
+    return (size_t)(p - csv);
+}
+
+int main(int argc, char **argv) {
+    int shape = WAVEFORM_SINE;
+    uint32_t amplitude = 1000;
+    uint32_t offset = 100;
+    uint32_t freq_mhz = 10000;
+    uint32_t rate = 20000;
+    uint32_t duration_ms = 1000;
+    render_format_t format = RENDER_RAW;
+    const char *path = "-";
+    int check = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i];
+        if (strcmp(opt, "--check") == 0) {
+            check = 1;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+        }
+        const char *val = argv[++i];
+        if (strcmp(opt, "--shape") == 0) {
+            shape = parse_shape(val);
+        } else if (strcmp(opt, "--amp") == 0) {
+            amplitude = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(opt, "--offset") == 0) {
+            offset = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(opt, "--freq") == 0) {
+            freq_mhz = parse_milli(val);
+        } else if (strcmp(opt, "--rate") == 0) {
+            rate = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(opt, "--duration") == 0) {
+            duration_ms = parse_milli(val);
+        } else if (strcmp(opt, "--format") == 0) {
+            if (strcmp(val, "raw") == 0) {
+                format = RENDER_RAW;
+            } else if (strcmp(val, "wav") == 0) {
+                format = RENDER_WAV;
+            } else if (strcmp(val, "csv") == 0) {
+                format = RENDER_CSV;
+            } else {
+                usage();
+            }
+        } else if (strcmp(opt, "--out") == 0) {
+            path = val;
+        } else {
+            usage();
+        }
+    }
+
+    // Same limits as the A and B keypad commands
+    if (shape < 0 || amplitude < 100 || amplitude > 2500 || offset < 50 || offset > 1250 || rate == 0) {
+        fprintf(stderr, "render: invalid shape, amplitude (100-2500), offset (50-1250) or rate\n");
+        return 2;
+    }
+    uint64_t samples = (uint64_t)rate * duration_ms / 1000u;
+    if (format == RENDER_WAV && samples > 0xFFFFFFFFu - 36u) {
+        fprintf(stderr, "render: too many samples for a WAV file\n");
+        return 2;
+    }
+
+    FILE *f = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    setvbuf(f, NULL, _IOFBF, 1u << 20);
+
+    static wave_cache_t cache;
+    gen_state_t gen = { .cache = &cache };
+    dds_init(&gen.dds, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&gen.dds, freq_mhz, rate);
+    wave_cache_init(&cache, WAVEFORM_LENGTH);
+    uint32_t band = waveform_band((uint8_t)shape, freq_mhz, rate); ///< la tabla que elige el firmware
+    wave_cache_begin(&cache);
+    wave_cache_fill_band(&cache, (uint8_t)shape, band, amplitude, offset);
+    wave_cache_commit(&cache, 0, 0);
+    wave_cache_swap(&cache);
+
+    // Per-sample path of the original generator(), for --check
+    uint8_t table[WAVEFORM_LENGTH];
+    const waveform_sample_t *limited = waveform_band_table((uint8_t)shape, band);
+    dds_t ref = gen.dds;
+    for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+        table[i] = waveform_to_dac(limited ? limited[i] : waveform_at((uint8_t)shape, i));
+    }
+
+    int status = 0;
+    uint64_t mismatches = 0;
+    uint64_t t0 = bench_now_ns();
+    if (format == RENDER_WAV && write_wav_header(f, rate, (uint32_t)samples) != 0) {
+        status = 1;
+    }
+    for (uint64_t done = 0; done < samples && status == 0; ) {
+        uint32_t n = samples - done < RENDER_CHUNK ? (uint32_t)(samples - done) : RENDER_CHUNK;
+        gen_block_fill(&gen, codes, n);
+        if (check) {
+            for (uint32_t i = 0; i < n; i++) {
+                mismatches += codes[i] != reference_generator(dds_next(&ref, table), amplitude, offset);
+            }
+        }
+        if (format == RENDER_CSV) {
+            size_t len = format_csv(done, codes, n);
+            status = fwrite(csv, 1, len, f) == len ? 0 : 1;
+        } else {
+            status = fwrite(codes, 1, n, f) == n ? 0 : 1;
+        }
+        done += n;
+    }
+    if (fflush(f) != 0 || (f != stdout && fclose(f) != 0)) {
+        status = 1;
+    }
+    uint64_t t1 = bench_now_ns();
+
+    if (status) {
+        perror(path);
+        return 1;
+    }
+    fprintf(stderr, "render: %llu samples in %.1f ms (%.0f samples/s)\n",
+            (unsigned long long)samples, (double)(t1 - t0) / 1e6, bench_rate(samples, t1 - t0));
+    if (check) {
+        fprintf(stderr, "render: check against the original generator(): %llu mismatches\n", (unsigned long long)mismatches);
+        return mismatches ? 3 : 0;
+    }
+    return 0;
+}
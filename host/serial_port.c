@@ -0,0 +1,75 @@
+/**
+ * @file serial_port.c
+ * @brief Raw access to the USB serial port of the firmware, for the host tools.
+ */
+
+#include "serial_port.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Write all of @p buf (uploader_write_t, @p ctx points to the descriptor).
+ */
+int32_t serial_write(const uint8_t *buf, uint32_t len, void *ctx) {
+    int fd = *(int *)ctx;
+    while (len) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buf += n;
+        len -= (uint32_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read what arrives within a timeout (uploader_read_t).
+ */
+int32_t serial_read(uint8_t *buf, uint32_t len, uint32_t timeout_ms, void *ctx) {
+    struct pollfd p = { .fd = *(int *)ctx, .events = POLLIN };
+    int r = poll(&p, 1, (int)timeout_ms);
+    if (r <= 0) {
+        return r;
+    }
+    ssize_t n = read(p.fd, buf, len);
+    return n < 0 ? -1 : (int32_t)n;
+}
+
+/**
+ * @brief Monotonic clock in ms (uploader_clock_t).
+ */
+uint32_t serial_now_ms(void *ctx) {
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/**
+ * @brief Open a serial port raw (the baud rate does not matter on USB CDC).
+ *
+ * @return File descriptor, -1 on error.
+ */
+int serial_open(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct termios t;
+    if (tcgetattr(fd, &t) == 0) {
+        cfmakeraw(&t);
+        cfsetspeed(&t, B115200);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    tcflush(fd, TCIFLUSH);
+    return fd;
+}
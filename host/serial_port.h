@@ -0,0 +1,17 @@
+/**
+ * @file serial_port.h
+ * @brief Raw access to the USB serial port of the firmware, for the host tools.
+ */
+
+// Avoid duplication in code
+#ifndef _SERIAL_PORT_H_
+#define _SERIAL_PORT_H_
+
+#include <stdint.h>
+
+int serial_open(const char *path);
+int32_t serial_write(const uint8_t *buf, uint32_t len, void *ctx);
+int32_t serial_read(uint8_t *buf, uint32_t len, uint32_t timeout_ms, void *ctx);
+uint32_t serial_now_ms(void *ctx);
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * @file Arduino.h
+ * @brief The part of the Arduino API (arduino-pico core) used by the .ino sketches, on the simulator.
+ *
+ * Built on the simulated Pico SDK (pico_sim_sdk.h), which the sketches may
+ * also call directly as on arduino-pico: digitalWrite() and digitalRead()
+ * are one SIO access each, so every pin write is recorded and charged by
+ * the simulator like the SDK calls of the C firmwares. The pin checks the
+ * core does on top are not charged, which favours the digitalWrite path.
+ * Serial goes to the simulator console.
+ */
+
+// Avoid duplication in code
+#ifndef _ARDUINO_H_
+#define _ARDUINO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "pico_sim_sdk.h"
+}
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void noInterrupts(void);
+void interrupts(void);
+
+/**
+ * @brief USB serial port of the core, printing to the simulator console.
+ */
+class SerialUSB {
+public:
+    void begin(unsigned long baud);
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(int n);
+    size_t print(unsigned int n);
+    size_t print(long n);
+    size_t print(unsigned long n);
+    size_t println(void);
+
+    template <typename T> size_t println(T value) {
+        size_t n = print(value);
+        return n + println();
+    }
+};
+
+extern SerialUSB Serial;
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file arduino_sim.cpp
+ * @brief Arduino API of arduino/Arduino.h on the simulated Pico SDK.
+ */
+
+#include "Arduino.h"
+
+SerialUSB Serial;
+
+static uint32_t saved_interrupts; ///< Estado de noInterrupts() para interrupts()
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    gpio_init(pin);
+    gpio_set_dir(pin, mode == OUTPUT);
+    if (mode == INPUT_PULLUP) {
+        gpio_pull_up(pin);
+    } else if (mode == INPUT_PULLDOWN) {
+        gpio_pull_down(pin);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    gpio_put(pin, value != LOW);
+}
+
+int digitalRead(uint8_t pin) {
+    return gpio_get(pin) ? HIGH : LOW;
+}
+
+unsigned long millis(void) {
+    return (unsigned long)(time_us_64() / 1000u);
+}
+
+unsigned long micros(void) {
+    return (unsigned long)time_us_64();
+}
+
+void delay(unsigned long ms) {
+    sleep_ms((uint32_t)ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    busy_wait_us(us);
+}
+
+void noInterrupts(void) {
+    saved_interrupts = save_and_disable_interrupts();
+}
+
+void interrupts(void) {
+    restore_interrupts(saved_interrupts);
+}
+
+void SerialUSB::begin(unsigned long baud) {
+    (void)baud;
+    stdio_init_all();
+}
+
+size_t SerialUSB::print(const char *s) {
+    return (size_t)printf("%s", s);
+}
+
+size_t SerialUSB::print(char c) {
+    return (size_t)printf("%c", c);
+}
+
+size_t SerialUSB::print(int n) {
+    return (size_t)printf("%d", n);
+}
+
+size_t SerialUSB::print(unsigned int n) {
+    return (size_t)printf("%u", n);
+}
+
+size_t SerialUSB::print(long n) {
+    return (size_t)printf("%ld", n);
+}
+
+size_t SerialUSB::print(unsigned long n) {
+    return (size_t)printf("%lu", n);
+}
+
+size_t SerialUSB::println(void) {
+    return (size_t)printf("\r\n");
+}
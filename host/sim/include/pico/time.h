@@ -0,0 +1,6 @@
+/**
+ * @file time.h
+ * @brief Pico SDK header on the simulator (see pico_sim_sdk.h).
+ */
+
+#include "pico_sim_sdk.h"
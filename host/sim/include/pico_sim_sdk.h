@@ -0,0 +1,151 @@
+/**
+ * @file pico_sim_sdk.h
+ * @brief The part of the Pico SDK used by c_irq and c_pol, on the simulator.
+ *
+ * The SDK headers under host/sim/include all include this one, so both
+ * firmwares build unmodified against host/sim/pico_sim.c. Only the calls
+ * the firmwares and the RP2040 backends make are provided; each one charges
+ * its modelled cost to the virtual clock and gives the simulator a chance
+ * to fire the interrupts that are due.
+ */
+
+// Avoid duplication in code
+#ifndef _PICO_SIM_SDK_H_
+#define _PICO_SIM_SDK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef volatile uint32_t io_rw_32;
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT (-1)
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+
+// GPIO
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_IRQ_LEVEL_LOW 0x1u
+#define GPIO_IRQ_LEVEL_HIGH 0x2u
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+#define NUM_BANK0_GPIOS 30
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_init_mask(uint32_t mask);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_set_dir_out_masked(uint32_t mask);
+void gpio_set_dir_in_masked(uint32_t mask);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+void gpio_put(uint gpio, bool value);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+void gpio_put_all(uint32_t value);
+bool gpio_get(uint gpio);
+uint32_t gpio_get_all(void);
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+void gpio_acknowledge_irq(uint gpio, uint32_t events);
+
+// Timer
+typedef struct {
+    io_rw_32 timehw;
+    io_rw_32 timelw;
+    io_rw_32 timehr;
+    io_rw_32 timelr;
+    io_rw_32 alarm[4];
+    io_rw_32 armed;
+    io_rw_32 timerawh;
+    io_rw_32 timerawl;
+    io_rw_32 dbgpause;
+    io_rw_32 pause;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_rw_32 ints;
+} timer_hw_t;
+
+extern timer_hw_t sim_timer_hw;
+#define timer_hw (&sim_timer_hw)
+
+void hardware_alarm_claim(uint alarm_num);
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_unclaim(uint alarm_num);
+bool hardware_alarm_is_claimed(uint alarm_num);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+
+static inline void hw_set_bits(io_rw_32 *addr, uint32_t mask) {
+    *addr |= mask;
+}
+
+static inline void hw_clear_bits(io_rw_32 *addr, uint32_t mask) {
+    *addr &= ~mask;
+}
+
+// Interrupts
+enum {
+    TIMER_IRQ_0 = 0,
+    TIMER_IRQ_1 = 1,
+    TIMER_IRQ_2 = 2,
+    TIMER_IRQ_3 = 3,
+    DMA_IRQ_0 = 11,
+    DMA_IRQ_1 = 12,
+    IO_IRQ_BANK0 = 13,
+    NUM_IRQS = 32
+};
+
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+#define PICO_LOWEST_IRQ_PRIORITY 0xc0
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_priority(uint num, uint8_t priority);
+
+void __wfi(void);
+void __wfe(void);
+void __sev(void);
+void __dmb(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+// Flash (a 2 MB chip mapped at XIP_BASE; see sim_flash())
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+#define FLASH_PAGE_SIZE 256u
+#define FLASH_SECTOR_SIZE 4096u
+
+extern uint8_t sim_flash_chip[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_chip)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+
+// Stdio (the firmware output goes to the simulator console)
+bool stdio_init_all(void);
+bool stdio_usb_connected(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+int sim_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+int sim_fputs(const char *s, FILE *stream);
+
+#define printf(...) sim_printf(__VA_ARGS__)
+#define fputs(s, stream) sim_fputs((s), (stream))
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file ino_fast.cpp
+ * @brief ino_fast/ino_fast.ino on the simulator.
+ */
+
+#include <stdint.h>
+#include <type_traits>
+
+#include "Arduino.h"
+#include "sim_ino.h"
+
+namespace ino_fast {
+#include "../../ino_fast/ino_fast.ino"
+}
+
+static_assert(std::is_const<std::remove_extent<decltype(ino_fast::seno)>::type>::value
+                  && std::is_const<std::remove_extent<decltype(ino_fast::triangular)>::type>::value
+                  && std::is_const<std::remove_extent<decltype(ino_fast::sierra)>::type>::value
+                  && std::is_const<std::remove_extent<decltype(ino_fast::cuadrada)>::type>::value,
+              "the tables stay in flash");
+
+static void fast_setup(void) {
+    ino_fast::setup();
+}
+
+static void fast_loop(void) {
+    ino_fast::loop();
+}
+
+extern "C" const sim_ino_sketch_t sim_ino_fast = {
+    "ino_fast",
+    fast_setup,
+    fast_loop,
+    sizeof(ino_fast::period_words) + sizeof(ino_fast::timing),
+    sizeof(ino_fast::seno) + sizeof(ino_fast::triangular) + sizeof(ino_fast::sierra) + sizeof(ino_fast::cuadrada)
+        + sizeof(ino_fast::WAVES),
+    &ino_fast::missed,
+};
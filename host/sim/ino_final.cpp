@@ -0,0 +1,48 @@
+/**
+ * @file ino_final.cpp
+ * @brief Polling_Ino_final.ino, unmodified, on the simulator.
+ */
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "sim_ino.h"
+
+namespace ino_final {
+#include "../../Polling_Ino_final.ino"
+}
+
+/**
+ * @brief The codes generator() of the sketch gives for each index of the period.
+ *
+ * The sketch itself never leaves index 0 (its index is a local variable),
+ * so this is the output it is meant to give, as the reference for the fast
+ * build.
+ */
+void sim_ino_final_codes(int cont, int amp, int dc, uint8_t codes[SIM_INO_POINTS]) {
+    const int *tables[3] = { ino_final::seno, ino_final::triangular, ino_final::sierra };
+    amp /= 2;
+    int norm_dc = 255 - ((dc * 255) / 1250);
+    int norm_amp = 2500 / amp;
+    for (int i = 0; i < SIM_INO_POINTS; i++) {
+        codes[i] = (uint8_t)(tables[cont][i] / norm_amp - norm_dc);
+    }
+}
+
+static void final_setup(void) {
+    ino_final::setup();
+}
+
+static void final_loop(void) {
+    ino_final::loop();
+}
+
+extern "C" const sim_ino_sketch_t sim_ino_final = {
+    "Polling_Ino_final",
+    final_setup,
+    final_loop,
+    sizeof(ino_final::seno) + sizeof(ino_final::triangular) + sizeof(ino_final::sierra)
+        + sizeof(ino_final::cuadrada),
+    0,
+    NULL,
+};
@@ -0,0 +1,1027 @@
+/**
+ * @file pico_sim.c
+ * @brief Discrete-event core of the RP2040 simulator and its SDK calls.
+ *
+ * The clock counts picoseconds. Every SDK call enters the simulator
+ * (sim_enter), makes its effect visible, charges its cost and then
+ * synchronizes: due script events are applied, due alarms latch their
+ * interrupt, and pending interrupts of a higher priority than the code
+ * running now are dispatched, each one nested on the host stack exactly
+ * like an exception on the chip. The run ends with a longjmp back to
+ * sim_run() once the virtual duration has elapsed.
+ */
+
+#include "pico_sim.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#undef printf
+#undef fputs
+
+#define SIM_PS_PER_US 1000000ull
+#define SIM_THREAD_LEVEL 0x100 ///< Prioridad del codigo fuera de interrupciones
+#define SIM_KEY_HOLD_MS 60.0   ///< Pulsacion de cada tecla de "type" y de "press"
+#define SIM_KEY_GAP_MS 60.0    ///< Pausa entre teclas de "type"
+#define SIM_MAX_NESTING 16     ///< Interrupciones anidadas
+#define SIM_SERIAL_LEN 256     ///< Entrada serial pendiente
+
+enum { EV_KEY, EV_BUTTON, EV_SERIAL };
+
+/**
+ * @brief Scripted input event.
+ */
+typedef struct {
+    uint64_t t;       ///< Instante (ps)
+    uint32_t seq;     ///< Orden en el guion, para eventos simultaneos
+    uint8_t kind;     ///< EV_*
+    uint8_t arg;      ///< Tecla (0-15), nivel o caracter
+    uint8_t down;     ///< Tecla pulsada o soltada
+    char label[32];   ///< Marca para el gancho de eventos ("" = ninguna)
+} sim_event_t;
+
+timer_hw_t sim_timer_hw;
+uint8_t sim_flash_chip[PICO_FLASH_SIZE_BYTES];
+
+static struct {
+    sim_board_t board;
+    uint64_t now;                    ///< Reloj virtual (ps)
+    uint64_t end;                    ///< Fin de la simulacion (ps)
+    uint64_t idle;                   ///< Tiempo dormido en __wfi/sleep (ps)
+    jmp_buf exit;                    ///< Salida al acabar el tiempo
+    bool running;
+
+    // GPIO
+    uint32_t out;                    ///< Nivel escrito en cada salida
+    uint32_t oe;                     ///< Pines configurados como salida
+    uint32_t pull_up;                ///< Pines con pull-up
+    uint32_t button;                 ///< Nivel del pulsador
+    bool keys[16];                   ///< Teclas pulsadas
+    uint32_t dac_mask;               ///< Pines del bus del DAC
+    uint8_t dac;                     ///< Ultimo codigo del bus
+    uint64_t dac_transitions;        ///< Cambios del bus
+    uint64_t dac_writes;             ///< Escrituras que tocan el bus
+    uint64_t writes[32];             ///< Escrituras que tocan cada pin
+    uint32_t edge_rise;              ///< Pines con interrupcion en flanco de subida
+    uint32_t edge_fall;              ///< Pines con interrupcion en flanco de bajada
+    uint32_t edge_level;             ///< Ultimo nivel de esos pines
+    uint8_t gpio_events[NUM_BANK0_GPIOS]; ///< Eventos sin reconocer de cada pin
+    gpio_irq_callback_t gpio_callback;
+
+    // NVIC
+    irq_handler_t handler[NUM_IRQS];
+    uint32_t enabled;
+    uint32_t pending;
+    uint64_t raised[NUM_IRQS];       ///< Instante en que se activo la linea
+    uint8_t priority[NUM_IRQS];
+    uint32_t level;                  ///< Prioridad del codigo en ejecucion
+    bool masked;                     ///< PRIMASK
+    uint64_t nested[SIM_MAX_NESTING + 1]; ///< Tiempo de los anidados en cada nivel
+    uint32_t depth;
+    sim_irq_stats_t stats[NUM_IRQS];
+
+    // Alarmas del timer
+    uint32_t alarm_seen[4];          ///< Ultimo valor visto en cada ALARMn
+    uint64_t alarm_fire[4];          ///< Instante en que dispara (ps)
+    uint32_t alarm_claimed;          ///< Alarmas reservadas con hardware_alarm_claim()
+
+    // Guion
+    sim_event_t events[SIM_MAX_EVENTS];
+    uint32_t event_count;
+    uint32_t event_next;
+    uint8_t serial[SIM_SERIAL_LEN];
+    uint32_t serial_head, serial_tail;
+
+    // Ganchos
+    sim_dac_hook_t dac_hook;
+    sim_event_hook_t event_hook;
+    sim_console_t console;
+    void *hook_ctx;
+
+    // Flash
+    uint32_t flash_programs;         ///< Paginas programadas
+    uint32_t flash_erases;           ///< Sectores borrados
+
+    struct timespec host_mark;       ///< Tiempo de CPU del host al salir del simulador
+} sim;
+
+static void sim_sync(void);
+
+/**
+ * @brief Board wiring of c_irq and c_pol at 125 MHz.
+ *
+ * Costs are cycles of a Cortex-M0+ running the SDK: a SIO write or read,
+ * a 64-bit timer read, exception entry with the SDK vector and its return,
+ * and printf over USB CDC. The flash times are the typical ones of the
+ * W25Q16JV of the Pico.
+ */
+void sim_board_default(sim_board_t *b) {
+    static const uint8_t dac_pins[SIM_DAC_BITS] = { 16, 17, 18, 19, 20, 21, 22, 26 };
+    memset(b, 0, sizeof(*b));
+    b->cpu_hz = 125000000;
+    b->costs = (sim_costs_t){ .gpio = 5, .time = 20, .irq_entry = 30, .irq_exit = 20, .print = 3000, .chr = 60,
+                              .flash_program_us = 400, .flash_erase_us = 45000 };
+    memcpy(b->dac_pins, dac_pins, sizeof(dac_pins));
+    b->row_base = 2;
+    b->col_base = 6;
+    b->button_pin = 1;
+    b->keymap = "123A456B789C*0#D";
+}
+
+/**
+ * @brief Reset the simulated chip (the flash is erased).
+ */
+void sim_init(const sim_board_t *b) {
+    memset(&sim, 0, sizeof(sim));
+    memset(&sim_timer_hw, 0, sizeof(sim_timer_hw));
+    sim.board = *b;
+    for (uint32_t i = 0; i < SIM_DAC_BITS; i++) {
+        sim.dac_mask |= 1u << b->dac_pins[i];
+    }
+    for (uint32_t i = 0; i < NUM_IRQS; i++) {
+        sim.priority[i] = PICO_DEFAULT_IRQ_PRIORITY;
+    }
+    sim.level = SIM_THREAD_LEVEL;
+    memset(sim_flash_chip, 0xFF, sizeof(sim_flash_chip));
+}
+
+/**
+ * @brief Hooks called on DAC bus transitions, marked script events and console output.
+ */
+void sim_set_hooks(sim_dac_hook_t dac, sim_event_hook_t event, sim_console_t console, void *ctx) {
+    sim.dac_hook = dac;
+    sim.event_hook = event;
+    sim.console = console;
+    sim.hook_ctx = ctx;
+}
+
+// --- Script --------------------------------------------------------------
+
+static bool sim_add_event(double ms, uint8_t kind, uint8_t arg, uint8_t down, const char *label) {
+    if (sim.event_count >= SIM_MAX_EVENTS || ms < 0) {
+        return false;
+    }
+    sim_event_t *e = &sim.events[sim.event_count];
+    e->t = (uint64_t)(ms * 1000.0) * SIM_PS_PER_US;
+    e->seq = sim.event_count++;
+    e->kind = kind;
+    e->arg = arg;
+    e->down = down;
+    snprintf(e->label, sizeof(e->label), "%s", label ? label : "");
+    return true;
+}
+
+static int sim_key_index(char key) {
+    for (int i = 0; i < 16; i++) {
+        if (sim.board.keymap[i] == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Add one line of script.
+ *
+ * Each line is "<time_ms> <command> [args]"; '#' starts a comment.
+ *
+ * - @c key <k> down|up : press or release one key of the keypad
+ * - @c type <keys> : press each key for 60 ms, 60 ms apart; the press of
+ *   the last key is a marked event ("type <keys>")
+ * - @c button 0|1 : set the level of the button input
+ * - @c press : hold the button high for 60 ms; the rising edge is marked
+ * - @c serial <text> : queue characters for getchar_timeout_us()
+ *
+ * @return false (with a message on stderr) if the line is malformed.
+ */
+bool sim_script_line(const char *line, uint32_t lineno) {
+    char cmd[16], arg[64] = "", extra[16] = "";
+    double ms;
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    if (*line == '\0' || *line == '\n' || *line == '#') {
+        return true;
+    }
+    int n = sscanf(line, "%lf %15s %63s %15s", &ms, cmd, arg, extra);
+    bool ok = n >= 2;
+    if (ok && strcmp(cmd, "key") == 0) {
+        int k = sim_key_index(arg[0]);
+        bool down = strcmp(extra, "down") == 0;
+        ok = n == 4 && k >= 0 && arg[1] == '\0' && (down || strcmp(extra, "up") == 0);
+        ok = ok && sim_add_event(ms, EV_KEY, (uint8_t)k, down, NULL);
+    } else if (ok && strcmp(cmd, "type") == 0) {
+        ok = n == 3;
+        for (uint32_t i = 0; ok && arg[i]; i++) {
+            int k = sim_key_index(arg[i]);
+            char label[32] = "";
+            if (arg[i + 1] == '\0') {
+                snprintf(label, sizeof(label), "type %s", arg);
+            }
+            ok = k >= 0 && sim_add_event(ms, EV_KEY, (uint8_t)k, 1, label)
+                 && sim_add_event(ms + SIM_KEY_HOLD_MS, EV_KEY, (uint8_t)k, 0, NULL);
+            ms += SIM_KEY_HOLD_MS + SIM_KEY_GAP_MS;
+        }
+    } else if (ok && strcmp(cmd, "button") == 0) {
+        ok = n == 3 && (arg[0] == '0' || arg[0] == '1') && sim_add_event(ms, EV_BUTTON, (uint8_t)(arg[0] - '0'), 0, NULL);
+    } else if (ok && strcmp(cmd, "press") == 0) {
+        ok = sim_add_event(ms, EV_BUTTON, 1, 0, "press") && sim_add_event(ms + SIM_KEY_HOLD_MS, EV_BUTTON, 0, 0, NULL);
+    } else if (ok && strcmp(cmd, "serial") == 0) {
+        ok = n >= 3;
+        for (uint32_t i = 0; ok && arg[i]; i++) {
+            ok = sim_add_event(ms, EV_SERIAL, (uint8_t)arg[i], 0, NULL);
+        }
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "script line %u: cannot parse \"%s\"\n", lineno, line);
+    }
+    return ok;
+}
+
+/**
+ * @brief Add every line of a script file.
+ */
+bool sim_script_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char line[160];
+    uint32_t lineno = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        ok = sim_script_line(line, ++lineno);
+    }
+    fclose(f);
+    return ok;
+}
+
+static int sim_event_cmp(const void *a, const void *b) {
+    const sim_event_t *x = a, *y = b;
+    if (x->t != y->t) {
+        return x->t < y->t ? -1 : 1;
+    }
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+// --- Clock ---------------------------------------------------------------
+
+static uint64_t sim_host_ns(const struct timespec *t) {
+    return (uint64_t)t->tv_sec * 1000000000ull + (uint64_t)t->tv_nsec;
+}
+
+/**
+ * @brief Enter the simulator from firmware code.
+ *
+ * With host_scale set, the host CPU time the firmware spent since it last
+ * left the simulator is charged to the clock, scaled.
+ */
+static void sim_enter(void) {
+    if (sim.board.host_scale > 0) {
+        struct timespec t;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+        uint64_t ns = sim_host_ns(&t) - sim_host_ns(&sim.host_mark);
+        sim.now += (uint64_t)((double)ns * 1000.0 * sim.board.host_scale);
+    }
+}
+
+/**
+ * @brief Return to firmware code.
+ */
+static void sim_leave(void) {
+    if (sim.board.host_scale > 0) {
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &sim.host_mark);
+    }
+}
+
+static uint64_t sim_next_event(void);
+
+/**
+ * @brief Charge a cost and run whatever became due.
+ *
+ * A long cost (a printf) is not atomic: the clock stops at every event on
+ * the way, so a higher-priority interrupt preempts it on time and the rest
+ * of the cost is paid after the handler.
+ */
+static void sim_charge(uint32_t cycles) {
+    uint64_t left = (uint64_t)cycles * 1000000000000ull / sim.board.cpu_hz;
+    for (;;) {
+        uint64_t next = sim_next_event();
+        uint64_t step = next <= sim.now ? 0 : next - sim.now < left ? next - sim.now : left;
+        sim.now += step;
+        left -= step;
+        sim_sync();
+        if (left == 0) {
+            return;
+        }
+    }
+}
+
+static uint64_t sim_now_us(void) {
+    return sim.now / SIM_PS_PER_US;
+}
+
+// --- GPIO ----------------------------------------------------------------
+
+/**
+ * @brief Level seen on a pin: driven outputs, the button, the keypad matrix or the pull.
+ */
+static bool sim_pin_level(uint32_t pin) {
+    if (sim.oe & (1u << pin)) {
+        return (sim.out >> pin) & 1u;
+    }
+    if (pin == sim.board.button_pin) {
+        return sim.button;
+    }
+    if (pin >= sim.board.col_base && pin < sim.board.col_base + 4) {
+        uint32_t c = pin - sim.board.col_base;
+        for (uint32_t r = 0; r < 4; r++) {
+            uint32_t row = sim.board.row_base + r;
+            if ((sim.oe & sim.out & (1u << row)) && sim.keys[r * 4 + c]) {
+                return true;
+            }
+        }
+    }
+    return (sim.pull_up >> pin) & 1u;
+}
+
+static uint32_t sim_all_levels(void) {
+    uint32_t v = 0;
+    for (uint32_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        v |= (uint32_t)sim_pin_level(pin) << pin;
+    }
+    return v;
+}
+
+/**
+ * @brief Latch the edges of the pins with an edge interrupt enabled.
+ */
+static void sim_gpio_edges(void) {
+    uint32_t watched = sim.edge_rise | sim.edge_fall;
+    if (!watched) {
+        return;
+    }
+    for (uint32_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        uint32_t bit = 1u << pin;
+        if (!(watched & bit)) {
+            continue;
+        }
+        bool level = sim_pin_level(pin);
+        if (level == ((sim.edge_level & bit) != 0)) {
+            continue;
+        }
+        sim.edge_level ^= bit;
+        uint8_t ev = level ? ((sim.edge_rise & bit) ? GPIO_IRQ_EDGE_RISE : 0) : ((sim.edge_fall & bit) ? GPIO_IRQ_EDGE_FALL : 0);
+        if (ev) {
+            if (!(sim.pending & (1u << IO_IRQ_BANK0))) {
+                sim.raised[IO_IRQ_BANK0] = sim.now;
+            }
+            sim.gpio_events[pin] |= ev;
+            sim.pending |= 1u << IO_IRQ_BANK0;
+        }
+    }
+}
+
+/**
+ * @brief Record a change of the DAC bus.
+ */
+static void sim_dac_update(void) {
+    uint8_t code = 0;
+    for (uint32_t i = 0; i < SIM_DAC_BITS; i++) {
+        code |= (uint8_t)(sim_pin_level(sim.board.dac_pins[i]) << i);
+    }
+    if (code != sim.dac) {
+        sim.dac = code;
+        sim.dac_transitions++;
+        if (sim.dac_hook) {
+            sim.dac_hook(sim.now, code, sim.hook_ctx);
+        }
+    }
+}
+
+/**
+ * @brief Common tail of every change of the pin levels.
+ */
+static void sim_outputs_changed(uint32_t mask) {
+    if (mask & sim.dac_mask) {
+        sim_dac_update();
+    }
+    sim_gpio_edges();
+}
+
+void gpio_init(uint gpio) {
+    gpio_init_mask(1u << gpio);
+}
+
+void gpio_init_mask(uint32_t mask) {
+    sim_enter();
+    sim.oe &= ~mask;
+    sim.out &= ~mask;
+    sim.pull_up &= ~mask;
+    sim_outputs_changed(mask);
+    sim_charge(sim.board.costs.gpio);
+    sim_leave();
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (out) {
+        gpio_set_dir_out_masked(1u << gpio);
+    } else {
+        gpio_set_dir_in_masked(1u << gpio);
+    }
+}
+
+void gpio_set_dir_out_masked(uint32_t mask) {
+    sim_enter();
+    sim.oe |= mask;
+    sim_outputs_changed(mask);
+    sim_charge(sim.board.costs.gpio);
+    sim_leave();
+}
+
+void gpio_set_dir_in_masked(uint32_t mask) {
+    sim_enter();
+    sim.oe &= ~mask;
+    sim_outputs_changed(mask);
+    sim_charge(sim.board.costs.gpio);
+    sim_leave();
+}
+
+void gpio_pull_up(uint gpio) {
+    sim.pull_up |= 1u << gpio;
+}
+
+void gpio_pull_down(uint gpio) {
+    sim.pull_up &= ~(1u << gpio);
+}
+
+void gpio_disable_pulls(uint gpio) {
+    gpio_pull_down(gpio);
+}
+
+void gpio_put(uint gpio, bool value) {
+    gpio_put_masked(1u << gpio, value ? 1u << gpio : 0);
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+    sim_enter();
+    sim.out = (sim.out & ~mask) | (value & mask);
+    for (uint32_t m = mask; m; m &= m - 1) {
+        sim.writes[__builtin_ctz(m)]++;
+    }
+    sim.dac_writes += (mask & sim.dac_mask) != 0;
+    sim_outputs_changed(mask);
+    sim_charge(sim.board.costs.gpio);
+    sim_leave();
+}
+
+void gpio_put_all(uint32_t value) {
+    gpio_put_masked(~0u, value);
+}
+
+bool gpio_get(uint gpio) {
+    sim_enter();
+    sim_charge(sim.board.costs.gpio);
+    bool level = sim_pin_level(gpio);
+    sim_leave();
+    return level;
+}
+
+uint32_t gpio_get_all(void) {
+    sim_enter();
+    sim_charge(sim.board.costs.gpio);
+    uint32_t levels = sim_all_levels();
+    sim_leave();
+    return levels;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    uint32_t bit = 1u << gpio;
+    if (events & GPIO_IRQ_EDGE_RISE) {
+        sim.edge_rise = enabled ? sim.edge_rise | bit : sim.edge_rise & ~bit;
+    }
+    if (events & GPIO_IRQ_EDGE_FALL) {
+        sim.edge_fall = enabled ? sim.edge_fall | bit : sim.edge_fall & ~bit;
+    }
+    sim.edge_level = (sim.edge_level & ~bit) | ((uint32_t)sim_pin_level(gpio) << gpio);
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, events, enabled);
+    sim.gpio_callback = callback;
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t events) {
+    sim.gpio_events[gpio] &= (uint8_t)~events;
+}
+
+/**
+ * @brief SDK handler of IO_IRQ_BANK0: acknowledge and call back for each pin.
+ */
+static void sim_gpio_irq(void) {
+    for (uint32_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        uint32_t events = sim.gpio_events[pin];
+        if (events) {
+            gpio_acknowledge_irq(pin, events);
+            if (sim.gpio_callback) {
+                sim_leave();
+                sim.gpio_callback(pin, events);
+                sim_enter();
+            }
+        }
+    }
+}
+
+// --- Timer ---------------------------------------------------------------
+
+/**
+ * @brief Arm the alarms whose ALARMn register was written.
+ *
+ * The alarm compares the low 32 bits of the microsecond counter, so a
+ * deadline already in the past fires only after the counter wraps. After
+ * firing, the register is moved away from the fired value so that
+ * writing the same value again is seen as a new arm.
+ */
+static void sim_alarm_scan(void) {
+    for (uint32_t n = 0; n < 4; n++) {
+        uint32_t target = sim_timer_hw.alarm[n];
+        if (target == sim.alarm_seen[n]) {
+            continue;
+        }
+        uint64_t now_us = sim_now_us();
+        sim.alarm_seen[n] = target;
+        sim.alarm_fire[n] = (now_us + (uint32_t)(target - (uint32_t)now_us)) * SIM_PS_PER_US;
+        sim_timer_hw.armed |= 1u << n;
+    }
+}
+
+static void sim_alarm_fire(void) {
+    for (uint32_t n = 0; n < 4; n++) {
+        uint32_t bit = 1u << n;
+        if (!(sim_timer_hw.armed & bit) || sim.alarm_fire[n] > sim.now) {
+            continue;
+        }
+        sim_timer_hw.armed &= ~bit;
+        sim_timer_hw.intr |= bit;
+        sim_timer_hw.alarm[n] ^= 0x80000000u;
+        sim.alarm_seen[n] = sim_timer_hw.alarm[n];
+        if ((sim_timer_hw.inte & bit) && !(sim.pending & bit)) {
+            sim.pending |= bit;
+            sim.raised[n] = sim.alarm_fire[n];
+        }
+    }
+}
+
+/**
+ * @brief Reserve a hardware alarm; claiming one twice stops the run, as the SDK panics.
+ */
+void hardware_alarm_claim(uint alarm_num) {
+    if (alarm_num >= 4 || (sim.alarm_claimed & (1u << alarm_num))) {
+        fprintf(stderr, "sim: hardware alarm %u already claimed\n", alarm_num);
+        exit(1);
+    }
+    sim.alarm_claimed |= 1u << alarm_num;
+}
+
+int hardware_alarm_claim_unused(bool required) {
+    for (uint n = 0; n < 4; n++) {
+        if (!(sim.alarm_claimed & (1u << n))) {
+            sim.alarm_claimed |= 1u << n;
+            return (int)n;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "sim: no hardware alarm left\n");
+        exit(1);
+    }
+    return -1;
+}
+
+void hardware_alarm_unclaim(uint alarm_num) {
+    sim.alarm_claimed &= ~(1u << alarm_num);
+}
+
+bool hardware_alarm_is_claimed(uint alarm_num) {
+    return (sim.alarm_claimed & (1u << alarm_num)) != 0;
+}
+
+uint64_t time_us_64(void) {
+    sim_enter();
+    sim_charge(sim.board.costs.time);
+    uint64_t us = sim_now_us();
+    sim_leave();
+    return us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+// --- NVIC ----------------------------------------------------------------
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    sim.handler[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (num == IO_IRQ_BANK0 && enabled) {
+        sim.handler[num] = sim_gpio_irq;
+    }
+    sim.enabled = enabled ? sim.enabled | (1u << num) : sim.enabled & ~(1u << num);
+}
+
+void irq_set_priority(uint num, uint8_t priority) {
+    sim.priority[num] = priority;
+}
+
+/**
+ * @brief Highest-priority pending interrupt that may preempt the running code.
+ *
+ * @return IRQ number, or -1.
+ */
+static int sim_next_irq(void) {
+    if (sim.masked) {
+        return -1;
+    }
+    uint32_t ready = sim.pending & sim.enabled;
+    int best = -1;
+    for (uint32_t i = 0; ready; i++, ready >>= 1) {
+        if ((ready & 1u) && sim.priority[i] < sim.level && (best < 0 || sim.priority[i] < sim.priority[best])) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Whether an interrupt line is still active after its handler.
+ */
+static bool sim_line_active(uint32_t irq) {
+    if (irq < 4) {
+        return (sim_timer_hw.intr & sim_timer_hw.inte) & (1u << irq);
+    }
+    if (irq == IO_IRQ_BANK0) {
+        for (uint32_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+            if (sim.gpio_events[pin]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Take one interrupt, nested on the running code.
+ */
+static void sim_exception(uint32_t irq) {
+    sim_irq_stats_t *st = &sim.stats[irq];
+    uint64_t late = sim.now - sim.raised[irq];
+    uint64_t start = sim.now;
+    uint32_t saved = sim.level;
+
+    sim.pending &= ~(1u << irq);
+    sim.level = sim.priority[irq];
+    sim.nested[++sim.depth] = 0;
+    st->count++;
+    st->total_late += late;
+    if (late > st->worst_late) {
+        st->worst_late = late;
+    }
+
+    sim_charge(sim.board.costs.irq_entry);
+    if (sim.handler[irq]) {
+        sim_leave();
+        sim.handler[irq]();
+        sim_enter();
+    }
+    sim.now += (uint64_t)sim.board.costs.irq_exit * 1000000000000ull / sim.board.cpu_hz;
+
+    uint64_t total = sim.now - start;
+    st->busy += total - sim.nested[sim.depth];
+    sim.depth--;
+    sim.nested[sim.depth] += total;
+    sim.level = saved;
+    if (sim_line_active(irq) && !(sim.pending & (1u << irq))) {
+        sim.pending |= 1u << irq;
+        sim.raised[irq] = sim.now;
+    }
+}
+
+/**
+ * @brief Apply one script event.
+ */
+static void sim_apply(const sim_event_t *e) {
+    switch (e->kind) {
+    case EV_KEY:
+        sim.keys[e->arg] = e->down;
+        break;
+    case EV_BUTTON:
+        sim.button = e->arg;
+        break;
+    case EV_SERIAL:
+        if (sim.serial_head - sim.serial_tail < SIM_SERIAL_LEN) {
+            sim.serial[sim.serial_head++ % SIM_SERIAL_LEN] = e->arg;
+        }
+        break;
+    }
+    if (e->label[0] && sim.event_hook) {
+        sim.event_hook(e->t, e->label, sim.hook_ctx);
+    }
+    sim_gpio_edges();
+}
+
+/**
+ * @brief Fire what is due and dispatch the interrupts that may preempt.
+ */
+static void sim_sync(void) {
+    for (;;) {
+        sim_alarm_scan();
+        while (sim.event_next < sim.event_count && sim.events[sim.event_next].t <= sim.now) {
+            sim_apply(&sim.events[sim.event_next++]);
+        }
+        sim_alarm_fire();
+        if (sim.now >= sim.end) {
+            longjmp(sim.exit, 1);
+        }
+        int irq = sim_next_irq();
+        if (irq < 0) {
+            return;
+        }
+        sim_exception((uint32_t)irq);
+    }
+}
+
+/**
+ * @brief Time of the next thing that can wake the CPU.
+ */
+static uint64_t sim_next_event(void) {
+    uint64_t t = sim.end;
+    if (sim.event_next < sim.event_count && sim.events[sim.event_next].t < t) {
+        t = sim.events[sim.event_next].t;
+    }
+    for (uint32_t n = 0; n < 4; n++) {
+        if ((sim_timer_hw.armed & (1u << n)) && sim.alarm_fire[n] < t) {
+            t = sim.alarm_fire[n];
+        }
+    }
+    return t;
+}
+
+/**
+ * @brief Sleep until @p until or until something is due, whichever comes first.
+ */
+static void sim_idle(uint64_t until) {
+    sim_alarm_scan();
+    uint64_t t = sim_next_event();
+    if (until < t) {
+        t = until;
+    }
+    if (t > sim.now && sim_next_irq() < 0) {
+        sim.idle += t - sim.now;
+        sim.now = t;
+    }
+    sim_sync();
+}
+
+void __wfi(void) {
+    sim_enter();
+    sim_idle(sim.end);
+    sim_leave();
+}
+
+void __wfe(void) {
+    __wfi();
+}
+
+void __sev(void) {
+}
+
+void __dmb(void) {
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = sim.masked;
+    sim.masked = true;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    sim_enter();
+    sim.masked = status != 0;
+    sim_sync();
+    sim_leave();
+}
+
+void sleep_us(uint64_t us) {
+    sim_enter();
+    uint64_t until = sim.now + us * SIM_PS_PER_US;
+    while (sim.now < until) {
+        sim_idle(until);
+    }
+    sim_leave();
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+void busy_wait_us(uint64_t us) {
+    sim_enter();
+    uint64_t until = sim.now + us * SIM_PS_PER_US;
+    while (sim.now < until) {
+        uint64_t t = sim_next_event();
+        sim.now = t < until ? t : until;
+        sim_sync();
+    }
+    sim_leave();
+}
+
+// --- Flash ---------------------------------------------------------------
+
+/**
+ * @brief Stall for a flash operation.
+ *
+ * The CPU executes nothing meanwhile (XIP is stopped); interrupts that
+ * become due only latch, and are taken once the caller unmasks them.
+ */
+static void sim_flash_busy(uint64_t us) {
+    uint64_t until = sim.now + us * SIM_PS_PER_US;
+    while (sim.now < until) {
+        uint64_t t = sim_next_event();
+        sim.now = t < until ? t : until;
+        sim_sync();
+    }
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    sim_enter();
+    for (size_t done = 0; done < count && flash_offs + done < PICO_FLASH_SIZE_BYTES; done += FLASH_SECTOR_SIZE) {
+        memset(&sim_flash_chip[flash_offs + done], 0xFF, FLASH_SECTOR_SIZE);
+        sim.flash_erases++;
+        sim_flash_busy(sim.board.costs.flash_erase_us);
+    }
+    sim_leave();
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    sim_enter();
+    for (size_t i = 0; i < count && flash_offs + i < PICO_FLASH_SIZE_BYTES; i++) {
+        sim_flash_chip[flash_offs + i] &= data[i];
+        if (i % FLASH_PAGE_SIZE == FLASH_PAGE_SIZE - 1 || i == count - 1) {
+            sim.flash_programs++;
+            sim_flash_busy(sim.board.costs.flash_program_us);
+        }
+    }
+    sim_leave();
+}
+
+/**
+ * @brief Run a flash operation with the interrupts masked (there is no core 1 to park).
+ */
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    uint32_t status = save_and_disable_interrupts();
+    func(param);
+    restore_interrupts(status);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+// --- Stdio ---------------------------------------------------------------
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+/**
+ * @brief A terminal is always open on the simulated USB port.
+ */
+bool stdio_usb_connected(void) {
+    return true;
+}
+
+static void sim_console_out(const char *text, uint32_t len) {
+    if (sim.console) {
+        sim.console(sim.now, text, len, sim.hook_ctx);
+    }
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    if (sim.serial_head == sim.serial_tail && timeout_us) {
+        sleep_us(timeout_us);
+    }
+    sim_enter();
+    sim_charge(sim.board.costs.time);
+    int c = sim.serial_head != sim.serial_tail ? sim.serial[sim.serial_tail++ % SIM_SERIAL_LEN] : PICO_ERROR_TIMEOUT;
+    sim_leave();
+    return c;
+}
+
+int putchar_raw(int c) {
+    sim_enter();
+    char ch = (char)c;
+    sim_console_out(&ch, 1);
+    sim_charge(sim.board.costs.chr);
+    sim_leave();
+    return c;
+}
+
+int sim_printf(const char *fmt, ...) {
+    char text[512];
+    va_list args;
+    sim_enter();
+    va_start(args, fmt);
+    int n = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    uint32_t len = n < 0 ? 0 : (uint32_t)n >= sizeof(text) ? sizeof(text) - 1 : (uint32_t)n;
+    sim_console_out(text, len);
+    sim_charge(sim.board.costs.print + len * sim.board.costs.chr);
+    sim_leave();
+    return n;
+}
+
+int sim_fputs(const char *s, FILE *stream) {
+    if (stream != stdout && stream != stderr) {
+        return fputs(s, stream);
+    }
+    return sim_printf("%s", s);
+}
+
+// --- Run -----------------------------------------------------------------
+
+/**
+ * @brief Run the firmware for a virtual duration.
+ *
+ * @param duration_us Virtual time to run.
+ * @param entry Firmware main().
+ * @return true if the time ran out, false if the firmware returned first.
+ */
+bool sim_run(uint64_t duration_us, void (*entry)(void)) {
+    qsort(sim.events, sim.event_count, sizeof(sim.events[0]), sim_event_cmp);
+    sim.end = duration_us * SIM_PS_PER_US;
+    sim.running = true;
+    if (setjmp(sim.exit)) {
+        sim.running = false;
+        return true;
+    }
+    sim_leave();
+    entry();
+    sim.running = false;
+    return false;
+}
+
+uint64_t sim_now_ps(void) {
+    return sim.now;
+}
+
+uint64_t sim_idle_ps(void) {
+    return sim.idle;
+}
+
+const sim_irq_stats_t *sim_irq_stats(uint32_t irq) {
+    return irq < NUM_IRQS ? &sim.stats[irq] : NULL;
+}
+
+uint64_t sim_dac_transitions(void) {
+    return sim.dac_transitions;
+}
+
+/**
+ * @brief GPIO writes (one per call, whatever the API) that touched the DAC bus.
+ */
+uint64_t sim_dac_writes(void) {
+    return sim.dac_writes;
+}
+
+/**
+ * @brief GPIO writes that touched one pin.
+ */
+uint64_t sim_gpio_writes(uint32_t pin) {
+    return pin < 32 ? sim.writes[pin] : 0;
+}
+
+/**
+ * @brief Image of the flash, to load before sim_run() or keep after it.
+ */
+uint8_t *sim_flash(void) {
+    return sim_flash_chip;
+}
+
+/**
+ * @brief Pages programmed and (in @p erases) sectors erased so far.
+ */
+uint32_t sim_flash_ops(uint32_t *erases) {
+    *erases = sim.flash_erases;
+    return sim.flash_programs;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file pico_sim.h
+ * @brief Virtual-time simulator of the RP2040 as seen by c_irq and c_pol.
+ *
+ * The firmware runs unmodified on the host, against the SDK headers in
+ * host/sim/include. Time only moves when the firmware makes an SDK call:
+ * each call charges its cost (in CPU cycles) to a virtual clock, and
+ * __wfi()/sleep jump straight to the next event. Between two calls the
+ * simulator fires whatever is due, as a discrete-event scheduler:
+ *
+ * - the four timer alarms (32-bit compare, as on the chip, so an alarm
+ *   armed in the past waits for the counter to wrap);
+ * - GPIO edge interrupts on the inputs driven by the script;
+ * - scripted keypad, button and serial input.
+ *
+ * The program flash is a 2 MB array behaving as NOR flash (erase to 0xFF,
+ * programming only clears bits); an erase or a program stalls the CPU for
+ * the typical time of the W25Q16JV with the interrupts masked, as
+ * flash_safe_execute() does on the chip. sim_flash() gives the image, to
+ * keep it from one run to the next like a board that is switched off.
+ *
+ * Interrupts preempt by priority (lower value wins, equal priorities do
+ * not nest) and pay an entry and exit cost. Every transition of the DAC
+ * bus (D0-D7) is timestamped, so the intermediate codes written bit by bit
+ * are visible too, and the GPIO writes are counted per pin.
+ *
+ * The code between two SDK calls is free unless host_scale is set, in
+ * which case the host CPU time it takes is charged, scaled. With the
+ * default costs the figures are therefore upper bounds for the board.
+ * PIO, DMA and core 1 are not simulated.
+ */
+
+// Avoid duplication in code
+#ifndef _PICO_SIM_H_
+#define _PICO_SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico_sim_sdk.h"
+
+#define SIM_MAX_EVENTS 4096 ///< Eventos de guion
+#define SIM_DAC_BITS 8      ///< Lineas del bus del DAC0808
+
+/**
+ * @brief Cost of the modelled operations, in CPU cycles.
+ */
+typedef struct {
+    uint32_t gpio;      ///< gpio_put/gpio_get y variantes enmascaradas
+    uint32_t time;      ///< Lectura del timer
+    uint32_t irq_entry; ///< Apilado y salto al manejador
+    uint32_t irq_exit;  ///< Retorno del manejador
+    uint32_t print;     ///< Llamada a printf (formato y driver)
+    uint32_t chr;       ///< Cada caracter enviado por el stdio
+    uint32_t flash_program_us; ///< Programar una pagina de la flash (us, no escala con el reloj)
+    uint32_t flash_erase_us;   ///< Borrar un sector de la flash (us)
+} sim_costs_t;
+
+/**
+ * @brief Simulated board.
+ */
+typedef struct {
+    uint32_t cpu_hz;              ///< Reloj del sistema
+    sim_costs_t costs;            ///< Coste de cada operacion
+    double host_scale;            ///< Escala del tiempo de CPU del host entre llamadas (0 = gratis)
+    uint8_t dac_pins[SIM_DAC_BITS]; ///< GPIO de D0..D7
+    uint32_t row_base;            ///< GPIO de la fila 0 del teclado
+    uint32_t col_base;            ///< GPIO de la columna 0 del teclado
+    uint32_t button_pin;          ///< GPIO del pulsador
+    const char *keymap;           ///< 16 teclas, fila por fila
+} sim_board_t;
+
+/**
+ * @brief Measurements of one interrupt line.
+ */
+typedef struct {
+    uint32_t count;       ///< Entradas al manejador
+    uint64_t worst_late;  ///< Peor retraso desde que se activa la linea (ps)
+    uint64_t total_late;  ///< Suma de retrasos (ps)
+    uint64_t busy;        ///< Tiempo en el manejador, sin anidados (ps)
+} sim_irq_stats_t;
+
+typedef void (*sim_dac_hook_t)(uint64_t t_ps, uint8_t code, void *ctx);
+typedef void (*sim_event_hook_t)(uint64_t t_ps, const char *what, void *ctx);
+typedef void (*sim_console_t)(uint64_t t_ps, const char *text, uint32_t len, void *ctx);
+
+void sim_board_default(sim_board_t *b);
+void sim_init(const sim_board_t *b);
+bool sim_script_line(const char *line, uint32_t lineno);
+bool sim_script_file(const char *path);
+void sim_set_hooks(sim_dac_hook_t dac, sim_event_hook_t event, sim_console_t console, void *ctx);
+bool sim_run(uint64_t duration_us, void (*entry)(void));
+
+uint64_t sim_now_ps(void);
+uint64_t sim_idle_ps(void);
+const sim_irq_stats_t *sim_irq_stats(uint32_t irq);
+uint64_t sim_dac_transitions(void);
+uint64_t sim_dac_writes(void);
+uint64_t sim_gpio_writes(uint32_t pin);
+uint8_t *sim_flash(void);
+uint32_t sim_flash_ops(uint32_t *erases);
+
+#endif
@@ -0,0 +1,385 @@
+/**
+ * @file sim_firmware.c
+ * @brief Runs c_irq or c_pol on the RP2040 simulator and reports its timing.
+ *
+ * Built once per firmware (sim_c_irq, sim_c_pol) with the firmware's
+ * main() renamed to firmware_main(). The report is CSV-like "key,value"
+ * lines:
+ *
+ * - the virtual and wall-clock time of the run;
+ * - the sample task: rate, samples, missed periods and worst lateness;
+ * - each interrupt line that fired: count, mean and worst entry latency
+ *   and the share of CPU time spent in it;
+ * - the time from reset to the first transition of the DAC bus, and the
+ *   flash pages programmed and sectors erased;
+ * - for every marked script event (the last key of a "type", a button
+ *   "press"), the time until the DAC bus first shows the new parameters:
+ *   a new wave cache active or a new tuning word, seen on the next bus
+ *   transition.
+ *
+ * Usage: sim_c_irq|sim_c_pol [--duration s] [--script file] [--trace file.csv]
+ *        [--console] [--cpu-mhz n] [--host-scale f] [--flash image] [--sweep]
+ *
+ * With --flash the program flash is loaded from the image (if it exists)
+ * and written back after the run, so a second run boots from what the
+ * first one saved, like a board switched off and on again.
+ *
+ * Without --script a built-in script types an amplitude, an offset and
+ * two frequencies, presses the button and types an amplitude and an
+ * offset as one entry. --sweep reruns the firmware at
+ * lower and lower CPU clocks (one forked process each) and reports the
+ * lowest clock without missed samples; scaling the sample rate by the
+ * clock ratio estimates the maximum sustainable rate at 125 MHz under the
+ * cost model (the UI load is scaled too, so the estimate errs low).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pico_sim.h"
+#include "gen_block.h"
+
+#undef printf ///< la salida del informe no pasa por la consola simulada
+#undef fputs
+
+#if SIM_FIRMWARE_C_POL
+#include "executive.h"
+#define SIM_FIRMWARE "c_pol"
+extern exec_task_t sample_task;
+void firmware_main();
+#else
+#include "alarm_sched.h"
+#define SIM_FIRMWARE "c_irq"
+#define SIM_SAMPLE_IRQ TIMER_IRQ_2 ///< SIGNAL_ALARM de c_irq
+extern alarm_task_t signal_task;
+int firmware_main();
+#endif
+
+extern gen_state_t gen;
+extern wave_cache_t wave_cache;
+
+#define SIM_DEFAULT_DURATION_S 14.0
+
+static const char *default_script[] = {
+    "7500 type A2000D",
+    "8500 type B600D",
+    "9500 type C250D",
+    "10500 press",
+    "11000 type C1000*5D",
+    "12000 type A1500B300D",
+};
+
+/**
+ * @brief Options of one run.
+ */
+typedef struct {
+    double duration;         ///< Tiempo virtual (s)
+    const char *script;      ///< Guion (NULL = el de serie)
+    const char *trace;       ///< CSV de las transiciones del bus
+    bool console;            ///< Copiar la salida del firmware a stderr
+    uint32_t cpu_mhz;        ///< Reloj del sistema
+    double host_scale;       ///< Escala del tiempo de CPU del host
+    const char *flash;       ///< Imagen de la flash que se conserva entre ejecuciones
+} sim_options_t;
+
+/**
+ * @brief Marked event waiting to show on the DAC bus.
+ */
+typedef struct {
+    FILE *trace;
+    bool console_bol;        ///< La consola esta a principio de linea
+    bool waiting;            ///< Hay un evento marcado pendiente
+    uint64_t mark_t;         ///< Instante del evento (ps)
+    char mark[32];           ///< Etiqueta del evento
+    uint8_t active;          ///< Buffer activo al marcar
+    uint32_t tuning;         ///< Palabra de sintonia al marcar
+    uint64_t first_t;        ///< Primera transicion del bus (ps, 0: ninguna)
+} sim_watch_t;
+
+static void report_mark(sim_watch_t *w, const char *latency) {
+    printf("command,%s,%.1f,%s\n", w->mark, w->mark_t / 1e9, latency);
+}
+
+static void on_dac(uint64_t t_ps, uint8_t code, void *ctx) {
+    sim_watch_t *w = ctx;
+    if (w->trace) {
+        fprintf(w->trace, "%llu,%u\n", (unsigned long long)(t_ps / 1000), code);
+    }
+    if (!w->first_t) {
+        w->first_t = t_ps;
+    }
+    if (w->waiting && (wave_cache.active != w->active || gen.dds.tuning != w->tuning)) {
+        char latency[32];
+        snprintf(latency, sizeof(latency), "%.3f", (t_ps - w->mark_t) / 1e9);
+        report_mark(w, latency);
+        w->waiting = false;
+    }
+}
+
+static void on_event(uint64_t t_ps, const char *what, void *ctx) {
+    sim_watch_t *w = ctx;
+    if (w->waiting) {
+        report_mark(w, "-"); ///< no llego al bus antes del siguiente
+    }
+    w->waiting = true;
+    w->mark_t = t_ps;
+    snprintf(w->mark, sizeof(w->mark), "%s", what);
+    w->active = wave_cache.active;
+    w->tuning = gen.dds.tuning;
+}
+
+static void on_console(uint64_t t_ps, const char *text, uint32_t len, void *ctx) {
+    sim_watch_t *w = ctx;
+    for (uint32_t i = 0; i < len; i++) {
+        if (w->console_bol) {
+            fprintf(stderr, "[%10.6f] ", t_ps / 1e12);
+        }
+        fputc(text[i], stderr);
+        w->console_bol = text[i] == '\n';
+    }
+}
+
+static void entry(void) {
+    firmware_main();
+}
+
+/**
+ * @brief Load (@p save false) or write back the flash image.
+ *
+ * A missing image on load is a blank chip.
+ */
+static bool flash_image(const char *path, bool save) {
+    FILE *f = fopen(path, save ? "wb" : "rb");
+    if (!f) {
+        if (!save) {
+            return true;
+        }
+        perror(path);
+        return false;
+    }
+    size_t n = save ? fwrite(sim_flash(), 1, PICO_FLASH_SIZE_BYTES, f) : fread(sim_flash(), 1, PICO_FLASH_SIZE_BYTES, f);
+    fclose(f);
+    if (n != PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "%s: short %s\n", path, save ? "write" : "read");
+        return false;
+    }
+    return true;
+}
+
+static double wall_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Sample task counters of the firmware.
+ */
+static void sample_stats(uint32_t *period_us, uint32_t *runs, uint32_t *missed, double *worst_late_us) {
+#if SIM_FIRMWARE_C_POL
+    *period_us = sample_task.period;
+    *runs = sample_task.runs;
+    *missed = sample_task.missed;
+    *worst_late_us = sample_task.worst_late;
+#else
+    *period_us = signal_task.period;
+    *runs = signal_task.runs;
+    *missed = signal_task.missed;
+    *worst_late_us = sim_irq_stats(SIM_SAMPLE_IRQ)->worst_late / 1e6;
+#endif
+}
+
+/**
+ * @brief Run the firmware once.
+ *
+ * @param quiet Print only the summary line of a sweep point.
+ * @return Missed sample periods, or -1 on a setup error.
+ */
+static int run_once(const sim_options_t *o, bool quiet) {
+    sim_board_t board;
+    static sim_watch_t w;
+    sim_board_default(&board);
+    board.cpu_hz = o->cpu_mhz * 1000000u;
+    board.host_scale = o->host_scale;
+    sim_init(&board);
+
+    memset(&w, 0, sizeof(w));
+    w.console_bol = true;
+    if (o->trace && !quiet) {
+        w.trace = fopen(o->trace, "w");
+        if (!w.trace) {
+            perror(o->trace);
+            return -1;
+        }
+        fprintf(w.trace, "t_ns,code\n");
+    }
+    bool ok = true;
+    if (o->script) {
+        ok = sim_script_file(o->script);
+    } else {
+        for (uint32_t i = 0; ok && i < sizeof(default_script) / sizeof(default_script[0]); i++) {
+            ok = sim_script_line(default_script[i], i + 1);
+        }
+    }
+    if (!ok || (o->flash && !flash_image(o->flash, false))) {
+        return -1;
+    }
+    sim_set_hooks(on_dac, quiet ? NULL : on_event, o->console && !quiet ? on_console : NULL, &w);
+
+    double start = wall_s();
+    bool timed_out = sim_run((uint64_t)(o->duration * 1e6), entry);
+    double wall = wall_s() - start;
+    if (w.trace) {
+        fclose(w.trace);
+    }
+    if (o->flash && !quiet && !flash_image(o->flash, true)) {
+        return -1;
+    }
+
+    uint32_t period, runs, missed;
+    double worst_late;
+    sample_stats(&period, &runs, &missed, &worst_late);
+    if (quiet) {
+        printf("sweep,%u,%u,%u,%.3f\n", o->cpu_mhz, runs, missed, worst_late);
+        return (int)missed;
+    }
+
+    double virt = sim_now_ps() / 1e12;
+    if (w.waiting) {
+        report_mark(&w, "-");
+    }
+    printf("firmware,%s\n", SIM_FIRMWARE);
+    printf("finished,%s\n", timed_out ? "time" : "returned");
+    printf("cpu_mhz,%u\n", o->cpu_mhz);
+    printf("virtual_s,%.6f\n", virt);
+    printf("wall_s,%.3f\n", wall);
+    printf("speedup,%.1f\n", wall > 0 ? virt / wall : 0.0);
+    printf("sample_rate_hz,%.1f\n", period ? 1e6 / period : 0.0);
+    printf("samples,%u\n", runs);
+    printf("missed,%u\n", missed);
+    printf("worst_sample_late_us,%.3f\n", worst_late);
+    printf("cpu_busy_pct,%.2f\n", 100.0 * (sim_now_ps() - sim_idle_ps()) / sim_now_ps());
+    printf("dac_transitions,%llu\n", (unsigned long long)sim_dac_transitions());
+    uint32_t erases;
+    uint32_t programs = sim_flash_ops(&erases);
+    printf("first_sample_us,%.3f\n", w.first_t / 1e6);
+    printf("flash_programs,%u\n", programs);
+    printf("flash_erases,%u\n", erases);
+    printf("irq,line,count,mean_late_us,worst_late_us,busy_pct\n");
+    for (uint32_t i = 0; i < NUM_IRQS; i++) {
+        const sim_irq_stats_t *s = sim_irq_stats(i);
+        if (s->count) {
+            printf("irq,%u,%u,%.3f,%.3f,%.3f\n", i, s->count, s->total_late / 1e6 / s->count,
+                   s->worst_late / 1e6, 100.0 * s->busy / sim_now_ps());
+        }
+    }
+    return (int)missed;
+}
+
+/**
+ * @brief Rerun at lower CPU clocks until samples are missed.
+ *
+ * Each point runs in a forked process (the firmware globals are only
+ * initialized once per process), which hands its sample period back
+ * through a pipe.
+ */
+static int sweep(sim_options_t o) {
+    static const uint32_t clocks[] = { 125, 100, 80, 64, 48, 32, 24, 16, 12, 8, 6, 4, 3, 2, 1 };
+    uint32_t lowest = 0;
+    uint32_t period = 0;
+
+    printf("sweep,cpu_mhz,samples,missed,worst_sample_late_us\n");
+    for (uint32_t i = 0; i < sizeof(clocks) / sizeof(clocks[0]); i++) {
+        int fd[2];
+        if (pipe(fd) < 0) {
+            perror("pipe");
+            return 2;
+        }
+        fflush(stdout);
+        o.cpu_mhz = clocks[i];
+        pid_t pid = fork();
+        if (pid == 0) {
+            uint32_t runs, missed;
+            double worst_late;
+            int r = run_once(&o, true);
+            sample_stats(&period, &runs, &missed, &worst_late);
+            fflush(stdout);
+            if (write(fd[1], &period, sizeof(period)) != sizeof(period)) {
+                r = -1;
+            }
+            _exit(r == 0 ? 0 : 1);
+        }
+        close(fd[1]);
+        uint32_t got = 0;
+        bool read_ok = read(fd[0], &got, sizeof(got)) == sizeof(got);
+        close(fd[0]);
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !read_ok) {
+            return 2;
+        }
+        period = got;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            break;
+        }
+        lowest = clocks[i];
+    }
+    if (lowest == 0 || period == 0) {
+        printf("max_sample_rate_hz,-\n");
+        return 1;
+    }
+    printf("lowest_cpu_mhz,%u\n", lowest);
+    printf("max_sample_rate_hz,%.0f\n", 1e6 / period * 125.0 / lowest);
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: sim_%s [--duration s] [--script file] [--trace file.csv] [--console] "
+                    "[--cpu-mhz n] [--host-scale f] [--flash image] [--sweep]\n", SIM_FIRMWARE);
+}
+
+int main(int argc, char **argv) {
+    sim_options_t o = { .duration = SIM_DEFAULT_DURATION_S, .cpu_mhz = 125 };
+    bool do_sweep = false;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--duration") == 0 && v) {
+            o.duration = atof(v);
+            i++;
+        } else if (strcmp(a, "--script") == 0 && v) {
+            o.script = v;
+            i++;
+        } else if (strcmp(a, "--trace") == 0 && v) {
+            o.trace = v;
+            i++;
+        } else if (strcmp(a, "--cpu-mhz") == 0 && v) {
+            o.cpu_mhz = (uint32_t)atoi(v);
+            i++;
+        } else if (strcmp(a, "--host-scale") == 0 && v) {
+            o.host_scale = atof(v);
+            i++;
+        } else if (strcmp(a, "--flash") == 0 && v) {
+            o.flash = v;
+            i++;
+        } else if (strcmp(a, "--console") == 0) {
+            o.console = true;
+        } else if (strcmp(a, "--sweep") == 0) {
+            do_sweep = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (o.duration <= 0 || o.cpu_mhz == 0) {
+        usage();
+        return 2;
+    }
+    if (do_sweep) {
+        return sweep(o);
+    }
+    return run_once(&o, false) < 0 ? 2 : 0;
+}
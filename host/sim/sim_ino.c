@@ -0,0 +1,227 @@
+/**
+ * @file sim_ino.c
+ * @brief Runs Polling_Ino_final.ino and ino_fast/ino_fast.ino on the RP2040 simulator and compares them.
+ *
+ * Both sketches get the same script: the frequency typed as "C5000D" (the
+ * highest one the fast build takes; the original writes a sample on every
+ * pass of its loop, whatever the frequency), a button press to the
+ * triangle, and then a measuring window. Each key is typed on its own,
+ * 600 ms apart, since the sketches ignore a key within 500 ms of the
+ * previous one. For each sketch the report gives, as "key,value" lines:
+ *
+ * - samples per second over the window (writes of the D7 line, which
+ *   every sample writes once) and GPIO calls per sample;
+ * - the CPU share and worst entry latency of the interrupts, and the
+ *   missed sample deadlines;
+ * - the RAM and flash taken by the waveform tables and sample buffers.
+ *
+ * The fast build must put on the bus, over the window, the codes that
+ * generator() of the original gives for the same parameters, in order and
+ * at 100 points per period of the typed frequency, without missing a
+ * deadline; it must also output more samples per second in less RAM.
+ *
+ * Usage: sim_ino [--console]
+ *
+ * Exits non-zero on any failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "check.h"
+#include "pico_sim.h"
+#include "sim_ino.h"
+
+#undef printf ///< el informe no pasa por la consola simulada
+
+#define INO_DURATION_US 6700000u ///< Fin de la ventana de medida
+#define INO_MARK "type *"        ///< Inicio de la ventana (la tecla solo empieza otra entrada)
+#define INO_FREQ_HZ 5000u        ///< Frecuencia tecleada
+#define INO_SHAPE 1              ///< Triangular, tras una pulsacion del boton
+#define INO_AMPLITUDE_MV 1000    ///< Valores por defecto de los sketches
+#define INO_OFFSET_MV 100
+#define INO_MAX_CODES 4096       ///< Transiciones del bus comprobadas
+
+static const char *script[] = {
+    "500 type C",
+    "1100 type 5",
+    "1700 type 0",
+    "2300 type 0",
+    "2900 type 0",
+    "3500 type D",
+    "4100 press",
+    "4700 type *",
+};
+
+/**
+ * @brief Counters at the start of the window and the bus codes after it.
+ */
+typedef struct {
+    uint8_t d7_pin;          ///< Pin de D7
+    bool marked;             ///< La ventana empezo
+    uint64_t mark_t;         ///< Inicio de la ventana (ps)
+    uint64_t mark_samples;   ///< Escrituras de D7 al empezar
+    uint64_t mark_calls;     ///< Escrituras del bus al empezar
+    uint64_t mark_busy;      ///< Tiempo en interrupciones al empezar (ps)
+    uint32_t code_count;     ///< Transiciones guardadas
+    uint8_t codes[INO_MAX_CODES];
+    bool console;            ///< Copiar la salida del sketch a stderr
+    bool console_bol;        ///< La consola esta a principio de linea
+} ino_watch_t;
+
+static uint64_t irq_busy(void) {
+    uint64_t busy = 0;
+    for (uint32_t i = 0; i < NUM_IRQS; i++) {
+        busy += sim_irq_stats(i)->busy;
+    }
+    return busy;
+}
+
+static void on_dac(uint64_t t_ps, uint8_t code, void *ctx) {
+    (void)t_ps;
+    ino_watch_t *w = ctx;
+    if (w->marked && w->code_count < INO_MAX_CODES) {
+        w->codes[w->code_count++] = code;
+    }
+}
+
+static void on_event(uint64_t t_ps, const char *what, void *ctx) {
+    ino_watch_t *w = ctx;
+    if (strcmp(what, INO_MARK) == 0) {
+        w->marked = true;
+        w->mark_t = t_ps;
+        w->mark_samples = sim_gpio_writes(w->d7_pin);
+        w->mark_calls = sim_dac_writes();
+        w->mark_busy = irq_busy();
+    }
+}
+
+static void on_console(uint64_t t_ps, const char *text, uint32_t len, void *ctx) {
+    ino_watch_t *w = ctx;
+    for (uint32_t i = 0; i < len; i++) {
+        if (w->console_bol) {
+            fprintf(stderr, "[%10.6f] ", t_ps / 1e12);
+        }
+        fputc(text[i], stderr);
+        w->console_bol = text[i] == '\n';
+    }
+}
+
+static const sim_ino_sketch_t *running; ///< Sketch de sim_run()
+
+/**
+ * @brief What the Arduino core does: setup() once, then loop() forever.
+ */
+static void sketch_main(void) {
+    running->setup();
+    for (;;) {
+        running->loop();
+    }
+}
+
+/**
+ * @brief Whether the bus codes follow the period, starting anywhere in it.
+ *
+ * Runs of equal codes show as one transition, so the period is compared
+ * with its runs merged.
+ */
+static bool codes_follow(const uint8_t *codes, uint32_t count, const uint8_t period[SIM_INO_POINTS]) {
+    uint8_t merged[SIM_INO_POINTS];
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < SIM_INO_POINTS; i++) {
+        if (period[i] != period[(i + SIM_INO_POINTS - 1) % SIM_INO_POINTS]) {
+            merged[n++] = period[i];
+        }
+    }
+    if (n == 0 || count < n) {
+        return false;
+    }
+    for (uint32_t start = 0; start < n; start++) {
+        uint32_t j = 0;
+        while (j < count && codes[j] == merged[(start + j) % n]) {
+            j++;
+        }
+        if (j == count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Run one sketch on the script and report it.
+ *
+ * @param[out] samples_per_s Samples per second over the window.
+ * @return false on a setup error.
+ */
+static bool run_sketch(const sim_ino_sketch_t *sketch, ino_watch_t *w, double *samples_per_s) {
+    sim_board_t board;
+    sim_board_default(&board);
+    sim_init(&board);
+    bool ok = true;
+    for (uint32_t i = 0; ok && i < sizeof(script) / sizeof(script[0]); i++) {
+        ok = sim_script_line(script[i], i + 1);
+    }
+    if (!ok) {
+        return false;
+    }
+    bool console = w->console;
+    memset(w, 0, sizeof(*w));
+    w->console = console;
+    w->console_bol = true;
+    w->d7_pin = board.dac_pins[SIM_DAC_BITS - 1];
+    sim_set_hooks(on_dac, on_event, console ? on_console : NULL, w);
+
+    running = sketch;
+    sim_run(INO_DURATION_US, sketch_main);
+
+    double window_s = (sim_now_ps() - w->mark_t) / 1e12;
+    uint64_t samples = sim_gpio_writes(w->d7_pin) - w->mark_samples;
+    uint64_t calls = sim_dac_writes() - w->mark_calls;
+    double worst_late = 0;
+    for (uint32_t i = 0; i < NUM_IRQS; i++) {
+        double late = sim_irq_stats(i)->worst_late / 1e6;
+        worst_late = late > worst_late ? late : worst_late;
+    }
+    *samples_per_s = w->marked && window_s > 0 ? samples / window_s : 0.0;
+
+    printf("sketch,%s\n", sketch->name);
+    printf("window_s,%.3f\n", window_s);
+    printf("samples_per_s,%.1f\n", *samples_per_s);
+    printf("gpio_calls_per_sample,%.2f\n", samples ? (double)calls / samples : 0.0);
+    printf("dac_transitions,%llu\n", (unsigned long long)sim_dac_transitions());
+    printf("irq_busy_pct,%.2f\n", window_s > 0 ? 100.0 * (irq_busy() - w->mark_busy) / 1e12 / window_s : 0.0);
+    printf("irq_worst_late_us,%.3f\n", worst_late);
+    if (sketch->missed) {
+        printf("missed,%u\n", *sketch->missed);
+    } else {
+        printf("missed,-\n");
+    }
+    printf("wave_ram_bytes,%u\n", sketch->wave_ram);
+    printf("wave_flash_bytes,%u\n", sketch->wave_flash);
+    return w->marked;
+}
+
+int main(int argc, char **argv) {
+    static ino_watch_t w;
+    w.console = argc > 1 && strcmp(argv[1], "--console") == 0;
+    double final_rate, fast_rate;
+
+    if (!run_sketch(&sim_ino_final, &w, &final_rate) || !run_sketch(&sim_ino_fast, &w, &fast_rate)) {
+        fprintf(stderr, "script error\n");
+        return 2;
+    }
+    uint8_t period[SIM_INO_POINTS];
+    sim_ino_final_codes(INO_SHAPE, INO_AMPLITUDE_MV, INO_OFFSET_MV, period);
+    double expected_rate = (double)INO_FREQ_HZ * SIM_INO_POINTS;
+
+    check_quiet(*sim_ino_fast.missed == 0, "fast build missed sample deadlines");
+    check_quiet(fast_rate > expected_rate * 0.999 && fast_rate < expected_rate * 1.001, "fast build sample rate");
+    check_quiet(codes_follow(w.codes, w.code_count, period), "fast build codes on the bus");
+    check_quiet(fast_rate > final_rate, "fast build outputs more samples per second");
+    check_quiet(sim_ino_fast.wave_ram < sim_ino_final.wave_ram, "fast build takes less RAM");
+
+    printf("compare,samples_per_s_ratio,%.2f\n", final_rate > 0 ? fast_rate / final_rate : 0.0);
+    printf("compare,wave_ram_ratio,%.2f\n", (double)sim_ino_fast.wave_ram / sim_ino_final.wave_ram);
+    return check_result();
+}
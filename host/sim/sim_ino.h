@@ -0,0 +1,44 @@
+/**
+ * @file sim_ino.h
+ * @brief Arduino sketches built for the simulator, as seen by sim_ino.c.
+ *
+ * Each sketch is compiled as C++ inside its own namespace (ino_final.cpp,
+ * ino_fast.cpp), so both link into one program; the wrapper describes it
+ * here with its entry points and what it keeps in RAM and in flash for the
+ * signal.
+ */
+
+// Avoid duplication in code
+#ifndef _SIM_INO_H_
+#define _SIM_INO_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_INO_POINTS 100 ///< Muestras por periodo de la señal en ambos sketches
+
+/**
+ * @brief One sketch on the simulator.
+ */
+typedef struct {
+    const char *name;                 ///< Nombre del sketch
+    void (*setup)(void);
+    void (*loop)(void);
+    uint32_t wave_ram;                ///< Bytes de RAM de tablas y buffers de la señal
+    uint32_t wave_flash;              ///< Bytes de flash de las tablas
+    const volatile uint32_t *missed;  ///< Plazos de muestreo perdidos (NULL: sin plazos)
+} sim_ino_sketch_t;
+
+extern const sim_ino_sketch_t sim_ino_final;
+extern const sim_ino_sketch_t sim_ino_fast;
+
+void sim_ino_final_codes(int cont, int amp, int dc, uint8_t codes[SIM_INO_POINTS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,319 @@
+/**
+ * @file stream_loopback.c
+ * @brief Sample streaming through a simulated USB link into a simulated device.
+ *
+ * The device is the c_irq stream path on a virtual clock: the 20 kHz
+ * sample interrupt pops one code per tick, and the main loop that runs
+ * after it moves the received bytes into the ring in place (span/commit),
+ * changes state and sends credit reports. The link moves host bytes in
+ * 1 ms USB frames, at most LINK_FIFO bytes waiting on the device side, so
+ * a slow device backs the link up as a real CDC port does. Log lines
+ * share the device-to-host direction with the reports.
+ *
+ * - Idle: a receiver that was never started sends no report, so nothing
+ *   binary reaches the console at boot.
+ * - Sustained: 10 s at a link faster than the sample rate. No underrun,
+ *   no overrun, every code played once in order.
+ * - Slow link: slower than the sample rate. Underruns are reported, and
+ *   they are exactly the held samples the output shows.
+ * - Host stall: the sender pauses for 300 ms. The ring covers part of it;
+ *   the rest shows as underruns, and the stream recovers.
+ * - Greedy host: ignores the credit. The device drops and counts the
+ *   overruns, and plays the rest in order.
+ *
+ * The cost per code of the receive and playback paths is printed too.
+ * Exits non-zero on any failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "check.h"
+#include "stream_tx.h"
+
+#define SIM_RATE_HZ 20000 ///< Reloj de muestreo de c_irq
+#define SIM_SAMPLE_US (1000000 / SIM_RATE_HZ)
+#define SIM_CODES (10 * SIM_RATE_HZ) ///< 10 s de codigos
+#define LINK_FIFO 256 ///< Bytes que el equipo acepta sin leer (USB CDC)
+#define HOST_FIFO 4096 ///< Bytes en espera en el host
+#define SERIAL_BATCH 64 ///< Bytes leidos por vuelta del bucle principal
+#define LOG_EVERY_US 1000000 ///< Una linea del registro por segundo
+#define BENCH_CODES 20000000u
+
+typedef struct {
+    const char *name;
+    uint32_t link_bytes_ms;     ///< Bytes por trama USB
+    uint32_t stall_at_us;       ///< Pausa del host (0: ninguna)
+    uint32_t stall_us;
+    bool greedy;                ///< El host ignora el credito
+} scenario_t;
+
+typedef struct {
+    stream_rx_t rx;
+    stream_tx_t tx;
+    uint8_t input[SIM_CODES];
+    uint32_t input_pos;         ///< Codigos entregados por el host
+    bool ended;                 ///< Bloque de fin enviado
+    uint8_t host_q[HOST_FIFO];  ///< Host -> enlace
+    uint32_t host_len;
+    uint8_t dev_q[LINK_FIFO];   ///< Enlace -> equipo
+    uint32_t dev_len;
+    uint8_t back_q[4096];       ///< Equipo -> host
+    uint32_t back_len;
+    uint32_t now_us;
+    uint32_t played;            ///< Codigos reproducidos
+    uint32_t mismatches;        ///< Codigos fuera de orden o distintos
+    uint32_t holds;             ///< Muestras mantenidas mientras sonaba
+    uint32_t first_us;
+    uint32_t last_us;
+    uint32_t max_fill;
+} sim_t;
+
+static sim_t sim;
+static volatile uint32_t bench_sink;
+
+static void back_write(const uint8_t *buf, uint32_t len) {
+    if (sim.back_len + len <= sizeof(sim.back_q)) {
+        memcpy(&sim.back_q[sim.back_len], buf, len);
+        sim.back_len += len;
+    }
+}
+
+/**
+ * @brief Sample interrupt: one code, checked against the input.
+ *
+ * A greedy host loses codes to overruns, so there the played codes only
+ * have to appear in the input in order.
+ */
+static void device_sample(bool greedy) {
+    uint32_t tail = atomic_load(&sim.rx.tail);
+    uint32_t underruns = atomic_load(&sim.rx.underruns);
+    uint8_t code;
+    if (!stream_rx_pop(&sim.rx, &code)) {
+        return;
+    }
+    if (atomic_load(&sim.rx.tail) == tail) {
+        sim.holds += atomic_load(&sim.rx.underruns) - underruns;
+        return;
+    }
+    if (!sim.played) {
+        sim.first_us = sim.now_us;
+    }
+    sim.last_us = sim.now_us;
+    static uint32_t match;
+    if (!sim.played) {
+        match = 0;
+    }
+    if (greedy) {
+        while (match < SIM_CODES && sim.input[match] != code) {
+            match++;
+        }
+        sim.mismatches += match >= SIM_CODES;
+        match++;
+    } else if (code != sim.input[sim.played]) {
+        sim.mismatches++;
+    }
+    sim.played++;
+}
+
+/**
+ * @brief Main loop pass: bytes into the ring in place, state, reports.
+ */
+static void device_main(void) {
+    uint32_t taken = 0;
+    while (taken < SERIAL_BATCH && taken < sim.dev_len) {
+        if (atomic_load(&sim.rx.state) == STREAM_OFF) {
+            if (sim.dev_q[taken++] == 'S') {
+                stream_rx_start(&sim.rx, sim.now_us);
+            }
+            continue;
+        }
+        uint8_t *dst;
+        uint32_t n = stream_rx_span(&sim.rx, &dst);
+        uint32_t avail = sim.dev_len - taken;
+        if (n) {
+            n = n < avail ? n : avail;
+            memcpy(dst, &sim.dev_q[taken], n); ///< la lectura USB directa al anillo
+            stream_rx_commit(&sim.rx, n);
+            taken += n;
+        } else {
+            stream_rx_feed(&sim.rx, sim.dev_q[taken++]);
+        }
+    }
+    sim.dev_len -= taken;
+    memmove(sim.dev_q, &sim.dev_q[taken], sim.dev_len);
+    stream_rx_poll(&sim.rx, sim.now_us);
+    uint8_t report[STREAM_RX_REPORT_LEN];
+    uint32_t len = stream_rx_report(&sim.rx, report, false);
+    back_write(report, len);
+    uint32_t fill = stream_rx_fill(&sim.rx);
+    sim.max_fill = fill > sim.max_fill ? fill : sim.max_fill;
+}
+
+/**
+ * @brief One USB frame: both directions move, then the host sends what its credit allows.
+ */
+static void usb_frame(const scenario_t *sc) {
+    uint32_t n = sc->link_bytes_ms;
+    n = n < sim.host_len ? n : sim.host_len;
+    n = n < LINK_FIFO - sim.dev_len ? n : LINK_FIFO - sim.dev_len;
+    memcpy(&sim.dev_q[sim.dev_len], sim.host_q, n);
+    sim.dev_len += n;
+    sim.host_len -= n;
+    memmove(sim.host_q, &sim.host_q[n], sim.host_len);
+
+    stream_tx_input(&sim.tx, sim.back_q, sim.back_len);
+    sim.back_len = 0;
+    if (sc->stall_us && sim.now_us - sc->stall_at_us < sc->stall_us) {
+        return;
+    }
+    while (sim.input_pos < SIM_CODES && HOST_FIFO - sim.host_len >= STREAM_TX_BLOCK_LEN) {
+        uint32_t len;
+        uint32_t took;
+        if (sc->greedy) {
+            took = SIM_CODES - sim.input_pos < STREAM_TX_BLOCK ? SIM_CODES - sim.input_pos : STREAM_TX_BLOCK;
+            sim.host_q[sim.host_len] = (uint8_t)took; ///< sin mirar el credito
+            memcpy(&sim.host_q[sim.host_len + 1], &sim.input[sim.input_pos], took);
+            len = 1 + took;
+        } else {
+            took = stream_tx_block(&sim.tx, &sim.input[sim.input_pos], SIM_CODES - sim.input_pos,
+                                   &sim.host_q[sim.host_len], &len);
+        }
+        if (!took) {
+            break;
+        }
+        sim.input_pos += took;
+        sim.host_len += len;
+    }
+    if (sim.input_pos == SIM_CODES && !sim.ended && sim.host_len < HOST_FIFO) {
+        sim.host_len += stream_tx_end(&sim.host_q[sim.host_len]);
+        sim.ended = true;
+    }
+}
+
+static void run(const scenario_t *sc) {
+    memset(&sim, 0, sizeof(sim));
+    uint32_t rng = 7;
+    for (uint32_t i = 0; i < SIM_CODES; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        sim.input[i] = (uint8_t)(rng >> 24);
+    }
+    stream_rx_init(&sim.rx);
+    stream_tx_init(&sim.tx);
+    sim.host_q[sim.host_len++] = 'S';
+    uint32_t next_log = LOG_EVERY_US;
+    // Hasta que el flujo termine, con un limite de 60 s virtuales
+    for (sim.now_us = SIM_SAMPLE_US; sim.now_us < 60000000u; sim.now_us += SIM_SAMPLE_US) {
+        device_sample(sc->greedy);
+        device_main();
+        if (sim.now_us % 1000 == 0) {
+            usb_frame(sc);
+        }
+        if (sim.now_us >= next_log) {
+            static const char line[] = "Sinusoidal: Amp: 1000, Offset: 100, Freq: 10.000\n";
+            back_write((const uint8_t *)line, sizeof(line) - 1);
+            next_log += LOG_EVERY_US;
+        }
+        if (sim.ended && sim.tx.state == STREAM_OFF && sim.tx.reports > 1) {
+            break;
+        }
+    }
+    double play_s = (sim.last_us - sim.first_us) / 1e6;
+    printf("%s: link %u kB/s, played %u of %u, %u underruns (%u reported), %u overruns, max fill %u,"
+           " %.0f codes/s\n",
+           sc->name, sc->link_bytes_ms, sim.played, SIM_CODES, atomic_load(&sim.rx.underruns), sim.tx.underruns,
+           sim.rx.overruns, sim.max_fill, play_s > 0 ? (sim.played - 1) / play_s : 0.0);
+    check(sim.ended && sim.tx.state == STREAM_OFF, "stream ended and reported off");
+    check(sim.mismatches == 0, "codes played in order");
+    check(sim.holds == atomic_load(&sim.rx.underruns) && sim.tx.underruns == sim.holds,
+          "underruns = held samples = reported");
+}
+
+/**
+ * @brief Cost per code of the receive paths and of the playback pop.
+ */
+static void bench(void) {
+    static stream_rx_t rx;
+    static uint8_t block[STREAM_TX_BLOCK_LEN];
+    block[0] = STREAM_TX_BLOCK;
+    for (int mode = 0; mode < 2; mode++) {
+        stream_rx_init(&rx);
+        stream_rx_start(&rx, 0);
+        atomic_store(&rx.state, STREAM_PLAYING);
+        uint64_t rx_ns = 0;
+        uint64_t pop_ns = 0;
+        for (uint32_t done = 0; done < BENCH_CODES; done += STREAM_TX_BLOCK) {
+            uint64_t t0 = bench_now_ns();
+            if (mode) {
+                stream_rx_feed(&rx, block[0]);
+                for (uint32_t i = 1; i < STREAM_TX_BLOCK_LEN;) {
+                    uint8_t *dst;
+                    uint32_t n = stream_rx_span(&rx, &dst);
+                    memcpy(dst, &block[i], n);
+                    stream_rx_commit(&rx, n);
+                    i += n;
+                }
+            } else {
+                for (uint32_t i = 0; i < STREAM_TX_BLOCK_LEN; i++) {
+                    stream_rx_feed(&rx, block[i]);
+                }
+            }
+            uint64_t t1 = bench_now_ns();
+            for (uint32_t i = 0; i < STREAM_TX_BLOCK; i++) {
+                uint8_t code;
+                if (stream_rx_pop(&rx, &code)) { ///< false mientras el anillo se llena
+                    bench_sink += code;
+                }
+            }
+            pop_ns += bench_now_ns() - t1;
+            rx_ns += t1 - t0;
+        }
+        printf("%s: %.2f ns/code receive, %.2f ns/code pop, %.1f Mcodes/s\n", mode ? "span" : "feed",
+               (double)rx_ns / BENCH_CODES, (double)pop_ns / BENCH_CODES, bench_rate(BENCH_CODES, rx_ns) / 1e6);
+    }
+}
+
+/**
+ * @brief A receiver that was never started sends nothing to the console.
+ */
+static void check_idle(void) {
+    static stream_rx_t rx;
+    uint8_t report[STREAM_RX_REPORT_LEN];
+    stream_rx_init(&rx);
+    uint32_t len = 0;
+    for (uint32_t t = 0; t < 10 * STREAM_RX_IDLE_US; t += SIM_SAMPLE_US) {
+        stream_rx_poll(&rx, t);
+        len += stream_rx_report(&rx, report, false);
+    }
+    printf("idle: %u report bytes\n", len);
+    check(len == 0, "no report without a stream");
+}
+
+int main(void) {
+    check_idle();
+    static const scenario_t scenarios[] = {
+        { "sustained", 100, 0, 0, false },
+        { "slow link", 18, 0, 0, false },
+        { "host stall", 100, 3000000, 300000, false },
+        { "greedy host", 1000, 0, 0, true },
+    };
+    for (uint32_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        const scenario_t *sc = &scenarios[i];
+        run(sc);
+        if (sc->greedy) {
+            check(sim.rx.overruns > 0 && sim.played == SIM_CODES - sim.rx.overruns,
+                  "overruns dropped and counted, the rest played");
+            continue;
+        }
+        check(sim.rx.overruns == 0 && sim.played == SIM_CODES, "credit kept the ring from overrunning");
+        if (sc->link_bytes_ms * 1000 > SIM_RATE_HZ * 2 && !sc->stall_us) {
+            check(atomic_load(&sim.rx.underruns) == 0, "no underrun at a sufficient link rate");
+        } else {
+            uint32_t u = atomic_load(&sim.rx.underruns);
+            check(u > 0 && (!sc->stall_us || u <= sc->stall_us / SIM_SAMPLE_US), "underruns reported");
+        }
+    }
+    bench();
+    return check_result();
+}
@@ -0,0 +1,146 @@
+/**
+ * @file stream_play.c
+ * @brief Play a sequence of DAC codes on c_irq through its USB serial port.
+ *
+ * Usage: stream_play [--text] <device> <file|->
+ *
+ * The file holds one DAC code (0-255) per byte, or with --text one number
+ * per word ('#' starts a comment). The codes are played at the sample
+ * rate of the firmware (20 kHz), sent only as fast as the device grants
+ * credit for; the device plays the generator again once the stream has
+ * played out. Progress, and the underruns the device reports, are
+ * printed on stderr every second.
+ *
+ * Exits non-zero if the device does not answer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "serial_port.h"
+#include "stream_tx.h"
+
+#define PLAY_START_MS 2000 ///< Espera del informe de inicio
+#define PLAY_END_MS 5000 ///< Espera del fin tras el ultimo codigo
+
+static uint8_t *read_codes(FILE *in, int text, uint32_t *count) {
+    uint32_t cap = 65536;
+    uint32_t n = 0;
+    uint8_t *codes = malloc(cap);
+    while (codes) {
+        if (n == cap) {
+            cap *= 2;
+            uint8_t *grown = realloc(codes, cap);
+            if (!grown) {
+                free(codes);
+                return NULL;
+            }
+            codes = grown;
+        }
+        if (!text) {
+            size_t got = fread(&codes[n], 1, cap - n, in);
+            if (!got) {
+                break;
+            }
+            n += (uint32_t)got;
+            continue;
+        }
+        unsigned v;
+        int r = fscanf(in, " %u", &v);
+        if (r == 1) {
+            codes[n++] = (uint8_t)(v > 255 ? 255 : v);
+        } else if (r == 0 && fgetc(in) == '#') {
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n') {
+            }
+        } else if (r == EOF) {
+            break;
+        }
+    }
+    *count = n;
+    return codes;
+}
+
+int main(int argc, char **argv) {
+    int text = argc > 1 && strcmp(argv[1], "--text") == 0;
+    if (argc != 3 + text) {
+        fprintf(stderr, "usage: %s [--text] <device> <file|->\n", argv[0]);
+        return 2;
+    }
+    const char *device = argv[1 + text];
+    const char *file = argv[2 + text];
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "rb");
+    if (!in) {
+        perror(file);
+        return 1;
+    }
+    uint32_t count;
+    uint8_t *codes = read_codes(in, text, &count);
+    if (!codes || !count) {
+        fprintf(stderr, "%s: no codes\n", file);
+        return 1;
+    }
+    int fd = serial_open(device);
+    if (fd < 0) {
+        perror(device);
+        return 1;
+    }
+
+    stream_tx_t tx;
+    stream_tx_init(&tx);
+    uint8_t start = 'S';
+    serial_write(&start, 1, &fd);
+    uint32_t t0 = serial_now_ms(NULL);
+    uint32_t last_print = t0;
+    uint32_t ended_at = 0;
+    uint32_t pos = 0;
+    int status = 0;
+    while (1) {
+        uint8_t buf[256];
+        int32_t got = serial_read(buf, sizeof(buf), 10, &fd);
+        if (got < 0) {
+            status = 1;
+            break;
+        }
+        stream_tx_input(&tx, buf, (uint32_t)got);
+        uint32_t now = serial_now_ms(NULL);
+        if (!tx.started && now - t0 > PLAY_START_MS) {
+            fprintf(stderr, "no answer from %s\n", device);
+            status = 1;
+            break;
+        }
+        while (pos < count) {
+            uint8_t block[STREAM_TX_BLOCK_LEN];
+            uint32_t len;
+            uint32_t took = stream_tx_block(&tx, &codes[pos], count - pos, block, &len);
+            if (!took) {
+                break;
+            }
+            serial_write(block, len, &fd);
+            pos += took;
+        }
+        if (pos == count && !ended_at) {
+            uint8_t end[1];
+            serial_write(end, stream_tx_end(end), &fd);
+            ended_at = now;
+        }
+        if (now - last_print >= 1000) {
+            fprintf(stderr, "%u/%u codes sent, %u underruns\n", pos, count, tx.underruns);
+            last_print = now;
+        }
+        if (ended_at && tx.state == STREAM_OFF && tx.reports > 1) {
+            break;
+        }
+        if (ended_at && now - ended_at > PLAY_END_MS + count / 20) {
+            fprintf(stderr, "no end report from %s\n", device);
+            status = 1;
+            break;
+        }
+    }
+    close(fd);
+    free(codes);
+    fprintf(stderr, "%u codes in %.1f s, %u underruns\n", pos, (serial_now_ms(NULL) - t0) / 1000.0, tx.underruns);
+    return status;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file stream_tx.c
+ * @brief Credit tracking and block building of the sample stream sender.
+ *
+ * The sender never has more codes in flight than the device granted, so
+ * the device ring cannot overrun however late the reports arrive.
+ */
+
+#include "stream_tx.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize a sender with no credit, before sending 'S'.
+ */
+void stream_tx_init(stream_tx_t *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+/**
+ * @brief Take what the device sent: credit reports among log bytes.
+ *
+ * The first report of a stream is the one in STREAM_PRIMING; after it,
+ * a report only counts if it grants more (an older one is stale).
+ */
+void stream_tx_input(stream_tx_t *t, const uint8_t *buf, uint32_t len) {
+    while (len) {
+        uint32_t n = sizeof(t->rx) - t->rx_len < len ? sizeof(t->rx) - t->rx_len : len;
+        memcpy(&t->rx[t->rx_len], buf, n);
+        t->rx_len += n;
+        buf += n;
+        len -= n;
+        while (t->rx_len) {
+            uint8_t state;
+            uint32_t granted;
+            uint32_t underruns;
+            int used = stream_rx_parse_report(t->rx, t->rx_len, &state, &granted, &underruns);
+            if (used == 0) {
+                break;
+            }
+            if (used < 0) {
+                used = 1;
+                t->skipped++;
+            } else if (!t->started ? state == STREAM_PRIMING : (int32_t)(granted - t->granted) >= 0) {
+                t->started = true;
+                t->granted = granted;
+                t->underruns = underruns;
+                t->state = state;
+                t->reports++;
+            }
+            t->rx_len -= (uint32_t)used;
+            memmove(t->rx, &t->rx[used], t->rx_len);
+        }
+    }
+}
+
+/**
+ * @brief Codes the device has room for.
+ */
+uint32_t stream_tx_room(const stream_tx_t *t) {
+    return t->started ? t->granted - t->sent : 0;
+}
+
+/**
+ * @brief Build one block from the codes the credit allows.
+ *
+ * @param t Sender.
+ * @param codes Codes to send.
+ * @param n Codes available.
+ * @param out Destination, STREAM_TX_BLOCK_LEN bytes.
+ * @param len Bytes of the block (0 if there is no credit).
+ * @return Codes taken from @p codes.
+ */
+uint32_t stream_tx_block(stream_tx_t *t, const uint8_t *codes, uint32_t n, uint8_t *out, uint32_t *len) {
+    uint32_t room = stream_tx_room(t);
+    n = n < room ? n : room;
+    n = n < STREAM_TX_BLOCK ? n : STREAM_TX_BLOCK;
+    *len = 0;
+    if (!n) {
+        return 0;
+    }
+    out[0] = (uint8_t)n;
+    memcpy(&out[1], codes, n);
+    *len = 1 + n;
+    t->sent += n;
+    return n;
+}
+
+/**
+ * @brief End-of-stream block.
+ */
+uint32_t stream_tx_end(uint8_t *out) {
+    out[0] = 0;
+    return 1;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file stream_tx.h
+ * @brief Host side of the sample stream (stream_rx.h): credit tracking and blocks.
+ */
+
+// Avoid duplication in code
+#ifndef _STREAM_TX_H_
+#define _STREAM_TX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stream_rx.h"
+
+#define STREAM_TX_BLOCK 255 ///< Codigos por bloque como maximo
+#define STREAM_TX_BLOCK_LEN (1 + STREAM_TX_BLOCK) ///< Bytes de un bloque completo
+
+/**
+ * @brief Sender state.
+ */
+typedef struct {
+    uint32_t sent;          ///< Codigos enviados
+    uint32_t granted;       ///< Credito concedido (codigos desde el inicio)
+    uint32_t underruns;     ///< Muestras sin codigo segun el ultimo informe
+    uint8_t state;          ///< Estado segun el ultimo informe (STREAM_*)
+    bool started;           ///< Llego el informe de inicio de este flujo
+    uint8_t rx[64];         ///< Bytes recibidos aun sin analizar
+    uint32_t rx_len;        ///< Bytes en rx
+    uint32_t reports;       ///< Informes recibidos
+    uint32_t skipped;       ///< Bytes recibidos que no eran informes (el registro del equipo)
+} stream_tx_t;
+
+void stream_tx_init(stream_tx_t *t);
+void stream_tx_input(stream_tx_t *t, const uint8_t *buf, uint32_t len);
+uint32_t stream_tx_room(const stream_tx_t *t);
+uint32_t stream_tx_block(stream_tx_t *t, const uint8_t *codes, uint32_t n, uint8_t *out, uint32_t *len);
+uint32_t stream_tx_end(uint8_t *out);
+
+#endif
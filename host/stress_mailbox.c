@@ -0,0 +1,89 @@
+/**
+ * @file stress_mailbox.c
+ * @brief Two-thread stress run of the SPSC parameter mailbox.
+ *
+ * The producer thread plays core 0: it posts parameter sets whose fields
+ * are all derived from one sequence number, retrying while the mailbox is
+ * full. The consumer thread plays core 1 and checks every set it takes: a
+ * torn update would break the relation between the fields, and a lost or
+ * repeated one would break the sequence. Exits non-zero on any error.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "mailbox.h"
+
+#define STRESS_MESSAGES 5000000u
+
+static mailbox_t mailbox;
+static uint32_t messages;
+
+/**
+ * @brief Parameter set number @p n.
+ */
+static siggen_params_t stress_params(uint32_t n) {
+    siggen_params_t p;
+    p.shape = (uint8_t)(n % 4u);
+    p.amplitude = 100u + n % 2401u;
+    p.offset = 50u + (n * 7u) % 1201u;
+    p.freq_mhz = n;
+    p.phase_deg = n % 360u;
+    p.mod = (uint8_t)(n % 5u);
+    p.mod_arg = n * 3u;
+    p.mod_time = ~n;
+    p.user_gen = n / 3u;
+    p.at_phase = n * 0x9E3779B9u;
+    return p;
+}
+
+static void *producer(void *arg) {
+    (void)arg;
+    for (uint32_t n = 0; n < messages; n++) {
+        siggen_params_t p = stress_params(n);
+        while (!mailbox_post(&mailbox, &p)) {
+            sched_yield(); ///< lleno: dejar correr al consumidor si comparten CPU
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    uint64_t *errors = arg;
+    for (uint32_t n = 0; n < messages; n++) {
+        siggen_params_t p;
+        while (!mailbox_take(&mailbox, &p)) {
+            sched_yield();
+        }
+        siggen_params_t expect = stress_params(n);
+        if (p.freq_mhz != n || p.shape != expect.shape || p.amplitude != expect.amplitude || p.offset != expect.offset ||
+            p.phase_deg != expect.phase_deg || p.mod != expect.mod || p.mod_arg != expect.mod_arg ||
+            p.mod_time != expect.mod_time || p.user_gen != expect.user_gen || p.at_phase != expect.at_phase) {
+            (*errors)++;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    pthread_t prod;
+    pthread_t cons;
+    uint64_t errors = 0;
+
+    messages = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : STRESS_MESSAGES;
+    mailbox_init(&mailbox);
+
+    uint64_t t0 = bench_now_ns();
+    pthread_create(&cons, NULL, consumer, &errors);
+    pthread_create(&prod, NULL, producer, NULL);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+    uint64_t t1 = bench_now_ns();
+
+    printf("messages,errors,messages_per_s\n%u,%llu,%.0f\n", messages, (unsigned long long)errors,
+           bench_rate(messages, t1 - t0));
+    return errors ? 1 : 0;
+}
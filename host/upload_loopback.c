@@ -0,0 +1,293 @@
+/**
+ * @file upload_loopback.c
+ * @brief Waveform uploads through a faulty link into a simulated device.
+ *
+ * The device is the c_irq upload path on a virtual clock: the receiver of
+ * wave_upload.c fed one byte per BYTE_US, and the 20 kHz sample path of
+ * wave_cache.h running in between, as the sample interrupt would. Its
+ * replies share the link with log lines, as on the real port. The host is
+ * the uploader of upload_wave.
+ *
+ * - Clean link: one upload, no frame resent, ordinary commands sent
+ *   before it still reach the command parser.
+ * - Faulty link: bytes dropped and bits flipped in both directions; every
+ *   upload must still complete once, with the table exact.
+ * - A table of the wrong length is rejected and changes nothing.
+ *
+ * Every output sample is compared against the period that should be
+ * playing: the old one until the first phase wrap after a commit, the new
+ * one after it. Any other code is a glitch. Exits non-zero on any failure.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "check.h"
+#include "wave_cache.h"
+#include "wave_uploader.h"
+
+#define LOOP_RATE_HZ 20000 ///< Reloj de muestreo de c_irq
+#define LOOP_SAMPLE_US (1000000 / LOOP_RATE_HZ)
+#define LOOP_FREQ_MHZ 97000 ///< ~206 muestras por periodo
+#define LOOP_AMP 2000
+#define LOOP_OFFSET 1000
+#define BYTE_US 20 ///< Tiempo de un byte en el enlace
+#define LOG_EVERY_US 3000 ///< Una linea del registro cada tanto
+#define LINK_BUF 8192
+#define NOISY_UPLOADS 40
+
+typedef struct {
+    // Equipo
+    wave_upload_t rx;
+    wave_cache_t cache;
+    dds_t dds;
+    waveform_sample_t user[2][WAVEFORM_LENGTH];
+    uint32_t gen;
+    uint32_t passed;                        ///< Bytes entregados como comandos
+    // Referencia de la salida
+    uint8_t ref[2][WAVEFORM_LENGTH];        ///< Periodo que suena y el siguiente
+    uint8_t playing;
+    bool ref_pending;
+    uint64_t samples;
+    uint64_t glitches;
+    uint32_t swaps;
+    // Enlace
+    uint32_t now_us;
+    uint32_t next_sample_us;
+    uint32_t next_log_us;
+    uint8_t to_host[LINK_BUF];
+    uint32_t to_host_len;
+    uint32_t drop_ppm;
+    uint32_t flip_ppm;
+    uint32_t faults;
+} loop_t;
+
+static loop_t loop;
+
+/**
+ * @brief A byte crosses the link: dropped, damaged or intact.
+ *
+ * @return false if it was dropped.
+ */
+static bool link_fault(uint8_t *b) {
+    uint32_t r = check_rand() % 1000000u;
+    if (r < loop.drop_ppm) {
+        loop.faults++;
+        return false;
+    }
+    if (r < loop.drop_ppm + loop.flip_ppm) {
+        *b ^= (uint8_t)(1u << (check_rand() % 8));
+        loop.faults++;
+    }
+    return true;
+}
+
+static void to_host(const uint8_t *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len && loop.to_host_len < LINK_BUF; i++) {
+        uint8_t b = buf[i];
+        if (link_fault(&b)) {
+            loop.to_host[loop.to_host_len++] = b;
+        }
+    }
+}
+
+static void device_reply(const uint8_t *buf, uint32_t len, void *ctx) {
+    (void)ctx;
+    to_host(buf, len);
+}
+
+/**
+ * @brief One tick of the sample path, checked against the reference.
+ */
+static void device_sample(void) {
+    uint32_t before = loop.dds.phase;
+    uint32_t idx = (uint32_t)(((uint64_t)before * loop.dds.length) >> 32);
+    uint8_t code = wave_cache_next(&loop.cache, &loop.dds);
+    if (code != loop.ref[loop.playing][idx]) {
+        loop.glitches++;
+    }
+    if (loop.ref_pending && loop.dds.phase < before) {
+        loop.playing ^= 1;
+        loop.ref_pending = false;
+        loop.swaps++;
+    }
+    loop.samples++;
+}
+
+/**
+ * @brief Let the virtual clock run: samples and log lines fall due.
+ */
+static void device_run(uint32_t us) {
+    uint32_t end = loop.now_us + us;
+    while ((int32_t)(loop.next_sample_us - end) <= 0) {
+        loop.now_us = loop.next_sample_us;
+        device_sample();
+        loop.next_sample_us += LOOP_SAMPLE_US;
+        if ((int32_t)(loop.now_us - loop.next_log_us) >= 0) {
+            static const char line[] = "Usuario: Amp: 2000, Offset: 1000, Freq: 97.000\n";
+            to_host((const uint8_t *)line, sizeof(line) - 1); ///< entre respuestas, no dentro
+            loop.next_log_us += LOG_EVERY_US;
+        }
+    }
+    loop.now_us = end;
+}
+
+/**
+ * @brief What load_user_wave() and engine_apply() do in c_irq.
+ */
+static void device_load(void) {
+    waveform_sample_t *table = loop.user[(loop.gen + 1) & 1];
+    wave_upload_export(&loop.rx, table);
+    loop.gen++;
+    waveform_set_user(table);
+    wave_cache_rebuild_shape(&loop.cache, WAVEFORM_USER, LOOP_AMP, LOOP_OFFSET);
+    waveform_scaling_t k = waveform_scaling(LOOP_AMP, LOOP_OFFSET);
+    uint8_t *next = loop.ref[loop.playing ^ 1];
+    for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+        next[i] = waveform_apply(waveform_to_dac(table[i]), k);
+    }
+    loop.ref_pending = true;
+}
+
+static int32_t link_write(const uint8_t *buf, uint32_t len, void *ctx) {
+    (void)ctx;
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t b = buf[i];
+        device_run(BYTE_US);
+        if (!link_fault(&b)) {
+            continue;
+        }
+        int r = wave_upload_feed(&loop.rx, b, loop.now_us);
+        if (r == WAVE_UPLOAD_PASS) {
+            loop.passed++;
+        } else if (r == WAVE_UPLOAD_DONE) {
+            device_load();
+        }
+    }
+    return 0;
+}
+
+static int32_t link_read(uint8_t *buf, uint32_t len, uint32_t timeout_ms, void *ctx) {
+    (void)ctx;
+    uint32_t waited = 0;
+    while (!loop.to_host_len && waited < timeout_ms * 1000u) {
+        device_run(1000); ///< una trama USB
+        waited += 1000;
+    }
+    uint32_t n = loop.to_host_len < len ? loop.to_host_len : len;
+    memcpy(buf, loop.to_host, n);
+    loop.to_host_len -= n;
+    memmove(loop.to_host, &loop.to_host[n], loop.to_host_len);
+    return (int32_t)n;
+}
+
+static uint32_t link_now_ms(void *ctx) {
+    (void)ctx;
+    return loop.now_us / 1000;
+}
+
+static void device_init(void) {
+    memset(&loop, 0, sizeof(loop));
+    check_seed(12345);
+    waveform_set_user(NULL);
+    wave_upload_init(&loop.rx, WAVEFORM_LENGTH, device_reply, NULL);
+    dds_init(&loop.dds, WAVEFORM_LENGTH, false);
+    dds_set_frequency(&loop.dds, LOOP_FREQ_MHZ, LOOP_RATE_HZ);
+    wave_cache_init(&loop.cache, WAVEFORM_LENGTH);
+    wave_cache_rebuild_shape(&loop.cache, WAVEFORM_SINE, LOOP_AMP, LOOP_OFFSET);
+    wave_cache_swap(&loop.cache);
+    waveform_scaling_t k = waveform_scaling(LOOP_AMP, LOOP_OFFSET);
+    for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+        loop.ref[0][i] = waveform_apply(waveform_to_dac(waveform_at(WAVEFORM_SINE, i)), k);
+    }
+    loop.next_sample_us = LOOP_SAMPLE_US;
+    loop.next_log_us = LOG_EVERY_US;
+}
+
+/**
+ * @brief Shape number @p n: a few harmonics with random weights, or noise.
+ */
+static void make_shape(uint32_t n, uint16_t *points) {
+    double v[WAVEFORM_LENGTH];
+    double w[4];
+    for (int h = 0; h < 4; h++) {
+        w[h] = (double)(check_rand() % 1000) / 1000.0;
+    }
+    for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+        double t = 2.0 * M_PI * i / WAVEFORM_LENGTH;
+        v[i] = n % 5 == 4 ? (double)(check_rand() % 65536)
+                          : w[0] * sin(t) + w[1] * sin(2 * t) + w[2] * sin(3 * t + 1.0) + w[3] * (i < 40);
+    }
+    uploader_resample(v, WAVEFORM_LENGTH, points, WAVEFORM_LENGTH, n % 5 != 4);
+}
+
+static bool table_exact(const uint16_t *points) {
+    const waveform_sample_t *t = loop.user[loop.gen & 1];
+    for (uint32_t i = 0; i < WAVEFORM_LENGTH; i++) {
+        if (t[i] != (waveform_sample_t)(points[i] >> (16 - WAVEFORM_BITS))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Play a few periods so that the last pending period is swapped in.
+ */
+static void settle(void) {
+    device_run(100000);
+}
+
+int main(void) {
+    uploader_t up;
+    uint16_t points[WAVEFORM_LENGTH];
+
+    // Enlace limpio
+    device_init();
+    uploader_init(&up, link_write, link_read, link_now_ms, NULL);
+    link_write((const uint8_t *)"TP", 2, NULL);
+    make_shape(0, points);
+    uint32_t start = loop.now_us;
+    int status = uploader_send(&up, points, WAVEFORM_LENGTH);
+    uint32_t took = loop.now_us - start;
+    settle();
+    printf("clean: %u frames, %u resent, %u us, %u swaps\n", up.frames, up.resent, took, loop.swaps);
+    check(status == WAVE_UPLOAD_OK && loop.gen == 1 && table_exact(points), "clean link: table uploaded exactly");
+    check(up.resent == 0 && up.restarts == 0, "clean link: nothing resent");
+    check(loop.passed == 2, "commands outside a transfer reach the parser");
+    check(loop.swaps == 1 && loop.glitches == 0, "clean link: one swap at a period boundary");
+
+    // Tamaño equivocado
+    uint32_t gen = loop.gen;
+    status = uploader_send(&up, points, WAVEFORM_LENGTH / 2);
+    settle();
+    check(status == WAVE_UPLOAD_BAD_RANGE && loop.gen == gen && loop.swaps == 1 && loop.glitches == 0,
+          "wrong length rejected, output unchanged");
+
+    // Enlace con fallos
+    device_init();
+    uploader_init(&up, link_write, link_read, link_now_ms, NULL);
+    loop.drop_ppm = 300;
+    loop.flip_ppm = 700;
+    uint32_t exact = 0;
+    uint32_t ok = 0;
+    for (uint32_t n = 0; n < NOISY_UPLOADS; n++) {
+        make_shape(n, points);
+        if (uploader_send(&up, points, WAVEFORM_LENGTH) == WAVE_UPLOAD_OK) {
+            ok++;
+            exact += table_exact(points);
+        }
+        settle();
+    }
+    printf("noisy: %u faults, %u frames, %u resent, %u restarts, %u skipped bytes, %u rejected frames\n",
+           loop.faults, up.frames, up.resent, up.restarts, up.skipped, loop.rx.errors);
+    printf("noisy: %llu samples, %u swaps, %llu glitches\n", (unsigned long long)loop.samples, loop.swaps,
+           (unsigned long long)loop.glitches);
+    check(ok == NOISY_UPLOADS && exact == NOISY_UPLOADS, "faulty link: every upload completed exactly");
+    check(loop.gen == NOISY_UPLOADS, "faulty link: each upload completed once");
+    check(loop.swaps == NOISY_UPLOADS && loop.glitches == 0, "faulty link: every swap at a period boundary");
+    check(up.resent > 0, "faulty link: faults were recovered by resending");
+
+    return check_result();
+}
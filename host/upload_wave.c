@@ -0,0 +1,94 @@
+/**
+ * @file upload_wave.c
+ * @brief Upload one period of a custom waveform to c_irq over its USB serial port.
+ *
+ * Usage: upload_wave [--raw] <device> <file|->
+ *
+ * The file holds the values of one period, separated by spaces, commas or
+ * line breaks ('#' starts a comment). They are resampled to the table
+ * length of the firmware and stretched to full scale, or with --raw taken
+ * as 0-65535 as they are. The device switches to the new shape at the end
+ * of the period it is playing; the amplitude and offset commands apply to
+ * it like to the built-in shapes.
+ *
+ * Exits non-zero if the device rejects the table or does not answer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "serial_port.h"
+#include "wave_uploader.h"
+
+#define UPLOAD_MAX_INPUT 65536 ///< Valores de entrada como maximo
+
+static uint32_t read_values(FILE *in, double *values, uint32_t max) {
+    uint32_t n = 0;
+    char line[256];
+    while (n < max && fgets(line, sizeof(line), in)) {
+        char *p = line;
+        char *hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+        while (n < max) {
+            char *end;
+            p += strspn(p, " \t,;\r\n");
+            double v = strtod(p, &end);
+            if (end == p) {
+                break;
+            }
+            values[n++] = v;
+            p = end;
+        }
+    }
+    return n;
+}
+
+int main(int argc, char **argv) {
+    int raw = argc > 1 && strcmp(argv[1], "--raw") == 0;
+    if (argc != 3 + raw) {
+        fprintf(stderr, "usage: %s [--raw] <device> <file|->\n", argv[0]);
+        return 2;
+    }
+    const char *device = argv[1 + raw];
+    const char *file = argv[2 + raw];
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+    if (!in) {
+        perror(file);
+        return 1;
+    }
+    static double values[UPLOAD_MAX_INPUT];
+    uint32_t n = read_values(in, values, UPLOAD_MAX_INPUT);
+    if (n < 2) {
+        fprintf(stderr, "%s: need at least 2 values\n", file);
+        return 1;
+    }
+    uint16_t points[WAVE_UPLOAD_MAX_POINTS];
+    uploader_resample(values, n, points, WAVE_UPLOAD_MAX_POINTS, !raw);
+
+    int fd = serial_open(device);
+    if (fd < 0) {
+        perror(device);
+        return 1;
+    }
+    uploader_t up;
+    uploader_init(&up, serial_write, serial_read, serial_now_ms, &fd);
+    int status = uploader_send(&up, points, WAVE_UPLOAD_MAX_POINTS);
+    close(fd);
+
+    fprintf(stderr, "%u values -> %u points, %u frames, %u resent, %u restarts\n", n, WAVE_UPLOAD_MAX_POINTS,
+            up.frames, up.resent, up.restarts);
+    if (status == WAVE_UPLOAD_OK) {
+        fprintf(stderr, "uploaded\n");
+        return 0;
+    }
+    if (status < 0) {
+        fprintf(stderr, "no answer from %s\n", device);
+    } else {
+        fprintf(stderr, "rejected by the device (status %d)\n", status);
+    }
+    return 1;
+}
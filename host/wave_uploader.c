@@ -0,0 +1,166 @@
+/**
+ * @file wave_uploader.c
+ * @brief Stop-and-wait sender of a waveform table, with retries.
+ *
+ * Every frame waits for its reply. A frame without a valid reply (lost or
+ * damaged on either side) or with a damaged-frame status is sent again;
+ * a table the device rejects at the commit, or a transfer it no longer
+ * knows about, is sent again from the start. Bytes that are not replies
+ * (the device log shares the port) are skipped.
+ */
+
+#include "wave_uploader.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Initialize an uploader on a link.
+ */
+void uploader_init(uploader_t *up, uploader_write_t write, uploader_read_t read, uploader_clock_t now_ms,
+                   void *ctx) {
+    memset(up, 0, sizeof(*up));
+    up->write = write;
+    up->read = read;
+    up->now_ms = now_ms;
+    up->ctx = ctx;
+    up->timeout_ms = UPLOADER_TIMEOUT_MS;
+}
+
+/**
+ * @brief Wait for the reply to the frame with sequence @p seq.
+ *
+ * @return Reply status, or -1 if none came within the timeout.
+ */
+static int uploader_wait(uploader_t *up, uint8_t seq) {
+    uint32_t start = up->now_ms(up->ctx);
+    while (1) {
+        while (up->rx_len) {
+            uint8_t status;
+            uint8_t got;
+            int used = wave_upload_parse_reply(up->rx, up->rx_len, &status, &got);
+            if (used == 0) {
+                break;
+            }
+            if (used < 0) {
+                used = 1;
+                up->skipped++;
+            }
+            up->rx_len -= (uint32_t)used;
+            memmove(up->rx, &up->rx[used], up->rx_len);
+            if (used > 1 && got == seq) {
+                return status;
+            }
+        }
+        uint32_t waited = up->now_ms(up->ctx) - start;
+        int32_t n = waited >= up->timeout_ms ? 0 :
+                    up->read(&up->rx[up->rx_len], sizeof(up->rx) - up->rx_len, up->timeout_ms - waited, up->ctx);
+        if (n <= 0) {
+            up->skipped += up->rx_len; ///< una respuesta cortada no llegara ya
+            up->rx_len = 0;
+            return -1;
+        }
+        up->rx_len += (uint32_t)n;
+    }
+}
+
+/**
+ * @brief Send one frame until it is answered with something other than a damaged-frame status.
+ *
+ * @return Last status, or -1 if the device never answered.
+ */
+static int uploader_exchange(uploader_t *up, const uint8_t *frame, uint32_t len, uint8_t seq) {
+    int status = -1;
+    for (uint32_t attempt = 0; attempt <= UPLOADER_RETRIES; attempt++) {
+        if (attempt) {
+            up->resent++;
+        }
+        up->frames++;
+        if (up->write(frame, len, up->ctx) < 0) {
+            return -1;
+        }
+        status = uploader_wait(up, seq);
+        if (status != -1 && status != WAVE_UPLOAD_BAD_CRC && status != WAVE_UPLOAD_BAD_TYPE) {
+            return status;
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief One attempt at the whole transfer.
+ */
+static int uploader_session(uploader_t *up, const uint8_t *bytes, uint32_t count, uint16_t crc) {
+    uint8_t frame[WAVE_UPLOAD_FRAME_MAX + 1];
+    int status = uploader_exchange(up, frame, wave_upload_frame_begin(frame, count, crc), 0);
+    for (uint32_t off = 0; status == WAVE_UPLOAD_OK && off < count * 2; off += WAVE_UPLOAD_CHUNK) {
+        uint32_t n = count * 2 - off < WAVE_UPLOAD_CHUNK ? count * 2 - off : WAVE_UPLOAD_CHUNK;
+        up->seq = up->seq == 255 ? 1 : up->seq + 1; ///< el 0 es del inicio y el commit
+        status = uploader_exchange(up, frame, wave_upload_frame_data(frame, up->seq, off, &bytes[off], n), up->seq);
+    }
+    if (status == WAVE_UPLOAD_OK) {
+        status = uploader_exchange(up, frame, wave_upload_frame_commit(frame, crc), 0);
+    }
+    return status;
+}
+
+/**
+ * @brief Upload a table.
+ *
+ * @param up Uploader.
+ * @param points Table, full scale 0-65535.
+ * @param count Points (the device only takes its own table length).
+ * @return WAVE_UPLOAD_OK, the status the device kept answering, or -1 if
+ *         it did not answer.
+ */
+int uploader_send(uploader_t *up, const uint16_t *points, uint32_t count) {
+    uint8_t bytes[WAVE_UPLOAD_MAX_POINTS * 2];
+    int status = WAVE_UPLOAD_BAD_RANGE;
+    if (count == 0 || count > WAVE_UPLOAD_MAX_POINTS) {
+        return status;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        bytes[2 * i] = (uint8_t)points[i];
+        bytes[2 * i + 1] = (uint8_t)(points[i] >> 8);
+    }
+    uint16_t crc = wave_upload_crc(0xFFFF, bytes, count * 2);
+    for (uint32_t attempt = 0; attempt <= UPLOADER_RETRIES; attempt++) {
+        if (attempt) {
+            up->restarts++;
+        }
+        status = uploader_session(up, bytes, count, crc);
+        if (status != WAVE_UPLOAD_BAD_TABLE && status != WAVE_UPLOAD_NO_START) {
+            break;
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief Resample one period to @p count points by linear interpolation.
+ *
+ * @param in One period of @p n values (the point after the last is the first).
+ * @param out Destination, full scale 0-65535.
+ * @param normalize Stretch the minimum to 0 and the maximum to 65535;
+ *        otherwise the values are taken as 0-65535 and clamped.
+ */
+void uploader_resample(const double *in, uint32_t n, uint16_t *out, uint32_t count, int normalize) {
+    double lo = 0.0;
+    double hi = 65535.0;
+    if (normalize) {
+        lo = hi = in[0];
+        for (uint32_t i = 1; i < n; i++) {
+            lo = in[i] < lo ? in[i] : lo;
+            hi = in[i] > hi ? in[i] : hi;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        double pos = (double)i * n / count;
+        uint32_t a = (uint32_t)pos;
+        double f = pos - a;
+        double v = in[a % n] * (1.0 - f) + in[(a + 1) % n] * f;
+        v = hi > lo ? (v - lo) * 65535.0 / (hi - lo) : 32768.0;
+        v = v < 0.0 ? 0.0 : v > 65535.0 ? 65535.0 : v;
+        out[i] = (uint16_t)lrint(v);
+    }
+}
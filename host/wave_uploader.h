@@ -0,0 +1,58 @@
+/**
+ * @file wave_uploader.h
+ * @brief Host side of the waveform upload protocol (wave_upload.h), over any byte link.
+ */
+
+// Avoid duplication in code
+#ifndef _WAVE_UPLOADER_H_
+#define _WAVE_UPLOADER_H_
+
+#include <stdint.h>
+
+#include "wave_upload.h"
+
+#define UPLOADER_TIMEOUT_MS 500 ///< Espera de una respuesta (mayor que WAVE_UPLOAD_TIMEOUT_US)
+#define UPLOADER_RETRIES 8 ///< Reenvios de una trama, y reintentos de la transferencia entera
+
+/**
+ * @brief Send bytes to the device; 0 if sent, negative on a link error.
+ */
+typedef int32_t (*uploader_write_t)(const uint8_t *buf, uint32_t len, void *ctx);
+
+/**
+ * @brief Receive bytes from the device within a timeout.
+ *
+ * @return Bytes read, 0 on timeout, negative on a link error.
+ */
+typedef int32_t (*uploader_read_t)(uint8_t *buf, uint32_t len, uint32_t timeout_ms, void *ctx);
+
+/**
+ * @brief Clock of the link in ms (the device log keeps a port busy, so
+ *        waits are bounded by time, not by silence).
+ */
+typedef uint32_t (*uploader_clock_t)(void *ctx);
+
+/**
+ * @brief Uploader state.
+ */
+typedef struct {
+    uploader_write_t write;     ///< Envio al equipo
+    uploader_read_t read;       ///< Recepcion del equipo
+    uploader_clock_t now_ms;    ///< Reloj del enlace
+    void *ctx;                  ///< Contexto del enlace
+    uint32_t timeout_ms;        ///< Espera de una respuesta
+    uint8_t rx[64];             ///< Bytes recibidos aun sin analizar
+    uint32_t rx_len;            ///< Bytes en rx
+    uint8_t seq;                ///< Secuencia de la ultima trama de datos
+    uint32_t frames;            ///< Tramas enviadas (con los reenvios)
+    uint32_t resent;            ///< Tramas reenviadas
+    uint32_t restarts;          ///< Transferencias empezadas de nuevo
+    uint32_t skipped;           ///< Bytes recibidos que no eran respuestas (el registro del equipo)
+} uploader_t;
+
+void uploader_init(uploader_t *up, uploader_write_t write, uploader_read_t read, uploader_clock_t now_ms,
+                   void *ctx);
+int uploader_send(uploader_t *up, const uint16_t *points, uint32_t count);
+void uploader_resample(const double *in, uint32_t n, uint16_t *out, uint32_t count, int normalize);
+
+#endif
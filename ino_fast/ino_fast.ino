@@ -0,0 +1,356 @@
+
+/**
+ * @file ino_fast.ino
+ * @brief Versión de alto rendimiento de Polling_Ino_final.ino para el RP2040 (núcleo arduino-pico).
+ *
+ * Misma interfaz que el sketch original: teclado matricial 4x4 (A amplitud, B offset, C frecuencia, D confirma),
+ * pulsador para cambiar la forma de onda y estado por el puerto serial cada segundo. Cambia el camino de las muestras:
+ *
+ * - Las tablas son const uint8_t y quedan en la flash; el original las guarda como int[] en la RAM (cuatro veces más).
+ * - El periodo escalado (amplitud y offset con la misma normalización que generator()) se calcula una sola vez por
+ *   cambio de parámetros, ya convertido en palabras GPIO con el mapa de pines del DAC. Cada muestra es una sola
+ *   escritura enmascarada de los ocho bits (gpio_put_masked) en lugar de ocho digitalWrite.
+ * - El muestreo lo dispara una alarma del temporizador del RP2040 y no loop(): el teclado y el serial no mueven los
+ *   instantes de muestreo. Un cambio de parámetros entra al acabar el periodo en curso de la señal.
+ *
+ * En el host se ejecuta sobre el simulador del RP2040 con un Arduino.h de prueba (host/sim/sim_ino.c), que lo compara
+ * con Polling_Ino_final.ino.
+ */
+
+
+#include <stdint.h>  ///< Incluye la biblioteca estándar de tipos de datos enteros.
+#include <Arduino.h> ///< Incluye la biblioteca de Arduino para el desarrollo de proyectos.
+#include <hardware/gpio.h>
+#include <hardware/irq.h>
+#include <hardware/timer.h>
+
+/**
+ * @brief Pines GPIO del DAC0808 (D0 a D7) y parámetros del muestreo.
+ */
+const uint8_t DAC_PINS[8] = {16, 17, 18, 19, 20, 21, 22, 26}; ///< Pines de D0..D7 del DAC0808.
+const uint8_t POINTS = 100;           ///< Muestras por periodo de la señal.
+const uint32_t SAMPLE_ALARM = 2;      ///< Alarma del temporizador (el pool de alarmas del núcleo usa la 3).
+const uint32_t MIN_PERIOD_US = 2;     ///< Periodo de muestreo mínimo: 500 kmuestras/s.
+const unsigned int MAX_FREQUENCY = 1000000 / POINTS / MIN_PERIOD_US; ///< Frecuencia máxima (Hz) con 100 puntos.
+
+const unsigned int MAX_AMPLITUDE = 2500; ///< Definir constantes para la amplitud máxima y el desplazamiento máximo en milivoltios
+const unsigned int MAX_OFFSET = 1250;
+
+/**
+ * @brief Tablas de las formas de onda, en la flash.
+ *
+ * Son las de Polling_Ino_final.ino como uint8_t; la cuadrada tiene 50 puntos arriba y 50 abajo (la del original
+ * tiene 96 valores y el periodo de 100 puntos se salía de la tabla).
+ */
+const uint8_t seno[] = {128, 136, 144, 152, 160, 167, 175, 182, 189, 196, 203, 209, 215, 221, 226, 231, 236, 240,
+                        243, 247, 249, 251, 253, 254, 255, 255, 255, 254, 252, 250, 248, 245, 242, 238, 234, 229,
+                        224, 218, 213, 206, 200, 193, 186, 179, 171, 163, 156, 148, 140, 132, 123, 115, 107, 99,
+                        92, 84, 76, 69, 62, 55, 49, 42, 37, 31, 26, 21, 17, 13, 10, 7, 5, 3, 1, 0, 0, 0, 1, 2, 4,
+                        6, 8, 12, 15, 19, 24, 29, 34, 40, 46, 52, 59, 66, 73, 80, 88, 95, 103, 111, 119, 127};
+
+const uint8_t triangular[] = {0, 5, 10, 15, 20, 26, 31, 36, 41, 46, 51, 56, 61, 66, 71, 76, 82,
+                              87, 92, 97, 102, 107, 112, 117, 122, 127, 133, 138, 143, 148, 153, 158, 163, 168,
+                              173, 178, 184, 189, 194, 199, 204, 209, 214, 219, 224, 229, 235, 240, 245, 250, 255,
+                              250, 245, 240, 235, 229, 224, 219, 214, 209, 204, 199, 194, 189, 184, 178, 173, 168,
+                              163, 158, 153, 148, 143, 138, 133, 127, 122, 117, 112, 107, 102, 97, 92, 87, 82,
+                              77, 71, 66, 61, 56, 51, 46, 41, 36, 31, 25, 20, 15, 10, 5};
+
+const uint8_t sierra[] = {129, 131, 134, 137, 139, 142, 144, 147, 149, 152, 155, 157, 160, 162, 165, 167,
+                          170, 173, 175, 178, 180, 183, 185, 188, 191, 193, 196, 198, 201, 203, 206, 209,
+                          211, 214, 216, 219, 222, 224, 227, 229, 232, 234, 237, 240, 242, 245, 247, 250,
+                          252, 255,   0,   3,   5,   8,  10,  13,  15,  18,  21,  23,  26,  28,  31,  33,
+                          36,  39,  41,  44,  46,  49,  52,  54,  57,  59,  62,  64,  67,  70,  72,  75,
+                          77,  80,  82,  85,  88,  90,  93,  95,  98, 100, 103, 106, 108, 111, 113, 116,
+                          118, 121, 124, 126};
+
+const uint8_t cuadrada[] = {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+                            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+                            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+                            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static_assert(sizeof(seno) == POINTS && sizeof(triangular) == POINTS && sizeof(sierra) == POINTS
+              && sizeof(cuadrada) == POINTS, "las tablas tienen un punto por muestra del periodo");
+
+const uint8_t *const WAVES[4] = {seno, triangular, sierra, cuadrada}; ///< Tabla de cada tipo (0 a 3)
+
+/**
+ * @brief Tiempo entre muestras: 10000 / frecuencia us, con el resto acumulado para que la frecuencia media sea exacta.
+ */
+struct sample_timing_t {
+    uint32_t period_us; ///< Parte entera del periodo de muestreo
+    uint32_t rem;       ///< Resto de 1000000 / POINTS entre la frecuencia
+    uint32_t div;       ///< Frecuencia (divisor del resto)
+};
+
+uint32_t dac_mask = 0;            ///< Lineas del DAC en una palabra GPIO
+uint32_t period_words[2][POINTS]; ///< Periodo escalado en palabras GPIO: el activo y el siguiente
+sample_timing_t timing[2];        ///< Tiempo de muestreo de cada buffer
+volatile uint8_t active = 0;      ///< Buffer que lee la interrupción
+volatile bool pending = false;    ///< El otro buffer entra al acabar el periodo en curso
+volatile uint32_t missed = 0;     ///< Plazos de muestreo perdidos
+uint8_t sample_index = 0;         ///< Muestra del periodo (solo la interrupción)
+uint32_t deadline = 0;            ///< Instante de la próxima muestra en us (solo la interrupción)
+uint32_t remainder_acc = 0;       ///< Resto acumulado del periodo de muestreo (solo la interrupción)
+
+/**
+ * @brief Palabra GPIO de un código del DAC: cada bit del código en el pin de su línea.
+ *
+ * @param code Código de 8 bits.
+ * @return Niveles de los ocho pines del DAC, para gpio_put_masked().
+ */
+uint32_t dac_word(uint8_t code) {
+    uint32_t word = 0;
+    for (int bit = 0; bit < 8; bit++) {
+        if (code & (1u << bit)) {
+            word |= 1u << DAC_PINS[bit];
+        }
+    }
+    return word;
+}
+
+/**
+ * @brief Calcula un periodo de la señal en un buffer, listo para la interrupción.
+ *
+ * @param buf Buffer a llenar (0 o 1).
+ * @param cont El tipo de forma de onda. 0 para senoidal, 1 para triangular, 2 para de sierra, 3 para cuadrada.
+ * @param Amp La amplitud máxima de la señal (pico a pico) en milivoltios.
+ * @param DC El componente de CC (nivel de desplazamiento) de la señal en milivoltios.
+ * @param frequency La frecuencia de la señal en Hz.
+ */
+void fill_period(uint8_t buf, int cont, int Amp, int DC, unsigned int frequency) {
+    Amp /= 2;
+    int norm_DC = 255 - ((DC * 255) / 1250); ///< Normalizar DC y Amp como generator() del original
+    int norm_Amp = 2500 / Amp;
+
+    const uint8_t *table = WAVES[cont];
+    for (int i = 0; i < POINTS; i++) {
+        period_words[buf][i] = dac_word((uint8_t)(table[i] / norm_Amp - norm_DC));
+    }
+    timing[buf].period_us = 1000000 / POINTS / frequency;
+    timing[buf].rem = 1000000 / POINTS % frequency;
+    timing[buf].div = frequency;
+}
+
+/**
+ * @brief Interrupción de la alarma de muestreo: escribe una muestra y programa la siguiente.
+ *
+ * Los plazos avanzan sobre una línea de tiempo fija, así el tiempo de la interrupción no se acumula. La alarma
+ * compara los 32 bits bajos del temporizador, por lo que un plazo ya pasado esperaría a la vuelta del contador:
+ * se cuenta como perdido y se reprograma desde ahora.
+ */
+void __not_in_flash_func(sample_isr)() {
+    hw_clear_bits(&timer_hw->intr, 1u << SAMPLE_ALARM);
+    gpio_put_masked(dac_mask, period_words[active][sample_index]);
+
+    if (++sample_index == POINTS) {
+        sample_index = 0;
+        if (pending) {
+            active ^= 1;
+            pending = false;
+            remainder_acc = 0;
+        }
+    }
+    const sample_timing_t &t = timing[active];
+    deadline += t.period_us;
+    remainder_acc += t.rem;
+    if (remainder_acc >= t.div) {
+        remainder_acc -= t.div;
+        deadline++;
+    }
+    timer_hw->alarm[SAMPLE_ALARM] = deadline;
+    uint32_t now = time_us_32();
+    if ((int32_t)(deadline - now) <= 0) {
+        missed++;
+        deadline = now + t.period_us;
+        timer_hw->alarm[SAMPLE_ALARM] = deadline;
+    }
+}
+
+/**
+ * @brief Parámetros de la señal que edita el teclado.
+ */
+int count = 0;                  ///< Contador para el tipo de forma de onda
+unsigned int amplitude = 1000;  ///< Amplitud predeterminada de la señal (en mV)
+unsigned int offsete = 100;     ///< Desplazamiento predeterminado de la señal (en mV)
+unsigned int frequency = 10;    ///< Frecuencia predeterminada de la señal (en Hz)
+
+/**
+ * @brief Prepara los parámetros actuales en el buffer libre; la interrupción los toma al acabar el periodo.
+ *
+ * Mientras se llena el buffer no hay cambio pendiente, así que la interrupción no lo toca.
+ */
+void apply_params() {
+    noInterrupts();
+    pending = false;
+    uint8_t next = active ^ 1;
+    interrupts();
+    fill_period(next, count, amplitude, offsete, frequency);
+    pending = true;
+}
+
+/**
+ * @brief Definiciones para el control del teclado.
+ */
+unsigned long last_button_press = 0; ///< Último tiempo de pulsación del botón
+
+
+char matrix_keys[4][4] = {      ///< Definir las teclas de la matriz
+    {'1', '2', '3', 'A'},
+    {'4', '5', '6', 'B'},
+    {'7', '8', '9', 'C'},
+    {'*', '0', '#', 'D'}
+};
+
+
+int keypad_rows[] = {2, 3, 4, 5};   ///< Definir los pines del teclado
+int keypad_columns[] = {6, 7, 8, 9};
+int button_pin = 1;
+
+
+int col_pins[4];    ///< Variables para pines de columna y fila
+int row_pins[4];
+
+
+unsigned long last_keypress_time = 0;   ///< Variable para almacenar el tiempo de la última pulsación
+unsigned long last_print_time = 0;      ///< Tiempo de la última impresión del estado
+char text_input[20] = {0};              ///< Texto ingresado por el teclado
+
+
+void asignacion() {                     ///< Función para inicializar los pines del teclado
+    for (int dato = 0; dato < 4; dato++) {
+        row_pins[dato] = keypad_rows[dato];
+        pinMode(row_pins[dato], OUTPUT);
+        col_pins[dato] = keypad_columns[dato];
+        pinMode(col_pins[dato], INPUT_PULLDOWN);
+    }
+}
+
+/**
+ * @brief Configuración inicial del programa.
+ *
+ * Configura los pines del teclado y del DAC0808, inicia la comunicación serial, calcula el primer periodo de la
+ * señal y arranca la alarma de muestreo.
+ */
+void setup() {
+    asignacion(); ///< Inicializa los pines del teclado.
+    Serial.begin(9600); ///< Inicia la comunicación serial a 9600 baudios.
+    for (int bit = 0; bit < 8; bit++) {
+        pinMode(DAC_PINS[bit], OUTPUT); ///< Configura los pines del DAC como salidas.
+    }
+    dac_mask = dac_word(0xFF);
+
+    fill_period(0, count, amplitude, offsete, frequency);
+    active = 0;
+    hardware_alarm_claim(SAMPLE_ALARM); ///< Que otra biblioteca no la tome con hardware_alarm_claim_unused().
+    hw_clear_bits(&timer_hw->intr, 1u << SAMPLE_ALARM);
+    irq_set_exclusive_handler(TIMER_IRQ_0 + SAMPLE_ALARM, sample_isr);
+    hw_set_bits(&timer_hw->inte, 1u << SAMPLE_ALARM);
+    irq_set_enabled(TIMER_IRQ_0 + SAMPLE_ALARM, true);
+    deadline = time_us_32() + timing[0].period_us;
+    timer_hw->alarm[SAMPLE_ALARM] = deadline;
+    last_print_time = millis();
+}
+
+/**
+ * @brief Función principal del programa.
+ *
+ * Lee el teclado y el pulsador y cada segundo imprime el estado por el puerto serial; las muestras las escribe la
+ * interrupción.
+ */
+void loop() {
+    // Escanear el teclado
+    for (int row = 0; row < 4; row++) {
+        digitalWrite(row_pins[row], HIGH);
+        for (int col = 0; col < 4; col++) {
+            if (digitalRead(col_pins[col]) == HIGH) {
+                unsigned long current_time = micros();
+                if (current_time - last_keypress_time > 500000) { ///< 500ms en microsegundos
+                    char key_pressed = matrix_keys[row][col];
+                    if (key_pressed == 'D') {  ///< Si se presiona 'D', finalizar la entrada
+                        Serial.print("Texto ingresado: ");
+                        Serial.println(text_input);
+                        if (text_input[0] == 'A') {
+                            unsigned int amplitud = atoi(&text_input[1]);
+                            if (amplitud >= 100 && amplitud <= MAX_AMPLITUDE) {
+                                amplitude = amplitud;
+                                apply_params();
+                                Serial.print("Configuración ingresada: Amplitud -> ");
+                                Serial.println(amplitude);
+                            } else {
+                                Serial.println("Configuración de amplitud inválida");
+                            }
+                        } else if (text_input[0] == 'B') {
+                            unsigned int offset = atoi(&text_input[1]);
+                            if (offset >= 50 && offset <= MAX_OFFSET) {
+                                offsete = offset;
+                                apply_params();
+                                Serial.print("Configuración ingresada: Offset -> ");
+                                Serial.println(offsete);
+                            } else {
+                                Serial.println("Configuración de offset inválida");
+                            }
+                        } else if (text_input[0] == 'C') {
+                            unsigned int frecuencia = atoi(&text_input[1]);
+                            if (frecuencia >= 1 && frecuencia <= MAX_FREQUENCY) {
+                                frequency = frecuencia;
+                                apply_params();
+                                Serial.print("Configuración ingresada: Frecuencia -> ");
+                                Serial.println(frequency);
+                            } else {
+                                Serial.println("Configuración de frecuencia inválida");
+                            }
+                        }
+                        text_input[0] = '\0';  ///< Reiniciar el texto ingresado
+                    } else {
+                        strncat(text_input, &key_pressed, 1);
+                        if (strlen(text_input) >= 10) {  ///< Límite de caracteres
+                            Serial.println("Texto demasiado largo. Presione 'D' para finalizar.");
+                            text_input[0] = '\0';  ///< Reiniciar el texto ingresado
+                        }
+                    }
+                    last_keypress_time = current_time;
+                }
+            }
+        }
+        digitalWrite(row_pins[row], LOW);
+    }
+
+    // Control de botón para cambiar el tipo de forma de onda
+    if (digitalRead(button_pin) == HIGH) {
+        unsigned long current_time = millis();
+        if (current_time - last_button_press > 300) {
+            count = (count + 1) % 4;  ///< Incrementar el contador al presionar el botón
+            apply_params();
+            last_button_press = current_time;
+        }
+    }
+
+    // Impresión de información por el puerto serial
+    unsigned long current_time = millis();
+    if (current_time - last_print_time >= 1000) {
+        Serial.print("Señal: Tipo -> ");
+        switch (count) {
+            case 0:
+                Serial.print("senoidal");
+                break;
+            case 1:
+                Serial.print("triangular");
+                break;
+            case 2:
+                Serial.print("diente de sierra");
+                break;
+            case 3:
+                Serial.print("cuadrada");
+                break;
+        }
+        Serial.print(", Amplitud -> ");
+        Serial.print(amplitude);
+        Serial.print(" mV, Offset -> ");
+        Serial.print(offsete);
+        Serial.print(" mV, Frecuencia -> ");
+        Serial.print(frequency);
+        Serial.println(" Hz");
+        last_print_time = current_time;
+    }
+}
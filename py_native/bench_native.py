@@ -0,0 +1,92 @@
+"""
+ * @file bench_native.py
+ * @brief Comparacion del bucle en Python puro de Polling_Python_final.py con el modulo nativo.
+ * Mide las muestras por segundo de generator() + set_dac_value() (ocho Pin.value() por muestra) frente a
+ * siggen_native.fill() + write_block() con los mismos parametros. En la Pico usa los pines reales; en el
+ * puerto unix de MicroPython usa pines simulados.
+ * SIN VERIFICAR: este script aun no se ha ejecutado ni en la Pico ni en el puerto unix. La parte nativa se mide
+ * en host/natmod_check, que compila siggen_native.c con el compilador del host.
+"""
+
+import math
+import time
+
+try:
+    from machine import Pin
+    ON_BOARD = True
+except ImportError:
+    ON_BOARD = False
+
+    class Pin:
+        OUT = 1
+
+        def __init__(self, n, mode=None, value=0):
+            self.v = value
+
+        def value(self, v=None):
+            if v is not None:
+                self.v = 1 if v else 0
+            return self.v
+
+import siggen_native
+
+SAMPLES = 20000
+BLOCK = 256
+
+pins = [Pin(n, Pin.OUT) for n in (16, 17, 18, 19, 20, 21, 22, 26)]
+
+# Mismo periodo senoidal que Polling_Python_final.py (100 puntos)
+seno = [int(127.5 + 127.5 * math.sin(2 * math.pi * i / 100)) for i in range(100)]
+signal_index = 0
+
+def set_dac_value(value):
+    pins[0].value(value & 0x01)
+    pins[1].value(value & 0x02)
+    pins[2].value(value & 0x04)
+    pins[3].value(value & 0x08)
+    pins[4].value(value & 0x10)
+    pins[5].value(value & 0x20)
+    pins[6].value(value & 0x40)
+    pins[7].value(value & 0x80)
+
+def generator(Amp, DC):
+    global signal_index
+    Amp //= 2
+    signal = seno[signal_index]
+    norm_DC = 255 - ((DC * 255) // 1250)
+    norm_Amp = 2500 // Amp
+    signal = (signal // norm_Amp) - norm_DC
+    set_dac_value(signal)
+    signal_index += 1
+    signal_index %= 100
+
+def rate(samples, us):
+    return samples * 1000000 // us if us else 0
+
+t0 = time.ticks_us()
+for _ in range(SAMPLES):
+    generator(2500, 1250)
+python_us = time.ticks_diff(time.ticks_us(), t0)
+
+siggen_native.setup(0, 2500, 1250, 1000000, 5)
+buf = bytearray(BLOCK)
+t0 = time.ticks_us()
+for _ in range(SAMPLES // BLOCK):
+    siggen_native.fill(buf)
+    siggen_native.write_block(buf, 0)
+native_us = time.ticks_diff(time.ticks_us(), t0)
+native_samples = SAMPLES // BLOCK * BLOCK
+
+py_rate = rate(SAMPLES, python_us)
+nat_rate = rate(native_samples, native_us)
+print("python: %d samples/s (max %d Hz at 100 points)" % (py_rate, py_rate // 100))
+print("native: %d samples/s, %dx" % (nat_rate, nat_rate // py_rate if py_rate else 0))
+
+if ON_BOARD:
+    # Ritmo sostenido con el temporizador, a 200 kHz durante 1 s
+    siggen_native.start()
+    w0, s0 = siggen_native.stats()
+    for _ in range(50):
+        siggen_native.run(20000)
+    w, s = siggen_native.stats()
+    print("paced at 200 kHz: %d written, %d skipped in 1 s" % (w - w0, s - s0))
@@ -0,0 +1,70 @@
+"""
+ * @file siggen.py
+ * @brief Interfaz Python del modulo nativo siggen_native.
+ * Envuelve el generador DDS y la salida temporizada del modulo nativo con los mismos parametros que usa
+ * Polling_Python_final.py (tipo 0-3, amplitud y offset en mV, frecuencia en Hz), de modo que el programa
+ * solo entrega rebanadas de tiempo al modulo y sigue leyendo el teclado en Python.
+"""
+
+from machine import Pin
+import siggen_native
+
+# GPIO del DAC0808, D0 a D7
+DAC_PINS = (16, 17, 18, 19, 20, 21, 22, 26)
+
+# Periodo de muestreo por defecto: 200 kHz
+SAMPLE_PERIOD_US = 5
+
+"""
+@brief Generador de señales con la ruta de muestras en código nativo.
+
+Configura los pines del DAC como salidas en bajo (el módulo nativo solo los conmuta) y guarda los
+parámetros para aplicarlos con un solo cambio al final del periodo.
+
+@param period_us: Periodo de muestreo en microsegundos.
+"""
+class Generator:
+    def __init__(self, period_us=SAMPLE_PERIOD_US):
+        self.pins = [Pin(n, Pin.OUT, value=0) for n in DAC_PINS]
+        self.period_us = period_us
+        self.started = False
+
+    """
+    @brief Aplica tipo, amplitud, offset y frecuencia; el cambio entra al final del periodo en curso.
+
+    @param cont: Tipo de forma de onda (0 senoidal, 1 triangular, 2 diente de sierra, 3 cuadrada).
+    @param Amp: Amplitud en mV.
+    @param DC: Offset en mV.
+    @param frequency: Frecuencia en Hz.
+    """
+    def setup(self, cont, Amp, DC, frequency):
+        siggen_native.setup(cont, Amp, DC, int(frequency * 1000), self.period_us)
+
+    """
+    @brief Reproduce la señal durante una rebanada de tiempo y devuelve las muestras escritas.
+
+    Las muestras cuyo plazo pasó mientras corría Python se saltan, así la frecuencia y la fase se mantienen.
+
+    @param slice_us: Duración de la rebanada en microsegundos.
+    """
+    def play(self, slice_us):
+        if not self.started:
+            siggen_native.start()
+            self.started = True
+        return siggen_native.run(slice_us)
+
+    """
+    @brief Escribe un bloque de códigos en el DAC, seguidos o uno por periodo.
+
+    @param codes: bytes o bytearray con los códigos.
+    @param period_us: Tiempo entre códigos (0: lo más rápido posible).
+    @return: Códigos escritos tarde.
+    """
+    def write_block(self, codes, period_us=0):
+        return siggen_native.write_block(codes, period_us)
+
+    """
+    @brief Muestras escritas y saltadas desde el último cambio de periodo de muestreo.
+    """
+    def stats(self):
+        return siggen_native.stats()
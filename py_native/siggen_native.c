@@ -0,0 +1,207 @@
+/**
+ * @file siggen_native.c
+ * @brief MicroPython native module (natmod): DDS generator and paced DAC writes.
+ *
+ * Gives Polling_Python_final.py the sample path of the C firmwares: the
+ * period is scaled once into the wave cache (amplitude and offset as in
+ * generator()), a 32-bit DDS walks it, and each code reaches the eight
+ * DAC lines with a single GPIO toggle. The output loop is paced by the
+ * 1 us timer (dac_pace.h) and returns after a slice of time, so the keypad
+ * stays in Python.
+ *
+ * Functions:
+ *
+ * - setup(shape, amplitude_mv, offset_mv, freq_mhz, period_us)
+ * - start(), run(slice_us) -> samples written
+ * - fill(buf): next codes of the generator into a buffer, without output
+ * - write(code), write_block(buf, period_us) -> codes written late
+ * - stats() -> (written, skipped), code() -> code on the bus
+ *
+ * On the Pico (ARCH=armv6m) the timer and the GPIO toggle are register
+ * accesses, as a native module cannot call the SDK; the pins must already
+ * be outputs (machine.Pin(n, Pin.OUT)). On the unix port (ARCH=x64) the bus
+ * is only the value code() returns and the clock is virtual, advancing one
+ * microsecond per read, so run() is deterministic.
+ */
+
+#include "py/dynruntime.h"
+
+#include "dac_pace.h"
+#include "dds.h"
+#include "wave_cache.h"
+#include "waveform.h"
+
+#define SIGGEN_NATIVE_MAX_WAIT_US 100000u ///< Espera maxima de un cambio por el fin del periodo
+
+#if defined(__thumb__)
+#define SIO_GPIO_OUT_XOR (*(volatile uint32_t *)0xd000001cu) ///< Conmutacion atomica de las salidas
+#define TIMER_TIMERAWL (*(volatile uint32_t *)0x40054028u)   ///< Temporizador de 1 us, sin latch
+#endif
+
+static wave_cache_t cache; ///< Periodo escalado que lee el generador
+static gen_state_t gen; ///< Acumulador de fase del generador
+static dac_pace_t pace; ///< Linea de tiempo de las muestras
+static bool configured; ///< setup() ya dejo un periodo activo
+
+#if !defined(__linux__)
+// The module links no C library
+void *memset(void *s, int c, size_t n) {
+    return mp_fun_table.memset_(s, c, n);
+}
+
+void *memcpy(void *dst, const void *src, size_t n) {
+    return mp_fun_table.memmove_(dst, src, n);
+}
+#endif
+
+#if defined(__thumb__)
+uint32_t dac_pace_hw_now_us(void) {
+    return TIMER_TIMERAWL;
+}
+
+void dac_pace_hw_toggle(uint32_t mask) {
+    SIO_GPIO_OUT_XOR = mask;
+}
+#else
+static uint32_t virtual_us; ///< Reloj virtual del puerto unix
+
+uint32_t dac_pace_hw_now_us(void) {
+    return virtual_us++;
+}
+
+void dac_pace_hw_toggle(uint32_t mask) {
+    (void)mask; ///< el bus es pace.bus
+}
+#endif
+
+/**
+ * @brief setup(shape, amplitude_mv, offset_mv, freq_mhz, period_us)
+ *
+ * Scales the period and sets the step. After the first call a change goes
+ * in at the next period boundary (or after SIGGEN_NATIVE_MAX_WAIT_US), as
+ * in the C firmwares; a new sample period restarts the timeline.
+ */
+static mp_obj_t siggen_setup(size_t n_args, const mp_obj_t *args) {
+    mp_int_t shape = mp_obj_get_int(args[0]);
+    mp_int_t amplitude = mp_obj_get_int(args[1]);
+    mp_int_t offset = mp_obj_get_int(args[2]);
+    mp_int_t freq_mhz = mp_obj_get_int(args[3]);
+    mp_int_t period_us = mp_obj_get_int(args[4]);
+    if (shape < 0 || shape >= WAVEFORM_COUNT) {
+        mp_raise_ValueError(MP_ERROR_TEXT("shape"));
+    }
+    if (amplitude < 2 || offset < 0 || freq_mhz < 0 || period_us < 1) {
+        mp_raise_ValueError(MP_ERROR_TEXT("out of range"));
+    }
+    uint32_t rate = 1000000u / (uint32_t)period_us;
+    if ((uint32_t)period_us != pace.period_us) {
+        uint32_t bus = pace.bus; ///< lo que queda en las lineas
+        dac_pace_init(&pace, &gen, (uint32_t)period_us);
+        pace.bus = bus;
+        dac_pace_start(&pace);
+    }
+    wave_cache_begin(&cache);
+    wave_cache_fill_band(&cache, (uint8_t)shape, waveform_band((uint8_t)shape, (uint32_t)freq_mhz, rate),
+                         (uint32_t)amplitude, (uint32_t)offset);
+    wave_cache_retune(&cache, dds_tuning_word((uint32_t)freq_mhz, rate));
+    wave_cache_commit(&cache, 0, SIGGEN_NATIVE_MAX_WAIT_US / (uint32_t)period_us);
+    if (!configured) {
+        wave_cache_swap(&cache);
+        dds_set_frequency(&gen.dds, (uint32_t)freq_mhz, rate); ///< swap() deja el paso al llamante
+        configured = true;
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(siggen_setup_obj, 5, 5, siggen_setup);
+
+/**
+ * @brief start(): start the timeline one sample period from now.
+ */
+static mp_obj_t siggen_start(void) {
+    dac_pace_start(&pace);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(siggen_start_obj, siggen_start);
+
+/**
+ * @brief run(slice_us): play the generator on the timeline for a slice of time.
+ */
+static mp_obj_t siggen_run(mp_obj_t slice_obj) {
+    if (!configured) {
+        mp_raise_ValueError(MP_ERROR_TEXT("setup first"));
+    }
+    return mp_obj_new_int_from_uint(dac_pace_run(&pace, (uint32_t)mp_obj_get_int(slice_obj)));
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(siggen_run_obj, siggen_run);
+
+/**
+ * @brief fill(buf): the next codes of the generator, without writing them.
+ */
+static mp_obj_t siggen_fill(mp_obj_t buf_obj) {
+    mp_buffer_info_t buf;
+    mp_get_buffer_raise(buf_obj, &buf, MP_BUFFER_WRITE);
+    uint8_t *out = buf.buf;
+    for (size_t i = 0; i < buf.len; i++) {
+        out[i] = gen_next(&gen);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(siggen_fill_obj, siggen_fill);
+
+/**
+ * @brief write(code): put one code on the bus now.
+ */
+static mp_obj_t siggen_write(mp_obj_t code_obj) {
+    dac_pace_put(&pace, (uint8_t)mp_obj_get_int(code_obj));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(siggen_write_obj, siggen_write);
+
+/**
+ * @brief write_block(buf, period_us): write a block of codes, back to back if period_us is 0.
+ */
+static mp_obj_t siggen_write_block(mp_obj_t buf_obj, mp_obj_t period_obj) {
+    mp_buffer_info_t buf;
+    mp_get_buffer_raise(buf_obj, &buf, MP_BUFFER_READ);
+    uint32_t late = dac_pace_write(&pace, buf.buf, buf.len, (uint32_t)mp_obj_get_int(period_obj));
+    return mp_obj_new_int_from_uint(late);
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(siggen_write_block_obj, siggen_write_block);
+
+/**
+ * @brief stats(): (samples written by run(), samples skipped for being late).
+ */
+static mp_obj_t siggen_stats(void) {
+    mp_obj_t items[2] = { mp_obj_new_int_from_uint(pace.played), mp_obj_new_int_from_uint(pace.skipped) };
+    return mp_obj_new_tuple(2, items);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(siggen_stats_obj, siggen_stats);
+
+/**
+ * @brief code(): the code on the bus.
+ */
+static mp_obj_t siggen_code(void) {
+    return mp_obj_new_int(dac_bus_decode((uint16_t)(pace.bus >> DAC_BUS_PIN_BASE)));
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(siggen_code_obj, siggen_code);
+
+mp_obj_t mpy_init(mp_obj_fun_bc_t *self, size_t n_args, size_t n_kw, mp_obj_t *args) {
+    MP_DYNRUNTIME_INIT_ENTRY
+
+    gen.cache = &cache;
+    dds_init(&gen.dds, WAVEFORM_LENGTH, false);
+    wave_cache_init(&cache, WAVEFORM_LENGTH);
+    dac_pace_init(&pace, &gen, 1);
+    configured = false;
+
+    mp_store_global(MP_QSTR_setup, MP_OBJ_FROM_PTR(&siggen_setup_obj));
+    mp_store_global(MP_QSTR_start, MP_OBJ_FROM_PTR(&siggen_start_obj));
+    mp_store_global(MP_QSTR_run, MP_OBJ_FROM_PTR(&siggen_run_obj));
+    mp_store_global(MP_QSTR_fill, MP_OBJ_FROM_PTR(&siggen_fill_obj));
+    mp_store_global(MP_QSTR_write, MP_OBJ_FROM_PTR(&siggen_write_obj));
+    mp_store_global(MP_QSTR_write_block, MP_OBJ_FROM_PTR(&siggen_write_block_obj));
+    mp_store_global(MP_QSTR_stats, MP_OBJ_FROM_PTR(&siggen_stats_obj));
+    mp_store_global(MP_QSTR_code, MP_OBJ_FROM_PTR(&siggen_code_obj));
+
+    MP_DYNRUNTIME_INIT_EXIT
+}
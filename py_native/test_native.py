@@ -0,0 +1,76 @@
+"""
+ * @file test_native.py
+ * @brief Pruebas del modulo nativo siggen_native en el puerto unix de MicroPython.
+ * Ejecutar con: micropython test_native.py (con siggen_native.mpy compilado con ARCH=x64 en el mismo directorio).
+ * En el puerto unix el bus es solo el valor de code() y el reloj es virtual (1 us por lectura).
+ * Termina con PASS o con la lista de fallos y código de salida 1.
+ * SIN VERIFICAR: este script aún no se ha ejecutado en ningún puerto de MicroPython ni con un siggen_native.mpy
+ * enlazado con mpy_ld. Las mismas pruebas, portadas a C, sí se ejecutan en host/natmod_check contra una
+ * imitación de py/dynruntime.h.
+"""
+
+import sys
+import siggen_native
+
+failures = []
+
+def check(ok, what):
+    if not ok:
+        failures.append(what)
+        print("FAIL", what)
+
+# Un paso exacto (2^24, 256 muestras por periodo) a 200 kHz: 781.25 Hz
+PERIOD_US = 5
+EXACT_MHZ = 781250
+
+"""
+@brief El periodo se repite exactamente y queda dentro del rango del DAC.
+"""
+def test_period():
+    siggen_native.setup(0, 2500, 1250, EXACT_MHZ, PERIOD_US)
+    buf = bytearray(512)
+    siggen_native.fill(buf)
+    check(buf[:256] == buf[256:], "sine period repeats")
+    # generator() lleva 2500 mV a media escala del DAC (Amp / 2 y 2500 / Amp)
+    check(max(buf) - min(buf) >= 120, "largest amplitude, half the DAC range")
+    siggen_native.setup(3, 2500, 1250, EXACT_MHZ, PERIOD_US)
+    siggen_native.fill(buf)  # el cambio entra al final del periodo en curso
+    siggen_native.fill(buf)
+    check(len(set(buf)) == 2, "square has two levels")
+    siggen_native.setup(1, 1000, 100, EXACT_MHZ, PERIOD_US)
+    siggen_native.fill(buf)
+    siggen_native.fill(buf)
+    check(max(buf) - min(buf) < 120, "smaller amplitude, smaller swing")
+
+"""
+@brief write() y write_block() dejan el último código en el bus.
+"""
+def test_write():
+    siggen_native.write(0xA5)
+    check(siggen_native.code() == 0xA5, "write")
+    late = siggen_native.write_block(bytes(range(256)), 0)
+    check(late == 0 and siggen_native.code() == 255, "write_block back to back")
+    late = siggen_native.write_block(bytes([1, 2, 3]), PERIOD_US)
+    check(late == 0 and siggen_native.code() == 3, "write_block paced")
+
+"""
+@brief run() escribe una muestra por periodo y salta las que quedaron atrás.
+"""
+def test_run():
+    siggen_native.setup(0, 2500, 1250, EXACT_MHZ, PERIOD_US)
+    siggen_native.start()
+    written, skipped = siggen_native.stats()
+    n = siggen_native.run(10000)
+    check(abs(n - 10000 // PERIOD_US) <= 2, "one sample per period (%d)" % n)
+    # Un bloque pausado de 100 periodos deja la linea de tiempo 100 muestras atrás
+    siggen_native.write_block(bytes(100), PERIOD_US)
+    siggen_native.run(1000)
+    w, s = siggen_native.stats()
+    check(abs(s - skipped - 100) <= 2, "late samples skipped (%d)" % (s - skipped))
+    check(w >= written + n, "written count")
+
+test_period()
+test_write()
+test_run()
+print("FAIL" if failures else "PASS")
+sys.exit(1 if failures else 0)